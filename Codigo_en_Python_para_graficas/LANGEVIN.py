@@ -6,6 +6,8 @@ import os
 # Ruta al archivo de datos.
 # Asegúrate de que esta ruta sea correcta desde donde ejecutes el script.
 file_path = r'Resultados_simulacion/100.0/FIJOS/RES_IMPORTANTES/grafica.txt'
+# Con el barrido adaptativo (BARRIDO_ADAPTATIVO en oscilador.c) los datos están en barrido.txt:
+# file_path = r'Resultados_simulacion/100.0/FIJOS/RES_IMPORTANTES/barrido.txt'
 N = 4  # Número de partículas (monómeros)
 
 # Ruta personalizada para guardar la gráfica
@@ -23,7 +25,8 @@ def theoretical_ree(f):
 try:
     # 1. Cargar los datos del archivo de texto.
     #    La opción unpack=True asigna cada columna a una variable diferente.
-    f_cte, r_ee_exp, error_r_ee = np.loadtxt(file_path, unpack=True)
+    #    Solo las tres primeras columnas (barrido.txt añade el tiempo simulado de cada punto).
+    f_cte, r_ee_exp, error_r_ee = np.loadtxt(file_path, unpack=True, usecols=(0, 1, 2))
 
     # 2. Preparar los datos para la curva teórica.
     #    Creamos un array de fuerzas mucho más denso (500 puntos) para que la
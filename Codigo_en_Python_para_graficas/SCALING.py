@@ -2,10 +2,12 @@ import matplotlib.pyplot as plt
 import numpy as np
 import os
 
-def plot_grafica_txt(ruta_archivo, guardar_imagen=False, titulo=None, b=1.0, usar_log=False, ruta_guardado_personalizada=None):
+def plot_grafica_txt(ruta_archivo, guardar_imagen=False, titulo=None, b=1.0, usar_log=False, ruta_guardado_personalizada=None, flory=False):
     """
     Lee un archivo .txt con formato (N, Rg, error) y crea una gráfica comparando
     con la ley teórica Rg = b * sqrt((N^2 - 1) / (6N)).
+    Con flory=True (cadena real, simulada con VOLUMEN_EXCLUIDO) ajusta además
+    Rg = A * N^nu y lo compara con el exponente de Flory nu = 0.588.
 
     Parámetros:
     - ruta_archivo: ruta al archivo .txt
@@ -14,6 +16,7 @@ def plot_grafica_txt(ruta_archivo, guardar_imagen=False, titulo=None, b=1.0, usa
     - b: longitud media de enlace (por defecto 1.0)
     - usar_log: si True, usa escala log-log
     - ruta_guardado_personalizada: ruta personalizada para guardar la imagen
+    - flory: si True, ajusta el exponente nu de Rg ~ N^nu
     """
     try:
         # Leer datos
@@ -45,6 +48,16 @@ def plot_grafica_txt(ruta_archivo, guardar_imagen=False, titulo=None, b=1.0, usa
             label=r'Teoría $R_g = b \sqrt{\frac{N^2-1}{6N}}$'
         )
 
+        # Ajuste de Flory Rg = A N^nu (cadena con volumen excluido)
+        if flory and len(N) >= 2:
+            nu, log_A = np.polyfit(np.log(N), np.log(Rg), 1)
+            N_fino = np.linspace(N.min(), N.max(), 200)
+            plt.plot(
+                N_fino, np.exp(log_A) * N_fino**nu, '-', color='seagreen', linewidth=2,
+                label=rf'Ajuste $R_g \propto N^{{{nu:.3f}}}$ (Flory: $\nu = 0.588$)'
+            )
+            print(f"Exponente ajustado nu = {nu:.4f} (Flory 0.588, ideal 0.5)")
+
         # Personalización de la gráfica
         if titulo is None:
             titulo = "Radio de giro vs número de monómeros"
@@ -0,0 +1,82 @@
+import numpy as np
+
+# --- Lectura de trayectorias binarias (.bin) sin parsear texto ---
+# El simulador las escribe junto al .txt si se define SALIDA_BINARIA en funciones_oscilador.h
+# (formato en Codigos_en_C/binario.h). Los datos se mapean con np.memmap: no se copian ni se
+# convierten, así que abrir una trayectoria de varios GB es instantáneo y solo se lee del disco
+# lo que se usa. Se puede abrir mientras la simulación sigue escribiendo: se ven las filas ya
+# volcadas (cabecera 'registros').
+
+MAGIA = b'CADBIN01'
+VERSION = 1
+TAM_CABECERA = 64
+OBSERVABLES = ('Ek', 'Ep', 'Et', 'Rg', 'Ree')
+
+_dtype_cabecera = np.dtype([
+    ('magia', 'S8'),
+    ('version', '<i4'),
+    ('N', '<i4'),
+    ('columnas', '<i4'),
+    ('con_particulas', '<i4'),
+    ('dt', '<f8'),
+    ('registros', '<i8'),
+])
+
+
+def lee_cabecera(ruta):
+    """Devuelve la cabecera como diccionario."""
+    cab = np.fromfile(ruta, dtype=_dtype_cabecera, count=1)
+    if len(cab) == 0 or cab['magia'][0] != MAGIA or cab['version'][0] != VERSION:
+        raise ValueError(f"{ruta} no es una trayectoria binaria")
+    return {nombre: cab[nombre][0].item() for nombre in _dtype_cabecera.names if nombre != 'magia'}
+
+
+class TrayectoriaBinaria:
+    """
+    Trayectoria mapeada en memoria. Todos los atributos son vistas del mismo np.memmap:
+      datos  (registros, columnas): la tabla entera, como np.loadtxt del .txt
+      t      (registros,)
+      x, v   (registros, N, 3): posiciones y velocidades (None si no se guardaron)
+      Ek, Ep, Et, Rg, Ree (registros,)
+    """
+
+    def __init__(self, ruta):
+        self.ruta = ruta
+        self.cabecera = lee_cabecera(ruta)
+        self.N = self.cabecera['N']
+        self.dt = self.cabecera['dt']
+        self.columnas = self.cabecera['columnas']
+        self.recarga()
+
+    def recarga(self):
+        """Vuelve a mapear el fichero para ver las filas nuevas de una simulación en marcha."""
+        registros = lee_cabecera(self.ruta)['registros']
+        self.datos = np.memmap(self.ruta, dtype='<f8', mode='r', offset=TAM_CABECERA,
+                               shape=(registros, self.columnas))
+        N = self.N
+        self.t = self.datos[:, 0]
+        if self.cabecera['con_particulas']:
+            self.x = self.datos[:, 1:1 + 3*N].reshape(registros, N, 3)
+            self.v = self.datos[:, 1 + 3*N:1 + 6*N].reshape(registros, N, 3)
+        else:
+            self.x = self.v = None
+        for k, nombre in enumerate(OBSERVABLES):
+            setattr(self, nombre, self.datos[:, self.columnas - len(OBSERVABLES) + k])
+        return self
+
+    def __len__(self):
+        return self.datos.shape[0]
+
+
+def lee_trayectoria(ruta):
+    """Abre un .bin (o el .bin que acompaña a un .txt)."""
+    if ruta.endswith('.txt'):
+        ruta = ruta[:-4] + '.bin'
+    return TrayectoriaBinaria(ruta)
+
+
+if __name__ == '__main__':
+    import sys
+    tr = lee_trayectoria(sys.argv[1])
+    print(f"N = {tr.N}, dt = {tr.dt}, {len(tr)} registros de {tr.columnas} columnas")
+    print(f"<Ree> = {tr.Ree.mean():.6f}, <Rg> = {tr.Rg.mean():.6f}, <Et> = {tr.Et.mean():.6f}")
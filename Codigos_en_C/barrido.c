@@ -0,0 +1,243 @@
+#include "barrido.h"
+
+
+ParametrosBarrido parametros_barrido_defecto(void) {
+    ParametrosBarrido pb;
+    pb.F_min = 0.001;
+    pb.F_max = 20.0;
+    pb.n_inicial = 5;
+    pb.max_puntos = 25;
+    pb.error_objetivo = 0.01;
+    pb.T_equilibrado = 20.0;
+    pb.T_trozo = 50.0;
+    pb.T_maximo = 1500.0;
+    pb.intervalo_muestreo = 0.1;
+    pb.razon_minima = 1.05;
+    return pb;
+}
+
+double ree_langevin(double F, int N, double kb, double Temperatura) {
+    double f = F * L_0 / (kb * Temperatura);
+    if (f < 1e-4) return (N - 1) * L_0 * f / 3.0;  // coth(f) - 1/f ~ f/3
+    return (N - 1) * L_0 * (cosh(f) / sinh(f) - 1.0 / f);
+}
+
+
+void ruta_barrido(double K, char *ruta, size_t tam) {
+    char carpeta[256];
+    #ifdef WLCM
+    snprintf(carpeta, sizeof(carpeta), "Resultados_simulacion/WLCM/%.1f/FIJOS/RES_IMPORTANTES", K);
+    #else
+    snprintf(carpeta, sizeof(carpeta), "Resultados_simulacion/%.1f/FIJOS/RES_IMPORTANTES", K);
+    #endif
+
+    crea_carpetas(carpeta);
+    snprintf(ruta, tam, "%s/barrido.txt", carpeta);
+}
+
+
+#ifdef FIXED
+
+// Un punto del barrido: su estado (doble buffer para un_paso_verlet) y sus estadísticas
+typedef struct {
+    double F_cte;
+    double *memoria;
+    double *x, *v, *F;
+    double *x_nuevo, *v_nuevo, *F_nuevo;
+    double T_simulado;
+    EstimadorBloques ree;
+} PuntoBarrido;
+
+// Parámetros comunes a todos los puntos
+typedef struct {
+    const ParametrosBarrido *pb;
+    int N;
+    double K, dt, m, a, b, sigma;
+    double kb, Temperatura;
+    double *betta;
+} ContextoBarrido;
+
+static int crea_punto(PuntoBarrido *p, double F_cte, int N, double K, const PuntoBarrido *origen) {
+    memset(p, 0, sizeof(PuntoBarrido));
+    p->F_cte = F_cte;
+    p->memoria = malloc(6*3*(size_t)N*sizeof(double));
+    if (!p->memoria) return 0;
+    p->x       = p->memoria;
+    p->v       = p->memoria + 3*N;
+    p->F       = p->memoria + 6*N;
+    p->x_nuevo = p->memoria + 9*N;
+    p->v_nuevo = p->memoria + 12*N;
+    p->F_nuevo = p->memoria + 15*N;
+
+    if (origen) {
+        // Arranque en caliente desde la configuración del vecino
+        memcpy(p->x, origen->x, 3*N*sizeof(double));
+        memcpy(p->v, origen->v, 3*N*sizeof(double));
+    } else {
+        for (int j = 0; j < N; j++) {
+            p->x[3*j] = j * L_0;
+            p->x[3*j+1] = p->x[3*j+2] = 0.0;
+            p->v[3*j] = p->v[3*j+1] = p->v[3*j+2] = 0.0;
+        }
+    }
+    Fuerza_verlet(N, p->x, p->F, K, F_cte);
+    return 1;
+}
+
+static void libera_punto(PuntoBarrido *p) {
+    free(p->memoria);
+    p->memoria = NULL;
+}
+
+// Simula el punto durante T; si 'muestrea', añade Ree cada intervalo_muestreo
+static void simula_punto(ContextoBarrido *c, PuntoBarrido *p, double T, int muestrea) {
+    int N = c->N;
+    long long pasos = (long long)(T / c->dt + 0.5);
+    long long pasos_muestreo = (long long)(c->pb->intervalo_muestreo / c->dt + 0.5);
+    if (pasos_muestreo < 1) pasos_muestreo = 1;
+
+    #ifdef VOLUMEN_EXCLUIDO
+    libera_vecinos();  // La lista de vecinos es de la cadena del punto anterior
+    #endif
+    for (long long paso = 1; paso <= pasos; paso++) {
+        for (int i = 0; i < 3*N; i++) c->betta[i] = gaussian() * c->sigma;
+        un_paso_verlet(c->betta, c->b, c->a, N, p->x, p->x_nuevo, p->v, p->v_nuevo,
+                       p->F, p->F_nuevo, c->dt, c->m, Fuerza_verlet, c->K, p->F_cte);
+
+        double *tmp;
+        tmp = p->x; p->x = p->x_nuevo; p->x_nuevo = tmp;
+        tmp = p->v; p->v = p->v_nuevo; p->v_nuevo = tmp;
+        tmp = p->F; p->F = p->F_nuevo; p->F_nuevo = tmp;
+
+        if (muestrea && paso % pasos_muestreo == 0)
+            anade_estimador_bloques(&p->ree, p->x[3*(N-1)+2] - p->x[2]);
+    }
+    if (muestrea) p->T_simulado += pasos * c->dt;
+}
+
+// Equilibra y simula por trozos hasta el error objetivo o T_maximo
+static void converge_punto(ContextoBarrido *c, PuntoBarrido *p) {
+    const ParametrosBarrido *pb = c->pb;
+    simula_punto(c, p, pb->T_equilibrado, 0);
+    do {
+        simula_punto(c, p, pb->T_trozo, 1);
+    } while (error_estimador_bloques(&p->ree) > pb->error_objetivo && p->T_simulado < pb->T_maximo);
+
+    printf("  -> F_cte = %.6f  <Ree> = %.6f +- %.6f  (T = %.1f)\n", p->F_cte,
+           media_estimador_bloques(&p->ree), error_estimador_bloques(&p->ree), p->T_simulado);
+}
+
+// Segunda derivada de <Ree> respecto a u = ln F en el punto i (diferencias divididas)
+static double curvatura(const PuntoBarrido *p, int n, int i) {
+    if (i <= 0 || i >= n - 1) return 0.0;
+    double u_a = log(p[i-1].F_cte), u = log(p[i].F_cte), u_b = log(p[i+1].F_cte);
+    double y_a = media_estimador_bloques(&p[i-1].ree), y = media_estimador_bloques(&p[i].ree), y_b = media_estimador_bloques(&p[i+1].ree);
+    double s_a = (y - y_a) / (u - u_a), s_b = (y_b - y) / (u_b - u);
+    return 2.0 * (s_b - s_a) / (u_b - u_a);
+}
+
+// Desviación respecto a la curva de Langevin que no explica el error estadístico
+static double desviacion(const ContextoBarrido *c, const PuntoBarrido *p) {
+    double r = fabs(media_estimador_bloques(&p->ree) - ree_langevin(p->F_cte, c->N, c->kb, c->Temperatura));
+    return fmax(0.0, r - 2.0 * error_estimador_bloques(&p->ree));
+}
+
+// Puntuación del intervalo [i, i+1]
+static double puntuacion(const ContextoBarrido *c, const PuntoBarrido *p, int n, int i) {
+    double h = log(p[i+1].F_cte) - log(p[i].F_cte);
+    double d2 = fmax(fabs(curvatura(p, n, i)), fabs(curvatura(p, n, i + 1)));
+    double interpolacion = d2 * h * h / 8.0;
+    return interpolacion + 0.5 * (desviacion(c, &p[i]) + desviacion(c, &p[i+1]));
+}
+
+int barrido_fuerzas(const ParametrosBarrido *pb, double kb, double Temperatura, double alfa, int N,
+                    double dt, double m, double K, const char *archivo_salida) {
+    if (pb->n_inicial < 2 || pb->max_puntos < pb->n_inicial || !(pb->F_max > pb->F_min) || pb->F_min <= 0.0) {
+        printf("Parámetros del barrido no válidos\n");
+        return 0;
+    }
+
+    ContextoBarrido c;
+    c.pb = pb;
+    c.N = N;
+    c.K = K;
+    c.dt = dt;
+    c.m = m;
+    c.kb = kb;
+    c.Temperatura = Temperatura;
+    c.a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    c.b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    c.sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+    c.betta = malloc(3*(size_t)N*sizeof(double));
+    PuntoBarrido *puntos = calloc(pb->max_puntos, sizeof(PuntoBarrido));
+    if (!c.betta || !puntos) {
+        printf("No se pudo reservar memoria para el barrido\n");
+        free(c.betta);
+        free(puntos);
+        return 0;
+    }
+
+    // 1. Rejilla inicial en log F
+    int n = 0;
+    double razon = pow(pb->F_max / pb->F_min, 1.0 / (pb->n_inicial - 1));
+    for (int i = 0; i < pb->n_inicial; i++) {
+        double F_cte = pb->F_min * pow(razon, i);
+        if (!crea_punto(&puntos[n], F_cte, N, K, n > 0 ? &puntos[n-1] : NULL)) break;
+        converge_punto(&c, &puntos[n]);
+        n++;
+    }
+
+    // 2. Refinamiento: punto medio (en log F) del intervalo con más puntuación
+    while (n < pb->max_puntos) {
+        int mejor = -1;
+        double maxima = pb->error_objetivo;
+        for (int i = 0; i < n - 1; i++) {
+            if (puntos[i+1].F_cte / puntos[i].F_cte < pb->razon_minima) continue;
+            double s = puntuacion(&c, puntos, n, i);
+            if (s > maxima) {
+                maxima = s;
+                mejor = i;
+            }
+        }
+        if (mejor < 0) break;
+
+        memmove(&puntos[mejor + 2], &puntos[mejor + 1], (n - mejor - 1)*sizeof(PuntoBarrido));
+        double F_cte = sqrt(puntos[mejor].F_cte * puntos[mejor + 2].F_cte);
+        if (!crea_punto(&puntos[mejor + 1], F_cte, N, K, &puntos[mejor])) {
+            memmove(&puntos[mejor + 1], &puntos[mejor + 2], (n - mejor - 1)*sizeof(PuntoBarrido));
+            break;
+        }
+        printf("Refinando [%.6f, %.6f] (puntuación %.4f)\n", puntos[mejor].F_cte, puntos[mejor + 2].F_cte, maxima);
+        converge_punto(&c, &puntos[mejor + 1]);
+        n++;
+    }
+
+    // 3. Resultados
+    int escritos = n;
+    FILE *f = fopen(archivo_salida, "w");
+    if (!f) {
+        printf("No se pudo crear el archivo %s\n", archivo_salida);
+        escritos = 0;
+    } else {
+        double T_total = 0.0;
+        for (int i = 0; i < n; i++) T_total += puntos[i].T_simulado + pb->T_equilibrado;
+        fprintf(f, "# Barrido adaptativo N %d K %.1f: %d puntos, T total %.1f (rejilla fija: %.1f)\n",
+                N, K, n, T_total, n * (pb->T_maximo + pb->T_equilibrado));
+        fprintf(f, "# F_cte Ree error T_simulado\n");
+        for (int i = 0; i < n; i++)
+            fprintf(f, "%.6f %.6f %.6f %.1f\n", puntos[i].F_cte, media_estimador_bloques(&puntos[i].ree),
+                    error_estimador_bloques(&puntos[i].ree), puntos[i].T_simulado);
+        fclose(f);
+        printf("Barrido: %d puntos, T total %.1f, escrito en %s\n", n, T_total, archivo_salida);
+    }
+
+    #ifdef VOLUMEN_EXCLUIDO
+    libera_vecinos();
+    #endif
+    for (int i = 0; i < n; i++) libera_punto(&puntos[i]);
+    free(puntos);
+    free(c.betta);
+    return escritos;
+}
+
+#endif
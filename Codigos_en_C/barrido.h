@@ -0,0 +1,53 @@
+#pragma once
+
+#include "integracion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+
+/**
+ * Barrido adaptativo de la curva fuerza-extensión <Ree>(F_cte) (solo con FIXED).
+ *
+ * En vez de una lista fija de fuerzas simuladas todas durante el mismo T_fisico:
+ *  - Cada punto se simula por trozos de T_trozo hasta que el error de <Ree> baja de
+ *    error_objetivo (o se llega a T_maximo). El error se estima por bloques (Flyvbjerg-Petersen),
+ *    así que tiene en cuenta la correlación temporal de las muestras.
+ *  - Tras los n_inicial puntos iniciales (espaciados en log F) se añade el punto medio en log F
+ *    del intervalo con más puntuación, hasta max_puntos o hasta que ninguno supera error_objetivo.
+ *    La puntuación de un intervalo es el error de interpolarlo linealmente (curvatura en log F)
+ *    más la desviación significativa (más allá de 2 errores) respecto a la curva de Langevin
+ *    (N-1) L_0 L(F L_0 / kT) de LANGEVIN.py.
+ *  - Cada punto nuevo arranca de la configuración equilibrada de su vecino de la izquierda.
+ */
+
+typedef struct {
+    double F_min, F_max;        // Intervalo de fuerzas
+    int n_inicial;              // Puntos iniciales (al menos 2)
+    int max_puntos;
+    double error_objetivo;      // Error absoluto de <Ree> buscado en cada punto
+    double T_equilibrado;       // Tiempo descartado al empezar cada punto
+    double T_trozo;             // Tiempo simulado entre comprobaciones del error
+    double T_maximo;            // Tiempo máximo (sin equilibrado) por punto
+    double intervalo_muestreo;  // Tiempo entre muestras de Ree
+    double razon_minima;        // No se refinan intervalos con F_{i+1}/F_i menor que esto
+} ParametrosBarrido;
+
+// Valores por defecto razonables para el rango de F_cte_vals de oscilador.c
+ParametrosBarrido parametros_barrido_defecto(void);
+
+// Curva de Langevin: (N-1) L_0 (coth(f) - 1/f) con f = F L_0 / (kb T)
+double ree_langevin(double F, int N, double kb, double Temperatura);
+
+// Ruta de barrido.txt, junto a grafica.txt en RES_IMPORTANTES (crea las carpetas)
+void ruta_barrido(double K, char *ruta, size_t tam);
+
+#ifdef FIXED
+/**
+ * Ejecuta el barrido adaptativo y escribe "F_cte <Ree> error T_simulado" por línea (como
+ * grafica.txt, más el tiempo simulado) en archivo_salida.
+ * @return Número de puntos simulados (0 si hubo un error).
+ */
+int barrido_fuerzas(const ParametrosBarrido *pb, double kb, double Temperatura, double alfa, int N,
+                    double dt, double m, double K, const char *archivo_salida);
+#endif
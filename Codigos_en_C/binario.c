@@ -0,0 +1,135 @@
+#include "binario.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+_Static_assert(sizeof(CabeceraBinaria) == TAM_CABECERA_BINARIA, "La cabecera binaria debe ocupar TAM_CABECERA_BINARIA bytes");
+
+
+int columnas_binarias(int N, int con_particulas) {
+    return 1 + (con_particulas ? 6*N : 0) + COLUMNAS_OBSERVABLES;
+}
+
+void ruta_binaria(const char *ruta_texto, char *ruta, size_t tam) {
+    size_t n = strlen(ruta_texto);
+    if (n >= 4 && strcmp(ruta_texto + n - 4, ".txt") == 0) n -= 4;
+    snprintf(ruta, tam, "%.*s.bin", (int)n, ruta_texto);
+}
+
+static void escribe_cabecera(SalidaBinaria *s) {
+    long posicion = ftell(s->archivo);
+    fseek(s->archivo, 0, SEEK_SET);
+    fwrite(&s->cabecera, sizeof(CabeceraBinaria), 1, s->archivo);
+    fseek(s->archivo, posicion, SEEK_SET);
+}
+
+SalidaBinaria *abre_salida_binaria(const char *ruta, int N, int con_particulas, double dt) {
+    SalidaBinaria *s = calloc(1, sizeof(SalidaBinaria));
+    if (!s) return NULL;
+    s->archivo = fopen(ruta, "wb");
+    if (!s->archivo) {
+        printf("Error al abrir el archivo %s\n", ruta);
+        free(s);
+        return NULL;
+    }
+    memcpy(s->cabecera.magia, MAGIA_BINARIA, 8);
+    s->cabecera.version = VERSION_BINARIA;
+    s->cabecera.N = N;
+    s->cabecera.columnas = columnas_binarias(N, con_particulas);
+    s->cabecera.con_particulas = con_particulas;
+    s->cabecera.dt = dt;
+    s->cabecera.registros = 0;
+    fwrite(&s->cabecera, sizeof(CabeceraBinaria), 1, s->archivo);
+    fflush(s->archivo);
+    return s;
+}
+
+void vuelca_salida_binaria(SalidaBinaria *s) {
+    if (!s) return;
+    // Primero los datos y después la cabecera: un lector nunca ve registros sin escribir
+    fflush(s->archivo);
+    s->cabecera.registros += s->pendientes;
+    s->pendientes = 0;
+    escribe_cabecera(s);
+    fflush(s->archivo);
+}
+
+void escribe_registro_binario(SalidaBinaria *s, const double registro[]) {
+    if (!s) return;
+    fwrite(registro, sizeof(double), s->cabecera.columnas, s->archivo);
+    if (++s->pendientes >= REGISTROS_VOLCADO) vuelca_salida_binaria(s);
+}
+
+void cierra_salida_binaria(SalidaBinaria *s) {
+    if (!s) return;
+    vuelca_salida_binaria(s);
+    fclose(s->archivo);
+    free(s);
+}
+
+
+static int cabecera_valida(const CabeceraBinaria *c, size_t tam) {
+    if (tam < sizeof(CabeceraBinaria)) return 0;
+    if (memcmp(c->magia, MAGIA_BINARIA, 8) != 0 || c->version != VERSION_BINARIA || c->columnas <= 0) return 0;
+    return 1;
+}
+
+int abre_trayectoria_binaria(const char *ruta, TrayectoriaBinaria *t) {
+    memset(t, 0, sizeof(TrayectoriaBinaria));
+#ifdef _WIN32
+    FILE *f = fopen(ruta, "rb");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long tam = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    t->mapa = tam > 0 ? malloc(tam) : NULL;
+    if (!t->mapa || fread(t->mapa, 1, tam, f) != (size_t)tam) {
+        free(t->mapa);
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+    t->tam_mapa = tam;
+#else
+    int fd = open(ruta, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+    t->mapa = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (t->mapa == MAP_FAILED) {
+        t->mapa = NULL;
+        return 0;
+    }
+    t->tam_mapa = st.st_size;
+#endif
+    t->cabecera = (const CabeceraBinaria *)t->mapa;
+    if (!cabecera_valida(t->cabecera, t->tam_mapa)) {
+        printf("%s no es una trayectoria binaria\n", ruta);
+        cierra_trayectoria_binaria(t);
+        return 0;
+    }
+    t->columnas = t->cabecera->columnas;
+    t->datos = (const double *)((const char *)t->mapa + TAM_CABECERA_BINARIA);
+    // Solo las filas completas que caben en el fichero (puede estar escribiéndose)
+    int64_t caben = (int64_t)((t->tam_mapa - TAM_CABECERA_BINARIA) / (t->columnas * sizeof(double)));
+    t->registros = t->cabecera->registros < caben ? t->cabecera->registros : caben;
+    return 1;
+}
+
+void cierra_trayectoria_binaria(TrayectoriaBinaria *t) {
+    if (!t->mapa) return;
+#ifdef _WIN32
+    free(t->mapa);
+#else
+    munmap(t->mapa, t->tam_mapa);
+#endif
+    memset(t, 0, sizeof(TrayectoriaBinaria));
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+
+/**
+ * Trayectorias en binario para leerlas sin parsear texto (con numpy.memmap desde Python,
+ * Codigo_en_Python_para_graficas/trayectoria_binaria.py, o con mmap desde C).
+ *
+ * El fichero es una cabecera de TAM_CABECERA_BINARIA bytes y después 'registros' filas de
+ * 'columnas' doubles en el orden de la máquina, con las mismas columnas que el .txt:
+ *     t [x_0 .. x_{3N-1} v_0 .. v_{3N-1}] Ek Ep Et Rg Ree
+ * (las posiciones y velocidades solo si con_particulas). La cabecera se reescribe en cada
+ * volcado, así que un lector puede mapear el fichero mientras la simulación sigue escribiendo
+ * y ver los registros ya completos.
+ */
+
+#define MAGIA_BINARIA "CADBIN01"
+#define VERSION_BINARIA 1
+#define TAM_CABECERA_BINARIA 64
+#define COLUMNAS_OBSERVABLES 5          // Ek Ep Et Rg Ree
+#define REGISTROS_VOLCADO 256           // Registros entre volcados (y actualizaciones de cabecera)
+
+typedef struct {
+    char magia[8];
+    int32_t version;
+    int32_t N;
+    int32_t columnas;
+    int32_t con_particulas;
+    double dt;
+    int64_t registros;                  // Filas completas escritas
+    char reservado[TAM_CABECERA_BINARIA - 40];
+} CabeceraBinaria;
+
+typedef struct {
+    FILE *archivo;
+    CabeceraBinaria cabecera;
+    int pendientes;                     // Registros escritos desde el último volcado
+} SalidaBinaria;
+
+typedef struct {
+    const CabeceraBinaria *cabecera;
+    const double *datos;                // [registro*columnas + columna]
+    int64_t registros;
+    int columnas;
+    void *mapa;
+    size_t tam_mapa;
+} TrayectoriaBinaria;
+
+// Columnas de una fila: 1 + (6N si con_particulas) + COLUMNAS_OBSERVABLES
+int columnas_binarias(int N, int con_particulas);
+
+// Ruta del .bin de una trayectoria: cambia la extensión .txt (o la añade)
+void ruta_binaria(const char *ruta_texto, char *ruta, size_t tam);
+
+/**
+ * Crea el fichero y escribe la cabecera.
+ * @return La salida, o NULL si no se puede crear.
+ */
+SalidaBinaria *abre_salida_binaria(const char *ruta, int N, int con_particulas, double dt);
+
+// Añade una fila de cabecera.columnas doubles
+void escribe_registro_binario(SalidaBinaria *s, const double registro[]);
+
+// Vuelca los registros pendientes y actualiza la cabecera
+void vuelca_salida_binaria(SalidaBinaria *s);
+
+void cierra_salida_binaria(SalidaBinaria *s);
+
+/**
+ * Mapea en memoria una trayectoria binaria (sin copiarla; en Windows se lee entera).
+ * @return 1 si se ha podido abrir y la cabecera es válida, 0 si no.
+ */
+int abre_trayectoria_binaria(const char *ruta, TrayectoriaBinaria *t);
+
+void cierra_trayectoria_binaria(TrayectoriaBinaria *t);
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <string.h>
+#include "simulacion.h"
+#include "histograma.h"
+
+/*
+ * Interfaz de línea de órdenes sobre simulacion.h: una simulación con los parámetros de la
+ * línea de órdenes, que escribe "t Ek Ep Et Rg Ree" cada 'cada' pasos por la salida estándar y
+ * al final <Ree> y <Rg> con su error por bloques. No escribe ningún fichero.
+ *
+ * Uso: cadena_cli.exe [-N 4] [-F 0] [-T 1] [-K 1000] [-dt 0.0003] [-m 1] [-alfa 0.5] [-kb 1]
+ *                     [-semilla 12456] [-tiempo 100] [-equilibrado 10] [-cada 0.1] [-silencio]
+ *   -F        Fuerza sobre la última partícula (solo con FIXED)
+ *   -tiempo   Tiempo simulado después del equilibrado
+ *   -cada     Intervalo de tiempo entre salidas
+ *   -silencio Solo el resumen final
+ */
+
+static void uso(void) {
+    printf("Uso: cadena_cli.exe [-N n] [-F fuerza] [-T temperatura] [-K k] [-dt dt] [-m m] [-alfa alfa] [-kb kb]\n"
+           "                    [-semilla s] [-tiempo t] [-equilibrado t] [-cada t] [-silencio]\n");
+}
+
+int main(int argc, char *argv[]) {
+    ConfiguracionSimulacion c = configuracion_simulacion_defecto();
+    double tiempo = 100.0, equilibrado = 10.0, cada = 0.1;
+    int silencio = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *opcion = argv[i];
+        if (strcmp(opcion, "-silencio") == 0) {
+            silencio = 1;
+            continue;
+        }
+        if (strcmp(opcion, "-h") == 0 || strcmp(opcion, "--help") == 0 || i + 1 >= argc) {
+            uso();
+            return strcmp(opcion, "-h") == 0 || strcmp(opcion, "--help") == 0 ? 0 : 1;
+        }
+        const char *valor = argv[++i];
+        if      (strcmp(opcion, "-N") == 0)           c.N = atoi(valor);
+        else if (strcmp(opcion, "-F") == 0)           c.F_cte = atof(valor);
+        else if (strcmp(opcion, "-T") == 0)           c.Temperatura = atof(valor);
+        else if (strcmp(opcion, "-K") == 0)           c.K = atof(valor);
+        else if (strcmp(opcion, "-dt") == 0)          c.dt = atof(valor);
+        else if (strcmp(opcion, "-m") == 0)           c.m = atof(valor);
+        else if (strcmp(opcion, "-alfa") == 0)        c.alfa = atof(valor);
+        else if (strcmp(opcion, "-kb") == 0)          c.kb = atof(valor);
+        else if (strcmp(opcion, "-semilla") == 0)     c.semilla = atoi(valor);
+        else if (strcmp(opcion, "-tiempo") == 0)      tiempo = atof(valor);
+        else if (strcmp(opcion, "-equilibrado") == 0) equilibrado = atof(valor);
+        else if (strcmp(opcion, "-cada") == 0)        cada = atof(valor);
+        else {
+            printf("Opción desconocida: %s\n", opcion);
+            uso();
+            return 1;
+        }
+    }
+    #ifndef FIXED
+    if (c.F_cte != 0.0) printf("# Sin FIXED se ignora -F\n");
+    #endif
+
+    Simulacion *s = crea_simulacion(&c, NULL);
+    if (!s) return 1;
+    long pasos_cada = (long)(cada / c.dt + 0.5);
+    if (pasos_cada < 1) pasos_cada = 1;
+    long salidas = (long)(tiempo / (pasos_cada * c.dt) + 0.5);
+    avanza_simulacion(s, (long)(equilibrado / c.dt + 0.5));
+
+    EstimadorBloques ree, rg;
+    memset(&ree, 0, sizeof(ree));
+    memset(&rg, 0, sizeof(rg));
+    ObservablesSimulacion o;
+    if (!silencio) printf("# t Ek Ep Et Rg Ree\n");
+    for (long k = 0; k < salidas; k++) {
+        avanza_simulacion(s, pasos_cada);
+        observa_simulacion(s, &o);
+        anade_estimador_bloques(&ree, o.Ree);
+        anade_estimador_bloques(&rg, o.Rg);
+        if (!silencio) printf("%.6f %.6f %.6f %.6f %.6f %.6f\n", o.t, o.Ek, o.Ep, o.Et, o.Rg, o.Ree);
+    }
+    printf("# N %d F %g T %g: <Ree> %.6f +- %.6f  <Rg> %.6f +- %.6f\n", c.N, c.F_cte, c.Temperatura,
+           media_estimador_bloques(&ree), error_estimador_bloques(&ree),
+           media_estimador_bloques(&rg), error_estimador_bloques(&rg));
+
+    destruye_simulacion(s);
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "cadena_larga.h"
+
+// La fuerza de la partícula j está completa tras el triplete centrado en j+1, que se suma después
+// del enlace (j+2, j+3) para respetar el orden de Fuerza_verlet: RETRASO partículas por detrás
+#ifdef WLCM
+#define RETRASO 3
+#else
+#define RETRASO 1
+#endif
+#define BLOQUE 64                    // Partículas por bloque (potencia de 2 >= RETRASO)
+#define HUECO(k) ((k) & (2*BLOQUE - 1))  // Buffers del bloque actual y del anterior
+
+
+// Estiramiento del enlace (i, i+1). Debe coincidir operación a operación con Fuerza_verlet.
+// Con WLCM deja en e los datos del enlace para la flexión.
+static inline void estira_enlace(const double x[], int i, double F_i[3], double F_j[3], double K, double e[4]) {
+    int i3 = 3*i;
+    int j3 = 3*(i+1);
+
+    double dx = x[j3]   - x[i3];
+    double dy = x[j3+1] - x[i3+1];
+    double dz = x[j3+2] - x[i3+2];
+
+    double r = sqrt(dx*dx + dy*dy + dz*dz);
+    #ifdef WLCM
+    enlace_flexion(dx, dy, dz, r, e);
+    #else
+    (void)e;
+    #endif
+    if (r == 0.0) return;
+
+    double fac = K * (r - L_0) / r;
+
+    double Fx = fac * dx;
+    double Fy = fac * dy;
+    double Fz = fac * dz;
+
+    F_i[0] += Fx;
+    F_i[1] += Fy;
+    F_i[2] += Fz;
+
+    F_j[0] -= Fx;
+    F_j[1] -= Fy;
+    F_j[2] -= Fz;
+}
+
+#ifdef WLCM
+// Flexión del triplete centrado en i a partir de los enlaces (i-1, i) y (i, i+1) ya guardados.
+// Debe coincidir operación a operación con suma_flexion.
+static inline void flexiona_triplete(int i, const double e_i[4], const double e_ip1[4],
+                                     double F_im1[3], double F_i[3], double F_ip1[3]) {
+    double f_im1[3], f_ip1[3];
+    triplete_flexion(rigidez_flexion(i), parametros_flexion.cos_theta0, e_i, e_ip1, f_im1, f_ip1);
+
+    F_im1[0] += f_im1[0];
+    F_im1[1] += f_im1[1];
+    F_im1[2] += f_im1[2];
+
+    F_ip1[0] += f_ip1[0];
+    F_ip1[1] += f_ip1[1];
+    F_ip1[2] += f_ip1[2];
+
+    F_i[0] -= (f_im1[0] + f_ip1[0]);
+    F_i[1] -= (f_im1[1] + f_ip1[1]);
+    F_i[2] -= (f_im1[2] + f_ip1[2]);
+}
+#endif
+
+
+#ifdef FIXED
+void un_paso_verlet_fusionado(double sigma, double b, double a, int N, double x[], double v[], double F[],
+                              double dt, double m, double K, double F_cte)
+#else
+void un_paso_verlet_fusionado(double sigma, double b, double a, int N, double x[], double v[], double F[],
+                              double dt, double m, double K)
+#endif
+{
+    // Ruido, fuerza nueva y enlace (el que empieza en la partícula) de los dos últimos bloques.
+    // La fuerza antigua se sigue leyendo de F, que solo se sobrescribe al actualizar la velocidad.
+    double betta[2*BLOQUE][3];
+    double F_nue[2*BLOQUE][3];
+    #ifdef WLCM
+    double enlace[2*BLOQUE][4];
+    #define ENLACE(k) enlace[HUECO(k)]
+    asegura_flexion();
+    #else
+    #define ENLACE(k) NULL
+    #endif
+
+    for (int k0 = 0; k0 < N; k0 += BLOQUE) {
+        int k1 = (k0 + BLOQUE < N) ? k0 + BLOQUE : N;
+        int n = k1 - k0;
+        double *r = betta[HUECO(k0)];
+        double *f = F_nue[HUECO(k0)];
+
+        // 1. Ruido del bloque, en el mismo orden que partícula a partícula
+        #ifdef RUIDO_CONTADOR
+        gaussianas_contador(&ruido_contador_global, 3*k0, 3*n, sigma, r);
+        #else
+        for (int i = 0; i < 3*n; i++) {
+            r[i] = gaussian() * sigma;
+        }
+        #endif
+        #ifdef FIXED
+        if (k0 == 0) {
+            // La primera partícula está fija: ni ruido ni velocidad (la fuerza se anula en el paso 5)
+            r[0] = r[1] = r[2] = 0.0;
+            v[0] = v[1] = v[2] = 0.0;
+        }
+        #endif
+
+        // 2. Posiciones nuevas del bloque, en el sitio
+        double *xb = &x[3*k0];
+        const double *vb = &v[3*k0], *Fb = &F[3*k0];
+        for (int i = 0; i < 3*n; i++) {
+            xb[i] = xb[i] + vb[i]*dt*b + Fb[i]*dt*dt*b/(2*m) + b*dt*r[i];
+            f[i] = 0.0;
+        }
+
+        // 3. Estiramiento de los enlaces (k-1, k) que acaban en el bloque
+        for (int k = (k0 > 0 ? k0 : 1); k < k1; k++)
+            estira_enlace(x, k-1, F_nue[HUECO(k-1)], F_nue[HUECO(k)], K, ENLACE(k-1));
+
+        // 4. Flexión de los tripletes centrados en k-2 para k en el bloque
+        #ifdef WLCM
+        for (int centro = (k0 - 2 > 1 ? k0 - 2 : 1); centro < k1 - 2; centro++)
+            flexiona_triplete(centro, ENLACE(centro-1), ENLACE(centro),
+                              F_nue[HUECO(centro-1)], F_nue[HUECO(centro)], F_nue[HUECO(centro+1)]);
+        #endif
+
+        // 5. Velocidades de las partículas cuya fuerza ya está completa
+        #ifdef FIXED
+        if (k0 == 0 && k1 > RETRASO) F_nue[0][0] = F_nue[0][1] = F_nue[0][2] = 0.0;
+        #endif
+        for (int j = (k0 - RETRASO > 0 ? k0 - RETRASO : 0); j < k1 - RETRASO; j++) {
+            const double *fj = F_nue[HUECO(j)], *rj = betta[HUECO(j)];
+            for (int c = 0; c < 3; c++) {
+                int i = 3*j + c;
+                v[i] = a*v[i] + (a*F[i] + fj[c])*dt/(2*m) + b*rj[c]/m;
+                F[i] = fj[c];
+            }
+        }
+    }
+
+    // Tras el último enlace: fuerza constante sobre la última partícula (antes de la flexión)
+    #ifdef FIXED
+    F_nue[HUECO(N-1)][2] += F_cte;
+    #endif
+    #ifdef WLCM
+    if (N >= 3)
+        flexiona_triplete(N-2, ENLACE(N-3), ENLACE(N-2),
+                          F_nue[HUECO(N-3)], F_nue[HUECO(N-2)], F_nue[HUECO(N-1)]);
+    #endif
+    for (int j = (N > RETRASO ? N - RETRASO : 0); j < N; j++) {
+        #ifdef FIXED
+        if (j == 0) F_nue[0][0] = F_nue[0][1] = F_nue[0][2] = 0.0;
+        #endif
+        const double *fj = F_nue[HUECO(j)], *rj = betta[HUECO(j)];
+        for (int c = 0; c < 3; c++) {
+            int i = 3*j + c;
+            v[i] = a*v[i] + (a*F[i] + fj[c])*dt/(2*m) + b*rj[c]/m;
+            F[i] = fj[c];
+        }
+    }
+}
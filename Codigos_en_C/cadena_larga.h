@@ -0,0 +1,32 @@
+#pragma once
+
+#include "random.h"
+#include "funciones_oscilador.h"
+#include "flexion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+
+/**
+ * Paso de Verlet (GJF) fusionado para cadenas largas: recorre la cadena una sola vez por bloques
+ * de BLOQUE partículas y en cada bloque genera el ruido, actualiza posiciones, calcula las fuerzas
+ * de Fuerza_verlet y actualiza velocidades, cada fase en su propio bucle. Las velocidades van
+ * 1 partícula por detrás (3 con WLCM, cuya flexión necesita los enlaces vecinos). Así cada
+ * partícula se lee y escribe una vez por paso mientras está en caché, los bucles son tan simples
+ * como los de un_paso_verlet y solo hacen falta x, v y F (en el sitio, sin copias antiguo/nuevo).
+ * Reproduce bit a bit un_paso_verlet + Fuerza_verlet con el mismo orden de llamadas a gaussian().
+ * Con RUIDO_CONTADOR el ruido es el de ruido_contador_global en su paso (lo pone quien llama).
+ * @param sigma  Amplitud del ruido, sqrt(2 alfa kb T dt).
+ * @param b, a   Coeficientes de GJF (los mismos que en verlet_trayectoria).
+ * @param x      Posiciones; se sobrescriben con las nuevas.
+ * @param v      Velocidades; se sobrescriben con las nuevas.
+ * @param F      Fuerzas F(x) a la entrada; F(x_nuevo) a la salida.
+ */
+#ifdef FIXED
+void un_paso_verlet_fusionado(double sigma, double b, double a, int N, double x[], double v[], double F[],
+                              double dt, double m, double K, double F_cte);
+#else
+void un_paso_verlet_fusionado(double sigma, double b, double a, int N, double x[], double v[], double F[],
+                              double dt, double m, double K);
+#endif
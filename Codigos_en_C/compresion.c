@@ -0,0 +1,453 @@
+#include "compresion.h"
+
+_Static_assert(sizeof(CabeceraComprimida) == TAM_CABECERA_COMPRIMIDA, "La cabecera comprimida debe ocupar TAM_CABECERA_COMPRIMIDA bytes");
+
+#define MAXIMO_CUANTIZADO 4611686018427387904.0   // 2^62: |q| por encima se satura
+
+// Bloques de columnas de una fila: tiempo, posiciones, velocidades y observables
+#define MAX_BLOQUES 4
+
+// Predicciones entre las que se elige en cada bloque (2 bits por bloque)
+enum {
+    PREDICE_ANTERIOR,               // Valor de la fila anterior
+    PREDICE_LINEAL,                 // Extrapolación lineal de las dos filas anteriores
+    PREDICE_VECINA,                 // Fila anterior más el desplazamiento de la partícula anterior
+    PREDICE_CERO                    // Cero (velocidades muy espaciadas: ruido térmico)
+};
+#define N_PREDICCIONES 4
+
+typedef struct {
+    uint8_t *datos;
+    size_t tam, capacidad;
+    uint64_t acumulador;
+    int bits;
+    int sin_memoria;                // El buffer no pudo crecer: el registro está incompleto
+} FlujoBits;
+
+typedef struct {
+    const uint8_t *datos;
+    size_t tam, pos;
+    uint64_t acumulador;
+    int bits;
+} LectorBits;
+
+typedef struct {
+    int N, columnas, con_particulas, modo;
+    double paso;                    // 2*precision en el modo cuantizado
+    int n_bloques, bloques[MAX_BLOQUES + 1];
+    int inicio_x, fin_x;            // Columnas de las posiciones
+    double *anterior, *anterior_2, *actual;         // Sin pérdidas: filas reconstruidas
+    int64_t *q_anterior, *q_anterior_2, *q_actual;  // Cuantizada: filas en múltiplos de paso
+} Predictor;
+
+struct Compresor {
+    FILE *archivo;
+    CabeceraComprimida cabecera;
+    Predictor p;
+    FlujoBits flujo;
+    uint64_t *residuos;             // Cuantizada: residuos en zigzag de la fila
+    long long bytes;
+    int detenido;                   // Sin memoria para un registro: el .cmp se queda con los anteriores
+};
+
+struct Descompresor {
+    FILE *archivo;
+    CabeceraComprimida cabecera;
+    Predictor p;
+    uint8_t *buffer;
+    size_t capacidad;
+};
+
+
+// --- Bits ---
+
+static void pon_bits32(FlujoBits *f, uint32_t valor, int n) {
+    if (n == 0) return;
+    if (n < 32) valor &= (1u << n) - 1;
+    f->acumulador |= (uint64_t)valor << f->bits;
+    f->bits += n;
+    while (f->bits >= 8) {
+        if (f->tam == f->capacidad) {
+            size_t capacidad = f->capacidad ? 2*f->capacidad : 1024;
+            uint8_t *nuevo = realloc(f->datos, capacidad);
+            if (!nuevo) {
+                f->sin_memoria = 1;
+                f->acumulador = 0;
+                f->bits = 0;
+                return;
+            }
+            f->datos = nuevo;
+            f->capacidad = capacidad;
+        }
+        f->datos[f->tam++] = (uint8_t)f->acumulador;
+        f->acumulador >>= 8;
+        f->bits -= 8;
+    }
+}
+
+static void pon_bits(FlujoBits *f, uint64_t valor, int n) {
+    if (n > 32) {
+        pon_bits32(f, (uint32_t)valor, 32);
+        pon_bits32(f, (uint32_t)(valor >> 32), n - 32);
+    } else {
+        pon_bits32(f, (uint32_t)valor, n);
+    }
+}
+
+// Completa el último byte con ceros
+static void cierra_bits(FlujoBits *f) {
+    if (f->bits > 0) pon_bits32(f, 0, 8 - f->bits);
+}
+
+static uint32_t lee_bits32(LectorBits *l, int n) {
+    if (n == 0) return 0;
+    while (l->bits < n) {
+        uint64_t byte = l->pos < l->tam ? l->datos[l->pos] : 0;
+        l->pos++;
+        l->acumulador |= byte << l->bits;
+        l->bits += 8;
+    }
+    uint32_t valor = n == 32 ? (uint32_t)l->acumulador : (uint32_t)(l->acumulador & ((1ull << n) - 1));
+    l->acumulador >>= n;
+    l->bits -= n;
+    return valor;
+}
+
+static uint64_t lee_bits(LectorBits *l, int n) {
+    if (n > 32) {
+        uint64_t bajo = lee_bits32(l, 32);
+        return bajo | ((uint64_t)lee_bits32(l, n - 32) << 32);
+    }
+    return lee_bits32(l, n);
+}
+
+static inline int bits_significativos(uint64_t x) { return x ? 64 - __builtin_clzll(x) : 0; }
+// Residuos en complemento a dos sobre uint64_t: la resta desborda sin UB y el descompresor deshace
+// la misma vuelta al sumar (|q| llega a 2^62, así que 2*q y las diferencias no caben en int64_t)
+static inline uint64_t zigzag(uint64_t r) { return (r << 1) ^ (0 - (r >> 63)); }
+static inline uint64_t deszigzag(uint64_t u) { return (u >> 1) ^ (0 - (u & 1)); }
+
+
+// --- Predicción ---
+
+static int inicia_predictor(Predictor *p, int modo, double precision, int N, int con_particulas) {
+    memset(p, 0, sizeof(Predictor));
+    p->N = N;
+    p->modo = modo;
+    p->con_particulas = con_particulas;
+    p->columnas = columnas_binarias(N, con_particulas);
+    p->paso = 2.0 * precision;
+    p->bloques[p->n_bloques++] = 0;
+    p->bloques[p->n_bloques++] = 1;
+    if (con_particulas) {
+        p->inicio_x = 1;
+        p->fin_x = 1 + 3*N;
+        p->bloques[p->n_bloques++] = 1 + 3*N;
+        p->bloques[p->n_bloques++] = 1 + 6*N;
+    }
+    p->bloques[p->n_bloques] = p->columnas;
+    p->anterior = calloc(p->columnas, sizeof(double));
+    p->anterior_2 = calloc(p->columnas, sizeof(double));
+    p->actual = calloc(p->columnas, sizeof(double));
+    p->q_anterior = calloc(p->columnas, sizeof(int64_t));
+    p->q_anterior_2 = calloc(p->columnas, sizeof(int64_t));
+    p->q_actual = calloc(p->columnas, sizeof(int64_t));
+    return p->anterior && p->anterior_2 && p->actual && p->q_anterior && p->q_anterior_2 && p->q_actual;
+}
+
+static void libera_predictor(Predictor *p) {
+    free(p->anterior);
+    free(p->anterior_2);
+    free(p->actual);
+    free(p->q_anterior);
+    free(p->q_anterior_2);
+    free(p->q_actual);
+}
+
+// La partícula anterior en la misma fila, si la columna es de posición y no es la primera partícula
+static inline int usa_particula_anterior(const Predictor *p, int c) {
+    return c >= p->inicio_x + 3 && c < p->fin_x;
+}
+
+static inline double prediccion(const Predictor *p, int tipo, int c) {
+    switch (tipo) {
+        case PREDICE_LINEAL: return 2.0*p->anterior[c] - p->anterior_2[c];
+        case PREDICE_VECINA:
+            if (usa_particula_anterior(p, c)) return p->anterior[c] + (p->actual[c-3] - p->anterior[c-3]);
+            return p->anterior[c];
+        case PREDICE_CERO: return 0.0;
+        default: return p->anterior[c];
+    }
+}
+
+static inline uint64_t prediccion_cuantizada(const Predictor *p, int tipo, int c) {
+    uint64_t anterior = (uint64_t)p->q_anterior[c];
+    switch (tipo) {
+        case PREDICE_LINEAL: return 2*anterior - (uint64_t)p->q_anterior_2[c];
+        case PREDICE_VECINA:
+            if (usa_particula_anterior(p, c))
+                return anterior + ((uint64_t)p->q_actual[c-3] - (uint64_t)p->q_anterior[c-3]);
+            return anterior;
+        case PREDICE_CERO: return 0;
+        default: return anterior;
+    }
+}
+
+static void avanza_predictor(Predictor *p) {
+    double *d = p->anterior_2; p->anterior_2 = p->anterior; p->anterior = p->actual; p->actual = d;
+    int64_t *q = p->q_anterior_2; p->q_anterior_2 = p->q_anterior; p->q_anterior = p->q_actual; p->q_actual = q;
+}
+
+static inline int64_t cuantiza(double x, double paso) {
+    double q = x / paso;
+    if (!(q < MAXIMO_CUANTIZADO)) q = isnan(q) ? 0.0 : MAXIMO_CUANTIZADO;
+    if (q < -MAXIMO_CUANTIZADO) q = -MAXIMO_CUANTIZADO;
+    return llround(q);
+}
+
+
+// --- Compresor ---
+
+void ruta_comprimida(const char *ruta_texto, char *ruta, size_t tam) {
+    size_t n = strlen(ruta_texto);
+    if (n >= 4 && strcmp(ruta_texto + n - 4, ".txt") == 0) n -= 4;
+    snprintf(ruta, tam, "%.*s.cmp", (int)n, ruta_texto);
+}
+
+Compresor *abre_compresor(const char *ruta, ModoCompresion modo, double precision, int N, int con_particulas,
+                          double dt) {
+    if (modo == COMPRESION_CUANTIZADA && !(precision > 0.0)) {
+        printf("La compresión cuantizada necesita una precisión positiva (%g)\n", precision);
+        return NULL;
+    }
+    Compresor *c = calloc(1, sizeof(Compresor));
+    if (!c) return NULL;
+    c->residuos = malloc(columnas_binarias(N, con_particulas)*sizeof(uint64_t));
+    if (!c->residuos || !inicia_predictor(&c->p, modo, precision, N, con_particulas)) {
+        libera_predictor(&c->p);
+        free(c->residuos);
+        free(c);
+        return NULL;
+    }
+    c->archivo = fopen(ruta, "wb");
+    if (!c->archivo) {
+        printf("Error al abrir el archivo %s\n", ruta);
+        libera_predictor(&c->p);
+        free(c->residuos);
+        free(c);
+        return NULL;
+    }
+    memcpy(c->cabecera.magia, MAGIA_COMPRIMIDA, 8);
+    c->cabecera.version = VERSION_COMPRIMIDA;
+    c->cabecera.modo = modo;
+    c->cabecera.N = N;
+    c->cabecera.columnas = c->p.columnas;
+    c->cabecera.con_particulas = con_particulas;
+    c->cabecera.dt = dt;
+    c->cabecera.precision = modo == COMPRESION_CUANTIZADA ? precision : 0.0;
+    fwrite(&c->cabecera, sizeof(CabeceraComprimida), 1, c->archivo);
+    c->bytes = sizeof(CabeceraComprimida);
+    return c;
+}
+
+static inline uint64_t diferencia_bits(double valor, double pred) {
+    uint64_t bits_valor, bits_pred;
+    memcpy(&bits_valor, &valor, 8);
+    memcpy(&bits_pred, &pred, 8);
+    return bits_valor ^ bits_pred;
+}
+
+static void comprime_sin_perdidas(Compresor *c, const double registro[]) {
+    Predictor *p = &c->p;
+    memcpy(p->actual, registro, p->columnas*sizeof(double));
+    for (int b = 0; b < p->n_bloques; b++) {
+        // La predicción con menos bytes significativos en el bloque
+        int mejor = 0;
+        long menor = -1;
+        for (int tipo = 0; tipo < N_PREDICCIONES; tipo++) {
+            long bytes = 0;
+            for (int k = p->bloques[b]; k < p->bloques[b+1]; k++)
+                bytes += (bits_significativos(diferencia_bits(registro[k], prediccion(p, tipo, k))) + 7) / 8;
+            if (menor < 0 || bytes < menor) {
+                menor = bytes;
+                mejor = tipo;
+            }
+        }
+        pon_bits32(&c->flujo, mejor, 2);
+        for (int k = p->bloques[b]; k < p->bloques[b+1]; k++) {
+            uint64_t diferencia = diferencia_bits(registro[k], prediccion(p, mejor, k));
+            int bytes = (bits_significativos(diferencia) + 7) / 8;
+            pon_bits32(&c->flujo, bytes, 4);
+            pon_bits(&c->flujo, diferencia, 8*bytes);
+        }
+    }
+}
+
+static void comprime_cuantizado(Compresor *c, const double registro[]) {
+    Predictor *p = &c->p;
+    uint64_t *residuos = c->residuos;
+    for (int k = 0; k < p->columnas; k++) p->q_actual[k] = cuantiza(registro[k], p->paso);
+    for (int b = 0; b < p->n_bloques; b++) {
+        // La predicción cuyo mayor residuo ocupa menos bits
+        int mejor = 0, ancho = 65;
+        for (int tipo = 0; tipo < N_PREDICCIONES; tipo++) {
+            uint64_t maximo = 0;
+            for (int k = p->bloques[b]; k < p->bloques[b+1]; k++)
+                maximo |= zigzag((uint64_t)p->q_actual[k] - prediccion_cuantizada(p, tipo, k));
+            if (bits_significativos(maximo) < ancho) {
+                ancho = bits_significativos(maximo);
+                mejor = tipo;
+            }
+        }
+        for (int k = p->bloques[b]; k < p->bloques[b+1]; k++)
+            residuos[k] = zigzag((uint64_t)p->q_actual[k] - prediccion_cuantizada(p, mejor, k));
+        pon_bits32(&c->flujo, mejor, 2);
+        pon_bits32(&c->flujo, ancho, 7);
+        for (int k = p->bloques[b]; k < p->bloques[b+1]; k++) pon_bits(&c->flujo, residuos[k], ancho);
+    }
+}
+
+void comprime_registro(Compresor *c, const double registro[]) {
+    if (!c || c->detenido) return;
+    c->flujo.tam = 0;
+    c->flujo.acumulador = 0;
+    c->flujo.bits = 0;
+    if (c->p.modo == COMPRESION_SIN_PERDIDAS) comprime_sin_perdidas(c, registro);
+    else comprime_cuantizado(c, registro);
+    cierra_bits(&c->flujo);
+    if (c->flujo.sin_memoria) {
+        printf("No se pudo reservar memoria para comprimir el registro %lld: el .cmp acaba en el anterior\n",
+               (long long)c->cabecera.registros);
+        c->detenido = 1;
+        return;
+    }
+    avanza_predictor(&c->p);
+
+    uint32_t tam = (uint32_t)c->flujo.tam;
+    fwrite(&tam, sizeof(uint32_t), 1, c->archivo);
+    fwrite(c->flujo.datos, 1, tam, c->archivo);
+    c->bytes += sizeof(uint32_t) + tam;
+    c->cabecera.registros++;
+}
+
+long long bytes_compresor(const Compresor *c) {
+    return c ? c->bytes : 0;
+}
+
+void cierra_compresor(Compresor *c) {
+    if (!c) return;
+    fseek(c->archivo, 0, SEEK_SET);
+    fwrite(&c->cabecera, sizeof(CabeceraComprimida), 1, c->archivo);
+    fclose(c->archivo);
+    libera_predictor(&c->p);
+    free(c->flujo.datos);
+    free(c->residuos);
+    free(c);
+}
+
+
+// --- Descompresor ---
+
+Descompresor *abre_descompresor(const char *ruta) {
+    FILE *f = fopen(ruta, "rb");
+    if (!f) return NULL;
+    Descompresor *d = calloc(1, sizeof(Descompresor));
+    if (!d) {
+        fclose(f);
+        return NULL;
+    }
+    d->archivo = f;
+    CabeceraComprimida *c = &d->cabecera;
+    if (fread(c, sizeof(CabeceraComprimida), 1, f) != 1 || memcmp(c->magia, MAGIA_COMPRIMIDA, 8) != 0
+        || c->version != VERSION_COMPRIMIDA || c->N < 1
+        || (c->modo != COMPRESION_SIN_PERDIDAS && c->modo != COMPRESION_CUANTIZADA)) {
+        printf("%s no es una trayectoria comprimida\n", ruta);
+        fclose(f);
+        free(d);
+        return NULL;
+    }
+    if (!inicia_predictor(&d->p, c->modo, c->precision, c->N, c->con_particulas) || d->p.columnas != c->columnas) {
+        libera_predictor(&d->p);
+        fclose(f);
+        free(d);
+        return NULL;
+    }
+    return d;
+}
+
+const CabeceraComprimida *cabecera_descompresor(const Descompresor *d) {
+    return &d->cabecera;
+}
+
+int lee_registro_comprimido(Descompresor *d, double registro[]) {
+    uint32_t tam;
+    if (fread(&tam, sizeof(uint32_t), 1, d->archivo) != 1) return 0;
+    if (tam > d->capacidad) {
+        uint8_t *nuevo = realloc(d->buffer, tam);
+        if (!nuevo) return 0;
+        d->buffer = nuevo;
+        d->capacidad = tam;
+    }
+    if (fread(d->buffer, 1, tam, d->archivo) != tam) return 0;
+
+    Predictor *p = &d->p;
+    LectorBits l = {d->buffer, tam, 0, 0, 0};
+    if (p->modo == COMPRESION_SIN_PERDIDAS) {
+        for (int b = 0; b < p->n_bloques; b++) {
+            int tipo = (int)lee_bits32(&l, 2);
+            for (int k = p->bloques[b]; k < p->bloques[b+1]; k++) {
+                int bytes = (int)lee_bits32(&l, 4);
+                if (bytes > 8) return 0;
+                double pred = prediccion(p, tipo, k);
+                uint64_t bits_valor;
+                memcpy(&bits_valor, &pred, 8);
+                bits_valor ^= lee_bits(&l, 8*bytes);
+                memcpy(&p->actual[k], &bits_valor, 8);
+                registro[k] = p->actual[k];
+            }
+        }
+    } else {
+        for (int b = 0; b < p->n_bloques; b++) {
+            int tipo = (int)lee_bits32(&l, 2);
+            int ancho = (int)lee_bits32(&l, 7);
+            if (ancho > 64) return 0;
+            for (int k = p->bloques[b]; k < p->bloques[b+1]; k++) {
+                p->q_actual[k] = (int64_t)(prediccion_cuantizada(p, tipo, k) + deszigzag(lee_bits(&l, ancho)));
+                registro[k] = (double)p->q_actual[k] * p->paso;
+            }
+        }
+    }
+    avanza_predictor(p);
+    return l.pos <= l.tam;
+}
+
+void cierra_descompresor(Descompresor *d) {
+    if (!d) return;
+    fclose(d->archivo);
+    libera_predictor(&d->p);
+    free(d->buffer);
+    free(d);
+}
+
+long long descomprime_a_binario(const char *ruta_cmp, const char *ruta_bin) {
+    Descompresor *d = abre_descompresor(ruta_cmp);
+    if (!d) return -1;
+    const CabeceraComprimida *c = cabecera_descompresor(d);
+    SalidaBinaria *s = abre_salida_binaria(ruta_bin, c->N, c->con_particulas, c->dt);
+    double *registro = malloc(c->columnas*sizeof(double));
+    if (!s || !registro) {
+        free(registro);
+        cierra_salida_binaria(s);
+        cierra_descompresor(d);
+        return -1;
+    }
+    long long filas = 0;
+    while (lee_registro_comprimido(d, registro)) {
+        escribe_registro_binario(s, registro);
+        filas++;
+    }
+    free(registro);
+    cierra_salida_binaria(s);
+    cierra_descompresor(d);
+    return filas;
+}
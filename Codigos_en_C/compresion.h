@@ -0,0 +1,95 @@
+#pragma once
+
+#include "binario.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+
+/**
+ * Compresión de trayectorias sin dependencias externas. Las filas son las de binario.h
+ * (t [x v] Ek Ep Et Rg Ree) y se dividen en bloques (tiempo, posiciones, velocidades y
+ * observables). Cada bloque de cada fila elige la predicción que deja residuos más pequeños y
+ * la indica con 2 bits:
+ *  - el valor de la fila anterior (filas seguidas muy próximas);
+ *  - la extrapolación lineal de las dos anteriores (el tiempo sale exacto);
+ *  - en las posiciones, x_j(t-1) + x_{j-1}(t) - x_{j-1}(t-1): la partícula anterior se ha movido
+ *    casi igual, porque los enlaces miden ~L_0;
+ *  - cero (velocidades de filas muy espaciadas, que son ruido térmico sin memoria).
+ *
+ * Dos modos:
+ *  - COMPRESION_SIN_PERDIDAS: se guarda el XOR de los bits del valor y de la predicción, con
+ *    4 bits para el número de bytes significativos y esos bytes. Se recupera bit a bit.
+ *  - COMPRESION_CUANTIZADA: cada valor se redondea a un múltiplo de 2*precision (error máximo
+ *    'precision'), el residuo entero frente a la predicción se codifica en zigzag y se empaqueta
+ *    con el número de bits del mayor residuo de cada bloque.
+ *
+ * Cada fila se escribe como un entero de 32 bits con su tamaño y sus bytes. La cabecera ocupa
+ * TAM_CABECERA_COMPRIMIDA bytes y lleva el número de filas al cerrar (el lector no lo necesita).
+ */
+
+#define MAGIA_COMPRIMIDA "CADCMP01"
+#define VERSION_COMPRIMIDA 1
+#define TAM_CABECERA_COMPRIMIDA 64
+
+typedef enum {
+    COMPRESION_SIN_PERDIDAS,
+    COMPRESION_CUANTIZADA
+} ModoCompresion;
+
+typedef struct {
+    char magia[8];
+    int32_t version;
+    int32_t modo;
+    int32_t N;
+    int32_t columnas;
+    int32_t con_particulas;
+    int32_t reservado_0;
+    double dt;
+    double precision;                   // Error máximo del modo cuantizado
+    int64_t registros;
+    char reservado[TAM_CABECERA_COMPRIMIDA - 56];
+} CabeceraComprimida;
+
+typedef struct Compresor Compresor;
+typedef struct Descompresor Descompresor;
+
+// Ruta del .cmp de una trayectoria: cambia la extensión .txt (o la añade)
+void ruta_comprimida(const char *ruta_texto, char *ruta, size_t tam);
+
+/**
+ * Crea el fichero comprimido.
+ * @param precision  Error máximo por valor en el modo cuantizado (se ignora sin pérdidas).
+ * @return El compresor, o NULL si no se puede crear o la precisión no es válida.
+ */
+Compresor *abre_compresor(const char *ruta, ModoCompresion modo, double precision, int N, int con_particulas,
+                          double dt);
+
+// Añade una fila de columnas_binarias(N, con_particulas) doubles
+void comprime_registro(Compresor *c, const double registro[]);
+
+// Bytes escritos hasta ahora (cabecera incluida)
+long long bytes_compresor(const Compresor *c);
+
+void cierra_compresor(Compresor *c);
+
+// Abre un .cmp. Devuelve NULL si no existe o la cabecera no es válida.
+Descompresor *abre_descompresor(const char *ruta);
+
+const CabeceraComprimida *cabecera_descompresor(const Descompresor *d);
+
+/**
+ * Lee la siguiente fila.
+ * @return 1 si se ha leído, 0 al final del fichero o si la fila está truncada.
+ */
+int lee_registro_comprimido(Descompresor *d, double registro[]);
+
+void cierra_descompresor(Descompresor *d);
+
+/**
+ * Descomprime un .cmp a la trayectoria binaria de binario.h (para numpy.memmap).
+ * @return Número de filas escritas, o -1 si falla.
+ */
+long long descomprime_a_binario(const char *ruta_cmp, const char *ruta_bin);
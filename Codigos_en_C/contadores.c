@@ -0,0 +1,214 @@
+#include "contadores.h"
+#include "funciones_oscilador.h" // crea_carpetas
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+
+typedef struct {
+    double ns;
+    uint64_t activo, corriendo;         // Tiempos del grupo (para el multiplexado)
+    uint64_t valor[EVENTOS_CONTADORES];
+} MarcaContadores;
+
+struct ContadoresHardware {
+    int lider;                          // Descriptor del grupo (-1 si solo tiempos)
+    int descriptor[EVENTOS_CONTADORES];
+    int posicion[EVENTOS_CONTADORES];   // Posición del evento en la lectura del grupo (-1 si no está)
+    int n_eventos;
+    char motivo[160];
+    uint64_t azar;                      // xorshift64 para elegir los pasos medidos
+    int midiendo;
+    MarcaContadores marca;
+    long long pasos_medidos, pasos_totales;
+    FaseMedida fase[N_FASES];
+};
+
+static const char *nombres_fases[N_FASES] = {"ruido", "fuerza", "actualizacion", "salida", "fusionado"};
+
+static double reloj_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return 1e9*t.tv_sec + t.tv_nsec;
+}
+
+#ifdef __linux__
+static int abre_evento(uint64_t config, int lider) {
+    struct perf_event_attr atributos;
+    memset(&atributos, 0, sizeof(atributos));
+    atributos.size = sizeof(atributos);
+    atributos.type = PERF_TYPE_HARDWARE;
+    atributos.config = config;
+    atributos.disabled = (lider == -1);     // El grupo arranca entero con el líder
+    atributos.exclude_kernel = 1;           // Solo modo usuario: basta con perf_event_paranoid <= 2
+    atributos.exclude_hv = 1;
+    atributos.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &atributos, 0, -1, lider, 0);
+}
+#endif
+
+static void lee_marca(const ContadoresHardware *c, MarcaContadores *m) {
+    m->ns = reloj_ns();
+#ifdef __linux__
+    if (c->lider < 0) return;
+    uint64_t lectura[3 + EVENTOS_CONTADORES];
+    if (read(c->lider, lectura, sizeof(lectura)) < (ssize_t)(3*sizeof(uint64_t))) return;
+    m->activo = lectura[1];
+    m->corriendo = lectura[2];
+    for (int e = 0; e < EVENTOS_CONTADORES; e++)
+        if (c->posicion[e] >= 0) m->valor[e] = lectura[3 + c->posicion[e]];
+#endif
+}
+
+ContadoresHardware *abre_contadores_hardware(void) {
+    ContadoresHardware *c = calloc(1, sizeof(ContadoresHardware));
+    if (!c) return NULL;
+    c->lider = -1;
+    c->azar = 0x9E3779B97F4A7C15ULL;
+    for (int e = 0; e < EVENTOS_CONTADORES; e++) {
+        c->descriptor[e] = -1;
+        c->posicion[e] = -1;
+    }
+#ifdef __linux__
+    static const uint64_t configuraciones[EVENTOS_CONTADORES] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    int error_lider = 0;
+    for (int e = 0; e < EVENTOS_CONTADORES; e++) {
+        int fd = abre_evento(configuraciones[e], c->lider);
+        if (fd < 0) {
+            if (c->lider < 0) error_lider = errno;
+            continue;       // Sin ese evento en este procesador: sigue con los demás
+        }
+        if (c->lider < 0) c->lider = fd;
+        c->descriptor[e] = fd;
+        c->posicion[e] = c->n_eventos++;
+    }
+    if (c->lider >= 0) {
+        ioctl(c->lider, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(c->lider, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    } else {
+        snprintf(c->motivo, sizeof(c->motivo), "perf_event_open: %s (mira /proc/sys/kernel/perf_event_paranoid)",
+                 strerror(error_lider));
+    }
+#else
+    snprintf(c->motivo, sizeof(c->motivo), "perf_event_open solo existe en Linux");
+#endif
+    return c;
+}
+
+void cierra_contadores_hardware(ContadoresHardware *c) {
+    if (!c) return;
+#ifdef __linux__
+    for (int e = 0; e < EVENTOS_CONTADORES; e++)
+        if (c->descriptor[e] >= 0) close(c->descriptor[e]);
+#endif
+    free(c);
+}
+
+int contadores_disponibles(const ContadoresHardware *c) {
+    return c && c->lider >= 0;
+}
+
+const char *motivo_contadores(const ContadoresHardware *c) {
+    return c ? c->motivo : "sin contadores";
+}
+
+int evento_disponible(const ContadoresHardware *c, EventoContadores e) {
+    return c && c->posicion[e] >= 0;
+}
+
+int empieza_paso_contadores(ContadoresHardware *c) {
+    if (!c) return 0;
+    c->pasos_totales++;
+    c->azar ^= c->azar << 13;
+    c->azar ^= c->azar >> 7;
+    c->azar ^= c->azar << 17;
+    if (PASOS_CONTADORES > 1 && c->azar % PASOS_CONTADORES != 0) return 0;
+    c->pasos_medidos++;
+    c->midiendo = 1;
+    lee_marca(c, &c->marca);
+    return 1;
+}
+
+void fase_contadores(ContadoresHardware *c, FaseContadores fase) {
+    if (!c || !c->midiendo) return;
+    MarcaContadores ahora = c->marca;  // Si la lectura falla, la fase no suma eventos
+    lee_marca(c, &ahora);
+    FaseMedida *f = &c->fase[fase];
+    f->veces++;
+    f->ns += ahora.ns - c->marca.ns;
+    if (c->lider >= 0) {
+        // Si el grupo se ha multiplexado, se extrapola al tiempo activo
+        uint64_t activo = ahora.activo - c->marca.activo, corriendo = ahora.corriendo - c->marca.corriendo;
+        double escala = (corriendo > 0 && corriendo < activo) ? (double)activo / corriendo : 1.0;
+        for (int e = 0; e < EVENTOS_CONTADORES; e++)
+            if (c->posicion[e] >= 0) f->cuenta[e] += escala * (double)(ahora.valor[e] - c->marca.valor[e]);
+    }
+    c->marca = ahora;
+}
+
+void termina_paso_contadores(ContadoresHardware *c) {
+    if (c) c->midiendo = 0;
+}
+
+long long pasos_medidos_contadores(const ContadoresHardware *c) {
+    return c ? c->pasos_medidos : 0;
+}
+
+long long pasos_totales_contadores(const ContadoresHardware *c) {
+    return c ? c->pasos_totales : 0;
+}
+
+const FaseMedida *fase_medida_contadores(const ContadoresHardware *c, FaseContadores fase) {
+    return &c->fase[fase];
+}
+
+void imprime_contadores_hardware(const ContadoresHardware *c, int N, FILE *f) {
+    if (contadores_disponibles(c)) fprintf(f, "# contadores hardware: %d eventos\n", c->n_eventos);
+    else fprintf(f, "# contadores hardware no disponibles, solo tiempos: %s\n", motivo_contadores(c));
+    fprintf(f, "# %lld pasos medidos de %lld\n", c->pasos_medidos, c->pasos_totales);
+    fprintf(f, "# fase ns_paso ciclos_paso instrucciones_paso IPC fallos_cache_paso fallos_salto_paso "
+               "ns_particula ciclos_particula instrucciones_particula fallos_cache_particula fallos_salto_particula\n");
+    if (c->pasos_medidos == 0) return;
+    double pasos = (double)c->pasos_medidos;
+    for (int k = 0; k < N_FASES; k++) {
+        const FaseMedida *m = &c->fase[k];
+        if (m->veces == 0) continue;
+        double por_paso[EVENTOS_CONTADORES];
+        for (int e = 0; e < EVENTOS_CONTADORES; e++)
+            por_paso[e] = evento_disponible(c, e) ? m->cuenta[e] / pasos : NAN;
+        double ipc = (por_paso[EVENTO_CICLOS] > 0.0) ? por_paso[EVENTO_INSTRUCCIONES] / por_paso[EVENTO_CICLOS] : NAN;
+        fprintf(f, "%s %.2f %.1f %.1f %.3f %.2f %.2f", nombres_fases[k], m->ns / pasos,
+                por_paso[EVENTO_CICLOS], por_paso[EVENTO_INSTRUCCIONES], ipc,
+                por_paso[EVENTO_FALLOS_CACHE], por_paso[EVENTO_FALLOS_SALTO]);
+        fprintf(f, " %.4f %.4f %.4f %.5f %.5f\n", m->ns / pasos / N,
+                por_paso[EVENTO_CICLOS] / N, por_paso[EVENTO_INSTRUCCIONES] / N,
+                por_paso[EVENTO_FALLOS_CACHE] / N, por_paso[EVENTO_FALLOS_SALTO] / N);
+    }
+}
+
+void escribe_contadores_hardware(const ContadoresHardware *c, int N, const char *carpeta, const char *nombre) {
+    if (!c) return;
+    char carpeta_contadores[512];
+    snprintf(carpeta_contadores, sizeof(carpeta_contadores), "%s/CONTADORES", carpeta);
+    crea_carpetas(carpeta_contadores);
+
+    char ruta[1024];
+    snprintf(ruta, sizeof(ruta), "%s/contadores_%s", carpeta_contadores, nombre);
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        printf("No se pudo crear el archivo %s\n", ruta);
+        return;
+    }
+    imprime_contadores_hardware(c, N, f);
+    fclose(f);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+
+/**
+ * Contadores hardware del procesador (perf_event_open de Linux) por fase del paso de
+ * verlet_trayectoria, para saber si el bucle está limitado por la latencia, por el ancho de banda
+ * de memoria o por la parte frontal (saltos, decodificación) según N.
+ *
+ * Se abren en grupo (se leen juntos, con una sola llamada) los ciclos, las instrucciones, los
+ * fallos de caché (último nivel) y los fallos de predicción de saltos del hilo que llama, solo en
+ * modo usuario. Cada lectura cuesta una llamada al sistema, así que no se mide cada paso: uno de
+ * cada PASOS_CONTADORES, elegido al azar con un generador propio (no toca el del ruido) para no
+ * ir a compás de las salidas. En los pasos medidos, fase_contadores suma lo contado desde la
+ * marca anterior a la fase que se cierra.
+ *
+ * Se degrada sin cortar nada: si el núcleo no deja abrir los contadores (perf_event_paranoid,
+ * contenedores, máquinas virtuales o fuera de Linux) solo se miden los tiempos de cada fase con
+ * clock_gettime, y los eventos que no existan en el procesador salen como nan. Si el núcleo
+ * multiplexa el grupo, las cuentas se escalan con el tiempo que ha estado activo.
+ *
+ * Con el paso fusionado (N > N_CADENA_LARGA) el ruido, la fuerza y la actualización van en la
+ * misma pasada y se cuentan juntos en FASE_FUSIONADO; con el motor de hilos los pasos no se miden
+ * (los contadores son del hilo principal).
+ */
+
+#define PASOS_CONTADORES 16         // Se mide, de media, uno de cada PASOS_CONTADORES pasos
+#define EVENTOS_CONTADORES 4
+
+typedef enum {
+    FASE_RUIDO,                     // Gaussianas del paso
+    FASE_FUERZA,                    // Fuerza en las posiciones nuevas
+    FASE_ACTUALIZACION,             // Posiciones, velocidades y copia al paso siguiente
+    FASE_SALIDA,                    // Forma, observables, .txt y demás salidas
+    FASE_FUSIONADO,                 // Paso fusionado completo (ruido + actualización + fuerza)
+    N_FASES
+} FaseContadores;
+
+typedef enum {
+    EVENTO_CICLOS,
+    EVENTO_INSTRUCCIONES,
+    EVENTO_FALLOS_CACHE,
+    EVENTO_FALLOS_SALTO
+} EventoContadores;
+
+typedef struct {
+    long long veces;                        // Intervalos sumados
+    double ns;
+    double cuenta[EVENTOS_CONTADORES];
+} FaseMedida;
+
+typedef struct ContadoresHardware ContadoresHardware;
+
+/**
+ * Abre los contadores del hilo que llama. Si perf_event_open falla se queda en solo tiempos.
+ * @return Los contadores, o NULL si no hay memoria.
+ */
+ContadoresHardware *abre_contadores_hardware(void);
+
+void cierra_contadores_hardware(ContadoresHardware *c);
+
+// 1 si se cuentan eventos, 0 si solo tiempos; 'motivo' explica por qué (cadena vacía si hay)
+int contadores_disponibles(const ContadoresHardware *c);
+const char *motivo_contadores(const ContadoresHardware *c);
+
+// 1 si el evento se cuenta
+int evento_disponible(const ContadoresHardware *c, EventoContadores e);
+
+/**
+ * Empieza un paso: decide si se mide y, si es así, toma la marca inicial.
+ * @return 1 si el paso se mide (y hay que cerrarlo con termina_paso_contadores).
+ */
+int empieza_paso_contadores(ContadoresHardware *c);
+
+/**
+ * Suma a 'fase' lo contado desde la última marca y toma una marca nueva. No hace nada si c es
+ * NULL o el paso no se mide, así que se puede llamar en todos los pasos.
+ */
+void fase_contadores(ContadoresHardware *c, FaseContadores fase);
+
+void termina_paso_contadores(ContadoresHardware *c);
+
+// Pasos medidos y pasos totales
+long long pasos_medidos_contadores(const ContadoresHardware *c);
+long long pasos_totales_contadores(const ContadoresHardware *c);
+
+// Lo acumulado en una fase (sumas sobre los pasos medidos)
+const FaseMedida *fase_medida_contadores(const ContadoresHardware *c, FaseContadores fase);
+
+/**
+ * Tabla por fase, por paso y por partícula: ns, ciclos, instrucciones, IPC, fallos de caché y de
+ * salto, con nan en lo que no se cuente.
+ * @param N  Partículas, para los valores por partícula.
+ */
+void imprime_contadores_hardware(const ContadoresHardware *c, int N, FILE *f);
+
+// Escribe la tabla en carpeta/CONTADORES/contadores_<nombre>
+void escribe_contadores_hardware(const ContadoresHardware *c, int N, const char *carpeta, const char *nombre);
@@ -0,0 +1,277 @@
+#include "correlador.h"
+#include "funciones_oscilador.h" // crea_carpetas
+
+
+Correlador *crea_correlador(int dim) {
+    if (dim < 1 || dim > DIM_MAX_CORRELADOR) {
+        printf("Dimensión del correlador no válida: %d (máximo %d)\n", dim, DIM_MAX_CORRELADOR);
+        return NULL;
+    }
+    Correlador *c = calloc(1, sizeof(Correlador));
+    if (!c) return NULL;
+    c->dim = dim;
+    c->p = PUNTOS_CORRELADOR;
+    c->m = PROMEDIO_CORRELADOR;
+    c->n_niveles = NIVELES_CORRELADOR;
+
+    int L = c->n_niveles, p = c->p;
+    c->registro = calloc((size_t)L*p*dim, sizeof(double));
+    c->cabeza = calloc(L, sizeof(int));
+    c->insertados = calloc(L, sizeof(long long));
+    c->acumulador = calloc((size_t)L*dim, sizeof(double));
+    c->n_acumulado = calloc(L, sizeof(int));
+    c->correlacion = calloc((size_t)L*p, sizeof(double));
+    c->desplazamiento = calloc((size_t)L*p, sizeof(double));
+    c->cuentas = calloc((size_t)L*p, sizeof(long long));
+    c->suma = calloc(dim, sizeof(double));
+    c->referencia = calloc(dim, sizeof(double));
+    if (!c->referencia || !c->registro || !c->cabeza || !c->insertados || !c->acumulador || !c->n_acumulado ||
+        !c->correlacion || !c->desplazamiento || !c->cuentas || !c->suma) {
+        printf("No se pudo reservar memoria para el correlador\n");
+        libera_correlador(c);
+        return NULL;
+    }
+    return c;
+}
+
+void libera_correlador(Correlador *c) {
+    if (!c) return;
+    free(c->registro);
+    free(c->cabeza);
+    free(c->insertados);
+    free(c->acumulador);
+    free(c->n_acumulado);
+    free(c->correlacion);
+    free(c->desplazamiento);
+    free(c->cuentas);
+    free(c->suma);
+    free(c->referencia);
+    free(c);
+}
+
+void anade_correlador(Correlador *c, const double A[]) {
+    int dim = c->dim, p = c->p, m = c->m;
+    double bloque[DIM_MAX_CORRELADOR];  // Promedio que sube al nivel siguiente
+    double relativa[DIM_MAX_CORRELADOR];
+    const double *w = relativa;
+
+    if (c->insertados[0] == 0)
+        for (int d = 0; d < dim; d++) c->referencia[d] = A[d];
+    for (int d = 0; d < dim; d++) {
+        relativa[d] = A[d] - c->referencia[d];
+        c->suma[d] += relativa[d];
+    }
+
+    for (int k = 0; k < c->n_niveles; k++) {
+        // Guarda la muestra en el registro circular del nivel
+        int cabeza = (c->cabeza[k] + 1) % p;
+        c->cabeza[k] = cabeza;
+        double *registro = c->registro + (size_t)k*p*dim;
+        double *nueva = registro + cabeza*dim;
+        for (int d = 0; d < dim; d++) nueva[d] = w[d];
+        c->insertados[k]++;
+
+        // Correlaciones con las muestras anteriores del nivel. Por encima del nivel 0 los
+        // retrasos j < p/m ya los ha dado el nivel anterior con más resolución.
+        int j_min = (k == 0) ? 0 : p / m;
+        int j_max = (c->insertados[k] < p) ? (int)c->insertados[k] : p;
+        double *correlacion = c->correlacion + (size_t)k*p;
+        double *desplazamiento = c->desplazamiento + (size_t)k*p;
+        long long *cuentas = c->cuentas + (size_t)k*p;
+        for (int j = j_min; j < j_max; j++) {
+            const double *vieja = registro + ((cabeza - j + p) % p)*dim;
+            double producto = 0.0, diferencia = 0.0;
+            for (int d = 0; d < dim; d++) {
+                producto += nueva[d] * vieja[d];
+                diferencia += (nueva[d] - vieja[d]) * (nueva[d] - vieja[d]);
+            }
+            correlacion[j] += producto;
+            desplazamiento[j] += diferencia;
+            cuentas[j]++;
+        }
+
+        // Cada m muestras, su promedio pasa al nivel siguiente
+        double *acumulador = c->acumulador + (size_t)k*dim;
+        for (int d = 0; d < dim; d++) acumulador[d] += w[d];
+        if (++c->n_acumulado[k] < m) break;
+        for (int d = 0; d < dim; d++) {
+            bloque[d] = acumulador[d] / m;
+            acumulador[d] = 0.0;
+        }
+        c->n_acumulado[k] = 0;
+        w = bloque;
+    }
+}
+
+int resultados_correlador(const Correlador *c, double tau[], double correlacion[],
+                          double normalizada[], double desplazamiento[]) {
+    int p = c->p, filas = 0;
+    long long n = c->insertados[0];
+    if (n == 0) return 0;
+
+    double media2 = 0.0;
+    for (int d = 0; d < c->dim; d++) media2 += (c->suma[d] / n) * (c->suma[d] / n);
+    double varianza = c->correlacion[0] / c->cuentas[0] - media2;
+
+    double escala = 1.0;  // m^k
+    for (int k = 0; k < c->n_niveles; k++, escala *= c->m) {
+        int j_min = (k == 0) ? 0 : p / c->m;
+        for (int j = j_min; j < p; j++) {
+            long long cuentas = c->cuentas[(size_t)k*p + j];
+            if (cuentas == 0) continue;
+            double C = c->correlacion[(size_t)k*p + j] / cuentas - media2;
+            if (tau) tau[filas] = j * escala;
+            if (correlacion) correlacion[filas] = C;
+            if (normalizada) normalizada[filas] = varianza > 0.0 ? C / varianza : 0.0;
+            if (desplazamiento) desplazamiento[filas] = c->desplazamiento[(size_t)k*p + j] / cuentas;
+            filas++;
+        }
+    }
+    return filas;
+}
+
+double tiempo_relajacion(const Correlador *c, double dt_muestra) {
+    int max_filas = c->n_niveles * c->p;
+    double *tau = malloc(max_filas*sizeof(double));
+    double *normalizada = malloc(max_filas*sizeof(double));
+    if (!tau || !normalizada) {
+        free(tau);
+        free(normalizada);
+        return 0.0;
+    }
+
+    int filas = resultados_correlador(c, tau, NULL, normalizada, NULL);
+    double integral = 0.0;
+    for (int i = 1; i < filas && normalizada[i] > 0.0; i++)
+        integral += 0.5 * (normalizada[i] + normalizada[i-1]) * (tau[i] - tau[i-1]);
+
+    free(tau);
+    free(normalizada);
+    return integral * dt_muestra;
+}
+
+int escribe_correlador(const Correlador *c, double dt_muestra, const char *nombre, const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        printf("No se pudo crear el archivo %s\n", ruta);
+        return 0;
+    }
+
+    int max_filas = c->n_niveles * c->p;
+    double *tabla = malloc(4*max_filas*sizeof(double));
+    if (!tabla) {
+        fclose(f);
+        return 0;
+    }
+    double *tau = tabla, *correlacion = tabla + max_filas;
+    double *normalizada = tabla + 2*max_filas, *desplazamiento = tabla + 3*max_filas;
+    int filas = resultados_correlador(c, tau, correlacion, normalizada, desplazamiento);
+
+    fprintf(f, "# %s muestras %lld dt %.6f tau correlacion normalizada desplazamiento\n",
+            nombre, c->insertados[0], dt_muestra);
+    for (int i = 0; i < filas; i++)
+        fprintf(f, "%.6f %.6e %.6e %.6e\n", tau[i] * dt_muestra, correlacion[i], normalizada[i], desplazamiento[i]);
+
+    free(tabla);
+    fclose(f);
+    return 1;
+}
+
+
+CorrelacionesCadena *crea_correlaciones_cadena(int N) {
+    CorrelacionesCadena *c = calloc(1, sizeof(CorrelacionesCadena));
+    if (!c) return NULL;
+    c->N = N;
+    c->Ree = crea_correlador(3);
+    c->cdm = crea_correlador(3);
+    int ok = c->Ree && c->cdm;
+    for (int p = 0; p < N_MODOS_ROUSE; p++) {
+        c->rouse[p] = crea_correlador(3);
+        ok = ok && c->rouse[p];
+    }
+    c->cosenos = malloc((size_t)N_MODOS_ROUSE*N*sizeof(double));
+    if (!ok || !c->cosenos) {
+        libera_correlaciones_cadena(c);
+        return NULL;
+    }
+
+    // X_p = (1/N) sum_i x_i cos(p pi (i + 1/2) / N)
+    for (int p = 0; p < N_MODOS_ROUSE; p++)
+        for (int i = 0; i < N; i++)
+            c->cosenos[(size_t)p*N + i] = cos(PI * (p + 1) * (i + 0.5) / N) / N;
+    return c;
+}
+
+void libera_correlaciones_cadena(CorrelacionesCadena *c) {
+    if (!c) return;
+    libera_correlador(c->Ree);
+    libera_correlador(c->cdm);
+    for (int p = 0; p < N_MODOS_ROUSE; p++) libera_correlador(c->rouse[p]);
+    free(c->cosenos);
+    free(c);
+}
+
+void acumula_correlaciones_cadena(CorrelacionesCadena *c, const double x[], double t) {
+    int N = c->N;
+    double Ree[3] = {x[3*(N-1)] - x[0], x[3*(N-1)+1] - x[1], x[3*(N-1)+2] - x[2]};
+    anade_correlador(c->Ree, Ree);
+
+    double cdm_x = 0.0, cdm_y = 0.0, cdm_z = 0.0;
+    for (int i = 0; i < N; i++) {
+        cdm_x += x[3*i];
+        cdm_y += x[3*i+1];
+        cdm_z += x[3*i+2];
+    }
+    double cdm[3] = {cdm_x / N, cdm_y / N, cdm_z / N};
+    anade_correlador(c->cdm, cdm);
+
+    for (int p = 0; p < N_MODOS_ROUSE; p++) {
+        const double *cosenos = c->cosenos + (size_t)p*N;
+        double X_x = 0.0, X_y = 0.0, X_z = 0.0;
+        for (int i = 0; i < N; i++) {
+            X_x += cosenos[i] * x[3*i];
+            X_y += cosenos[i] * x[3*i+1];
+            X_z += cosenos[i] * x[3*i+2];
+        }
+        double X[3] = {X_x, X_y, X_z};
+        anade_correlador(c->rouse[p], X);
+    }
+
+    if (c->muestras == 0) c->t_primera = t;
+    c->t_ultima = t;
+    c->muestras++;
+}
+
+void escribe_correlaciones_cadena(const CorrelacionesCadena *c, const char *carpeta, const char *nombre) {
+    if (c->muestras < 2) return;
+    double dt_muestra = (c->t_ultima - c->t_primera) / (c->muestras - 1);
+
+    char carpeta_corr[512];
+    snprintf(carpeta_corr, sizeof(carpeta_corr), "%s/CORRELACIONES", carpeta);
+    crea_carpetas(carpeta_corr);
+
+    char ruta[1024];
+    snprintf(ruta, sizeof(ruta), "%s/Ree_%s", carpeta_corr, nombre);
+    escribe_correlador(c->Ree, dt_muestra, "Ree", ruta);
+    snprintf(ruta, sizeof(ruta), "%s/cdm_%s", carpeta_corr, nombre);
+    escribe_correlador(c->cdm, dt_muestra, "cdm", ruta);
+    for (int p = 0; p < N_MODOS_ROUSE; p++) {
+        char magnitud[32];
+        snprintf(magnitud, sizeof(magnitud), "rouse_%d", p + 1);
+        snprintf(ruta, sizeof(ruta), "%s/%s_%s", carpeta_corr, magnitud, nombre);
+        escribe_correlador(c->rouse[p], dt_muestra, magnitud, ruta);
+    }
+
+    // Tiempos de relajación: Ree y cada modo (tau_p ~ 1/p^2 en el modelo de Rouse)
+    snprintf(ruta, sizeof(ruta), "%s/tiempos_%s", carpeta_corr, nombre);
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        printf("No se pudo crear el archivo %s\n", ruta);
+        return;
+    }
+    fprintf(f, "# magnitud tiempo_relajacion\n");
+    fprintf(f, "Ree %.6f\n", tiempo_relajacion(c->Ree, dt_muestra));
+    for (int p = 0; p < N_MODOS_ROUSE; p++)
+        fprintf(f, "rouse_%d %.6f\n", p + 1, tiempo_relajacion(c->rouse[p], dt_muestra));
+    fclose(f);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "random.h" // PI
+
+
+/**
+ * Correlador multi-tau (bloques logarítmicos) de una magnitud vectorial A(t) de dimensión dim.
+ * Acumula al vuelo, sin guardar la serie:
+ *   C(tau) = <(A(t) - <A>) . (A(t+tau) - <A>)>
+ *   D(tau) = <|A(t+tau) - A(t)|^2>   (el MSD si A es una posición)
+ * Internamente se correla A - A(0), para que una media grande (el centro de masas, o Ree con
+ * la cadena estirada) no se coma las cifras de la covarianza al restar <A>^2.
+ *
+ * El nivel 0 guarda las últimas PUNTOS_CORRELADOR muestras y da los retrasos 0..p-1 exactos.
+ * Cada PROMEDIO_CORRELADOR muestras de un nivel se promedian y pasan al siguiente, así que el
+ * nivel k cubre retrasos j * m^k con j = p/m .. p-1. La memoria es O(p * niveles) = O(log T) y
+ * el coste por muestra es O(p) amortizado. En los niveles promediados las muestras son medias
+ * de bloques de m^k, lo que suaviza C(tau) y, para difusión, rebaja D(tau) en ~m^k/(3 tau).
+ */
+#define PUNTOS_CORRELADOR 16
+#define PROMEDIO_CORRELADOR 2
+#define NIVELES_CORRELADOR 32   // Retraso máximo ~ p * m^(niveles-1) muestras
+#define DIM_MAX_CORRELADOR 8
+
+typedef struct {
+    int dim;
+    int p, m, n_niveles;
+    double *registro;         // [nivel][p][dim]: últimas p muestras de cada nivel (circular)
+    int *cabeza;              // [nivel]: posición de la última muestra
+    long long *insertados;    // [nivel]: muestras recibidas
+    double *acumulador;       // [nivel][dim]: suma de las muestras que van al nivel siguiente
+    int *n_acumulado;         // [nivel]
+    double *correlacion;      // [nivel][p]: suma de A(t) . A(t+tau)
+    double *desplazamiento;   // [nivel][p]: suma de |A(t+tau) - A(t)|^2
+    long long *cuentas;       // [nivel][p]
+    double *suma;             // [dim]: suma de las muestras del nivel 0, para la media
+    double *referencia;       // [dim]: primera muestra, que se resta a todas
+} Correlador;
+
+Correlador *crea_correlador(int dim);
+void libera_correlador(Correlador *c);
+
+// Añade una muestra A(t) (dim componentes)
+void anade_correlador(Correlador *c, const double A[]);
+
+/**
+ * Tabla de resultados ordenada por retraso (en muestras). Devuelve el número de filas.
+ * @param tau             Retrasos (longitud al menos n_niveles * p).
+ * @param correlacion     C(tau), la covarianza.
+ * @param normalizada     C(tau) / C(0).
+ * @param desplazamiento  <|A(t+tau) - A(t)|^2>.
+ * Cualquiera de las salidas puede ser NULL.
+ */
+int resultados_correlador(const Correlador *c, double tau[], double correlacion[],
+                          double normalizada[], double desplazamiento[]);
+
+/**
+ * Tiempo de relajación: integral (trapecios) de la correlación normalizada hasta que cruza cero.
+ * @param dt_muestra  Tiempo entre muestras.
+ */
+double tiempo_relajacion(const Correlador *c, double dt_muestra);
+
+/**
+ * Escribe "tau correlacion normalizada desplazamiento" por línea, tras una línea de comentario.
+ * @return 1 si se ha escrito, 0 si no se pudo abrir el archivo.
+ */
+int escribe_correlador(const Correlador *c, double dt_muestra, const char *nombre, const char *ruta);
+
+
+// Correlaciones de una cadena que se acumulan durante la integración
+#define N_MODOS_ROUSE 3
+
+typedef struct {
+    int N;
+    Correlador *Ree;                    // Vector extremo a extremo x_{N-1} - x_0
+    Correlador *cdm;                    // Centro de masas (su D(tau) es el MSD)
+    Correlador *rouse[N_MODOS_ROUSE];   // Modos de Rouse X_p, p = 1..N_MODOS_ROUSE
+    double *cosenos;                    // [p][i]: cos(p pi (i + 1/2) / N) / N
+    long long muestras;
+    double t_primera, t_ultima;         // Para el tiempo medio entre muestras
+} CorrelacionesCadena;
+
+CorrelacionesCadena *crea_correlaciones_cadena(int N);
+void libera_correlaciones_cadena(CorrelacionesCadena *c);
+
+// Añade la configuración x del instante t
+void acumula_correlaciones_cadena(CorrelacionesCadena *c, const double x[], double t);
+
+/**
+ * Escribe carpeta/CORRELACIONES/<magnitud>_<nombre> para Ree, cdm y rouse_p, y en
+ * tiempos_<nombre> los tiempos de relajación de Ree y de cada modo de Rouse.
+ * @param carpeta  Carpeta de la trayectoria.
+ * @param nombre   Nombre del archivo de la trayectoria (V_i.txt).
+ */
+void escribe_correlaciones_cadena(const CorrelacionesCadena *c, const char *carpeta, const char *nombre);
@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <string.h>
+#include "compresion.h"
+
+/*
+ * Descomprime trayectorias .cmp (SALIDA_COMPRIMIDA) al .bin de binario.h, que se lee con
+ * Codigo_en_Python_para_graficas/trayectoria_binaria.py. Sin -o el .bin va junto al .cmp.
+ *
+ * Uso: descomprime_cli.exe archivo.cmp [archivo.cmp ...] [-o salida.bin]
+ */
+
+int main(int argc, char *argv[]) {
+    const char *salida = NULL;
+    int n_archivos = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) salida = argv[++i];
+        else n_archivos++;
+    }
+    if (n_archivos == 0 || (salida && n_archivos > 1)) {
+        printf("Uso: descomprime_cli.exe archivo.cmp [archivo.cmp ...] [-o salida.bin]\n");
+        return 1;
+    }
+
+    int fallos = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0) {
+            i++;
+            continue;
+        }
+        char ruta_bin[512];
+        if (salida) snprintf(ruta_bin, sizeof(ruta_bin), "%s", salida);
+        else {
+            size_t n = strlen(argv[i]);
+            if (n >= 4 && strcmp(argv[i] + n - 4, ".cmp") == 0) n -= 4;
+            snprintf(ruta_bin, sizeof(ruta_bin), "%.*s.bin", (int)n, argv[i]);
+        }
+        long long filas = descomprime_a_binario(argv[i], ruta_bin);
+        if (filas < 0) {
+            printf("No se pudo descomprimir %s\n", argv[i]);
+            fallos++;
+        } else {
+            printf("%s -> %s (%lld filas)\n", argv[i], ruta_bin, filas);
+        }
+    }
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+#include "estimadores.h"
+
+// El extremo solo depende de su vecino si no hay flexión ni volumen excluido
+#if !defined(WLCM) && !defined(VOLUMEN_EXCLUIDO)
+#define EXTREMO_CONDICIONADO
+#endif
+
+#define PUNTOS_INTEGRAL_ENLACE 20000     // Par, para Simpson
+#define PRIMERA_ACTUALIZACION 16         // Muestras antes de calcular los primeros beta
+
+// log(sinh(y)/y) sin desbordar para y grande
+static double log_sinh_entre(double y) {
+    if (y < 1e-8) return 0.0;
+    return y + log1p(-exp(-2.0*y)) - log(2.0*y);
+}
+
+// Función de Langevin coth(y) - 1/y
+static double langevin(double y) {
+    if (y < 1e-4) return y / 3.0;
+    return 1.0 / tanh(y) - 1.0 / y;
+}
+
+double extension_enlace_armonico(double K, double F, double kb, double Temperatura) {
+    double kT = kb * Temperatura;
+    if (F == 0.0) return 0.0;
+    if (!(kT > 0.0)) return L_0 + F / K;  // Sin fluctuaciones: el mínimo de U - F r
+
+    // Simpson en [0, L_0 + F/K + 30 sigma]; los pesos se normalizan con el máximo del exponente
+    double signo = F < 0.0 ? -1.0 : 1.0;
+    double f = fabs(F) / kT;
+    double maximo = L_0 + fabs(F) / K + 30.0 * sqrt(kT / K);
+    double h = maximo / PUNTOS_INTEGRAL_ENLACE;
+    double exponente_max = -INFINITY;
+    for (int i = 1; i <= PUNTOS_INTEGRAL_ENLACE; i++) {
+        double r = i * h;
+        double e = 2.0*log(r) - 0.5*K/kT*(r - L_0)*(r - L_0) + log_sinh_entre(f*r);
+        if (e > exponente_max) exponente_max = e;
+    }
+    double numerador = 0.0, denominador = 0.0;
+    for (int i = 1; i <= PUNTOS_INTEGRAL_ENLACE; i++) {  // En r = 0 el peso es cero
+        double r = i * h;
+        double w = (i == PUNTOS_INTEGRAL_ENLACE) ? 1.0 : (i % 2 ? 4.0 : 2.0);
+        double p = w * exp(2.0*log(r) - 0.5*K/kT*(r - L_0)*(r - L_0) + log_sinh_entre(f*r) - exponente_max);
+        denominador += p;
+        numerador += p * r * langevin(f*r);
+    }
+    return signo * numerador / denominador;
+}
+
+#ifdef FIXED
+EstimadoresCadena *crea_estimadores_cadena(int N, double K, double kb, double Temperatura, double F_cte)
+#else
+EstimadoresCadena *crea_estimadores_cadena(int N, double K, double kb, double Temperatura)
+#endif
+{
+    if (N < 2) return NULL;
+    EstimadoresCadena *e = calloc(1, sizeof(EstimadoresCadena));
+    double *sumas = calloc(5*(size_t)(N - 1), sizeof(double));
+    if (!e || !sumas) {
+        free(e);
+        free(sumas);
+        return NULL;
+    }
+    e->N = N;
+    e->proxima_actualizacion = PRIMERA_ACTUALIZACION;
+    e->suma_r  = sumas;
+    e->suma_T  = sumas + (N - 1);
+    e->suma_T2 = sumas + 2*(N - 1);
+    e->suma_rT = sumas + 3*(N - 1);
+    e->beta    = sumas + 4*(N - 1);
+    #ifdef FIXED
+    e->enlace_ideal = extension_enlace_armonico(K, F_cte, kb, Temperatura);
+    #else
+    (void)K;
+    (void)kb;
+    (void)Temperatura;
+    e->enlace_ideal = 0.0;
+    #endif
+    return e;
+}
+
+void libera_estimadores_cadena(EstimadoresCadena *e) {
+    if (!e) return;
+    free(e->suma_r);
+    free(e);
+}
+
+// beta = Cov(y, T) / Var(T) con las sumas hasta ahora (0 si T no varía)
+static double coeficiente(double suma_y, double suma_T, double suma_T2, double suma_yT, long long n) {
+    double media_T = suma_T / n;
+    double varianza = suma_T2 / n - media_T * media_T;
+    if (!(varianza > 0.0)) return 0.0;
+    return (suma_yT / n - (suma_y / n) * media_T) / varianza;
+}
+
+static void actualiza_coeficientes(EstimadoresCadena *e) {
+    long long n = e->muestras;
+    for (int j = 0; j < e->N - 1; j++)
+        e->beta[j] = coeficiente(e->suma_r[j], e->suma_T[j], e->suma_T2[j], e->suma_rT[j], n);
+    e->beta_Rg = coeficiente(e->suma_Rg, e->suma_W, e->suma_W2, e->suma_RgW, n);
+}
+
+void acumula_estimadores_cadena(EstimadoresCadena *e, const double x[], const double F[], double Rg, double Ree) {
+    int N = e->N;
+    if (e->muestras == e->proxima_actualizacion) {
+        actualiza_coeficientes(e);
+        e->proxima_actualizacion *= 2;
+    }
+
+    // Tensiones desde el extremo: T_j = T_{j+1} + F_z de la partícula j+1
+    double T = 0.0, W = 0.0, Ree_control = Ree;
+    for (int j = N - 2; j >= 0; j--) {
+        T += F[3*(j+1) + 2];
+        double r = x[3*(j+1) + 2] - x[3*j + 2];
+        e->suma_r[j] += r;
+        e->suma_T[j] += T;
+        e->suma_T2[j] += T * T;
+        e->suma_rT[j] += r * T;
+        Ree_control -= e->beta[j] * T;
+        W += T;
+    }
+    e->suma_Rg += Rg;
+    e->suma_W += W;
+    e->suma_W2 += W * W;
+    e->suma_RgW += Rg * W;
+
+    anade_estimador_bloques(&e->Ree, Ree);
+    anade_estimador_bloques(&e->Ree_control, Ree_control);
+    anade_estimador_bloques(&e->Rg, Rg);
+    anade_estimador_bloques(&e->Rg_control, Rg - e->beta_Rg * W);
+    #ifdef EXTREMO_CONDICIONADO
+    double ultimo = x[3*(N-1) + 2] - x[3*(N-2) + 2];
+    anade_estimador_bloques(&e->Ree_condicionada, Ree - ultimo + e->enlace_ideal);
+    anade_estimador_bloques(&e->ultimo_enlace, ultimo);
+    #endif
+    e->muestras++;
+}
+
+void resume_estimadores_cadena(const EstimadoresCadena *e, ResultadoEstimadores *r) {
+    r->Ree = media_estimador_bloques(&e->Ree);
+    r->error_Ree = error_estimador_bloques(&e->Ree);
+    r->Ree_control = media_estimador_bloques(&e->Ree_control);
+    r->error_Ree_control = error_estimador_bloques(&e->Ree_control);
+    r->Rg = media_estimador_bloques(&e->Rg);
+    r->error_Rg = error_estimador_bloques(&e->Rg);
+    r->Rg_control = media_estimador_bloques(&e->Rg_control);
+    r->error_Rg_control = error_estimador_bloques(&e->Rg_control);
+    r->Ree_ideal = (e->N - 1) * e->enlace_ideal;
+
+    r->Ree_condicionada = r->error_Ree_condicionada = NAN;
+    #ifdef EXTREMO_CONDICIONADO
+    // Solo si el último enlace se distribuye como uno aislado a Temperatura (a 3 errores)
+    double desvio = fabs(media_estimador_bloques(&e->ultimo_enlace) - e->enlace_ideal);
+    if (e->muestras > 0 && desvio <= 3.0 * error_estimador_bloques(&e->ultimo_enlace)) {
+        r->Ree_condicionada = media_estimador_bloques(&e->Ree_condicionada);
+        r->error_Ree_condicionada = error_estimador_bloques(&e->Ree_condicionada);
+    }
+    #endif
+}
+
+void escribe_estimadores_cadena(const EstimadoresCadena *e, const char *carpeta, const char *nombre) {
+    if (e->muestras == 0) return;
+    char carpeta_est[512];
+    snprintf(carpeta_est, sizeof(carpeta_est), "%s/ESTIMADORES", carpeta);
+    crea_carpetas(carpeta_est);
+
+    char ruta[1024];
+    snprintf(ruta, sizeof(ruta), "%s/estimadores_%s", carpeta_est, nombre);
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        printf("No se pudo crear el archivo %s\n", ruta);
+        return;
+    }
+    ResultadoEstimadores r;
+    resume_estimadores_cadena(e, &r);
+    double factor_Ree = r.error_Ree * r.error_Ree;
+    double factor_Rg = r.error_Rg * r.error_Rg;
+    fprintf(f, "# %lld muestras\n", e->muestras);
+    fprintf(f, "# estimador media error factor\n");
+    fprintf(f, "Ree_simple %.6f %.6f 1\n", r.Ree, r.error_Ree);
+    fprintf(f, "Ree_control %.6f %.6f %.3f\n", r.Ree_control, r.error_Ree_control,
+            factor_Ree / (r.error_Ree_control * r.error_Ree_control));
+    fprintf(f, "Ree_condicionada %.6f %.6f %.3f\n", r.Ree_condicionada, r.error_Ree_condicionada,
+            factor_Ree / (r.error_Ree_condicionada * r.error_Ree_condicionada));
+    fprintf(f, "Ree_ideal %.6f 0 nan\n", r.Ree_ideal);
+    fprintf(f, "Rg_simple %.6f %.6f 1\n", r.Rg, r.error_Rg);
+    fprintf(f, "Rg_control %.6f %.6f %.3f\n", r.Rg_control, r.error_Rg_control,
+            factor_Rg / (r.error_Rg_control * r.error_Rg_control));
+    fclose(f);
+}
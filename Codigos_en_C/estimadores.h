@@ -0,0 +1,79 @@
+#pragma once
+
+#include "funciones_oscilador.h"
+#include "histograma.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/**
+ * Estimadores de <Ree> y <Rg> con menos varianza que la media temporal, acumulados en cada salida
+ * junto a la media simple (todos con error por bloques, histograma.h).
+ *
+ *  - Variables de control con las fuerzas: en un estado estacionario la fuerza media sobre cada
+ *    partícula es cero (<F> = alfa <v> = 0, también con el paso GJF), así que la "tensión"
+ *    T_j = suma de F_z de las partículas j+1..N-1 tiene media exactamente cero con cualquier
+ *    potencial (WLCM, VOLUMEN_EXCLUIDO) y aunque la cadena no esté a Temperatura. Cada enlace
+ *    r_jz se corrige con su tensión: Ree - sum_j beta_j T_j, con beta_j = Cov(r_jz, T_j) / Var(T_j)
+ *    (en una cadena de muelles con L_0 = 0 la corrección es exacta y la varianza cero). Rg se
+ *    corrige con W = sum_j T_j. Los beta se recalculan cada vez que se duplican las muestras.
+ *  - Esperanza condicionada del extremo: dada la partícula N-2, la N-1 solo siente su enlace y
+ *    F_cte, así que E[z_{N-1} - z_{N-2} | resto] = <r_z> de un enlace aislado
+ *    (extension_enlace_armonico, la función de Langevin para muelles rígidos). Solo sin WLCM ni
+ *    VOLUMEN_EXCLUIDO, y solo es válida si la cadena está en equilibrio a Temperatura: se da
+ *    como NaN si la media del último enlace no es compatible con ese <r_z>.
+ *  - Cadena ideal: (N-1) <r_z>, la referencia teórica en equilibrio.
+ */
+
+typedef struct {
+    int N;
+    long long muestras;
+    long long proxima_actualizacion;    // Los beta se recalculan al llegar a este número de muestras
+    EstimadorBloques Ree, Rg;           // Medias simples
+    EstimadorBloques Ree_control, Rg_control;
+    // Por enlace j: sumas de r_jz, T_j, T_j^2 y r_jz T_j, y el beta en uso
+    double *suma_r, *suma_T, *suma_T2, *suma_rT, *beta;
+    double suma_Rg, suma_W, suma_W2, suma_RgW, beta_Rg;
+    double enlace_ideal;                // <r_z> de un enlace aislado con F_cte a Temperatura
+    EstimadorBloques Ree_condicionada, ultimo_enlace;
+} EstimadoresCadena;
+
+typedef struct {
+    double Ree, error_Ree;
+    double Ree_control, error_Ree_control;
+    double Ree_condicionada, error_Ree_condicionada;   // NaN si no se puede o no es válida
+    double Ree_ideal;
+    double Rg, error_Rg;
+    double Rg_control, error_Rg_control;
+} ResultadoEstimadores;
+
+/**
+ * <r_z> de un enlace armónico K (r - L_0)^2 / 2 con la fuerza F a lo largo de z, integrando
+ * r^2 exp(-U/kT) sinh(F r/kT)/(F r/kT) en r. Con K grande tiende a L_0 (coth(f) - 1/f), f = F L_0/kT.
+ */
+double extension_enlace_armonico(double K, double F, double kb, double Temperatura);
+
+#ifdef FIXED
+EstimadoresCadena *crea_estimadores_cadena(int N, double K, double kb, double Temperatura, double F_cte);
+#else
+EstimadoresCadena *crea_estimadores_cadena(int N, double K, double kb, double Temperatura);
+#endif
+void libera_estimadores_cadena(EstimadoresCadena *e);
+
+/**
+ * Añade una configuración.
+ * @param F  Fuerzas en x (las de Fuerza_verlet, con F_cte).
+ */
+void acumula_estimadores_cadena(EstimadoresCadena *e, const double x[], const double F[], double Rg, double Ree);
+
+void resume_estimadores_cadena(const EstimadoresCadena *e, ResultadoEstimadores *r);
+
+/**
+ * Escribe "estimador media error factor" en carpeta/ESTIMADORES/estimadores_<nombre>, con
+ * factor = (error simple / error)^2: cuántas veces más corta puede ser la simulación.
+ * @param carpeta  Carpeta de la trayectoria.
+ * @param nombre   Nombre del archivo de la trayectoria (V_i.txt).
+ */
+void escribe_estimadores_cadena(const EstimadoresCadena *e, const char *carpeta, const char *nombre);
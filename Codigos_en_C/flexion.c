@@ -0,0 +1,126 @@
+#include "flexion.h"
+#include <pthread.h>
+
+
+ParametrosFlexion parametros_flexion = {0};
+
+// Buffer de enlaces de cada hilo (Fuerza_verlet puede llamarse desde varios hilos a la vez)
+static _Thread_local double *buffer_enlaces = NULL;
+static _Thread_local int capacidad_enlaces = 0;
+
+#ifdef WLCM
+// La configuración por defecto se escribe una sola vez aunque varios hilos lleguen a la vez
+static pthread_once_t flexion_por_defecto = PTHREAD_ONCE_INIT;
+#endif
+
+
+void configura_flexion(double k, const double k_segmentos[], int n_segmentos, double theta_0) {
+    free(parametros_flexion.k_segmentos);
+    parametros_flexion.k_segmentos = NULL;
+    parametros_flexion.n_segmentos = 0;
+
+    if (k_segmentos && n_segmentos > 0) {
+        parametros_flexion.k_segmentos = malloc(n_segmentos*sizeof(double));
+        if (!parametros_flexion.k_segmentos) {
+            printf("No se pudo reservar memoria para la rigidez por segmentos\n");
+        } else {
+            memcpy(parametros_flexion.k_segmentos, k_segmentos, n_segmentos*sizeof(double));
+            parametros_flexion.n_segmentos = n_segmentos;
+        }
+    }
+
+    parametros_flexion.k = k;
+    parametros_flexion.cos_theta0 = cos(theta_0);
+    parametros_flexion.configurado = 1;
+}
+
+#ifdef WLCM
+static void configura_flexion_defecto(void) {
+    if (!parametros_flexion.configurado)
+        configura_flexion(K_BENDING, NULL, 0, THETA_0);
+}
+#endif
+
+void asegura_flexion(void) {
+    #ifdef WLCM
+    pthread_once(&flexion_por_defecto, configura_flexion_defecto);
+    #endif
+}
+
+double *enlaces_flexion(int N) {
+    if (N > capacidad_enlaces) {
+        double *nuevo = realloc(buffer_enlaces, 4*(size_t)N*sizeof(double));
+        if (!nuevo) {
+            printf("No se pudo reservar memoria para los enlaces (N = %d)\n", N);
+            return NULL;
+        }
+        buffer_enlaces = nuevo;
+        capacidad_enlaces = N;
+    }
+    return buffer_enlaces;
+}
+
+void libera_flexion(void) {
+    free(buffer_enlaces);
+    buffer_enlaces = NULL;
+    capacidad_enlaces = 0;
+}
+
+void suma_flexion(int N, const double enlaces[], double F[]) {
+    if (N < 3) return;
+    double c0 = parametros_flexion.cos_theta0;
+    double k = parametros_flexion.k;
+    int n_segmentos = parametros_flexion.n_segmentos;
+    const double *k_segmentos = parametros_flexion.k_segmentos;
+
+    // Las fuerzas de i-1 (P) e i (Q) se acumulan en registros: cada partícula se lee y se escribe
+    // una sola vez, con las contribuciones en el mismo orden que triplete a triplete
+    double P_x = F[0], P_y = F[1], P_z = F[2];
+    double Q_x = F[3], Q_y = F[4], Q_z = F[5];
+    for (int i = 1; i < N - 1; i++) {
+        double f_im1[3], f_ip1[3];
+        double k_i = (i < n_segmentos) ? k_segmentos[i] : k;
+        triplete_flexion(k_i, c0, &enlaces[4*(i-1)], &enlaces[4*i], f_im1, f_ip1);
+
+        F[3*(i-1)]     = P_x + f_im1[0];
+        F[3*(i-1) + 1] = P_y + f_im1[1];
+        F[3*(i-1) + 2] = P_z + f_im1[2];
+
+        P_x = Q_x - (f_im1[0] + f_ip1[0]);
+        P_y = Q_y - (f_im1[1] + f_ip1[1]);
+        P_z = Q_z - (f_im1[2] + f_ip1[2]);
+
+        Q_x = F[3*(i+1)]     + f_ip1[0];
+        Q_y = F[3*(i+1) + 1] + f_ip1[1];
+        Q_z = F[3*(i+1) + 2] + f_ip1[2];
+    }
+    F[3*(N-2)] = P_x; F[3*(N-2) + 1] = P_y; F[3*(N-2) + 2] = P_z;
+    F[3*(N-1)] = Q_x; F[3*(N-1) + 1] = Q_y; F[3*(N-1) + 2] = Q_z;
+}
+
+void Fuerza_flexion(int N, double x[], double F[]) {
+    asegura_flexion();
+    double *enlaces = enlaces_flexion(N);
+    if (!enlaces) {
+        // Sin buffer: cada triplete calcula sus dos enlaces
+        for (int i = 1; i < N - 1; i++) {
+            double e_i[4], e_ip1[4], f_im1[3], f_ip1[3];
+            enlace_posiciones(x, i-1, e_i);
+            enlace_posiciones(x, i, e_ip1);
+            triplete_flexion(rigidez_flexion(i), parametros_flexion.cos_theta0, e_i, e_ip1, f_im1, f_ip1);
+            for (int k = 0; k < 3; k++) {
+                F[3*(i-1) + k] += f_im1[k];
+                F[3*(i+1) + k] += f_ip1[k];
+                F[3*i + k] -= f_im1[k] + f_ip1[k];
+            }
+        }
+        return;
+    }
+    for (int i = 0; i < N - 1; i++) {
+        double dx = x[3*(i+1)]   - x[3*i];
+        double dy = x[3*(i+1)+1] - x[3*i+1];
+        double dz = x[3*(i+1)+2] - x[3*i+2];
+        enlace_flexion(dx, dy, dz, sqrt(dx*dx + dy*dy + dz*dz), &enlaces[4*i]);
+    }
+    suma_flexion(N, enlaces, F);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "funciones_oscilador.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/**
+ * Fuerzas de flexión del modelo worm-like chain. Por triplete (i-1, i, i+1):
+ *   f_{i-1} = k_i / |r_i|     (u_{i+1} - cos(theta_0) u_i)
+ *   f_{i+1} = k_i / |r_{i+1}| (u_i - cos(theta_0) u_{i+1})
+ *   f_i     = -(f_{i-1} + f_{i+1})
+ * con r_i = x_i - x_{i-1} y u_i = r_i/|r_i|.
+ *
+ * Cada enlace se describe con 4 números {u_x, u_y, u_z, 1/|r|}, calculados una sola vez por
+ * enlace (en Fuerza_verlet, en el mismo bucle que el estiramiento) en vez de dos veces por
+ * triplete, así que el triplete solo multiplica. Los enlaces de longitud cero tienen 1/|r| = 0
+ * y anulan su triplete con un factor 0/1 en lugar de saltarlo, sin salidas del bucle.
+ *
+ * cos(theta_0) y la rigidez se fijan una vez por simulación con configura_flexion, antes de
+ * lanzar hilos. La rigidez puede ser uniforme o distinta para cada triplete (k_segmentos[i] para
+ * el centrado en i).
+ */
+
+typedef struct {
+    int configurado;
+    double k;               // Rigidez uniforme
+    double cos_theta0;
+    int n_segmentos;        // Longitud de k_segmentos (0 si la rigidez es uniforme)
+    double *k_segmentos;    // Rigidez del triplete centrado en i
+} ParametrosFlexion;
+
+extern ParametrosFlexion parametros_flexion;
+
+/**
+ * Fija los parámetros de la flexión.
+ * @param k            Rigidez uniforme (la de los tripletes sin valor propio).
+ * @param k_segmentos  Rigidez de cada triplete (índice = partícula central) o NULL; se copia.
+ * @param n_segmentos  Longitud de k_segmentos.
+ * @param theta_0      Ángulo de equilibrio.
+ */
+void configura_flexion(double k, const double k_segmentos[], int n_segmentos, double theta_0);
+
+// Con WLCM y sin configurar, usa K_BENDING y THETA_0 (una sola vez, aunque la llamen varios hilos)
+void asegura_flexion(void);
+
+// Buffer (propio de cada hilo) de 4 doubles por enlace para N partículas; NULL si no hay memoria
+double *enlaces_flexion(int N);
+
+// Libera el buffer de enlaces del hilo (se vuelve a crear en la siguiente llamada)
+void libera_flexion(void);
+
+// Suma a F la flexión de todos los tripletes a partir de los datos de los enlaces
+void suma_flexion(int N, const double enlaces[], double F[]);
+
+// Suma a F la flexión calculando antes los enlaces a partir de x
+void Fuerza_flexion(int N, double x[], double F[]);
+
+
+static inline double rigidez_flexion(int i) {
+    return (i < parametros_flexion.n_segmentos) ? parametros_flexion.k_segmentos[i] : parametros_flexion.k;
+}
+
+/**
+ * Datos de un enlace para la flexión.
+ * @param dx, dy, dz  Vector del enlace.
+ * @param r           Su longitud (ya calculada para el estiramiento).
+ * @param e           Salida: {u_x, u_y, u_z, 1/r}, todo 0 si r = 0.
+ */
+static inline void enlace_flexion(double dx, double dy, double dz, double r, double e[4]) {
+    double inv = (r > 0.0) ? 1.0 / r : 0.0;
+    e[0] = dx * inv;
+    e[1] = dy * inv;
+    e[2] = dz * inv;
+    e[3] = inv;
+}
+
+// Datos del enlace (i, i+1) calculados a partir de las posiciones
+static inline void enlace_posiciones(const double x[], int i, double e[4]) {
+    double dx = x[3*(i+1)]   - x[3*i];
+    double dy = x[3*(i+1)+1] - x[3*i+1];
+    double dz = x[3*(i+1)+2] - x[3*i+2];
+    enlace_flexion(dx, dy, dz, sqrt(dx*dx + dy*dy + dz*dz), e);
+}
+
+/**
+ * Fuerzas de flexión de un triplete a partir de sus dos enlaces.
+ * @param k       Rigidez del triplete.
+ * @param c0      cos(theta_0) (parametros_flexion.cos_theta0).
+ * @param e_i     Enlace (i-1, i).
+ * @param e_ip1   Enlace (i, i+1).
+ * @param f_im1   Salida: fuerza sobre i-1. La de i es -(f_im1 + f_ip1).
+ * @param f_ip1   Salida: fuerza sobre i+1.
+ */
+static inline void triplete_flexion(double k, double c0, const double e_i[4], const double e_ip1[4],
+                                    double f_im1[3], double f_ip1[3]) {
+    double u_i_x = e_i[0], u_i_y = e_i[1], u_i_z = e_i[2], inv_i = e_i[3];
+    double u_ip1_x = e_ip1[0], u_ip1_y = e_ip1[1], u_ip1_z = e_ip1[2], inv_ip1 = e_ip1[3];
+
+    double mascara = (inv_i > 0.0 && inv_ip1 > 0.0) ? 1.0 : 0.0;
+    double k_im1 = mascara * k * inv_i;
+    double k_ip1 = mascara * k * inv_ip1;
+
+    f_im1[0] = k_im1 * (u_ip1_x - c0 * u_i_x);
+    f_im1[1] = k_im1 * (u_ip1_y - c0 * u_i_y);
+    f_im1[2] = k_im1 * (u_ip1_z - c0 * u_i_z);
+
+    f_ip1[0] = k_ip1 * (u_i_x - c0 * u_ip1_x);
+    f_ip1[1] = k_ip1 * (u_i_y - c0 * u_ip1_y);
+    f_ip1[2] = k_ip1 * (u_i_z - c0 * u_ip1_z);
+}
@@ -0,0 +1,158 @@
+#include "forma.h"
+
+
+#define BARRIDOS_JACOBI 16
+
+void autovalores_simetrica3(const double S[6], double lambda[3]) {
+    double A[3][3] = {{S[0], S[3], S[4]}, {S[3], S[1], S[5]}, {S[4], S[5], S[2]}};
+    // Jacobi cíclico: cada giro anula A[p][q]; converge cuadráticamente en pocos barridos
+    for (int barrido = 0; barrido < BARRIDOS_JACOBI; barrido++) {
+        double fuera = fabs(A[0][1]) + fabs(A[0][2]) + fabs(A[1][2]);
+        double diagonal = fabs(A[0][0]) + fabs(A[1][1]) + fabs(A[2][2]);
+        if (!(fuera > 1e-17 * diagonal)) break;
+        for (int p = 0; p < 2; p++)
+            for (int q = p + 1; q < 3; q++) {
+                if (A[p][q] == 0.0) continue;
+                double theta = (A[q][q] - A[p][p]) / (2.0 * A[p][q]);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta*theta + 1.0));
+                double c = 1.0 / sqrt(t*t + 1.0), s = t * c;
+                A[p][p] -= t * A[p][q];
+                A[q][q] += t * A[p][q];
+                A[p][q] = A[q][p] = 0.0;
+                int r = 3 - p - q;  // El tercer índice
+                double a_rp = A[r][p], a_rq = A[r][q];
+                A[r][p] = A[p][r] = c * a_rp - s * a_rq;
+                A[r][q] = A[q][r] = s * a_rp + c * a_rq;
+            }
+    }
+    double l[3] = {A[0][0], A[1][1], A[2][2]};
+    // De mayor a menor
+    for (int i = 0; i < 2; i++)
+        for (int j = i + 1; j < 3; j++)
+            if (l[j] > l[i]) { double tmp = l[i]; l[i] = l[j]; l[j] = tmp; }
+    lambda[0] = l[0]; lambda[1] = l[1]; lambda[2] = l[2];
+}
+
+void calcula_forma(int N, const double x[], FormaCadena *f, double u[]) {
+    double x0 = x[0], y0 = x[1], z0 = x[2];
+    // Momentos respecto a la partícula 0: sumas de d, d_a d_b
+    double sx = 0.0, sy = 0.0, sz = 0.0;
+    double sxx = 0.0, syy = 0.0, szz = 0.0, sxy = 0.0, sxz = 0.0, syz = 0.0;
+    double px = 0.0, py = 0.0, pz = 0.0;  // d de la partícula anterior, para los enlaces
+    for (int i = 0; i < N; i++) {
+        double dx = x[3*i] - x0, dy = x[3*i+1] - y0, dz = x[3*i+2] - z0;
+        sx += dx; sy += dy; sz += dz;
+        sxx += dx*dx; syy += dy*dy; szz += dz*dz;
+        sxy += dx*dy; sxz += dx*dz; syz += dy*dz;
+        if (u && i > 0) {
+            double ex = dx - px, ey = dy - py, ez = dz - pz;
+            double r = sqrt(ex*ex + ey*ey + ez*ez);
+            double inv = (r > 0.0) ? 1.0 / r : 0.0;
+            u[3*(i-1)] = ex * inv; u[3*(i-1)+1] = ey * inv; u[3*(i-1)+2] = ez * inv;
+        }
+        px = dx; py = dy; pz = dz;
+    }
+
+    f->Ree[0] = px; f->Ree[1] = py; f->Ree[2] = pz;
+    double mx = sx / N, my = sy / N, mz = sz / N;
+    f->S[0] = sxx / N - mx*mx;
+    f->S[1] = syy / N - my*my;
+    f->S[2] = szz / N - mz*mz;
+    f->S[3] = sxy / N - mx*my;
+    f->S[4] = sxz / N - mx*mz;
+    f->S[5] = syz / N - my*mz;
+    autovalores_simetrica3(f->S, f->lambda);
+    double l1 = f->lambda[0], l2 = f->lambda[1], l3 = f->lambda[2];
+    f->Rg2 = f->S[0] + f->S[1] + f->S[2];
+    f->asfericidad = l1 - 0.5*(l2 + l3);
+    f->acilindricidad = l2 - l3;
+    f->anisotropia = (f->Rg2 > 0.0) ? 1.0 - 3.0*(l1*l2 + l2*l3 + l3*l1) / (f->Rg2 * f->Rg2) : 0.0;
+}
+
+double correlacion_orientacion(int N, const double u[], int s) {
+    int n = N - 1 - s;
+    if (n <= 0) return NAN;
+    double suma = 0.0;
+    for (int i = 0; i < n; i++) {
+        const double *a = &u[3*i], *b = &u[3*(i+s)];
+        suma += a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    }
+    return suma / n;
+}
+
+
+EstadisticaForma *crea_estadistica_forma(int N) {
+    if (N < 2) return NULL;
+    EstadisticaForma *e = calloc(1, sizeof(EstadisticaForma));
+    if (!e) return NULL;
+    e->u = malloc(3*(size_t)(N - 1)*sizeof(double));
+    if (!e->u) {
+        free(e);
+        return NULL;
+    }
+    e->N = N;
+    for (int s = 1; s < N - 1 && e->n_separaciones < SEPARACIONES_FORMA; s *= 2)
+        e->separacion[e->n_separaciones++] = s;
+    return e;
+}
+
+void libera_estadistica_forma(EstadisticaForma *e) {
+    if (!e) return;
+    free(e->u);
+    free(e);
+}
+
+void acumula_estadistica_forma(EstadisticaForma *e, const double x[]) {
+    FormaCadena f;
+    calcula_forma(e->N, x, &f, e->u);
+    for (int k = 0; k < 3; k++) {
+        anade_estimador_bloques(&e->Ree[k], f.Ree[k]);
+        anade_estimador_bloques(&e->lambda[k], f.lambda[k]);
+    }
+    anade_estimador_bloques(&e->Ree2, f.Ree[0]*f.Ree[0] + f.Ree[1]*f.Ree[1] + f.Ree[2]*f.Ree[2]);
+    anade_estimador_bloques(&e->Rg2, f.Rg2);
+    anade_estimador_bloques(&e->asfericidad, f.asfericidad);
+    anade_estimador_bloques(&e->acilindricidad, f.acilindricidad);
+    anade_estimador_bloques(&e->anisotropia, f.anisotropia);
+    for (int k = 0; k < e->n_separaciones; k++)
+        anade_estimador_bloques(&e->orientacion[k], correlacion_orientacion(e->N, e->u, e->separacion[k]));
+    e->muestras++;
+}
+
+static void escribe_linea(FILE *f, const char *nombre, const EstimadorBloques *e) {
+    fprintf(f, "%s %.6f %.6f\n", nombre, media_estimador_bloques(e), error_estimador_bloques(e));
+}
+
+void escribe_estadistica_forma(const EstadisticaForma *e, const char *carpeta, const char *nombre) {
+    if (e->muestras == 0) return;
+    char carpeta_forma[512];
+    snprintf(carpeta_forma, sizeof(carpeta_forma), "%s/FORMA", carpeta);
+    crea_carpetas(carpeta_forma);
+
+    char ruta[1024];
+    snprintf(ruta, sizeof(ruta), "%s/forma_%s", carpeta_forma, nombre);
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        printf("No se pudo crear el archivo %s\n", ruta);
+        return;
+    }
+    fprintf(f, "# %lld muestras\n", e->muestras);
+    fprintf(f, "# observable media error\n");
+    escribe_linea(f, "Ree_x", &e->Ree[0]);
+    escribe_linea(f, "Ree_y", &e->Ree[1]);
+    escribe_linea(f, "Ree_z", &e->Ree[2]);
+    escribe_linea(f, "Ree2", &e->Ree2);
+    escribe_linea(f, "Rg2", &e->Rg2);
+    escribe_linea(f, "lambda_1", &e->lambda[0]);
+    escribe_linea(f, "lambda_2", &e->lambda[1]);
+    escribe_linea(f, "lambda_3", &e->lambda[2]);
+    escribe_linea(f, "asfericidad", &e->asfericidad);
+    escribe_linea(f, "acilindricidad", &e->acilindricidad);
+    escribe_linea(f, "anisotropia", &e->anisotropia);
+    char etiqueta[64];
+    for (int k = 0; k < e->n_separaciones; k++) {
+        snprintf(etiqueta, sizeof(etiqueta), "orientacion_%d", e->separacion[k]);
+        escribe_linea(f, etiqueta, &e->orientacion[k]);
+    }
+    fclose(f);
+}
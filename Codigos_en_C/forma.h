@@ -0,0 +1,81 @@
+#pragma once
+
+#include "funciones_oscilador.h"
+#include "histograma.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/**
+ * Forma de la cadena en una sola pasada por las partículas: vector extremo a extremo completo,
+ * tensor de giro S_ab = <(r_a - r_cm,a)(r_b - r_cm,b)>, sus autovalores l1 >= l2 >= l3 y de
+ * ellos Rg^2 = l1 + l2 + l3, la asfericidad b = l1 - (l2 + l3)/2, la acilindricidad c = l2 - l3 y
+ * la anisotropía relativa kappa^2 = (b^2 + 3c^2/4) / Rg^4 (0 esfera, 1/4 anillo plano, 1 varilla).
+ *
+ * La pasada acumula los momentos de primer y segundo orden respecto a la partícula 0 (no
+ * respecto al origen, para no perder cifras al restar con la cadena lejos de él) y a la vez los
+ * vectores unitarios de los enlaces, con los que se calcula la correlación de orientación
+ * C(s) = <u_i . u_{i+s}> en las separaciones s = 1, 2, 4, ... (log2 N de ellas, coste O(N log N)).
+ * Los autovalores salen por rotaciones de Jacobi (unas pocas en 3x3), que a diferencia de la
+ * fórmula cerrada (trigonométrica) no pierden la mitad de las cifras con autovalores repetidos.
+ *
+ * Es lo bastante barata para evaluarla cada PASOS_FORMA pasos en verlet_trayectoria en vez de en
+ * cada salida; las medias (con error por bloques) van a <carpeta>/FORMA/forma_<archivo>.
+ */
+
+#define SEPARACIONES_FORMA 24   // Separaciones de C(s) como mucho (s = 2^k < N - 1)
+
+typedef struct {
+    double Ree[3];              // r_{N-1} - r_0
+    double S[6];                // Tensor de giro: xx, yy, zz, xy, xz, yz
+    double lambda[3];           // Autovalores de mayor a menor
+    double Rg2;
+    double asfericidad, acilindricidad, anisotropia;
+} FormaCadena;
+
+/**
+ * Autovalores de la matriz simétrica {S[0] S[3] S[4]; S[3] S[1] S[5]; S[4] S[5] S[2]}.
+ * @param lambda  Salida, de mayor a menor.
+ */
+void autovalores_simetrica3(const double S[6], double lambda[3]);
+
+/**
+ * Forma instantánea de la cadena.
+ * @param u  Salida opcional (NULL para no calcularla): los 3(N-1) componentes de los vectores
+ *           unitarios de los enlaces (cero si el enlace mide cero).
+ */
+void calcula_forma(int N, const double x[], FormaCadena *f, double u[]);
+
+// <u_i . u_{i+s}> en una configuración a partir de los vectores de calcula_forma (N-1 enlaces)
+double correlacion_orientacion(int N, const double u[], int s);
+
+
+/**
+ * Medias de la forma a lo largo de una trayectoria.
+ */
+typedef struct {
+    int N;
+    long long muestras;
+    double *u;                                  // Enlaces unitarios de la última configuración
+    EstimadorBloques Ree[3], Ree2;
+    EstimadorBloques Rg2, lambda[3];
+    EstimadorBloques asfericidad, acilindricidad, anisotropia;
+    int n_separaciones;
+    int separacion[SEPARACIONES_FORMA];
+    EstimadorBloques orientacion[SEPARACIONES_FORMA];
+} EstadisticaForma;
+
+EstadisticaForma *crea_estadistica_forma(int N);
+void libera_estadistica_forma(EstadisticaForma *e);
+
+// Añade la configuración x
+void acumula_estadistica_forma(EstadisticaForma *e, const double x[]);
+
+/**
+ * Escribe carpeta/FORMA/forma_<nombre> con una línea "observable media error" por observable
+ * (Ree_x, Ree_y, Ree_z, Ree2, Rg2, lambda_1..3, asfericidad, acilindricidad, anisotropia y
+ * orientacion_<s> para cada separación).
+ */
+void escribe_estadistica_forma(const EstadisticaForma *e, const char *carpeta, const char *nombre);
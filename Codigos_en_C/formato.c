@@ -0,0 +1,160 @@
+#include "formato.h"
+
+#define LIMITE_ENTERO 9223372036854775808.0    // 2^63
+#define LIMITE_MANTISA 9007199254740992ull     // 2^53: enteros exactos en double
+#define MAXIMOS_DECIMALES 22                   // 10^22 es el mayor exacto en double
+
+static const double potencias_10[MAXIMOS_DECIMALES + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const char pares_digitos[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+
+// --- Formato ---
+
+// Millonésimas de f en [0, 1), redondeadas al par (puede dar 10^6)
+static uint64_t millonesimas(double f) {
+    uint64_t bits;
+    memcpy(&bits, &f, 8);
+    int exponente = (int)(bits >> 52) & 0x7ff;
+    uint64_t mantisa = bits & ((1ull << 52) - 1);
+    if (exponente) mantisa |= 1ull << 52;
+    else exponente = 1;
+    if (mantisa == 0) return 0;
+    // f = mantisa * 2^-desplazamiento, con desplazamiento >= 53 porque f < 1
+    int desplazamiento = 1075 - exponente;
+    if (desplazamiento >= 128) return 0;      // f*10^6 < 2^-54
+    unsigned __int128 producto = (unsigned __int128)mantisa * 1000000u;
+    unsigned __int128 cociente = producto >> desplazamiento;
+    unsigned __int128 resto = producto - (cociente << desplazamiento);
+    unsigned __int128 mitad = (unsigned __int128)1 << (desplazamiento - 1);
+    if (resto > mitad || (resto == mitad && (cociente & 1))) cociente++;
+    return (uint64_t)cociente;
+}
+
+int formatea_fijo6(double x, char *s) {
+    if (!(fabs(x) < LIMITE_ENTERO)) return snprintf(s, TAM_MAXIMO_FIJO6, "%.6f", x);
+    char *p = s;
+    if (signbit(x)) {
+        *p++ = '-';
+        x = -x;
+    }
+    uint64_t entera = (uint64_t)x;
+    uint64_t fraccion = millonesimas(x - (double)entera);   // La resta es exacta
+    if (fraccion == 1000000) {
+        entera++;
+        fraccion = 0;
+    }
+
+    char digitos[20];
+    int n = 0;
+    do {
+        digitos[n++] = (char)('0' + entera % 10);
+        entera /= 10;
+    } while (entera);
+    while (n) *p++ = digitos[--n];
+
+    *p++ = '.';
+    uint32_t f = (uint32_t)fraccion;
+    memcpy(p,     &pares_digitos[2*(f / 10000)], 2);
+    memcpy(p + 2, &pares_digitos[2*(f / 100 % 100)], 2);
+    memcpy(p + 4, &pares_digitos[2*(f % 100)], 2);
+    p += 6;
+    *p = '\0';
+    return (int)(p - s);
+}
+
+
+// --- Lectura ---
+
+static inline int es_espacio(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+double lee_decimal(const char *p, char **fin) {
+    const char *q = p;
+    while (es_espacio(*q)) q++;
+    int negativo = *q == '-';
+    if (*q == '-' || *q == '+') q++;
+
+    uint64_t mantisa = 0;
+    int cifras = 0, decimales = 0;
+    for (; *q >= '0' && *q <= '9'; q++, cifras++) {
+        if (mantisa >= LIMITE_MANTISA / 10) return strtod(p, fin);
+        mantisa = 10*mantisa + (uint64_t)(*q - '0');
+    }
+    if (*q == '.') {
+        q++;
+        for (; *q >= '0' && *q <= '9'; q++, cifras++, decimales++) {
+            if (mantisa >= LIMITE_MANTISA / 10 || decimales == MAXIMOS_DECIMALES) return strtod(p, fin);
+            mantisa = 10*mantisa + (uint64_t)(*q - '0');
+        }
+    }
+    // Exponentes, hexadecimal, inf, nan o nada que leer: como strtod
+    if (cifras == 0 || *q == 'e' || *q == 'E' || *q == 'x' || *q == 'X') return strtod(p, fin);
+
+    if (fin) *fin = (char *)q;
+    double valor = (double)mantisa / potencias_10[decimales];
+    return negativo ? -valor : valor;
+}
+
+
+// --- Salida con buffer ---
+
+static int asegura_espacio(SalidaTexto *s, size_t n) {
+    if (s->usado + n <= s->capacidad) return 1;
+    size_t capacidad = s->capacidad ? s->capacidad : TAM_BLOQUE_TEXTO + TAM_MAXIMO_FIJO6;
+    while (s->usado + n > capacidad) capacidad *= 2;
+    char *nuevo = realloc(s->buffer, capacidad);
+    if (!nuevo) return 0;
+    s->buffer = nuevo;
+    s->capacidad = capacidad;
+    return 1;
+}
+
+SalidaTexto *abre_salida_texto(FILE *archivo) {
+    SalidaTexto *s = calloc(1, sizeof(SalidaTexto));
+    if (!s) return NULL;
+    s->archivo = archivo;
+    if (!asegura_espacio(s, TAM_BLOQUE_TEXTO)) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+void anade_fijo6(SalidaTexto *s, char separador, double x) {
+    if (!asegura_espacio(s, TAM_MAXIMO_FIJO6 + 1)) return;
+    if (separador) s->buffer[s->usado++] = separador;
+    s->usado += formatea_fijo6(x, s->buffer + s->usado);
+}
+
+void anade_texto(SalidaTexto *s, const char *texto) {
+    size_t n = strlen(texto);
+    if (!asegura_espacio(s, n + 1)) return;
+    memcpy(s->buffer + s->usado, texto, n);
+    s->usado += n;
+}
+
+void termina_linea_texto(SalidaTexto *s) {
+    if (!asegura_espacio(s, 1)) return;
+    s->buffer[s->usado++] = '\n';
+    if (s->usado >= TAM_BLOQUE_TEXTO) vuelca_salida_texto(s);
+}
+
+void vuelca_salida_texto(SalidaTexto *s) {
+    if (s->usado) fwrite(s->buffer, 1, s->usado, s->archivo);
+    s->usado = 0;
+}
+
+void cierra_salida_texto(SalidaTexto *s) {
+    if (!s) return;
+    vuelca_salida_texto(s);
+    free(s->buffer);
+    free(s);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+
+/**
+ * Escritura y lectura rápidas del texto de las trayectorias, sin printf ni scanf.
+ *
+ * formatea_fijo6 escribe exactamente lo mismo que "%.6f" (redondeo al par del valor binario
+ * exacto, como glibc y el CRT de MinGW con el locale "C") con aritmética entera: la parte
+ * fraccionaria se multiplica por 10^6 en 128 bits. Los valores con |x| >= 2^63, infinitos y NaN
+ * pasan por snprintf.
+ *
+ * SalidaTexto junta líneas enteras en un buffer y las escribe con un fwrite por bloque de
+ * TAM_BLOQUE_TEXTO bytes. No es dueña del FILE: cierra_salida_texto vuelca pero no cierra.
+ *
+ * lee_decimal da el mismo double que strtod para los números que escribe formatea_fijo6
+ * (mantisa decimal de hasta 2^53 y como mucho 22 decimales: una sola división exacta).
+ * Lo demás (exponentes, nan, inf, mantisas más largas) pasa por strtod.
+ */
+
+#define TAM_BLOQUE_TEXTO 65536
+#define TAM_MAXIMO_FIJO6 320            // "%.6f" de -DBL_MAX con el terminador
+
+typedef struct {
+    FILE *archivo;
+    char *buffer;
+    size_t usado, capacidad;
+} SalidaTexto;
+
+/**
+ * Escribe x como "%.6f".
+ * @param s  Al menos TAM_MAXIMO_FIJO6 bytes.
+ * @return Número de caracteres escritos (sin el terminador).
+ */
+int formatea_fijo6(double x, char *s);
+
+// strtod rápido para decimales sin exponente
+double lee_decimal(const char *p, char **fin);
+
+SalidaTexto *abre_salida_texto(FILE *archivo);
+
+// Añade el separador (si no es 0) y x como "%.6f"
+void anade_fijo6(SalidaTexto *s, char separador, double x);
+
+void anade_texto(SalidaTexto *s, const char *texto);
+
+// Termina la línea y escribe el buffer si pasa de TAM_BLOQUE_TEXTO
+void termina_linea_texto(SalidaTexto *s);
+
+void vuelca_salida_texto(SalidaTexto *s);
+
+void cierra_salida_texto(SalidaTexto *s);
@@ -1,4 +1,7 @@
 #include "funciones_oscilador.h"
+#include "vecinos.h"
+#include "flexion.h"
+#include "formato.h"
 #include <sys/stat.h> // mkdir
 #include <sys/types.h>
 
@@ -17,6 +20,11 @@ void Fuerza_verlet(int N, double x[], double F[], double K)
 
     // 2. CALCULAR FUERZAS DE ESTIRAMIENTO
     // ====================================
+    #ifdef WLCM
+    // Los vectores unitarios de los enlaces se guardan para la flexión
+    asegura_flexion();
+    double *enlaces = enlaces_flexion(N);
+    #endif
     for (int i = 0; i < N - 1; i++) {
         int i3 = 3*i;
         int j3 = 3*(i+1);
@@ -26,6 +34,9 @@ void Fuerza_verlet(int N, double x[], double F[], double K)
         double dz = x[j3+2] - x[i3+2];
 
         double r = sqrt(dx*dx + dy*dy + dz*dz);
+        #ifdef WLCM
+        if (enlaces) enlace_flexion(dx, dy, dz, r, &enlaces[4*i]);
+        #endif
         if (r == 0.0) continue;
         
         double fac = K * (r - L_0) / r;
@@ -58,58 +69,58 @@ void Fuerza_verlet(int N, double x[], double F[], double K)
     // 4. AÑADIR FUERZAS DE FLEXIÓN (WORM-LIKE CHAIN MODEL)
     // =====================================================
     #ifdef WLCM
-    for (int i = 1; i < N - 1; i++) {
-        int im1_3 = 3 * (i - 1);
-        int i_3   = 3 * i;
-        int ip1_3 = 3 * (i + 1);
-
-        double r_i_x = x[i_3]     - x[im1_3];
-        double r_i_y = x[i_3 + 1] - x[im1_3 + 1];
-        double r_i_z = x[i_3 + 2] - x[im1_3 + 2];
-
-        double r_ip1_x = x[ip1_3]     - x[i_3];
-        double r_ip1_y = x[ip1_3 + 1] - x[i_3 + 1];
-        double r_ip1_z = x[ip1_3 + 2] - x[i_3 + 2];
-        
-        double mag_ri  = sqrt(r_i_x*r_i_x + r_i_y*r_i_y + r_i_z*r_i_z);
-        double mag_rip1 = sqrt(r_ip1_x*r_ip1_x + r_ip1_y*r_ip1_y + r_ip1_z*r_ip1_z);
+    if (enlaces)
+        suma_flexion(N, enlaces, F);
+    else
+        Fuerza_flexion(N, x, F);  // Sin memoria para el buffer: recalcula los enlaces
+    
+    #ifdef FIXED
+    // Asegurar nuevamente que la primera partícula esté fija después de WLCM
+    F[0] = 0.0;
+    F[1] = 0.0;
+    F[2] = 0.0;
+    #endif
+    #endif // Fin del bloque WLCM
 
-        if (mag_ri == 0.0 || mag_rip1 == 0.0) continue;
+    // 5. AÑADIR VOLUMEN EXCLUIDO (WCA ENTRE PARTÍCULAS NO ENLAZADAS)
+    // ===============================================================
+    #ifdef VOLUMEN_EXCLUIDO
+    Fuerza_volumen_excluido(N, x, F);
 
-        double u_i_x = r_i_x / mag_ri; double u_i_y = r_i_y / mag_ri; double u_i_z = r_i_z / mag_ri;
-        double u_ip1_x = r_ip1_x / mag_rip1; double u_ip1_y = r_ip1_y / mag_rip1; double u_ip1_z = r_ip1_z / mag_rip1;
-        
-        double cos_theta = u_i_x*u_ip1_x + u_i_y*u_ip1_y + u_i_z*u_ip1_z;
-        double cos_theta0 = cos(THETA_0);
-        
-        double f_im1_x = (K_BENDING / mag_ri) * (u_ip1_x - cos_theta0 * u_i_x);
-        double f_im1_y = (K_BENDING / mag_ri) * (u_ip1_y - cos_theta0 * u_i_y);
-        double f_im1_z = (K_BENDING / mag_ri) * (u_ip1_z - cos_theta0 * u_i_z);
-        
-        double f_ip1_x = (K_BENDING / mag_rip1) * (u_i_x - cos_theta0 * u_ip1_x);
-        double f_ip1_y = (K_BENDING / mag_rip1) * (u_i_y - cos_theta0 * u_ip1_y);
-        double f_ip1_z = (K_BENDING / mag_rip1) * (u_i_z - cos_theta0 * u_ip1_z);
+    #ifdef FIXED
+    F[0] = 0.0;
+    F[1] = 0.0;
+    F[2] = 0.0;
+    #endif
+    #endif
+}
 
-        F[im1_3]     += f_im1_x;
-        F[im1_3 + 1] += f_im1_y;
-        F[im1_3 + 2] += f_im1_z;
+/**
+ * Fuerza determinista total para Euler-Maruyama: la conservativa de Fuerza_verlet
+ * más la fricción -eta*p/m.
+ * @param p     Array con los momentos.
+ * @param eta   Coeficiente de fricción.
+ */
+#ifdef FIXED
+void Fuerza_euler(int N, double x[], double p[], double F[], double K, double eta, double m, double F_cte)
+#else
+void Fuerza_euler(int N, double x[], double p[], double F[], double K, double eta, double m)
+#endif
+{
+    #ifdef FIXED
+    Fuerza_verlet(N, x, F, K, F_cte);
+    #else
+    Fuerza_verlet(N, x, F, K);
+    #endif
 
-        F[ip1_3]     += f_ip1_x;
-        F[ip1_3 + 1] += f_ip1_y;
-        F[ip1_3 + 2] += f_ip1_z;
+    for (int i = 0; i < 3*N; i++)
+        F[i] -= eta * p[i] / m;
 
-        F[i_3]       -= (f_im1_x + f_ip1_x);
-        F[i_3 + 1]   -= (f_im1_y + f_ip1_y);
-        F[i_3 + 2]   -= (f_im1_z + f_ip1_z);
-    }
-    
     #ifdef FIXED
-    // Asegurar nuevamente que la primera partícula esté fija después de WLCM
     F[0] = 0.0;
     F[1] = 0.0;
     F[2] = 0.0;
     #endif
-    #endif // Fin del bloque WLCM
 }
 
 
@@ -129,6 +140,9 @@ double Energia_potencial_instantanea(int N, double x[], double m, double K){
         double r=sqrt(dx*dx+dy*dy+dz*dz);
         V=V+0.5*K*(r-L_0)*(r-L_0);
     }
+    #ifdef VOLUMEN_EXCLUIDO
+    V=V+Energia_volumen_excluido(N,x);
+    #endif
     return V;
 }
 
@@ -138,6 +152,20 @@ double Energia_total_instantanea(int N, double x[], double v[], double m, double
     return E;
 }
 
+void crea_carpetas(char *ruta) {
+    for (size_t i = 1; ruta[i - 1] != '\0'; i++) {
+        if (ruta[i] != '/' && ruta[i] != '\0') continue;
+        char separador = ruta[i];
+        ruta[i] = '\0';
+#ifdef _WIN32
+        mkdir(ruta);
+#else
+        mkdir(ruta, 0755);
+#endif
+        ruta[i] = separador;
+    }
+}
+
 void escribir_tiempo_en_ultimo_archivo(double tiempo, const char *carpeta, const char *prefijo) {
     DIR *dir;
     struct dirent *entry;
@@ -189,35 +217,88 @@ void escribir_tiempo_en_ultimo_archivo(double tiempo, const char *carpeta, const
 }
 
 double calcula_radio_giro(int N, double *x) {
-    double x_cm = 0.0, y_cm = 0.0, z_cm = 0.0;
-    double Rg2 = 0.0;
-    int i;
-    
-    // 1. Calcular el centro de masa
-    for (i = 0; i < N; i++) {
-        x_cm += x[3*i];      // x de partícula i
-        y_cm += x[3*i + 1];  // y de partícula i  
-        z_cm += x[3*i + 2];  // z de partícula i
+    // Una sola pasada: Rg^2 = <d^2> - <d>^2 con d la posición respecto a la partícula 0
+    // (respecto al origen se perderían cifras con la cadena lejos de él; forma.c hace lo mismo)
+    double sx = 0.0, sy = 0.0, sz = 0.0, s2 = 0.0;
+    for (int i = 0; i < N; i++) {
+        double dx = x[3*i] - x[0];
+        double dy = x[3*i + 1] - x[1];
+        double dz = x[3*i + 2] - x[2];
+        sx += dx; sy += dy; sz += dz;
+        s2 += dx*dx + dy*dy + dz*dz;
     }
-    
-    x_cm /= N;
-    y_cm /= N;
-    z_cm /= N;
-    
-    // 2. Calcular Rg^2
-    for (i = 0; i < N; i++) {
-        double dx = x[3*i] - x_cm;
-        double dy = x[3*i + 1] - y_cm;
-        double dz = x[3*i + 2] - z_cm;
-        
-        Rg2 += dx*dx + dy*dy + dz*dz;
+    double mx = sx / N, my = sy / N, mz = sz / N;
+    double Rg2 = s2 / N - (mx*mx + my*my + mz*mz);
+
+    // Devolver Rg (no Rg^2)
+    return sqrt(Rg2 > 0.0 ? Rg2 : 0.0);
+}
+/**
+ * Temperatura configuracional T_conf = <|grad U|^2> / (kb <lap U>) de una configuración.
+ * El laplaciano es el de los muelles armónicos más la repulsión WCA si VOLUMEN_EXCLUIDO
+ * (no incluye la flexión de WLCM), así que solo es un estimador exacto de la temperatura
+ * para la cadena sin rigidez.
+ * En modo FIXED la primera partícula no cuenta como grado de libertad.
+ * @param F   Fuerzas ya calculadas en x (F = -grad U).
+ */
+double Temperatura_configuracional(int N, double x[], double F[], double K, double kb) {
+    double grad2 = 0.0, lap = 0.0;
+
+    #ifdef FIXED
+    int i_min = 1;
+    #else
+    int i_min = 0;
+    #endif
+
+    for (int i = 3*i_min; i < 3*N; i++)
+        grad2 += F[i]*F[i];
+
+    for (int i = 0; i < N - 1; i++) {
+        double dx = x[3*(i+1)]   - x[3*i];
+        double dy = x[3*(i+1)+1] - x[3*i+1];
+        double dz = x[3*(i+1)+2] - x[3*i+2];
+        double r = sqrt(dx*dx + dy*dy + dz*dz);
+        if (r == 0.0) continue;
+
+        // lap_i U = U'' + 2U'/r, igual para las dos partículas del enlace
+        double lap_enlace = K + 2.0*K*(r - L_0)/r;
+        lap += (i >= i_min) ? 2.0*lap_enlace : lap_enlace;
     }
-    
-    Rg2 /= N;
-    
-    // 3. Devolver Rg (no Rg^2)
-    return sqrt(Rg2);
+
+    #ifdef VOLUMEN_EXCLUIDO
+    lap += Laplaciano_volumen_excluido(N, x, i_min);
+    #endif
+
+    if (lap <= 0.0) return 0.0;
+    return grad2 / (kb * lap);
 }
+
+/**
+ * Lee una línea completa de longitud arbitraria (como getline, que no existe en MinGW).
+ * @param linea   Buffer reservado con malloc; se amplía si hace falta.
+ * @param tam     Tamaño actual del buffer.
+ * @return 1 si se ha leído una línea, 0 al final del archivo.
+ */
+static int lee_linea(char **linea, size_t *tam, FILE *file) {
+    if (*linea == NULL || *tam == 0) {
+        *tam = 4096;
+        *linea = malloc(*tam);
+        if (!*linea) return 0;
+    }
+
+    size_t len = 0;
+    while (fgets(*linea + len, (int)(*tam - len), file)) {
+        len += strlen(*linea + len);
+        if (len > 0 && (*linea)[len-1] == '\n') return 1;
+
+        char *nuevo = realloc(*linea, 2*(*tam));
+        if (!nuevo) return 0;
+        *linea = nuevo;
+        *tam *= 2;
+    }
+    return len > 0;
+}
+
 /**
  * Procesa un archivo de trayectoria generado por verlet_trayectoria
  * y escribe promedios y errores de Ek, Ep, Rg, Ree en la carpeta RES_IMPORTANTES
@@ -235,7 +316,9 @@ void procesar_trayectoria(char* archivo_input, int N_start, int N, double K
         return;
     }
 
-    char linea[32768];
+    // Con datos por partícula la línea mide ~10*(6N+6) caracteres: se lee con lee_linea
+    char *linea = NULL;
+    size_t tam_linea = 0;
     int linea_actual = 0;
     int n_datos = 0;
     int primera_impresion = 1; // flag para imprimir solo la primera línea
@@ -245,22 +328,35 @@ void procesar_trayectoria(char* archivo_input, int N_start, int N, double K
     double sum_Rg=0, sum_Rg2=0;
     double sum_Ree=0, sum_Ree2=0;
 
-    while(fgets(linea, sizeof(linea), file)) {
+    while(lee_linea(&linea, &tam_linea, file)) {
         linea_actual++;
+        // Comentarios: "# INESTABLE ..." si la trayectoria se cortó por inestable (salud.c)
+        if(linea[0] == '#') {
+            printf("%s: %s", archivo_input, linea);
+            continue;
+        }
         if(linea_actual <= N_start) continue;
 
         char *ptr = linea;
-        int skip_cols = 1 + 3*N + 3*N; // tiempo + 3*N posiciones + 3*N velocidades
+        // tiempo + 3*N posiciones + 3*N velocidades (solo tiempo si es una cadena larga)
+        int skip_cols = SALIDA_PARTICULAS(N) ? 1 + 3*N + 3*N : 1;
         for(int i=0;i<skip_cols;i++){
             while(*ptr != ' ' && *ptr != '\t' && *ptr != '\0' && *ptr != '\n') ptr++;
             while((*ptr == ' ' || *ptr == '\t') && *ptr != '\0' && *ptr != '\n') ptr++;
         }
 
-        double Ek, Ep, Rg, Ree;
-        if(sscanf(ptr, "%lf %lf %*lf %lf %lf", &Ek, &Ep, &Rg, &Ree) != 4) {
+        // Ek Ep Et Rg Ree con lee_decimal (formato.c), que da lo mismo que strtod sin scanf
+        double observables[5];
+        int leidas = 0;
+        for (char *fin; leidas < 5; leidas++, ptr = fin) {
+            observables[leidas] = lee_decimal(ptr, &fin);
+            if (fin == ptr) break;
+        }
+        if(leidas != 5) {
             printf("Error leyendo la línea %d\n", linea_actual);
             continue;
         }
+        double Ek = observables[0], Ep = observables[1], Rg = observables[3], Ree = observables[4];
 
         sum_Ek += Ek; sum_Ek2 += Ek*Ek;
         sum_Ep += Ep; sum_Ep2 += Ep*Ep;
@@ -269,6 +365,7 @@ void procesar_trayectoria(char* archivo_input, int N_start, int N, double K
         n_datos++;
     }
 
+    free(linea);
     fclose(file);
 
     if(n_datos == 0) {
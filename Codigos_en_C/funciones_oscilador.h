@@ -10,14 +10,80 @@
 
 #define L_0 1.0
 
+// Cadenas largas: por encima de N_CADENA_LARGA partículas se usa el paso fusionado
+// (cadena_larga.c) y la trayectoria solo guarda tiempo y observables, sin datos por partícula.
+#define N_CADENA_LARGA 256
+//#define SALIDA_PARTICULAS_CADENA_LARGA //DEFINIR PARA GUARDAR POSICIONES Y VELOCIDADES AUN CON N GRANDE
+#ifdef SALIDA_PARTICULAS_CADENA_LARGA
+#define GUARDA_PARTICULAS(N) 1
+#else
+#define GUARDA_PARTICULAS(N) ((N) <= N_CADENA_LARGA)
+#endif
+
+// Trayectoria también en binario (<archivo>.bin, binario.c) para leerla con numpy.memmap sin parsear texto
+//#define SALIDA_BINARIA //DEFINIR PARA ESCRIBIR ADEMÁS EL .bin JUNTO A CADA TRAYECTORIA
+
+// Trayectoria comprimida (<archivo>.cmp, compresion.c). Las posiciones y velocidades van solo al .cmp
+// y el .txt se queda con tiempo y observables; descomprime_cli.exe pasa el .cmp a .bin.
+//#define SALIDA_COMPRIMIDA //DEFINIR PARA ESCRIBIR LAS PARTÍCULAS COMPRIMIDAS EN VEZ DE EN TEXTO
+#define PRECISION_COMPRESION 0.0 // 0: sin pérdidas; > 0: cuantizada con ese error máximo por valor
+
+// Estado en vivo de cada trayectoria (paso, pasos/s, medias) en TELEMETRIA/*.tel (telemetria.c) para monitor.exe
+//#define TELEMETRIA //DEFINIR PARA PUBLICAR EL ESTADO DE LAS SIMULACIONES
+
+// Vigilancia de la estabilidad numérica en cada salida de verlet_trayectoria (salud.c; la granja
+// vigila siempre): una trayectoria que explota (NaN, enlaces rotos, temperatura desbocada) se corta
+// con una línea "# INESTABLE ..." en el .txt
+//#define SALUD //DEFINIR PARA VIGILAR LA ESTABILIDAD NUMÉRICA
+
+// Análisis que verlet_trayectoria acumula durante la integración y escribe junto a la trayectoria.
+// Distribuciones de Ree, Rg, enlaces y ángulos en cada salida (histograma.c), en DISTRIBUCIONES/
+//#define DISTRIBUCIONES //DEFINIR PARA ACUMULAR LAS DISTRIBUCIONES
+// Correlaciones multi-tau de Ree, centro de masas y modos de Rouse en cada salida (correlador.c), en CORRELACIONES/
+//#define CORRELACIONES //DEFINIR PARA CALCULAR LAS CORRELACIONES
+// Medias de Ree y Rg con variables de control y esperanza condicionada (estimadores.c), en ESTIMADORES/
+//#define ESTIMADORES //DEFINIR PARA CALCULAR LOS ESTIMADORES DE VARIANZA REDUCIDA
+
+// Forma de la cadena (vector extremo a extremo, tensor de giro, orientación de los enlaces; forma.c)
+// cada PASOS_FORMA pasos en verlet_trayectoria, con las medias en FORMA/forma_<archivo>.
+// Con PASOS_FORMA 0 (o con el motor de hilos, que solo da posiciones en las salidas) se evalúa en
+// cada salida.
+//#define FORMA //DEFINIR PARA ANALIZAR LA FORMA DE LA CADENA
+#define PASOS_FORMA 10
+
+// Ciclos, instrucciones, fallos de caché y de salto por fase del paso (ruido, fuerza, actualización,
+// salida) con perf_event_open (contadores.c), en CONTADORES/contadores_<archivo>. Sin permiso para
+// los contadores se quedan solo los tiempos de cada fase.
+//#define CONTADORES_HARDWARE //DEFINIR PARA MEDIR CADA FASE DE verlet_trayectoria
+
+// Columnas por partícula en el .txt
+#ifdef SALIDA_COMPRIMIDA
+#define SALIDA_PARTICULAS(N) 0
+#else
+#define SALIDA_PARTICULAS(N) GUARDA_PARTICULAS(N)
+#endif
+
+// Hilos para integrar una sola cadena larga (hilos.c). Con 1 se usa el paso fusionado en serie.
+#define N_HILOS 1
+
+// Ruido térmico por contador (Philox, random.h): depende solo de la semilla, el paso y la partícula,
+// así que la trayectoria es la misma bit a bit con cualquier N_HILOS o recorrido de las partículas
+//#define RUIDO_CONTADOR //DEFINIR PARA USAR EL RUIDO POR CONTADOR EN VEZ DE PARISI-RAPUANO
+
 //#define FIXED //DEFINIR SI HAY UN EXTREMO FIJO
 #define FIXED
 /*
 #define WLCM  //DEFINIR SI SE USA EL MODELO WORM-LIKE CHAIN
 #define K_BENDING 10.0
 #define THETA_0 0 // Ángulo de equilibrio de 0 grados
+// (rigidez distinta por segmento: configura_flexion en flexion.h)
 */
 
+//#define VOLUMEN_EXCLUIDO //DEFINIR PARA AÑADIR LA REPULSIÓN WCA ENTRE PARTÍCULAS NO ENLAZADAS (vecinos.c)
+#define EPSILON_WCA 1.0
+#define SIGMA_WCA 1.0
+#define PIEL_VECINOS 0.4 // Piel de la lista de Verlet: se reconstruye al moverse algo más de PIEL/2
+
 
 #ifndef FIXED
 void Fuerza_verlet(int N, double x[], double F[], double K);
@@ -25,7 +91,11 @@ void Fuerza_verlet(int N, double x[], double F[], double K);
 void Fuerza_verlet(int N, double x[], double F[], double K, double F_cte);
 #endif
 
+#ifdef FIXED
+void Fuerza_euler(int N, double x[], double p[], double F[], double K,double eta, double m, double F_cte);
+#else
 void Fuerza_euler(int N, double x[], double p[], double F[], double K,double eta, double m);
+#endif
 
 double Energia_cinetica_instantanea(int N, double v[], double m);
 
@@ -35,8 +105,13 @@ double Energia_total_instantanea(int N, double x[], double v[], double m, double
 
 void escribir_tiempo_en_ultimo_archivo(double tiempo, const char *carpeta, const char *prefijo);
 
+// Crea todas las carpetas de la ruta, como mkdir -p (la ruta se modifica y se restaura)
+void crea_carpetas(char *ruta);
+
 double calcula_radio_giro(int N, double *x);
 
+double Temperatura_configuracional(int N, double x[], double F[], double K, double kb);
+
 void procesar_trayectoria(char* archivo_input, int N_start, int N, double K 
     #ifdef FIXED
         , double F_cte
@@ -0,0 +1,474 @@
+#include "granja.h"
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h> // mkdir
+#include <sys/types.h>
+
+#ifndef _WIN32
+#include <sys/file.h> // flock
+#endif
+
+#define TAM_RUTA_PUNTO 768
+#define CADA_DEFECTO 1000
+
+static double reloj(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+static void nombre_maquina(char *maquina, size_t tam) {
+#ifdef _WIN32
+    const char *nombre = getenv("COMPUTERNAME");
+    snprintf(maquina, tam, "%s", nombre ? nombre : "?");
+#else
+    if (gethostname(maquina, tam) != 0) snprintf(maquina, tam, "?");
+    maquina[tam - 1] = '\0';
+#endif
+}
+
+static int existe(const char *ruta) {
+    struct stat st;
+    return stat(ruta, &st) == 0;
+}
+
+static void ruta_punto(const Granja *g, int i, const char *extension, char ruta[TAM_RUTA_PUNTO]) {
+    char nombre[TAM_NOMBRE_PUNTO];
+    nombre_punto_granja(&g->puntos[i], nombre);
+    snprintf(ruta, TAM_RUTA_PUNTO, "%s/%s%s", g->carpeta, nombre, extension);
+}
+
+void nombre_punto_granja(const PuntoGranja *p, char nombre[TAM_NOMBRE_PUNTO]) {
+    snprintf(nombre, TAM_NOMBRE_PUNTO, "K%g_N%d_F%g_T%g_s%d_p%ld", p->K, p->N, p->F_cte, p->Temperatura,
+             p->semilla, p->pasos);
+}
+
+// Lee "nombre valor" en g. Devuelve 0 si el nombre es conocido.
+static int lee_ajuste(Granja *g, const char *nombre, double valor) {
+    if      (strcmp(nombre, "dt") == 0)          g->dt = valor;
+    else if (strcmp(nombre, "m") == 0)           g->m = valor;
+    else if (strcmp(nombre, "alfa") == 0)        g->alfa = valor;
+    else if (strcmp(nombre, "kb") == 0)          g->kb = valor;
+    else if (strcmp(nombre, "cada") == 0)        g->cada = (long)valor;
+    else if (strcmp(nombre, "equilibrado") == 0) g->equilibrado = (long)valor;
+    else return 1;
+    return 0;
+}
+
+int lee_manifiesto_granja(const char *ruta, const char *carpeta, Granja *g) {
+    memset(g, 0, sizeof(Granja));
+    ConfiguracionSimulacion c = configuracion_simulacion_defecto();
+    g->dt = c.dt;
+    g->m = c.m;
+    g->alfa = c.alfa;
+    g->kb = c.kb;
+    g->cada = CADA_DEFECTO;
+
+    if (carpeta) snprintf(g->carpeta, sizeof(g->carpeta), "%s", carpeta);
+    else {
+        const char *base = strrchr(ruta, '/');
+        if (!base) base = strrchr(ruta, '\\');
+        base = base ? base + 1 : ruta;
+        const char *punto = strrchr(base, '.');
+        int largo = punto && punto != base ? (int)(punto - base) : (int)strlen(base);
+        snprintf(g->carpeta, sizeof(g->carpeta), "%s/%.*s", CARPETA_GRANJA, largo, base);
+    }
+
+    FILE *f = fopen(ruta, "r");
+    if (!f) {
+        printf("No se pudo abrir el manifiesto %s\n", ruta);
+        return 1;
+    }
+    char linea[512];
+    int numero = 0, capacidad = 0;
+    while (fgets(linea, sizeof(linea), f)) {
+        numero++;
+        char *comentario = strchr(linea, '#');
+        if (comentario) *comentario = '\0';
+        char *p = linea;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') continue;
+
+        char nombre[64], resto[8];
+        double valor;
+        if (isalpha((unsigned char)*p)) {
+            if (sscanf(p, "%63s %lf %7s", nombre, &valor, resto) != 2 || lee_ajuste(g, nombre, valor)) {
+                printf("%s:%d: ajuste no válido: %s\n", ruta, numero, p);
+                fclose(f);
+                libera_granja(g);
+                return 1;
+            }
+            continue;
+        }
+        PuntoGranja q;
+        if (sscanf(p, "%lf %d %lf %lf %d %ld %7s", &q.K, &q.N, &q.F_cte, &q.Temperatura, &q.semilla, &q.pasos,
+                   resto) != 6 || q.pasos < 1) {
+            printf("%s:%d: se esperaba \"K N F_cte Temperatura semilla pasos\": %s\n", ruta, numero, p);
+            fclose(f);
+            libera_granja(g);
+            return 1;
+        }
+        if (g->n_puntos == capacidad) {
+            capacidad = capacidad ? 2*capacidad : 16;
+            PuntoGranja *puntos = realloc(g->puntos, capacidad * sizeof(PuntoGranja));
+            if (!puntos) {
+                fclose(f);
+                libera_granja(g);
+                return 1;
+            }
+            g->puntos = puntos;
+        }
+        g->puntos[g->n_puntos++] = q;
+    }
+    fclose(f);
+    if (g->cada < 1 || g->equilibrado < 0) {
+        printf("%s: cada debe ser >= 1 y equilibrado >= 0\n", ruta);
+        libera_granja(g);
+        return 1;
+    }
+    #ifndef FIXED
+    for (int i = 0; i < g->n_puntos; i++) {
+        if (g->puntos[i].F_cte != 0.0) {
+            printf("# Sin FIXED se ignora F_cte en el manifiesto\n");
+            break;
+        }
+    }
+    #endif
+    crea_carpetas(g->carpeta);
+    return 0;
+}
+
+void libera_granja(Granja *g) {
+    free(g->puntos);
+    g->puntos = NULL;
+    g->n_puntos = 0;
+}
+
+// --- Cerrojos ---
+
+// Intenta tener el flock del .bloqueo. En Windows solo lo "tiene" quien lo acaba de crear.
+static int toma_cerrojo(int fd, int recien_creado) {
+#ifdef _WIN32
+    (void)fd;
+    return recien_creado ? 0 : -1;
+#else
+    (void)recien_creado;
+    return flock(fd, LOCK_EX | LOCK_NB);
+#endif
+}
+
+// Escribe quién tiene el punto en el .bloqueo (lo que ve quien lo encuentra cortado)
+static void firma_bloqueo(int fd) {
+    char maquina[128], texto[256];
+    nombre_maquina(maquina, sizeof(maquina));
+    int n = snprintf(texto, sizeof(texto), "%s %d %ld\n", maquina, (int)getpid(), (long)time(NULL));
+    if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0 || write(fd, texto, n) != n)
+        printf("No se pudo firmar el bloqueo\n");
+}
+
+/**
+ * Reclama un punto.
+ * @param cortado  Devuelve el contenido del .bloqueo si se ha reclamado uno de un trabajo cortado ("" si no).
+ * @return El descriptor del .bloqueo con su flock, o -1 si el punto es de otro trabajador.
+ */
+static int reclama_punto(const char *ruta, char *cortado, size_t tam) {
+    cortado[0] = '\0';
+    int fd = open(ruta, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd >= 0) {
+        if (toma_cerrojo(fd, 1) != 0) {
+            close(fd);
+            return -1;
+        }
+        firma_bloqueo(fd);
+        return fd;
+    }
+    if (errno != EEXIST) {
+        printf("No se pudo crear %s\n", ruta);
+        return -1;
+    }
+
+    // Ya existe: es de otro trabajador salvo que nadie tenga su flock
+    fd = open(ruta, O_RDWR);
+    if (fd < 0) return -1;
+    struct stat propio, actual;
+    if (toma_cerrojo(fd, 0) != 0 || fstat(fd, &propio) != 0) {
+        close(fd);
+        return -1;
+    }
+    // Recién creado por otro que aún no ha llegado a flock, o borrado y vuelto a crear entretanto
+    if (time(NULL) - propio.st_mtime < GRACIA_BLOQUEO || stat(ruta, &actual) != 0 || actual.st_ino != propio.st_ino) {
+        close(fd);
+        return -1;
+    }
+    ssize_t n = lseek(fd, 0, SEEK_SET) == 0 ? read(fd, cortado, tam - 1) : 0;
+    cortado[n > 0 ? n : 0] = '\0';
+    char *salto = strchr(cortado, '\n');
+    if (salto) *salto = '\0';
+    if (!cortado[0]) snprintf(cortado, tam, "?");
+    firma_bloqueo(fd);
+    return fd;
+}
+
+// Borra el .bloqueo antes de soltar el flock, para que nadie lo vea libre
+static void suelta_punto(int fd, const char *ruta) {
+    remove(ruta);
+    close(fd);
+}
+
+EstadoPunto estado_punto_granja(const Granja *g, int i) {
+    char ruta[TAM_RUTA_PUNTO];
+    ruta_punto(g, i, ".hecho", ruta);
+    if (existe(ruta)) return PUNTO_HECHO;
+    ruta_punto(g, i, ".inestable", ruta);
+    if (existe(ruta)) return PUNTO_INESTABLE;
+    ruta_punto(g, i, ".bloqueo", ruta);
+    int fd = open(ruta, O_RDONLY);
+    if (fd < 0) return PUNTO_PENDIENTE;
+    EstadoPunto estado = PUNTO_EN_CURSO;
+#ifndef _WIN32
+    struct stat st;
+    if (flock(fd, LOCK_EX | LOCK_NB) == 0 && fstat(fd, &st) == 0 && time(NULL) - st.st_mtime >= GRACIA_BLOQUEO)
+        estado = PUNTO_CORTADO;
+#endif
+    close(fd);
+    return estado;
+}
+
+// --- Simulación de un punto ---
+
+// Devuelve 0 si todo va bien, 1 si hay un error y 2 si la simulación es inestable (diagnóstico en 'salud')
+static int simula_punto(const Granja *g, const PuntoGranja *p, const char *ruta_txt, ResultadoPunto *r,
+                        SaludSimulacion *salud) {
+    ConfiguracionSimulacion c = configuracion_simulacion_defecto();
+    c.N = p->N;
+    c.dt = g->dt;
+    c.m = g->m;
+    c.alfa = g->alfa;
+    c.kb = g->kb;
+    c.K = p->K;
+    c.Temperatura = p->Temperatura;
+    c.F_cte = p->F_cte;
+    c.semilla = p->semilla;
+    Simulacion *s = crea_simulacion(&c, NULL);
+    if (!s) return 1;
+    FILE *f = fopen(ruta_txt, "w");
+    if (!f) {
+        printf("No se pudo crear %s\n", ruta_txt);
+        destruye_simulacion(s);
+        return 1;
+    }
+    fprintf(f, "# t Ek Ep Et Rg Ree\n");
+    SalidaTexto *texto = abre_salida_texto(f);
+    Telemetria *telemetria = abre_telemetria(ruta_txt, p->N, g->dt, g->equilibrado + p->pasos);
+
+    double t0 = reloj();
+    // El equilibrado también va por bloques de 'cada' pasos para cortar pronto si explota
+    #ifdef FIXED
+    inicializa_salud(salud, c.N, c.K, c.kb, c.Temperatura, c.m, c.dt, c.F_cte);
+    #else
+    inicializa_salud(salud, c.N, c.K, c.kb, c.Temperatura, c.m, c.dt);
+    #endif
+    int inestable = 0;
+    for (long paso = 0; paso < g->equilibrado && !inestable; ) {
+        long bloque = g->equilibrado - paso < g->cada ? g->equilibrado - paso : g->cada;
+        avanza_simulacion(s, bloque);
+        paso += bloque;
+        inestable = revisa_salud_simulacion(s, salud) == SALUD_INESTABLE;
+    }
+    EstimadorBloques ree, rg;
+    memset(&ree, 0, sizeof(ree));
+    memset(&rg, 0, sizeof(rg));
+    double suma_Ek = 0.0, suma_Ep = 0.0;
+    long salidas = 0;
+    ObservablesSimulacion o;
+    for (long paso = 0; paso < p->pasos && !inestable; ) {
+        long bloque = p->pasos - paso < g->cada ? p->pasos - paso : g->cada;
+        avanza_simulacion(s, bloque);
+        paso += bloque;
+        if (revisa_salud_simulacion(s, salud) == SALUD_INESTABLE) {
+            inestable = 1;
+            break;
+        }
+        observa_simulacion(s, &o);
+        anade_estimador_bloques(&ree, o.Ree);
+        anade_estimador_bloques(&rg, o.Rg);
+        suma_Ek += o.Ek;
+        suma_Ep += o.Ep;
+        salidas++;
+
+        anade_fijo6(texto, 0, o.t);
+        anade_fijo6(texto, ' ', o.Ek);
+        anade_fijo6(texto, ' ', o.Ep);
+        anade_fijo6(texto, ' ', o.Et);
+        anade_fijo6(texto, ' ', o.Rg);
+        anade_fijo6(texto, ' ', o.Ree);
+        termina_linea_texto(texto);
+        acumula_telemetria(telemetria, o.Ek, o.Ep, o.Ree);
+        publica_telemetria(telemetria, g->equilibrado + paso, ftell(f) + (long long)texto->usado);
+    }
+    if (inestable) {
+        anade_texto(texto, "# INESTABLE ");
+        anade_texto(texto, salud->diagnostico);
+        termina_linea_texto(texto);
+    }
+    cierra_salida_texto(texto);
+    int error = ferror(f);
+    if (fclose(f) != 0 || error) {
+        printf("Error al escribir %s\n", ruta_txt);
+        error = 1;
+    }
+    cierra_telemetria(telemetria);
+    destruye_simulacion(s);
+    if (inestable) return 2;
+    if (salud->estado == SALUD_AVISO) printf("[%d] Aviso en %s: %s\n", (int)getpid(), ruta_txt, salud->diagnostico);
+
+    r->media_Ree = media_estimador_bloques(&ree);
+    r->error_Ree = error_estimador_bloques(&ree);
+    r->media_Rg = media_estimador_bloques(&rg);
+    r->error_Rg = error_estimador_bloques(&rg);
+    r->media_Ek = suma_Ek / salidas;
+    r->media_Ep = suma_Ep / salidas;
+    r->segundos = reloj() - t0;
+    return error;
+}
+
+// El .hecho se escribe aparte y se renombra: o no existe o está completo
+static int escribe_hecho(const PuntoGranja *p, const ResultadoPunto *r, const char *ruta) {
+    char temporal[TAM_RUTA_PUNTO + 32], maquina[128];
+    snprintf(temporal, sizeof(temporal), "%s.%d", ruta, (int)getpid());
+    nombre_maquina(maquina, sizeof(maquina));
+    FILE *f = fopen(temporal, "w");
+    if (!f) {
+        printf("No se pudo crear %s\n", temporal);
+        return 1;
+    }
+    fprintf(f, "# K N F_cte Temperatura semilla pasos <Ree> error <Rg> error <Ek> <Ep> segundos maquina pid\n");
+    fprintf(f, "%.10g %d %.10g %.10g %d %ld %.10g %.10g %.10g %.10g %.10g %.10g %.3f %s %d\n", p->K, p->N, p->F_cte,
+            p->Temperatura, p->semilla, p->pasos, r->media_Ree, r->error_Ree, r->media_Rg, r->error_Rg, r->media_Ek,
+            r->media_Ep, r->segundos, maquina, (int)getpid());
+    int error = ferror(f);
+    if (fclose(f) != 0 || error || rename(temporal, ruta) != 0) {
+        printf("No se pudo escribir %s\n", ruta);
+        remove(temporal);
+        return 1;
+    }
+    return 0;
+}
+
+static int escribe_inestable(const char *diagnostico, const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        printf("No se pudo crear %s\n", ruta);
+        return 1;
+    }
+    fprintf(f, "%s\n", diagnostico);
+    return fclose(f) != 0;
+}
+
+// Primera línea del .inestable, sin el salto de línea
+static void lee_inestable(const Granja *g, int i, char *diagnostico, size_t tam) {
+    char ruta[TAM_RUTA_PUNTO];
+    ruta_punto(g, i, ".inestable", ruta);
+    diagnostico[0] = '\0';
+    FILE *f = fopen(ruta, "r");
+    if (!f) return;
+    if (fgets(diagnostico, (int)tam, f)) diagnostico[strcspn(diagnostico, "\n")] = '\0';
+    fclose(f);
+}
+
+int lee_resultado_granja(const Granja *g, int i, ResultadoPunto *r) {
+    char ruta[TAM_RUTA_PUNTO], linea[1024];
+    ruta_punto(g, i, ".hecho", ruta);
+    FILE *f = fopen(ruta, "r");
+    if (!f) return 0;
+    int leido = 0;
+    while (!leido && fgets(linea, sizeof(linea), f)) {
+        if (linea[0] == '#') continue;
+        double K, F_cte, Temperatura;
+        int N, semilla;
+        long pasos;
+        leido = sscanf(linea, "%lf %d %lf %lf %d %ld %lf %lf %lf %lf %lf %lf %lf", &K, &N, &F_cte, &Temperatura,
+                       &semilla, &pasos, &r->media_Ree, &r->error_Ree, &r->media_Rg, &r->error_Rg, &r->media_Ek,
+                       &r->media_Ep, &r->segundos) == 13;
+    }
+    fclose(f);
+    return leido;
+}
+
+int trabaja_granja(const Granja *g) {
+    // Los que fallan en este trabajador no se vuelven a intentar en él
+    char *fallados = calloc(g->n_puntos ? g->n_puntos : 1, 1);
+    if (!fallados) return 0;
+    int terminados = 0, reclamado;
+    do {
+        reclamado = 0;
+        for (int i = 0; i < g->n_puntos; i++) {
+            char ruta_hecho[TAM_RUTA_PUNTO], ruta_inestable[TAM_RUTA_PUNTO], ruta_bloqueo[TAM_RUTA_PUNTO], cortado[256];
+            ruta_punto(g, i, ".hecho", ruta_hecho);
+            ruta_punto(g, i, ".inestable", ruta_inestable);
+            if (fallados[i] || existe(ruta_hecho) || existe(ruta_inestable)) continue;
+            ruta_punto(g, i, ".bloqueo", ruta_bloqueo);
+            int fd = reclama_punto(ruta_bloqueo, cortado, sizeof(cortado));
+            if (fd < 0) continue;
+            // Puede haberse terminado entre la comprobación y el bloqueo
+            if (existe(ruta_hecho) || existe(ruta_inestable)) {
+                suelta_punto(fd, ruta_bloqueo);
+                continue;
+            }
+            reclamado = 1;
+            char nombre[TAM_NOMBRE_PUNTO], ruta_txt[TAM_RUTA_PUNTO];
+            nombre_punto_granja(&g->puntos[i], nombre);
+            ruta_punto(g, i, ".txt", ruta_txt);
+            if (cortado[0]) printf("[%d] Se retoma %s (cortado: %s)\n", (int)getpid(), nombre, cortado);
+
+            ResultadoPunto r;
+            SaludSimulacion salud;
+            int resultado = simula_punto(g, &g->puntos[i], ruta_txt, &r, &salud);
+            if (resultado == 0 && escribe_hecho(&g->puntos[i], &r, ruta_hecho) == 0) {
+                terminados++;
+                printf("[%d] %s: <Ree> %.6f +- %.6f  <Rg> %.6f +- %.6f  (%.1f s)\n", (int)getpid(), nombre,
+                       r.media_Ree, r.error_Ree, r.media_Rg, r.error_Rg, r.segundos);
+            } else if (resultado == 2) {
+                fallados[i] = 1;
+                escribe_inestable(salud.diagnostico, ruta_inestable);
+                printf("[%d] %s inestable: %s\n", (int)getpid(), nombre, salud.diagnostico);
+            } else {
+                fallados[i] = 1;
+                printf("[%d] Falló %s\n", (int)getpid(), nombre);
+            }
+            fflush(stdout);
+            suelta_punto(fd, ruta_bloqueo);
+        }
+    } while (reclamado);
+    free(fallados);
+    return terminados;
+}
+
+int resume_granja(const Granja *g, FILE *salida) {
+    static const char *estados[] = {"pendiente", "en curso", "cortado", "hecho", "inestable"};
+    int hechos = 0;
+    fprintf(salida, "# %-44s %-9s %12s %12s %12s %12s %12s %12s %10s\n", "punto", "estado", "<Ree>", "error",
+            "<Rg>", "error", "<Ek>", "<Ep>", "segundos");
+    for (int i = 0; i < g->n_puntos; i++) {
+        char nombre[TAM_NOMBRE_PUNTO];
+        nombre_punto_granja(&g->puntos[i], nombre);
+        EstadoPunto estado = estado_punto_granja(g, i);
+        ResultadoPunto r;
+        if (estado == PUNTO_HECHO && lee_resultado_granja(g, i, &r)) {
+            hechos++;
+            fprintf(salida, "  %-44s %-9s %12.6f %12.6f %12.6f %12.6f %12.6f %12.6f %10.1f\n", nombre, estados[estado],
+                    r.media_Ree, r.error_Ree, r.media_Rg, r.error_Rg, r.media_Ek, r.media_Ep, r.segundos);
+        } else if (estado == PUNTO_INESTABLE) {
+            char diagnostico[TAM_DIAGNOSTICO_SALUD];
+            lee_inestable(g, i, diagnostico, sizeof(diagnostico));
+            fprintf(salida, "  %-44s %-9s %s\n", nombre, estados[estado], diagnostico);
+        } else {
+            fprintf(salida, "  %-44s %-9s\n", nombre, estados[estado]);
+        }
+    }
+    fprintf(salida, "# %d de %d puntos hechos\n", hechos, g->n_puntos);
+    return hechos;
+}
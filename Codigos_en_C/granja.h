@@ -0,0 +1,112 @@
+#pragma once
+
+#include "simulacion.h"
+#include "histograma.h"
+#include "formato.h"
+#include "telemetria.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * Granja de barridos: un manifiesto con los puntos (K, N, F_cte, Temperatura, semilla, pasos)
+ * y cualquier número de procesos trabajadores, en una o varias máquinas que compartan la
+ * carpeta, que se reparten los puntos sin coordinador (sin MPI).
+ *
+ * Cada punto tiene un nombre fijo sacado de sus parámetros (nombre_punto_granja) y en la
+ * carpeta de la granja:
+ *   <nombre>.bloqueo  Lo crea con O_EXCL el trabajador que lo reclama y lo mantiene con flock
+ *                     mientras lo simula. Contiene máquina, pid y hora.
+ *   <nombre>.txt      "t Ek Ep Et Rg Ree" cada 'cada' pasos tras el equilibrado.
+ *   <nombre>.hecho    Resumen (<Ree>, <Rg>, <Ek>, <Ep> con error por bloques). Se escribe al
+ *                     terminar con rename, así que existe solo si el punto está completo.
+ *   <nombre>.inestable Diagnóstico de salud.h si la simulación explotó (el .txt acaba en una
+ *                     línea "# INESTABLE ..."). Los trabajadores saltan el punto; para volver a
+ *                     intentarlo (con otro dt en el manifiesto, p. ej.) se borra el fichero.
+ * Un .bloqueo cuyo flock no tiene nadie y con más de GRACIA_BLOQUEO segundos es de un trabajo
+ * cortado (el sistema suelta el flock al morir el proceso) y se vuelve a reclamar. Volver a
+ * lanzar la granja salta los puntos con .hecho, así que tras un corte solo se repite lo que
+ * estaba a medias. Los puntos se identifican por sus parámetros y no por su línea: se pueden
+ * añadir puntos al manifiesto de una granja ya empezada.
+ *
+ * En Windows no hay flock: el .bloqueo de un trabajo cortado hay que borrarlo a mano.
+ *
+ * Formato del manifiesto (una línea por punto; '#' empieza un comentario):
+ *   K N F_cte Temperatura semilla pasos
+ * y, antes o entre los puntos, líneas "nombre valor" para dt, m, alfa, kb (los de
+ * configuracion_simulacion_defecto si no están), cada (pasos entre salidas, 1000 por defecto)
+ * y equilibrado (pasos descartados al principio, 0 por defecto). Sin FIXED, F_cte se ignora.
+ */
+
+#define GRACIA_BLOQUEO 5                // Segundos entre crear un .bloqueo y tener su flock
+#define CARPETA_GRANJA "Resultados_simulacion/GRANJA"
+#define TAM_NOMBRE_PUNTO 160
+
+typedef struct {
+    double K;
+    int N;
+    double F_cte;
+    double Temperatura;
+    int semilla;
+    long pasos;
+} PuntoGranja;
+
+typedef struct {
+    char carpeta[512];
+    double dt, m, alfa, kb;
+    long cada, equilibrado;
+    int n_puntos;
+    PuntoGranja *puntos;
+} Granja;
+
+typedef enum {
+    PUNTO_PENDIENTE,
+    PUNTO_EN_CURSO,
+    PUNTO_CORTADO,                      // .bloqueo sin nadie que lo tenga: se volverá a reclamar
+    PUNTO_HECHO,
+    PUNTO_INESTABLE                     // .inestable: se salta hasta que se borre
+} EstadoPunto;
+
+typedef struct {
+    double media_Ree, error_Ree;
+    double media_Rg, error_Rg;
+    double media_Ek, media_Ep;
+    double segundos;
+} ResultadoPunto;
+
+/**
+ * Lee el manifiesto.
+ * @param carpeta  Carpeta de la granja; NULL: CARPETA_GRANJA/<nombre del manifiesto sin extensión>.
+ * @return 0 si todo va bien, 1 si no se puede leer o tiene una línea mal formada.
+ */
+int lee_manifiesto_granja(const char *ruta, const char *carpeta, Granja *g);
+
+void libera_granja(Granja *g);
+
+// Nombre de los ficheros del punto (sin carpeta ni extensión), p. ej. K1000_N4_F0.1_T1_s12456_p5000000
+void nombre_punto_granja(const PuntoGranja *p, char nombre[TAM_NOMBRE_PUNTO]);
+
+EstadoPunto estado_punto_granja(const Granja *g, int i);
+
+/**
+ * Lee el resumen de un punto terminado.
+ * @return 1 si el punto tiene .hecho y se ha leído, 0 si no.
+ */
+int lee_resultado_granja(const Granja *g, int i, ResultadoPunto *r);
+
+/**
+ * Bucle de un trabajador: reclama el siguiente punto libre, lo simula, lo marca como hecho y
+ * repite hasta que no queda ninguno que reclamar (hechos, inestables, en curso en otro
+ * trabajador o que ya fallaron en este). Cada salida pasa por revisa_salud_simulacion y un punto
+ * inestable se corta en cuanto se detecta.
+ * @return Número de puntos que ha terminado este trabajador.
+ */
+int trabaja_granja(const Granja *g);
+
+/**
+ * Escribe una línea por punto con su estado y, si está hecho, su resumen (si es inestable, el
+ * diagnóstico).
+ * @return Número de puntos hechos.
+ */
+int resume_granja(const Granja *g, FILE *salida);
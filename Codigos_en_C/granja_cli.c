@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "granja.h"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+/*
+ * Trabajador de la granja de barridos (granja.h): simula los puntos libres del manifiesto
+ * hasta que no queda ninguno y escribe el resumen. Se puede lanzar a la vez en varias
+ * terminales o máquinas que compartan la carpeta, o con -procesos en esta. Si se corta,
+ * volver a lanzarlo retoma solo los puntos que faltan.
+ *
+ * Uso: granja_cli.exe manifiesto [-carpeta Resultados_simulacion/GRANJA/<manifiesto>] [-procesos 1] [-resumen]
+ *   -procesos  Trabajadores en esta máquina (con fork; en Windows, lanzar varios a mano)
+ *   -resumen   Solo escribe el estado de cada punto, sin simular
+ * El resumen se escribe por pantalla y en <carpeta>/resumen.txt.
+ */
+
+static void uso(void) {
+    printf("Uso: granja_cli.exe manifiesto [-carpeta %s/<manifiesto>] [-procesos 1] [-resumen]\n", CARPETA_GRANJA);
+}
+
+int main(int argc, char *argv[]) {
+    const char *manifiesto = NULL, *carpeta = NULL;
+    int procesos = 1, solo_resumen = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-resumen") == 0) solo_resumen = 1;
+        else if (strcmp(argv[i], "-carpeta") == 0 && i + 1 < argc) carpeta = argv[++i];
+        else if (strcmp(argv[i], "-procesos") == 0 && i + 1 < argc) procesos = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && !manifiesto) manifiesto = argv[i];
+        else {
+            uso();
+            return 1;
+        }
+    }
+    if (!manifiesto || procesos < 1) {
+        uso();
+        return 1;
+    }
+    Granja g;
+    if (lee_manifiesto_granja(manifiesto, carpeta, &g) != 0) return 1;
+
+    if (!solo_resumen) {
+        printf("%d puntos en %s\n", g.n_puntos, g.carpeta);
+        fflush(stdout);
+        #ifdef _WIN32
+        if (procesos > 1) printf("# En Windows no hay fork: se ignora -procesos\n");
+        trabaja_granja(&g);
+        #else
+        for (int p = 1; p < procesos; p++) {
+            pid_t hijo = fork();
+            if (hijo == 0) {
+                trabaja_granja(&g);
+                libera_granja(&g);
+                return 0;
+            }
+            if (hijo < 0) printf("No se pudo lanzar el trabajador %d\n", p);
+        }
+        trabaja_granja(&g);
+        while (wait(NULL) > 0) {}
+        #endif
+    }
+
+    int hechos = resume_granja(&g, stdout);
+    char ruta[640];
+    snprintf(ruta, sizeof(ruta), "%s/resumen.txt", g.carpeta);
+    FILE *f = fopen(ruta, "w");
+    if (f) {
+        resume_granja(&g, f);
+        fclose(f);
+    }
+    int completa = hechos == g.n_puntos;
+    libera_granja(&g);
+    return completa ? 0 : 1;
+}
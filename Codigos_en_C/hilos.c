@@ -0,0 +1,345 @@
+#include "hilos.h"
+
+
+// Datos de cada enlace (b, b+1) que necesita el cálculo de fuerzas
+typedef struct {
+    double fs[3];  // Fuerza de estiramiento que el enlace ejerce sobre la partícula b
+    double e[4];   // Vector unitario e inversa de la longitud (enlace_flexion)
+    double mag;    // Longitud del enlace
+} DatosEnlace;
+
+typedef struct {
+    MotorHilos *motor;
+    int id;
+    int ini, fin;           // Tramo de partículas [ini, fin) del hilo
+    int b_ini;              // Primer enlace del buffer local
+    EstadoPR rng;           // Generador propio del hilo
+    double *betta;          // Ruido del paso actual de las partículas propias
+    double *F_nuevo;        // Fuerzas nuevas de las partículas propias
+    DatosEnlace *enlaces;   // Enlaces propios más los halos
+    pthread_t hilo;
+} TramoHilo;
+
+struct MotorHilos {
+    int N, n_hilos;
+    double *x[2];           // Doble buffer de posiciones
+    int actual;             // Buffer con las posiciones actuales
+    double *v, *F;
+    double a, b, sigma, dt, m, K, F_cte;
+    int pasos;              // Pasos de la tanda en curso
+    RuidoContador ruido;    // Clave y primer paso de la tanda en curso (RUIDO_CONTADOR)
+    int salir;
+    int arrancado;          // Los hilos no entran en las barreras hasta que se han lanzado todos
+    pthread_mutex_t cerrojo;
+    pthread_cond_t arranque;
+    pthread_barrier_t inicio, fin, paso;
+    TramoHilo *tramos;
+};
+
+
+/**
+ * Calcula las fuerzas de las partículas del tramo a partir de las posiciones x, sumando para
+ * cada partícula sus contribuciones en el mismo orden que Fuerza_verlet.
+ */
+static void fuerzas_tramo(TramoHilo *t, const double x[], double F_dest[]) {
+    MotorHilos *mo = t->motor;
+    int N = mo->N;
+
+    // 1. Enlaces que tocan al tramo: propios y dos de halo a cada lado
+    int b_ini = t->ini - 2 < 0 ? 0 : t->ini - 2;
+    int b_fin = t->fin < N - 2 ? t->fin : N - 2;
+    t->b_ini = b_ini;
+    for (int bo = b_ini; bo <= b_fin; bo++) {
+        DatosEnlace *e = &t->enlaces[bo - b_ini];
+        int i3 = 3*bo;
+        int j3 = 3*(bo+1);
+
+        double dx = x[j3]   - x[i3];
+        double dy = x[j3+1] - x[i3+1];
+        double dz = x[j3+2] - x[i3+2];
+
+        double r = sqrt(dx*dx + dy*dy + dz*dz);
+        e->mag = r;
+        #ifdef WLCM
+        enlace_flexion(dx, dy, dz, r, e->e);
+        #endif
+        if (r == 0.0) continue;
+
+        double fac = mo->K * (r - L_0) / r;
+        e->fs[0] = fac * dx;
+        e->fs[1] = fac * dy;
+        e->fs[2] = fac * dz;
+    }
+
+    // 2. Suma por partícula
+    for (int j = t->ini; j < t->fin; j++) {
+        double *Fj = &F_dest[3*(j - t->ini)];
+        Fj[0] = Fj[1] = Fj[2] = 0.0;
+
+        if (j >= 1) {
+            DatosEnlace *e = &t->enlaces[j - 1 - b_ini];
+            if (e->mag != 0.0) {
+                Fj[0] -= e->fs[0];
+                Fj[1] -= e->fs[1];
+                Fj[2] -= e->fs[2];
+            }
+        }
+        if (j <= N - 2) {
+            DatosEnlace *e = &t->enlaces[j - b_ini];
+            if (e->mag != 0.0) {
+                Fj[0] += e->fs[0];
+                Fj[1] += e->fs[1];
+                Fj[2] += e->fs[2];
+            }
+        }
+
+        #ifdef FIXED
+        if (j == N - 1) Fj[2] += mo->F_cte;
+        if (j == 0) Fj[0] = Fj[1] = Fj[2] = 0.0;
+        #endif
+
+        #ifdef WLCM
+        // Tripletes centrados en j-1 (j hace de i+1), j (centro) y j+1 (j hace de i-1)
+        for (int c = j - 1; c <= j + 1; c++) {
+            if (c < 1 || c > N - 2) continue;
+            double f_im1[3], f_ip1[3];
+            triplete_flexion(rigidez_flexion(c), parametros_flexion.cos_theta0, t->enlaces[c - 1 - b_ini].e, t->enlaces[c - b_ini].e,
+                             f_im1, f_ip1);
+            if (c == j - 1)
+                for (int k = 0; k < 3; k++) Fj[k] += f_ip1[k];
+            else if (c == j)
+                for (int k = 0; k < 3; k++) Fj[k] -= (f_im1[k] + f_ip1[k]);
+            else
+                for (int k = 0; k < 3; k++) Fj[k] += f_im1[k];
+        }
+        #ifdef FIXED
+        if (j == 0) Fj[0] = Fj[1] = Fj[2] = 0.0;
+        #endif
+        #endif
+    }
+}
+
+// Ejecuta 'pasos' pasos de GJF sobre el tramo del hilo. Una barrera por paso.
+static void trabaja_tramo(TramoHilo *t, int pasos) {
+    MotorHilos *mo = t->motor;
+    double a = mo->a, b = mo->b, dt = mo->dt, m = mo->m, sigma = mo->sigma;
+    double *v = mo->v, *F = mo->F;
+    int i_ini = 3*t->ini, i_fin = 3*t->fin;
+    int p = mo->actual;
+
+    #ifdef RUIDO_CONTADOR
+    RuidoContador ruido = mo->ruido;
+    #endif
+
+    for (int paso = 0; paso < pasos; paso++) {
+        double *x_antiguo = mo->x[p];
+        double *x_nuevo = mo->x[1 - p];
+
+        // 1. Ruido y posiciones nuevas del tramo
+        #ifdef RUIDO_CONTADOR
+        ruido.paso = mo->ruido.paso + paso;
+        gaussianas_contador(&ruido, i_ini, i_fin - i_ini, sigma, t->betta);
+        for (int i = i_ini; i < i_fin; i++) {
+            double betta = t->betta[i - i_ini];
+            x_nuevo[i] = x_antiguo[i] + v[i]*dt*b + F[i]*dt*dt*b/(2*m) + b*dt*betta;
+        }
+        #else
+        for (int i = i_ini; i < i_fin; i++) {
+            double betta = gaussian_r(&t->rng) * sigma;
+            t->betta[i - i_ini] = betta;
+            x_nuevo[i] = x_antiguo[i] + v[i]*dt*b + F[i]*dt*dt*b/(2*m) + b*dt*betta;
+        }
+        #endif
+        #ifdef FIXED
+        if (t->ini == 0) {
+            // La primera partícula está fija: ni ruido ni velocidad (fuerzas_tramo anula su fuerza)
+            t->betta[0] = t->betta[1] = t->betta[2] = 0.0;
+            x_nuevo[0] = x_antiguo[0];
+            x_nuevo[1] = x_antiguo[1];
+            x_nuevo[2] = x_antiguo[2];
+        }
+        #endif
+
+        // 2. Única sincronización del paso: los halos ya tienen posiciones nuevas
+        pthread_barrier_wait(&mo->paso);
+
+        // 3. Fuerzas y velocidades nuevas del tramo
+        fuerzas_tramo(t, x_nuevo, t->F_nuevo);
+        for (int i = i_ini; i < i_fin; i++) {
+            double F_n = t->F_nuevo[i - i_ini];
+            v[i] = a*v[i] + (a*F[i] + F_n)*dt/(2*m) + b*t->betta[i - i_ini]/m;
+            F[i] = F_n;
+        }
+        #ifdef FIXED
+        if (t->ini == 0) v[0] = v[1] = v[2] = 0.0;
+        #endif
+
+        p = 1 - p;
+    }
+}
+
+static void *bucle_hilo(void *arg) {
+    TramoHilo *t = arg;
+    MotorHilos *mo = t->motor;
+    pthread_mutex_lock(&mo->cerrojo);
+    while (!mo->arrancado) pthread_cond_wait(&mo->arranque, &mo->cerrojo);
+    int lanzados = !mo->salir;  // Si no se lanzaron todos, se sale sin tocar las barreras
+    pthread_mutex_unlock(&mo->cerrojo);
+    while (lanzados) {
+        pthread_barrier_wait(&mo->inicio);
+        if (mo->salir) break;
+        trabaja_tramo(t, mo->pasos);
+        pthread_barrier_wait(&mo->fin);
+    }
+    return NULL;
+}
+
+static void destruye_sincronizacion(MotorHilos *mo) {
+    pthread_barrier_destroy(&mo->inicio);
+    pthread_barrier_destroy(&mo->fin);
+    pthread_barrier_destroy(&mo->paso);
+    pthread_mutex_destroy(&mo->cerrojo);
+    pthread_cond_destroy(&mo->arranque);
+}
+
+// Libera la memoria del motor (con los hilos ya parados)
+static void libera_motor_hilos(MotorHilos *mo) {
+    if (mo->tramos) {
+        for (int h = 0; h < mo->n_hilos; h++) {
+            free(mo->tramos[h].betta);
+            free(mo->tramos[h].F_nuevo);
+            free(mo->tramos[h].enlaces);
+        }
+    }
+    free(mo->tramos);
+    free(mo->x[0]);
+    free(mo);
+}
+
+
+#ifdef FIXED
+MotorHilos *crea_motor_hilos(int N, int n_hilos, double x_0[], double v_0[], double kb, double Temperatura,
+                             double alfa, double dt, double m, double K, double F_cte)
+#else
+MotorHilos *crea_motor_hilos(int N, int n_hilos, double x_0[], double v_0[], double kb, double Temperatura,
+                             double alfa, double dt, double m, double K)
+#endif
+{
+    if (n_hilos < 1) n_hilos = 1;
+    if (n_hilos > N) n_hilos = N;
+
+    MotorHilos *mo = calloc(1, sizeof(MotorHilos));
+    if (!mo) return NULL;
+    mo->N = N;
+    mo->n_hilos = n_hilos;
+    mo->dt = dt;
+    mo->m = m;
+    mo->K = K;
+    #ifdef FIXED
+    mo->F_cte = F_cte;
+    #endif
+    mo->a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    mo->b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    mo->sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+    mo->ruido = ruido_contador_global;
+    mo->ruido.paso = 0;
+    #ifdef WLCM
+    asegura_flexion();
+    #endif
+
+    mo->x[0] = malloc(4*3*(size_t)N*sizeof(double));
+    mo->tramos = calloc(n_hilos, sizeof(TramoHilo));
+    int ok = mo->x[0] && mo->tramos;
+    for (int h = 0; ok && h < n_hilos; h++) {
+        TramoHilo *t = &mo->tramos[h];
+        t->ini = (int)((long)N*h/n_hilos);
+        t->fin = (int)((long)N*(h+1)/n_hilos);
+        int n = t->fin - t->ini;
+        t->betta = malloc(3*n*sizeof(double));
+        t->F_nuevo = malloc(3*n*sizeof(double));
+        t->enlaces = calloc(n + 3, sizeof(DatosEnlace));
+        ok = t->betta && t->F_nuevo && t->enlaces;
+    }
+    if (!ok) {
+        printf("No se pudo reservar memoria para el motor de hilos (N = %d)\n", N);
+        libera_motor_hilos(mo);
+        return NULL;
+    }
+    mo->x[1] = mo->x[0] + 3*N;
+    mo->v    = mo->x[0] + 6*N;
+    mo->F    = mo->x[0] + 9*N;
+    memcpy(mo->x[0], x_0, 3*N*sizeof(double));
+    memcpy(mo->v, v_0, 3*N*sizeof(double));
+
+    pthread_barrier_init(&mo->inicio, NULL, n_hilos);
+    pthread_barrier_init(&mo->fin, NULL, n_hilos);
+    pthread_barrier_init(&mo->paso, NULL, n_hilos);
+    pthread_mutex_init(&mo->cerrojo, NULL);
+    pthread_cond_init(&mo->arranque, NULL);
+
+    // Tramos contiguos de tamaño casi igual (ya repartidos arriba); generadores sacados del global
+    for (int h = 0; h < n_hilos; h++) {
+        TramoHilo *t = &mo->tramos[h];
+        t->motor = mo;
+        t->id = h;
+        inicializa_PR_desde(&t->rng, &estado_PR_global);
+    }
+
+    // Fuerzas iniciales
+    for (int h = 0; h < n_hilos; h++) {
+        TramoHilo *t = &mo->tramos[h];
+        fuerzas_tramo(t, mo->x[0], &mo->F[3*t->ini]);
+    }
+
+    int lanzados = 1;
+    for (; lanzados < n_hilos; lanzados++)
+        if (pthread_create(&mo->tramos[lanzados].hilo, NULL, bucle_hilo, &mo->tramos[lanzados]) != 0) break;
+    // Si falta alguno, las barreras (para n_hilos) no se completarían: los lanzados salen sin usarlas
+    pthread_mutex_lock(&mo->cerrojo);
+    mo->salir = lanzados < n_hilos;
+    mo->arrancado = 1;
+    pthread_cond_broadcast(&mo->arranque);
+    pthread_mutex_unlock(&mo->cerrojo);
+    if (lanzados < n_hilos) {
+        printf("No se pudieron lanzar los hilos del motor (%d de %d): se integra en serie\n", lanzados, n_hilos);
+        for (int h = 1; h < lanzados; h++) pthread_join(mo->tramos[h].hilo, NULL);
+        destruye_sincronizacion(mo);
+        libera_motor_hilos(mo);
+        return NULL;
+    }
+
+    return mo;
+}
+
+void avanza_motor_hilos(MotorHilos *mo, int pasos) {
+    if (pasos <= 0) return;
+    mo->pasos = pasos;
+    pthread_barrier_wait(&mo->inicio);
+    trabaja_tramo(&mo->tramos[0], pasos);  // El hilo principal hace de hilo 0
+    pthread_barrier_wait(&mo->fin);
+    mo->actual = (mo->actual + pasos) % 2;
+    mo->ruido.paso += pasos;
+}
+
+double *posiciones_motor_hilos(MotorHilos *mo) {
+    return mo->x[mo->actual];
+}
+
+double *velocidades_motor_hilos(MotorHilos *mo) {
+    return mo->v;
+}
+
+double *fuerzas_motor_hilos(MotorHilos *mo) {
+    return mo->F;
+}
+
+void destruye_motor_hilos(MotorHilos *mo) {
+    if (!mo) return;
+    mo->salir = 1;
+    pthread_barrier_wait(&mo->inicio);
+    for (int h = 1; h < mo->n_hilos; h++)
+        pthread_join(mo->tramos[h].hilo, NULL);
+
+    destruye_sincronizacion(mo);
+    libera_motor_hilos(mo);
+}
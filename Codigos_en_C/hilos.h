@@ -0,0 +1,45 @@
+#pragma once
+
+#include "random.h"
+#include "funciones_oscilador.h"
+#include "flexion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+
+/**
+ * Integración GJF de una sola cadena repartida entre varios hilos. Cada hilo es dueño de un
+ * tramo contiguo de partículas: mueve sus partículas, sincroniza una vez por paso y después
+ * calcula las fuerzas de sus partículas leyendo solo los halos (dos vecinos a cada lado) y
+ * actualiza sus velocidades. Las posiciones usan doble buffer para que una sola barrera por paso
+ * baste. Cada hilo tiene su propio generador Parisi-Rapuano, así que la trayectoria depende del
+ * número de hilos; con RUIDO_CONTADOR todos usan la clave de ruido_contador_global (copiada al
+ * crear el motor) y la trayectoria es la misma con cualquier número de hilos.
+ *
+ * La fuerza es la de Fuerza_verlet (muelles, FIXED y WLCM) evaluada en forma de "gather"
+ * (cada partícula suma sus propias contribuciones), sin escrituras compartidas.
+ */
+typedef struct MotorHilos MotorHilos;
+
+// Crea el motor y lanza los hilos. x_0 y v_0 se copian. Devuelve NULL si algo falla.
+#ifdef FIXED
+MotorHilos *crea_motor_hilos(int N, int n_hilos, double x_0[], double v_0[], double kb, double Temperatura,
+                             double alfa, double dt, double m, double K, double F_cte);
+#else
+MotorHilos *crea_motor_hilos(int N, int n_hilos, double x_0[], double v_0[], double kb, double Temperatura,
+                             double alfa, double dt, double m, double K);
+#endif
+
+// Avanza 'pasos' pasos con todos los hilos. Al volver, las posiciones y velocidades son coherentes.
+void avanza_motor_hilos(MotorHilos *motor, int pasos);
+
+// Posiciones, velocidades y fuerzas actuales (válidas entre llamadas a avanza_motor_hilos)
+double *posiciones_motor_hilos(MotorHilos *motor);
+double *velocidades_motor_hilos(MotorHilos *motor);
+double *fuerzas_motor_hilos(MotorHilos *motor);
+
+// Para los hilos y libera la memoria
+void destruye_motor_hilos(MotorHilos *motor);
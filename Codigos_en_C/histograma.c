@@ -0,0 +1,452 @@
+#include "histograma.h"
+#include "funciones_oscilador.h" // crea_carpetas
+
+
+// División entera redondeando hacia -infinito
+static long long divide_abajo(long long a, long long b) {
+    long long q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+    return q;
+}
+
+static Histograma *reserva_histograma(int n_bins) {
+    Histograma *h = calloc(1, sizeof(Histograma));
+    if (!h) return NULL;
+    h->n_bins = n_bins;
+    h->cuentas = calloc(n_bins, sizeof(double));
+    h->auxiliar = calloc(n_bins, sizeof(double));
+    if (!h->cuentas || !h->auxiliar) {
+        printf("No se pudo reservar memoria para el histograma (%d bins)\n", n_bins);
+        libera_histograma(h);
+        return NULL;
+    }
+    h->x_min = INFINITY;
+    h->x_max = -INFINITY;
+    return h;
+}
+
+Histograma *crea_histograma(int n_bins, double min, double max) {
+    if (n_bins < 1 || !(max > min)) {
+        printf("Rango de histograma no válido: [%g, %g) con %d bins\n", min, max, n_bins);
+        return NULL;
+    }
+    Histograma *h = reserva_histograma(n_bins);
+    if (!h) return NULL;
+    h->min = min;
+    h->ancho = (max - min) / n_bins;
+    return h;
+}
+
+Histograma *crea_histograma_auto(int n_bins, double ancho_0) {
+    if (n_bins < 4 || n_bins % 2 != 0 || !(ancho_0 > 0.0)) {
+        printf("Histograma automático no válido: %d bins (par y >= 4), ancho_0 = %g\n", n_bins, ancho_0);
+        return NULL;
+    }
+    Histograma *h = reserva_histograma(n_bins);
+    if (!h) return NULL;
+    h->auto_rango = 1;
+    h->ancho_0 = ancho_0;
+    h->ancho = ancho_0;
+    return h;
+}
+
+void libera_histograma(Histograma *h) {
+    if (!h) return;
+    free(h->cuentas);
+    free(h->auxiliar);
+    free(h);
+}
+
+void reinicia_histograma(Histograma *h) {
+    memset(h->cuentas, 0, h->n_bins*sizeof(double));
+    h->n = 0;
+    h->fuera = 0;
+    h->media = h->m2 = 0.0;
+    h->x_min = INFINITY;
+    h->x_max = -INFINITY;
+    if (h->auto_rango) {
+        h->nivel = 0;
+        h->inicio = 0;
+        h->ancho = h->ancho_0;
+        h->min = 0.0;
+    }
+}
+
+// Rango automático: dobla la anchura juntando bins de dos en dos y recentra la ventana
+static void dobla_histograma(Histograma *h) {
+    int n = h->n_bins;
+    long long nuevo_inicio = divide_abajo(h->inicio - n/2, 2);
+
+    memset(h->auxiliar, 0, n*sizeof(double));
+    for (int j = 0; j < n; j++) {
+        if (h->cuentas[j] == 0.0) continue;
+        long long k = divide_abajo(h->inicio + j, 2) - nuevo_inicio;
+        h->auxiliar[k] += h->cuentas[j];
+    }
+    double *tmp = h->cuentas;
+    h->cuentas = h->auxiliar;
+    h->auxiliar = tmp;
+
+    h->nivel++;
+    h->inicio = nuevo_inicio;
+    h->ancho = ldexp(h->ancho_0, h->nivel);
+    h->min = (double)h->inicio * h->ancho;
+}
+
+// Recorre las dobladas que haría falta para que x quepa, sin tocar las cuentas.
+// Devuelve 1 si cabe sin pasar de NIVEL_MAXIMO_HISTOGRAMA.
+static int cabe_histograma(const Histograma *h, double x) {
+    int nivel = h->nivel;
+    long long inicio = h->inicio;
+    for (;;) {
+        double ancho = ldexp(h->ancho_0, nivel);
+        double t = (x - (double)inicio * ancho) / ancho;
+        if (t >= 0.0 && t < h->n_bins) return 1;
+        if (nivel >= NIVEL_MAXIMO_HISTOGRAMA) return 0;
+        inicio = divide_abajo(inicio - h->n_bins/2, 2);
+        nivel++;
+    }
+}
+
+// Primera muestra de un histograma automático: ventana centrada en x con la anchura actual.
+// Devuelve 0 si x / ancho no cabe en 'inicio' (la muestra va a 'fuera').
+static int centra_histograma(Histograma *h, double x) {
+    double bin = floor(x / h->ancho);
+    if (!(fabs(bin) < 4611686018427387904.0)) return 0;    // 2^62
+    h->inicio = (long long)bin - h->n_bins/2;
+    h->min = (double)h->inicio * h->ancho;
+    return 1;
+}
+
+// Actualiza media, varianza y extremos con una muestra
+static void anade_momentos(Histograma *h, double x) {
+    double delta = x - h->media;
+    h->media += delta / h->n;
+    h->m2 += delta * (x - h->media);
+    if (x < h->x_min) h->x_min = x;
+    if (x > h->x_max) h->x_max = x;
+}
+
+void anade_histograma(Histograma *h, double x) {
+    if (!isfinite(x)) {
+        h->fuera++;
+        return;
+    }
+
+    if (h->auto_rango) {
+        if (h->n == 0 && !centra_histograma(h, x)) {
+            h->fuera++;
+            return;
+        }
+        double t = (x - h->min) / h->ancho;
+        if ((t < 0.0 || t >= h->n_bins) && !cabe_histograma(h, x)) {
+            h->fuera++;     // Ni con la anchura máxima: no se dobla por una sola muestra
+            return;
+        }
+        while (t < 0.0 || t >= h->n_bins) {
+            dobla_histograma(h);
+            t = (x - h->min) / h->ancho;
+        }
+        h->cuentas[(int)t]++;
+    } else {
+        double t = (x - h->min) / h->ancho;
+        if (t < 0.0 || t >= h->n_bins) {
+            h->fuera++;
+            return;
+        }
+        h->cuentas[(int)t]++;
+    }
+
+    h->n++;
+    anade_momentos(h, x);
+}
+
+// Combina medias y varianzas de dos grupos de muestras (Chan et al.)
+static void combina_momentos(Histograma *d, const Histograma *o) {
+    long long n = d->n + o->n;
+    if (n == 0) return;
+    double delta = o->media - d->media;
+    d->media += delta * o->n / n;
+    d->m2 += o->m2 + delta * delta * ((double)d->n * o->n / n);
+    if (o->x_min < d->x_min) d->x_min = o->x_min;
+    if (o->x_max > d->x_max) d->x_max = o->x_max;
+}
+
+int combina_histogramas(Histograma *destino, const Histograma *origen) {
+    if (destino->n_bins != origen->n_bins || destino->auto_rango != origen->auto_rango) {
+        printf("Histogramas incompatibles: no se pueden combinar\n");
+        return 0;
+    }
+
+    if (!destino->auto_rango) {
+        if (destino->min != origen->min || destino->ancho != origen->ancho) {
+            printf("Histogramas de rango fijo con rejillas distintas: no se pueden combinar\n");
+            return 0;
+        }
+        for (int j = 0; j < destino->n_bins; j++) destino->cuentas[j] += origen->cuentas[j];
+    } else {
+        if (destino->ancho_0 != origen->ancho_0) {
+            printf("Histogramas automáticos con ancho_0 distinto: no se pueden combinar\n");
+            return 0;
+        }
+        if (origen->n > 0 && destino->n == 0) {
+            // Destino vacío: copia la rejilla del origen
+            destino->nivel = origen->nivel;
+            destino->inicio = origen->inicio;
+            destino->ancho = origen->ancho;
+            destino->min = origen->min;
+            memcpy(destino->cuentas, origen->cuentas, origen->n_bins*sizeof(double));
+        } else if (origen->n > 0) {
+            while (destino->nivel < origen->nivel) dobla_histograma(destino);
+
+            // Bins ocupados del origen, en índices de la rejilla del destino
+            int n = destino->n_bins;
+            int j_ini = 0, j_fin = n - 1;
+            while (origen->cuentas[j_ini] == 0.0) j_ini++;
+            while (origen->cuentas[j_fin] == 0.0) j_fin--;
+            for (;;) {
+                long long factor = 1LL << (destino->nivel - origen->nivel);
+                long long k_ini = divide_abajo(origen->inicio + j_ini, factor) - destino->inicio;
+                long long k_fin = divide_abajo(origen->inicio + j_fin, factor) - destino->inicio;
+                if (k_ini >= 0 && k_fin < n) break;
+                dobla_histograma(destino);
+            }
+
+            long long factor = 1LL << (destino->nivel - origen->nivel);
+            for (int j = j_ini; j <= j_fin; j++) {
+                long long k = divide_abajo(origen->inicio + j, factor) - destino->inicio;
+                destino->cuentas[k] += origen->cuentas[j];
+            }
+        }
+    }
+
+    combina_momentos(destino, origen);
+    destino->n += origen->n;
+    destino->fuera += origen->fuera;
+    return 1;
+}
+
+double centro_bin(const Histograma *h, int i) {
+    return h->min + (i + 0.5) * h->ancho;
+}
+
+double densidad_bin(const Histograma *h, int i) {
+    if (h->n == 0) return 0.0;
+    return h->cuentas[i] / ((double)h->n * h->ancho);
+}
+
+double media_histograma(const Histograma *h) {
+    return h->media;
+}
+
+double desviacion_histograma(const Histograma *h) {
+    if (h->n < 2) return 0.0;
+    return sqrt(h->m2 / (h->n - 1));
+}
+
+int escribe_histograma(const Histograma *h, const char *nombre, const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        printf("No se pudo crear el archivo %s\n", ruta);
+        return 0;
+    }
+    fprintf(f, "# %s n %lld fuera %lld media %.6f desviacion %.6f min %.6f max %.6f\n", nombre,
+            h->n, h->fuera, media_histograma(h), desviacion_histograma(h),
+            h->n ? h->x_min : 0.0, h->n ? h->x_max : 0.0);
+    // Las filas "%.6f %.6f" se escriben con formato.c, por bloques
+    SalidaTexto *texto = abre_salida_texto(f);
+    for (int i = 0; i < h->n_bins && texto; i++) {
+        anade_fijo6(texto, 0, centro_bin(h, i));
+        anade_fijo6(texto, ' ', densidad_bin(h, i));
+        termina_linea_texto(texto);
+    }
+    cierra_salida_texto(texto);
+    fclose(f);
+    return 1;
+}
+
+
+void anade_estimador_bloques(EstimadorBloques *e, double x) {
+    for (int k = 0; k < NIVELES_BLOQUES; k++) {
+        e->n[k]++;
+        e->suma[k] += x;
+        e->suma2[k] += x * x;
+        if (!e->tiene_pendiente[k]) {
+            e->pendiente[k] = x;
+            e->tiene_pendiente[k] = 1;
+            return;
+        }
+        x = 0.5 * (e->pendiente[k] + x);
+        e->tiene_pendiente[k] = 0;
+    }
+}
+
+double media_estimador_bloques(const EstimadorBloques *e) {
+    return e->n[0] ? e->suma[0] / e->n[0] : 0.0;
+}
+
+double error_estimador_bloques(const EstimadorBloques *e) {
+    double error = INFINITY;
+    for (int k = 0; k < NIVELES_BLOQUES && e->n[k] >= BLOQUES_MINIMOS; k++) {
+        double media = e->suma[k] / e->n[k];
+        double varianza = e->suma2[k] / e->n[k] - media * media;
+        double error_k = sqrt(fmax(varianza, 0.0) / (e->n[k] - 1));
+        error = (k == 0) ? error_k : fmax(error, error_k);
+    }
+    return error;
+}
+
+// Lee 'n' números separados por espacios con lee_decimal (lo mismo que strtod). Devuelve cuántos ha leído.
+static int lee_columnas(const char *linea, double valores[], int n) {
+    const char *p = linea;
+    for (int k = 0; k < n; k++) {
+        char *fin;
+        valores[k] = lee_decimal(p, &fin);
+        if (fin == p) return k;
+        p = fin;
+    }
+    return n;
+}
+
+// Función principal de procesamiento
+void generar_histogramas(const char *carpeta_in,
+                         const char *carpeta_out_vel,
+                         const char *carpeta_out_pos,
+                         const char *prefijo,
+                         int bins) {
+    DIR *dir;
+    struct dirent *ent;
+
+    dir = opendir(carpeta_in);
+    if (!dir) {
+        perror("No se pudo abrir la carpeta de entrada");
+        return;
+    }
+
+    // Rango automático: bins pares y al menos 4
+    int bins_auto = bins < 4 ? 4 : bins + (bins % 2);
+
+    while ((ent = readdir(dir)) != NULL) {
+        if (strncmp(ent->d_name, prefijo, strlen(prefijo)) == 0 && strstr(ent->d_name, ".txt")) {
+            // Ruta al archivo de entrada
+            char ruta_in[512];
+            snprintf(ruta_in, sizeof(ruta_in), "%s/%s", carpeta_in, ent->d_name);
+
+            FILE *fin = fopen(ruta_in, "r");
+            if (!fin) {
+                perror("No se pudo abrir archivo de entrada");
+                continue;
+            }
+
+            char linea[512];
+            // saltar la primera línea
+            if (!fgets(linea, sizeof(linea), fin)) {
+                fclose(fin);
+                continue;
+            }
+
+            // Las muestras van directamente a los histogramas, sin guardarlas
+            Histograma *H_pos = crea_histograma_auto(bins_auto, 1e-6);
+            Histograma *H_vel = crea_histograma_auto(bins_auto, 1e-6);
+            if (!H_pos || !H_vel) {
+                libera_histograma(H_pos);
+                libera_histograma(H_vel);
+                fclose(fin);
+                continue;
+            }
+
+            while (fgets(linea, sizeof(linea), fin)) {
+                double c[6];  // tiempo, posición, velocidad y tres columnas más
+                if (lee_columnas(linea, c, 6) == 6) {
+                    anade_histograma(H_pos, c[1]);
+                    anade_histograma(H_vel, c[2]);
+                }
+            }
+            fclose(fin);
+
+            // crear archivos de salida
+            char ruta_pos[512], ruta_vel[512];
+            snprintf(ruta_pos, sizeof(ruta_pos), "%s/%s", carpeta_out_pos, ent->d_name);
+            snprintf(ruta_vel, sizeof(ruta_vel), "%s/%s", carpeta_out_vel, ent->d_name);
+
+            escribe_histograma(H_pos, "posicion", ruta_pos);
+            escribe_histograma(H_vel, "velocidad", ruta_vel);
+
+            libera_histograma(H_pos);
+            libera_histograma(H_vel);
+        }
+    }
+    closedir(dir);
+}
+
+
+DistribucionesCadena *crea_distribuciones_cadena(void) {
+    DistribucionesCadena *d = calloc(1, sizeof(DistribucionesCadena));
+    if (!d) return NULL;
+    d->Ree = crea_histograma_auto(BINS_DISTRIBUCIONES, 1e-3);
+    d->Rg = crea_histograma_auto(BINS_DISTRIBUCIONES, 1e-3);
+    d->enlace = crea_histograma_auto(BINS_DISTRIBUCIONES, 1e-4);
+    d->angulo = crea_histograma(BINS_DISTRIBUCIONES, 0.0, acos(-1.0));
+    if (!d->Ree || !d->Rg || !d->enlace || !d->angulo) {
+        libera_distribuciones_cadena(d);
+        return NULL;
+    }
+    return d;
+}
+
+void libera_distribuciones_cadena(DistribucionesCadena *d) {
+    if (!d) return;
+    libera_histograma(d->Ree);
+    libera_histograma(d->Rg);
+    libera_histograma(d->enlace);
+    libera_histograma(d->angulo);
+    free(d);
+}
+
+void acumula_distribuciones_cadena(DistribucionesCadena *d, int N, const double x[], double Rg, double Ree) {
+    anade_histograma(d->Ree, Ree);
+    anade_histograma(d->Rg, Rg);
+
+    double u_ant[3] = {0.0, 0.0, 0.0};
+    for (int i = 0; i < N - 1; i++) {
+        double dx = x[3*(i+1)]   - x[3*i];
+        double dy = x[3*(i+1)+1] - x[3*i+1];
+        double dz = x[3*(i+1)+2] - x[3*i+2];
+        double r = sqrt(dx*dx + dy*dy + dz*dz);
+        anade_histograma(d->enlace, r);
+        if (r == 0.0) {
+            u_ant[0] = u_ant[1] = u_ant[2] = 0.0;
+            continue;
+        }
+
+        double u[3] = {dx / r, dy / r, dz / r};
+        if (i > 0 && (u_ant[0] != 0.0 || u_ant[1] != 0.0 || u_ant[2] != 0.0)) {
+            double c = u_ant[0]*u[0] + u_ant[1]*u[1] + u_ant[2]*u[2];
+            if (c > 1.0) c = 1.0;
+            if (c < -1.0) c = -1.0;
+            anade_histograma(d->angulo, acos(c));
+        }
+        u_ant[0] = u[0]; u_ant[1] = u[1]; u_ant[2] = u[2];
+    }
+}
+
+int combina_distribuciones_cadena(DistribucionesCadena *destino, const DistribucionesCadena *origen) {
+    return combina_histogramas(destino->Ree, origen->Ree)
+         & combina_histogramas(destino->Rg, origen->Rg)
+         & combina_histogramas(destino->enlace, origen->enlace)
+         & combina_histogramas(destino->angulo, origen->angulo);
+}
+
+void escribe_distribuciones_cadena(const DistribucionesCadena *d, const char *carpeta, const char *nombre) {
+    char carpeta_dist[512];
+    snprintf(carpeta_dist, sizeof(carpeta_dist), "%s/DISTRIBUCIONES", carpeta);
+    crea_carpetas(carpeta_dist);
+
+    const Histograma *h[4] = {d->Ree, d->Rg, d->enlace, d->angulo};
+    const char *observable[4] = {"Ree", "Rg", "enlace", "angulo"};
+    for (int k = 0; k < 4; k++) {
+        char ruta[1024];
+        snprintf(ruta, sizeof(ruta), "%s/%s_%s", carpeta_dist, observable[k], nombre);
+        escribe_histograma(h[k], observable[k], ruta);
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "formato.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+
+
+/**
+ * Histograma en streaming: cada muestra se añade al vuelo (O(1)) sin guardarla, así que la
+ * memoria es O(bins) sea cual sea la longitud de la simulación.
+ *
+ * Dos modos:
+ *  - Rango fijo [min, max): las muestras fuera se cuentan aparte en 'fuera'.
+ *  - Rango automático: la rejilla es la de anchura ancho_0 * 2^nivel con el borde inferior en
+ *    un múltiplo de la anchura (inicio * ancho). Cuando llega una muestra fuera de rango se dobla
+ *    la anchura juntando los bins de dos en dos y se recentra la ventana, hasta que cabe. Como
+ *    todas las rejillas con el mismo ancho_0 están anidadas, dos histogramas automáticos se
+ *    pueden combinar sin perder información (réplicas, hilos...). La anchura no pasa de
+ *    ancho_0 * 2^NIVEL_MAXIMO_HISTOGRAMA: una muestra aislada muy lejos (una trayectoria que
+ *    explota) se cuenta en 'fuera' en vez de juntar todo el histograma en un par de bins.
+ * También lleva la media, la varianza y los extremos de las muestras.
+ */
+#define NIVEL_MAXIMO_HISTOGRAMA 30
+
+typedef struct {
+    int n_bins;
+    int auto_rango;
+    double min, ancho;        // Borde inferior y anchura de los bins actuales
+    double ancho_0;           // Rango automático: anchura inicial
+    int nivel;                // Rango automático: ancho = ancho_0 * 2^nivel
+    long long inicio;         // Rango automático: min = inicio * ancho
+    long long n;              // Muestras dentro del histograma
+    long long fuera;          // Muestras fuera del rango fijo o del nivel máximo (o no finitas)
+    double media, m2;         // Media y suma de cuadrados de desviaciones (Welford)
+    double x_min, x_max;      // Extremos observados
+    double *cuentas;
+    double *auxiliar;         // Para juntar bins al doblar la anchura
+} Histograma;
+
+// Histograma de rango fijo [min, max) con n_bins bins
+Histograma *crea_histograma(int n_bins, double min, double max);
+
+// Histograma de rango automático con n_bins bins (par, al menos 4) y anchura inicial ancho_0
+Histograma *crea_histograma_auto(int n_bins, double ancho_0);
+
+void libera_histograma(Histograma *h);
+
+// Vacía las cuentas (el rango automático vuelve a empezar)
+void reinicia_histograma(Histograma *h);
+
+// Añade una muestra
+void anade_histograma(Histograma *h, double x);
+
+/**
+ * Suma el histograma 'origen' en 'destino'. Los de rango fijo deben tener la misma rejilla; los
+ * automáticos, el mismo n_bins y ancho_0 (destino se ensancha si hace falta).
+ * @return 1 si se han combinado, 0 si son incompatibles.
+ */
+int combina_histogramas(Histograma *destino, const Histograma *origen);
+
+// Centro del bin i y densidad de probabilidad (cuentas / (n * ancho))
+double centro_bin(const Histograma *h, int i);
+double densidad_bin(const Histograma *h, int i);
+
+double media_histograma(const Histograma *h);
+double desviacion_histograma(const Histograma *h);
+
+/**
+ * Escribe el histograma como "x_centro densidad" por línea, precedido de una línea de
+ * comentario con nombre, número de muestras, media y desviación.
+ * @return 1 si se ha escrito, 0 si no se pudo abrir el archivo.
+ */
+int escribe_histograma(const Histograma *h, const char *nombre, const char *ruta);
+
+// Histogramas de posiciones y velocidades (columnas 2 y 3) de los archivos de una carpeta
+void generar_histogramas(const char *carpeta_in,
+                         const char *carpeta_out_vel,
+                         const char *carpeta_out_pos,
+                         const char *prefijo,
+                         int bins);
+
+
+/**
+ * Media y su error por bloques (Flyvbjerg-Petersen) en streaming: el nivel k promedia bloques de
+ * 2^k muestras, así que el error tiene en cuenta la correlación temporal. Memoria O(1).
+ */
+#define NIVELES_BLOQUES 40
+#define BLOQUES_MINIMOS 16
+
+typedef struct {
+    long long n[NIVELES_BLOQUES];
+    double suma[NIVELES_BLOQUES], suma2[NIVELES_BLOQUES];
+    double pendiente[NIVELES_BLOQUES];  // Muestra del nivel esperando pareja
+    int tiene_pendiente[NIVELES_BLOQUES];
+} EstimadorBloques;
+
+void anade_estimador_bloques(EstimadorBloques *e, double x);
+double media_estimador_bloques(const EstimadorBloques *e);
+
+// El mayor error de entre los niveles con al menos BLOQUES_MINIMOS bloques (el de la meseta)
+double error_estimador_bloques(const EstimadorBloques *e);
+
+// Distribuciones de una cadena que se acumulan durante la integración
+#define BINS_DISTRIBUCIONES 200
+
+typedef struct {
+    Histograma *Ree;      // Extremo a extremo en z (la misma Ree de la trayectoria)
+    Histograma *Rg;       // Radio de giro
+    Histograma *enlace;   // Longitud de los enlaces
+    Histograma *angulo;   // Ángulo entre enlaces consecutivos, en [0, pi]
+} DistribucionesCadena;
+
+DistribucionesCadena *crea_distribuciones_cadena(void);
+void libera_distribuciones_cadena(DistribucionesCadena *d);
+
+// Añade una configuración: Rg y Ree ya calculados, enlaces y ángulos a partir de x
+void acumula_distribuciones_cadena(DistribucionesCadena *d, int N, const double x[], double Rg, double Ree);
+
+int combina_distribuciones_cadena(DistribucionesCadena *destino, const DistribucionesCadena *origen);
+
+/**
+ * Escribe las cuatro distribuciones en carpeta/DISTRIBUCIONES/<observable>_<nombre>.
+ * @param carpeta  Carpeta de la trayectoria.
+ * @param nombre   Nombre del archivo de la trayectoria (V_i.txt).
+ */
+void escribe_distribuciones_cadena(const DistribucionesCadena *d, const char *carpeta, const char *nombre);
@@ -1,5 +1,30 @@
 #include "integracion.h"
 
+// Las dos mitades de un_paso_verlet, sueltas para medir cada fase con CONTADORES_HARDWARE
+void actualiza_posiciones_verlet(const double betta[], double b, int N, const double x_antiguo[], double x_nuevo[],
+                                 const double v_antiguo[], const double F_antiguo[], double dt, double m) {
+    for (int i = 0; i < 3*N; i++) {
+        x_nuevo[i] = x_antiguo[i] + v_antiguo[i]*dt*b + F_antiguo[i]*dt*dt*b/(2*m) + b*dt*betta[i];
+    }
+    #ifdef FIXED
+    // La primera partícula está fija: ni fuerza (Fuerza_verlet) ni ruido ni velocidad
+    x_nuevo[0] = x_antiguo[0];
+    x_nuevo[1] = x_antiguo[1];
+    x_nuevo[2] = x_antiguo[2];
+    #endif
+}
+
+void actualiza_velocidades_verlet(const double betta[], double b, double a, int N, const double v_antiguo[],
+                                  double v_nuevo[], const double F_antiguo[], const double F_nuevo[],
+                                  double dt, double m) {
+    for (int i = 0; i < 3*N; i++) {
+        v_nuevo[i] = a*v_antiguo[i] + (a*F_antiguo[i] + F_nuevo[i])*dt/(2*m) + b*betta[i]/m;
+    }
+    #ifdef FIXED
+    v_nuevo[0] = v_nuevo[1] = v_nuevo[2] = 0.0;
+    #endif
+}
+
 /**
  * Realiza un paso en la integración del movimiento usando el método de Verlet.
  * @param betta       Array con términos aleatorios para el ruido térmico.
@@ -30,10 +55,7 @@ void un_paso_verlet(double betta[], double b, double a, int N, double x_antiguo[
                     double K)
 #endif
 {
-    // Actualización de posiciones
-    for (int i = 0; i < 3*N; i++) {
-        x_nuevo[i] = x_antiguo[i] + v_antiguo[i]*dt*b + F_antiguo[i]*dt*dt*b/(2*m) + b*dt*betta[i];
-    }
+    actualiza_posiciones_verlet(betta, b, N, x_antiguo, x_nuevo, v_antiguo, F_antiguo, dt, m);
 
     // Cálculo de nuevas fuerzas
     #ifdef FIXED
@@ -42,10 +64,7 @@ void un_paso_verlet(double betta[], double b, double a, int N, double x_antiguo[
         Fuerza(N, x_nuevo, F_nuevo, K);
     #endif
 
-    // Actualización de velocidades
-    for (int i = 0; i < 3*N; i++) {
-        v_nuevo[i] = a*v_antiguo[i] + (a*F_antiguo[i] + F_nuevo[i])*dt/(2*m) + b*betta[i]/m;
-    }
+    actualiza_velocidades_verlet(betta, b, a, N, v_antiguo, v_nuevo, F_antiguo, F_nuevo, dt, m);
 }
 /**
     * Realiza la integración del movimiento usando el método de Verlet durante un número dado de pasos.
@@ -86,15 +105,108 @@ void verlet_trayectoria(char* filename_input, double kb, double Temperatura, dou
 
     fprintf(archivo, "%.6f %d\t%s\n", dt, pasos, filename_input);
 
-    double x_antiguo[3*N];
-    double x_nuevo[3*N];
-    double v_antiguo[3*N];
-    double v_nuevo[3*N];
-    double F_antiguo[3*N];
-    double F_nuevo[3*N];
-    double betta[3*N];
+    // Con N grande y la fuerza de la cadena se usa el paso fusionado, que trabaja en el sitio,
+    // o el motor de hilos si N_HILOS > 1. El volumen excluido no es local a lo largo de la
+    // cadena, así que con él siempre se usa el camino general.
+    #ifdef VOLUMEN_EXCLUIDO
+    int fusionado = 0;
+    #else
+    int fusionado = (N > N_CADENA_LARGA) && (Fuerza == Fuerza_verlet);
+    #endif
+    #ifdef RUIDO_CONTADOR
+    // Antes del motor de hilos, que copia la clave
+    inicializa_ruido_contador_desde(&ruido_contador_global, &estado_PR_global, 0);
+    #endif
+    MotorHilos *motor = NULL;
+    int pendientes = 0;
+    if (fusionado && N_HILOS > 1) {
+        #ifdef FIXED
+        motor = crea_motor_hilos(N, N_HILOS, x_0, v_0, kb, Temperatura, alfa, dt, m, K, F_cte);
+        #else
+        motor = crea_motor_hilos(N, N_HILOS, x_0, v_0, kb, Temperatura, alfa, dt, m, K);
+        #endif
+    }
+    int n_arrays = fusionado ? 3 : 7;
+
+    double *memoria = malloc((size_t)n_arrays*3*N*sizeof(double));
+    // Las líneas del .txt se forman en memoria (formato.c) y se escriben por bloques
+    SalidaTexto *texto = abre_salida_texto(archivo);
+    if (!memoria || !texto) {
+        printf("No se pudo reservar memoria para N = %d\n", N);
+        free(memoria);
+        cierra_salida_texto(texto);
+        destruye_motor_hilos(motor);
+        fclose(archivo);
+        return;
+    }
+    double *x_antiguo = memoria;
+    double *v_antiguo = memoria + 3*N;
+    double *F_antiguo = memoria + 6*N;
+    double *x_nuevo   = fusionado ? x_antiguo : memoria + 9*N;
+    double *v_nuevo   = fusionado ? v_antiguo : memoria + 12*N;
+    double *F_nuevo   = fusionado ? F_antiguo : memoria + 15*N;
+    double *betta     = fusionado ? NULL      : memoria + 18*N;
+    #ifdef DISTRIBUCIONES
+    // Distribuciones de Ree, Rg, enlaces y ángulos, acumuladas en cada salida sin guardar muestras
+    DistribucionesCadena *distribuciones = crea_distribuciones_cadena();
+    #endif
+    #ifdef CORRELACIONES
+    // Correlaciones multi-tau de Ree, centro de masas y modos de Rouse, en memoria O(log pasos)
+    CorrelacionesCadena *correlaciones = crea_correlaciones_cadena(N);
+    #endif
+    #ifdef ESTIMADORES
+    // Medias de Ree y Rg con variables de control y esperanza condicionada (estimadores.c)
+    #ifdef FIXED
+    EstimadoresCadena *estimadores = crea_estimadores_cadena(N, K, kb, Temperatura, F_cte);
+    #else
+    EstimadoresCadena *estimadores = crea_estimadores_cadena(N, K, kb, Temperatura);
+    #endif
+    #endif
+    #ifdef FORMA
+    // Forma de la cadena cada PASOS_FORMA pasos (en cada salida con el motor de hilos)
+    EstadisticaForma *forma = crea_estadistica_forma(N);
+    int pasos_forma = motor ? 0 : PASOS_FORMA;
+    #endif
+    #if defined(SALUD) || defined(ESTIMADORES)
+    double *F_salida = F_nuevo;     // Fuerzas en x_nuevo
+    #endif
     double Ek, Ep, Et,Rg,Ree;
     double counter = 0;
+    int salida_particulas = SALIDA_PARTICULAS(N);
+    double sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+    #if defined(SALIDA_BINARIA) || defined(SALIDA_COMPRIMIDA)
+    // Fila completa (con partículas si GUARDA_PARTICULAS) para el .bin y el .cmp
+    int guarda_particulas = GUARDA_PARTICULAS(N);
+    double *registro = malloc(columnas_binarias(N, guarda_particulas)*sizeof(double));
+    #endif
+    #ifdef SALIDA_BINARIA
+    char filename_binario[512];
+    ruta_binaria(filename_output, filename_binario, sizeof(filename_binario));
+    SalidaBinaria *binaria = abre_salida_binaria(filename_binario, N, guarda_particulas, dt);
+    #endif
+    #ifdef SALIDA_COMPRIMIDA
+    char filename_comprimido[512];
+    ruta_comprimida(filename_output, filename_comprimido, sizeof(filename_comprimido));
+    Compresor *compresor = abre_compresor(filename_comprimido,
+                                          PRECISION_COMPRESION > 0.0 ? COMPRESION_CUANTIZADA : COMPRESION_SIN_PERDIDAS,
+                                          PRECISION_COMPRESION, N, guarda_particulas, dt);
+    #endif
+
+    #ifdef TELEMETRIA
+    Telemetria *telemetria = abre_telemetria(filename_output, N, dt, pasos);
+    #endif
+    #ifdef CONTADORES_HARDWARE
+    // Ciclos, instrucciones y fallos por fase (contadores.c); con el motor de hilos no se mide
+    ContadoresHardware *contadores = motor ? NULL : abre_contadores_hardware();
+    #endif
+    #ifdef SALUD
+    SaludSimulacion salud;
+    #ifdef FIXED
+    inicializa_salud(&salud, N, K, kb, Temperatura, m, dt, F_cte);
+    #else
+    inicializa_salud(&salud, N, K, kb, Temperatura, m, dt);
+    #endif
+    #endif
 
     for (int i = 0; i < 3*N; i++) {
         x_antiguo[i] = x_0[i];
@@ -110,38 +222,158 @@ void verlet_trayectoria(char* filename_input, double kb, double Temperatura, dou
     #endif
 
     for (int paso = 0; paso < pasos; paso++) {
-        for (int i = 0; i < 3*N; i++) {
-            betta[i] = gaussian() * sqrt(2 * alfa * Temperatura * kb * dt);
-        }
-
-        #ifdef FIXED
-            un_paso_verlet(betta, b, a, N, x_antiguo, x_nuevo, v_antiguo, v_nuevo,
-                           F_antiguo, F_nuevo, dt, m, Fuerza, K, F_cte);
-        #else
-            un_paso_verlet(betta, b, a, N, x_antiguo, x_nuevo, v_antiguo, v_nuevo,
-                           F_antiguo, F_nuevo, dt, m, Fuerza, K);
+        #ifdef RUIDO_CONTADOR
+        ruido_contador_global.paso = paso;
+        #endif
+        #ifdef CONTADORES_HARDWARE
+        empieza_paso_contadores(contadores);
         #endif
+        if (motor) {
+            // Los pasos se acumulan y los hilos los ejecutan de una vez antes de cada salida
+            pendientes++;
+        } else if (fusionado) {
+            #ifdef FIXED
+                un_paso_verlet_fusionado(sigma, b, a, N, x_antiguo, v_antiguo, F_antiguo, dt, m, K, F_cte);
+            #else
+                un_paso_verlet_fusionado(sigma, b, a, N, x_antiguo, v_antiguo, F_antiguo, dt, m, K);
+            #endif
+            #ifdef CONTADORES_HARDWARE
+            fase_contadores(contadores, FASE_FUSIONADO);
+            #endif
+        } else {
+            #ifdef RUIDO_CONTADOR
+            gaussianas_contador(&ruido_contador_global, 0, 3*N, sigma, betta);
+            #else
+            for (int i = 0; i < 3*N; i++) {
+                betta[i] = gaussian() * sigma;
+            }
+            #endif
+
+            #ifdef CONTADORES_HARDWARE
+            // El mismo paso que un_paso_verlet, por partes para medir cada fase
+            fase_contadores(contadores, FASE_RUIDO);
+            actualiza_posiciones_verlet(betta, b, N, x_antiguo, x_nuevo, v_antiguo, F_antiguo, dt, m);
+            fase_contadores(contadores, FASE_ACTUALIZACION);
+            #ifdef FIXED
+            Fuerza(N, x_nuevo, F_nuevo, K, F_cte);
+            #else
+            Fuerza(N, x_nuevo, F_nuevo, K);
+            #endif
+            fase_contadores(contadores, FASE_FUERZA);
+            actualiza_velocidades_verlet(betta, b, a, N, v_antiguo, v_nuevo, F_antiguo, F_nuevo, dt, m);
+            fase_contadores(contadores, FASE_ACTUALIZACION);
+            #elif defined(FIXED)
+                un_paso_verlet(betta, b, a, N, x_antiguo, x_nuevo, v_antiguo, v_nuevo,
+                               F_antiguo, F_nuevo, dt, m, Fuerza, K, F_cte);
+            #else
+                un_paso_verlet(betta, b, a, N, x_antiguo, x_nuevo, v_antiguo, v_nuevo,
+                               F_antiguo, F_nuevo, dt, m, Fuerza, K);
+            #endif
+        }
 
         counter += dt;
 
+        #ifdef FORMA
+        if (forma && pasos_forma > 0 && (paso + 1) % pasos_forma == 0) acumula_estadistica_forma(forma, x_nuevo);
+        #endif
+
         if (counter >= 0.1) {
-            fprintf(archivo, "%.6f", paso * dt);
-            for (int i = 0; i < 3*N; i++) fprintf(archivo, " %.6f", x_nuevo[i]);
-            for (int i = 0; i < 3*N; i++) fprintf(archivo, " %.6f", v_nuevo[i]);
+            if (motor) {
+                avanza_motor_hilos(motor, pendientes);
+                pendientes = 0;
+                x_nuevo = posiciones_motor_hilos(motor);
+                v_nuevo = velocidades_motor_hilos(motor);
+                #if defined(SALUD) || defined(ESTIMADORES)
+                F_salida = fuerzas_motor_hilos(motor);
+                #endif
+            }
+            #ifdef SALUD
+            // Una trayectoria que ha explotado se corta aquí en vez de escribir NaN hasta el final
+            if (revisa_salud(&salud, paso * dt, x_nuevo, v_nuevo, F_salida) == SALUD_INESTABLE) {
+                anade_texto(texto, "# INESTABLE ");
+                anade_texto(texto, salud.diagnostico);
+                termina_linea_texto(texto);
+                printf("%s: trayectoria inestable, se corta. %s\n", filename_output, salud.diagnostico);
+                #ifdef CONTADORES_HARDWARE
+                termina_paso_contadores(contadores);
+                #endif
+                break;
+            }
+            #endif
+            anade_fijo6(texto, 0, paso * dt);
+            if (salida_particulas) {
+                for (int i = 0; i < 3*N; i++) anade_fijo6(texto, ' ', x_nuevo[i]);
+                for (int i = 0; i < 3*N; i++) anade_fijo6(texto, ' ', v_nuevo[i]);
+            }
             Ek = Energia_cinetica_instantanea(N, v_nuevo, m);
             Ep = Energia_potencial_instantanea(N, x_nuevo, m, K);
             Et = Energia_total_instantanea(N, x_nuevo, v_nuevo, m, K);
             Rg = calcula_radio_giro(N, x_nuevo);
             Ree=x_nuevo[3*(N-1)+2]-x_nuevo[2];
-            fprintf(archivo, " %.6f %.6f %.6f %.6f %.6f\n", Ek, Ep, Et, Rg, Ree);
+            anade_fijo6(texto, ' ', Ek);
+            anade_fijo6(texto, ' ', Ep);
+            anade_fijo6(texto, ' ', Et);
+            anade_fijo6(texto, ' ', Rg);
+            anade_fijo6(texto, ' ', Ree);
+            termina_linea_texto(texto);
+            #if defined(SALIDA_BINARIA) || defined(SALIDA_COMPRIMIDA)
+            if (registro) {
+                int c = 0;
+                registro[c++] = paso * dt;
+                if (guarda_particulas) {
+                    memcpy(registro + c, x_nuevo, 3*N*sizeof(double));
+                    memcpy(registro + c + 3*N, v_nuevo, 3*N*sizeof(double));
+                    c += 6*N;
+                }
+                registro[c++] = Ek; registro[c++] = Ep; registro[c++] = Et;
+                registro[c++] = Rg; registro[c++] = Ree;
+                #ifdef SALIDA_BINARIA
+                if (binaria) escribe_registro_binario(binaria, registro);
+                #endif
+                #ifdef SALIDA_COMPRIMIDA
+                if (compresor) comprime_registro(compresor, registro);
+                #endif
+            }
+            #endif
+            #ifdef TELEMETRIA
+            if (telemetria) {
+                acumula_telemetria(telemetria, Ek, Ep, Ree);
+                long long bytes_salida = ftell(archivo) + texto->usado;
+                #ifdef SALIDA_COMPRIMIDA
+                bytes_salida += bytes_compresor(compresor);
+                #endif
+                publica_telemetria(telemetria, paso + 1, bytes_salida);
+            }
+            #endif
+            #ifdef DISTRIBUCIONES
+            if (distribuciones) acumula_distribuciones_cadena(distribuciones, N, x_nuevo, Rg, Ree);
+            #endif
+            #ifdef CORRELACIONES
+            if (correlaciones) acumula_correlaciones_cadena(correlaciones, x_nuevo, paso * dt);
+            #endif
+            #ifdef ESTIMADORES
+            if (estimadores) acumula_estimadores_cadena(estimadores, x_nuevo, F_salida, Rg, Ree);
+            #endif
+            #ifdef FORMA
+            if (forma && pasos_forma <= 0) acumula_estadistica_forma(forma, x_nuevo);
+            #endif
             counter = 0;
         }
+        #ifdef CONTADORES_HARDWARE
+        fase_contadores(contadores, FASE_SALIDA);
+        #endif
 
-        for (int i = 0; i < 3*N; i++) {
-            x_antiguo[i] = x_nuevo[i];
-            v_antiguo[i] = v_nuevo[i];
-            F_antiguo[i] = F_nuevo[i];
+        if (!fusionado) {
+            for (int i = 0; i < 3*N; i++) {
+                x_antiguo[i] = x_nuevo[i];
+                v_antiguo[i] = v_nuevo[i];
+                F_antiguo[i] = F_nuevo[i];
+            }
         }
+        #ifdef CONTADORES_HARDWARE
+        fase_contadores(contadores, FASE_ACTUALIZACION);
+        termina_paso_contadores(contadores);
+        #endif
     }
     
     for (int i = 0; i < N; i++) {
@@ -154,6 +386,74 @@ void verlet_trayectoria(char* filename_input, double kb, double Temperatura, dou
         }
 
 
+    if (motor) {
+        avanza_motor_hilos(motor, pendientes);
+        destruye_motor_hilos(motor);
+    }
+    #ifdef SALUD
+    if (salud.estado == SALUD_AVISO) printf("%s: %s\n", filename_output, salud.diagnostico);
+    #endif
+    #ifdef VOLUMEN_EXCLUIDO
+    libera_vecinos();
+    #endif
+    #ifdef WLCM
+    libera_flexion();
+    #endif
+
+    // Se escriben junto a la trayectoria, según los interruptores de funciones_oscilador.h:
+    // <carpeta>/DISTRIBUCIONES/<observable>_<archivo>, <carpeta>/CORRELACIONES/<magnitud>_<archivo>,
+    // <carpeta>/ESTIMADORES/estimadores_<archivo>, <carpeta>/FORMA/forma_<archivo> y
+    // <carpeta>/CONTADORES/contadores_<archivo>
+    char carpeta[512];
+    const char *barra = strrchr(filename_output, '/');
+    const char *nombre = barra ? barra + 1 : filename_output;
+    if (barra) snprintf(carpeta, sizeof(carpeta), "%.*s", (int)(barra - filename_output), filename_output);
+    else snprintf(carpeta, sizeof(carpeta), ".");
+    (void)nombre;   // Sin ninguna de estas salidas no se usa
+    #ifdef DISTRIBUCIONES
+    if (distribuciones) {
+        escribe_distribuciones_cadena(distribuciones, carpeta, nombre);
+        libera_distribuciones_cadena(distribuciones);
+    }
+    #endif
+    #ifdef CORRELACIONES
+    if (correlaciones) {
+        escribe_correlaciones_cadena(correlaciones, carpeta, nombre);
+        libera_correlaciones_cadena(correlaciones);
+    }
+    #endif
+    #ifdef ESTIMADORES
+    if (estimadores) {
+        escribe_estimadores_cadena(estimadores, carpeta, nombre);
+        libera_estimadores_cadena(estimadores);
+    }
+    #endif
+    #ifdef FORMA
+    if (forma) {
+        escribe_estadistica_forma(forma, carpeta, nombre);
+        libera_estadistica_forma(forma);
+    }
+    #endif
+    #ifdef CONTADORES_HARDWARE
+    if (contadores) {
+        escribe_contadores_hardware(contadores, N, carpeta, nombre);
+        cierra_contadores_hardware(contadores);
+    }
+    #endif
+    #ifdef SALIDA_BINARIA
+    cierra_salida_binaria(binaria);
+    #endif
+    #ifdef SALIDA_COMPRIMIDA
+    cierra_compresor(compresor);
+    #endif
+    #if defined(SALIDA_BINARIA) || defined(SALIDA_COMPRIMIDA)
+    free(registro);
+    #endif
+    free(memoria);
+    cierra_salida_texto(texto);
+    #ifdef TELEMETRIA
+    cierra_telemetria(telemetria);
+    #endif
     fclose(archivo);
 }
 
@@ -249,14 +549,19 @@ void escribe_input_verlet(double kb, double Temperatura, double alfa, int N, dou
     #endif
 
     // --- Condiciones iniciales ---
-    fprintf(file, "\n# Posiciones iniciales:\n");
-    for (int i = 0; i < 3*N; i++) {
-        fprintf(file, "x_0_%d %g\n", i, x_0[i]);
-    }
+    if (!GUARDA_PARTICULAS(N)) {
+        fprintf(file, "\n# Condiciones iniciales omitidas (N > %d).\n", N_CADENA_LARGA);
+        fprintf(file, "# La trayectoria solo contiene tiempo y observables.\n");
+    } else {
+        fprintf(file, "\n# Posiciones iniciales:\n");
+        for (int i = 0; i < 3*N; i++) {
+            fprintf(file, "x_0_%d %g\n", i, x_0[i]);
+        }
 
-    fprintf(file, "\n# Velocidades iniciales:\n");
-    for (int i = 0; i < 3*N; i++) {
-        fprintf(file, "v_0_%d %g\n", i, v_0[i]);
+        fprintf(file, "\n# Velocidades iniciales:\n");
+        for (int i = 0; i < 3*N; i++) {
+            fprintf(file, "v_0_%d %g\n", i, v_0[i]);
+        }
     }
 
     fclose(file);
@@ -2,6 +2,19 @@
 
 #include "random.h"
 #include "funciones_oscilador.h"
+#include "cadena_larga.h"
+#include "hilos.h"
+#include "vecinos.h"
+#include "histograma.h"
+#include "correlador.h"
+#include "binario.h"
+#include "compresion.h"
+#include "formato.h"
+#include "telemetria.h"
+#include "salud.h"
+#include "estimadores.h"
+#include "forma.h"
+#include "contadores.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +22,13 @@
 #include <math.h>
 
 
+// Posiciones nuevas / velocidades nuevas de un_paso_verlet (la fuerza va entre las dos)
+void actualiza_posiciones_verlet(const double betta[], double b, int N, const double x_antiguo[], double x_nuevo[],
+                                 const double v_antiguo[], const double F_antiguo[], double dt, double m);
+void actualiza_velocidades_verlet(const double betta[], double b, double a, int N, const double v_antiguo[],
+                                  double v_nuevo[], const double F_antiguo[], const double F_nuevo[],
+                                  double dt, double m);
+
 #ifdef FIXED
 void un_paso_verlet(double betta[], double b, double a, int N, 
                     double x_antiguo[], double x_nuevo[], 
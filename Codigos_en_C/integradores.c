@@ -0,0 +1,196 @@
+#include "integradores.h"
+
+
+const char *nombre_integrador(TipoIntegrador tipo) {
+    switch (tipo) {
+        case INTEGRADOR_GJF:            return "GJF";
+        case INTEGRADOR_BAOAB:          return "BAOAB";
+        case INTEGRADOR_OBABO:          return "OBABO";
+        case INTEGRADOR_EULER_MARUYAMA: return "Euler-Maruyama";
+        default:                        return "desconocido";
+    }
+}
+
+void fuerza_integrador(Integrador *integ, double x[], double F[]) {
+    #ifdef FIXED
+        integ->Fuerza(integ->N, x, F, integ->K, integ->F_cte);
+    #else
+        integ->Fuerza(integ->N, x, F, integ->K);
+    #endif
+}
+
+/**
+ * Paso GJF: el mismo esquema que verlet_trayectoria (genera betta, llama a
+ * un_paso_verlet y copia el estado nuevo), por lo que reproduce su trayectoria.
+ */
+static void paso_gjf(Integrador *integ, double x[], double v[], double F[]) {
+    int n = 3*integ->N;
+    for (int i = 0; i < n; i++) {
+        integ->betta[i] = gaussian() * integ->sigma;
+    }
+
+    #ifdef FIXED
+        un_paso_verlet(integ->betta, integ->c2, integ->c1, integ->N, x, integ->x_aux, v, integ->v_aux,
+                       F, integ->F_aux, integ->dt, integ->m, integ->Fuerza, integ->K, integ->F_cte);
+    #else
+        un_paso_verlet(integ->betta, integ->c2, integ->c1, integ->N, x, integ->x_aux, v, integ->v_aux,
+                       F, integ->F_aux, integ->dt, integ->m, integ->Fuerza, integ->K);
+    #endif
+
+    memcpy(x, integ->x_aux, n*sizeof(double));
+    memcpy(v, integ->v_aux, n*sizeof(double));
+    memcpy(F, integ->F_aux, n*sizeof(double));
+}
+
+/**
+ * Paso O: propagación exacta de Ornstein-Uhlenbeck de las velocidades,
+ * v <- c1*v + c2*xi, con c1 = exp(-alfa*h/m) y c2 = sqrt((1-c1^2) kT/m).
+ */
+static void paso_O(Integrador *integ, double v[]) {
+    int n = 3*integ->N;
+    for (int i = 0; i < n; i++) {
+        v[i] = integ->c1*v[i] + integ->c2*gaussian();
+    }
+    #ifdef FIXED
+    v[0] = v[1] = v[2] = 0.0;   // La primera partícula está fija: ni ruido ni velocidad
+    #endif
+}
+
+static void paso_B(Integrador *integ, double v[], double F[], double h) {
+    int n = 3*integ->N;
+    double fac = h/integ->m;
+    for (int i = 0; i < n; i++) {
+        v[i] += fac*F[i];
+    }
+}
+
+static void paso_A(Integrador *integ, double x[], double v[], double h) {
+    int n = 3*integ->N;
+    for (int i = 0; i < n; i++) {
+        x[i] += h*v[i];
+    }
+}
+
+static void paso_baoab(Integrador *integ, double x[], double v[], double F[]) {
+    double dt = integ->dt;
+    paso_B(integ, v, F, 0.5*dt);
+    paso_A(integ, x, v, 0.5*dt);
+    paso_O(integ, v);
+    paso_A(integ, x, v, 0.5*dt);
+    fuerza_integrador(integ, x, F);
+    paso_B(integ, v, F, 0.5*dt);
+}
+
+static void paso_obabo(Integrador *integ, double x[], double v[], double F[]) {
+    double dt = integ->dt;
+    paso_O(integ, v);
+    paso_B(integ, v, F, 0.5*dt);
+    paso_A(integ, x, v, dt);
+    fuerza_integrador(integ, x, F);
+    paso_B(integ, v, F, 0.5*dt);
+    paso_O(integ, v);
+}
+
+/**
+ * Paso de Euler-Maruyama: x += v dt ; m dv = (F - alfa v) dt + sqrt(2 alfa kT dt) xi.
+ * La parte determinista es la de Fuerza_euler, pero con la fuerza conservativa del integrador.
+ */
+static void paso_euler_maruyama(Integrador *integ, double x[], double v[], double F[]) {
+    int n = 3*integ->N;
+    double dt = integ->dt;
+    double m = integ->m;
+
+    for (int i = 0; i < n; i++) {
+        double v_i = v[i];
+        v[i] = v_i + (F[i] - integ->alfa*v_i)*dt/m + integ->sigma*gaussian()/m;
+        x[i] = x[i] + v_i*dt;
+    }
+    #ifdef FIXED
+    v[0] = v[1] = v[2] = 0.0;   // La primera partícula está fija: ni ruido ni velocidad
+    #endif
+    fuerza_integrador(integ, x, F);
+}
+
+
+/**
+ * Prepara un integrador de la familia y reserva sus buffers.
+ * @param integ       Integrador a rellenar.
+ * @param tipo        Esquema de integración.
+ * @param N           Número de partículas.
+ * @param dt          Paso de tiempo.
+ * @param m           Masa de las partículas.
+ * @param alfa        Coeficiente de fricción.
+ * @param kb          Constante de Boltzmann.
+ * @param Temperatura Temperatura del baño.
+ * @param Fuerza      Puntero a función que calcula las fuerzas.
+ * @param K           Constante de los muelles.
+ * @return 0 si todo va bien, -1 si el tipo no existe o falla la reserva de memoria.
+ */
+#ifdef FIXED
+int crea_integrador(Integrador *integ, TipoIntegrador tipo, int N, double dt, double m,
+                    double alfa, double kb, double Temperatura,
+                    void (*Fuerza)(int, double[], double[], double, double),
+                    double K, double F_cte)
+#else
+int crea_integrador(Integrador *integ, TipoIntegrador tipo, int N, double dt, double m,
+                    double alfa, double kb, double Temperatura,
+                    void (*Fuerza)(int, double[], double[], double),
+                    double K)
+#endif
+{
+    memset(integ, 0, sizeof(*integ));
+    integ->tipo = tipo;
+    integ->N = N;
+    integ->dt = dt;
+    integ->m = m;
+    integ->alfa = alfa;
+    integ->kT = kb*Temperatura;
+    integ->K = K;
+    integ->Fuerza = Fuerza;
+    #ifdef FIXED
+    integ->F_cte = F_cte;
+    #endif
+
+    switch (tipo) {
+        case INTEGRADOR_GJF:
+            integ->c1 = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+            integ->c2 = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+            integ->sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+            integ->paso = paso_gjf;
+            break;
+        case INTEGRADOR_BAOAB:
+            integ->c1 = exp(-alfa*dt/m);
+            integ->c2 = sqrt((1.0 - integ->c1*integ->c1)*integ->kT/m);
+            integ->paso = paso_baoab;
+            break;
+        case INTEGRADOR_OBABO:
+            integ->c1 = exp(-0.5*alfa*dt/m);
+            integ->c2 = sqrt((1.0 - integ->c1*integ->c1)*integ->kT/m);
+            integ->paso = paso_obabo;
+            break;
+        case INTEGRADOR_EULER_MARUYAMA:
+            integ->sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+            integ->paso = paso_euler_maruyama;
+            break;
+        default:
+            printf("Integrador desconocido: %d\n", (int)tipo);
+            return -1;
+    }
+
+    if (tipo == INTEGRADOR_GJF) {
+        integ->betta = malloc(4*3*N*sizeof(double));
+        if (!integ->betta) {
+            printf("No se pudo reservar memoria para el integrador %s\n", nombre_integrador(tipo));
+            return -1;
+        }
+        integ->x_aux = integ->betta + 3*N;
+        integ->v_aux = integ->betta + 6*N;
+        integ->F_aux = integ->betta + 9*N;
+    }
+    return 0;
+}
+
+void libera_integrador(Integrador *integ) {
+    free(integ->betta);
+    integ->betta = integ->x_aux = integ->v_aux = integ->F_aux = NULL;
+}
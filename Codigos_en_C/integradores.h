@@ -0,0 +1,69 @@
+#pragma once
+
+#include "random.h"
+#include "funciones_oscilador.h"
+#include "integracion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+// Familia de integradores de Langevin disponibles
+typedef enum {
+    INTEGRADOR_GJF,             // Grønbech-Jensen–Farago (el de un_paso_verlet)
+    INTEGRADOR_BAOAB,           // Leimkuhler–Matthews, paso O exacto (Ornstein-Uhlenbeck)
+    INTEGRADOR_OBABO,           // Bussi–Parrinello, dos medios pasos O exactos
+    INTEGRADOR_EULER_MARUYAMA,  // Euler-Maruyama de primer orden
+    N_INTEGRADORES
+} TipoIntegrador;
+
+/**
+ * Estado de un integrador. Todos comparten la misma interfaz: paso(integ, x, v, F)
+ * avanza dt el estado (x, v) en el sitio, suponiendo que F = F(x) a la entrada
+ * y dejando F = F(x) a la salida.
+ */
+typedef struct Integrador {
+    TipoIntegrador tipo;
+    int N;
+    double dt, m, alfa, kT;
+    double K;
+    #ifdef FIXED
+    double F_cte;
+    void (*Fuerza)(int, double[], double[], double, double);
+    #else
+    void (*Fuerza)(int, double[], double[], double);
+    #endif
+
+    double c1, c2;  // GJF: (a, b). BAOAB/OBABO: amortiguamiento y amplitud del paso O
+    double sigma;   // Amplitud del ruido que multiplica a gaussian()
+
+    double *betta;  // Buffers de trabajo de tamaño 3N
+    double *x_aux;
+    double *v_aux;
+    double *F_aux;
+
+    void (*paso)(struct Integrador *integ, double x[], double v[], double F[]);
+} Integrador;
+
+// Nombre legible del integrador
+const char *nombre_integrador(TipoIntegrador tipo);
+
+// Prepara el integrador y reserva sus buffers. Devuelve 0 si todo va bien.
+#ifdef FIXED
+int crea_integrador(Integrador *integ, TipoIntegrador tipo, int N, double dt, double m,
+                    double alfa, double kb, double Temperatura,
+                    void (*Fuerza)(int, double[], double[], double, double),
+                    double K, double F_cte);
+#else
+int crea_integrador(Integrador *integ, TipoIntegrador tipo, int N, double dt, double m,
+                    double alfa, double kb, double Temperatura,
+                    void (*Fuerza)(int, double[], double[], double),
+                    double K);
+#endif
+
+// Libera los buffers del integrador
+void libera_integrador(Integrador *integ);
+
+// Calcula F = F(x) con la fuerza y parámetros del integrador
+void fuerza_integrador(Integrador *integ, double x[], double F[]);
@@ -0,0 +1,412 @@
+#include "intercambio.h"
+
+
+#define TANDA_SIN_INTERCAMBIO 100  // Muestras por tanda cuando no hay intercambios
+
+typedef struct ContextoIntercambio ContextoIntercambio;
+
+typedef struct {
+    ContextoIntercambio *c;
+    int id;
+    int condicion;              // Condición asignada (la cambian los intercambios)
+    int condicion_aplicada;     // Condición con la que se calcularon sigma, F_cte y las fuerzas
+    EstadoPR rng;               // Generador propio de la réplica
+    double *memoria;
+    double *x, *v, *F;
+    double *x_nuevo, *v_nuevo, *F_nuevo;
+    double *betta;
+    double Temperatura, sigma, F_cte;
+    int n_muestras;             // Muestras de la tanda en curso
+    long long *paso_muestra;
+    double *ree, *energia_cinetica;
+    double Ree_z, energia;      // Al final de la tanda, para los intercambios
+    int extremo;                // Último extremo visitado (-1 ninguno, 0 el primero, 1 el último)
+    pthread_t hilo;
+} Replica;
+
+struct ContextoIntercambio {
+    const ParametrosIntercambio *pi;
+    int N;
+    double kb, Temperatura, alfa, dt, m, K, F_cte;
+    double a, b;
+    long long paso;             // Primer paso de la tanda en curso
+    int pasos_tanda, pasos_muestreo;
+    int salir;
+    int arrancado;              // Los hilos no entran en las barreras hasta que se han lanzado todos
+    pthread_mutex_t cerrojo;
+    pthread_cond_t arranque;
+    pthread_barrier_t inicio, fin;
+    Replica *replicas;
+};
+
+
+void ruta_intercambio(double K, char *carpeta, size_t tam) {
+    #ifdef FIXED
+    #ifdef WLCM
+    snprintf(carpeta, tam, "Resultados_simulacion/WLCM/%.1f/FIJOS/INTERCAMBIO", K);
+    #else
+    snprintf(carpeta, tam, "Resultados_simulacion/%.1f/FIJOS/INTERCAMBIO", K);
+    #endif
+    #else
+    #ifdef WLCM
+    snprintf(carpeta, tam, "Resultados_simulacion/WLCM/%.1f/ESCALA/INTERCAMBIO", K);
+    #else
+    snprintf(carpeta, tam, "Resultados_simulacion/%.1f/ESCALA/INTERCAMBIO", K);
+    #endif
+    #endif
+    crea_carpetas(carpeta);
+}
+
+
+// Ajusta la réplica a su condición: ruido, fuerza constante, velocidades y fuerzas
+static void aplica_condicion(Replica *r) {
+    ContextoIntercambio *c = r->c;
+    const ParametrosIntercambio *pi = c->pi;
+    double valor = pi->valores[r->condicion];
+    int N = c->N;
+
+    double T_nueva = (pi->tipo == INTERCAMBIO_TEMPERATURA) ? valor : c->Temperatura;
+    if (r->condicion_aplicada >= 0 && T_nueva != r->Temperatura) {
+        double escala = sqrt(T_nueva / r->Temperatura);
+        for (int i = 0; i < 3*N; i++) r->v[i] *= escala;
+    }
+    r->Temperatura = T_nueva;
+    r->sigma = sqrt(2 * c->alfa * T_nueva * c->kb * c->dt);
+    r->F_cte = (pi->tipo == INTERCAMBIO_FUERZA) ? valor : c->F_cte;
+
+    #ifdef FIXED
+    Fuerza_verlet(N, r->x, r->F, c->K, r->F_cte);
+    #else
+    if (r->condicion_aplicada < 0) Fuerza_verlet(N, r->x, r->F, c->K);
+    #endif
+    r->condicion_aplicada = r->condicion;
+}
+
+// Integra una tanda de pasos guardando las muestras; deja Ree_z y la energía para el intercambio
+static void tanda_replica(Replica *r) {
+    ContextoIntercambio *c = r->c;
+    int N = c->N;
+    if (r->condicion != r->condicion_aplicada) aplica_condicion(r);
+
+    r->n_muestras = 0;
+    for (int p = 1; p <= c->pasos_tanda; p++) {
+        for (int i = 0; i < 3*N; i++) r->betta[i] = gaussian_r(&r->rng) * r->sigma;
+        #ifdef FIXED
+        un_paso_verlet(r->betta, c->b, c->a, N, r->x, r->x_nuevo, r->v, r->v_nuevo,
+                       r->F, r->F_nuevo, c->dt, c->m, Fuerza_verlet, c->K, r->F_cte);
+        #else
+        un_paso_verlet(r->betta, c->b, c->a, N, r->x, r->x_nuevo, r->v, r->v_nuevo,
+                       r->F, r->F_nuevo, c->dt, c->m, Fuerza_verlet, c->K);
+        #endif
+
+        double *tmp;
+        tmp = r->x; r->x = r->x_nuevo; r->x_nuevo = tmp;
+        tmp = r->v; r->v = r->v_nuevo; r->v_nuevo = tmp;
+        tmp = r->F; r->F = r->F_nuevo; r->F_nuevo = tmp;
+
+        long long paso = c->paso + p;
+        if (paso % c->pasos_muestreo == 0) {
+            r->paso_muestra[r->n_muestras] = paso;
+            r->ree[r->n_muestras] = r->x[3*(N-1)+2] - r->x[2];
+            r->energia_cinetica[r->n_muestras] = Energia_cinetica_instantanea(N, r->v, c->m);
+            r->n_muestras++;
+        }
+    }
+
+    r->Ree_z = r->x[3*(N-1)+2] - r->x[2];
+    if (c->pi->tipo == INTERCAMBIO_TEMPERATURA)
+        r->energia = Energia_potencial_instantanea(N, r->x, c->m, c->K) - r->F_cte * r->Ree_z;
+}
+
+static void *bucle_replica(void *arg) {
+    Replica *r = arg;
+    ContextoIntercambio *c = r->c;
+    pthread_mutex_lock(&c->cerrojo);
+    while (!c->arrancado) pthread_cond_wait(&c->arranque, &c->cerrojo);
+    int lanzados = !c->salir;   // Si no se lanzaron todos, se sale sin tocar las barreras
+    pthread_mutex_unlock(&c->cerrojo);
+    while (lanzados) {
+        pthread_barrier_wait(&c->inicio);
+        if (c->salir) break;
+        tanda_replica(r);
+        pthread_barrier_wait(&c->fin);
+    }
+    #ifdef VOLUMEN_EXCLUIDO
+    libera_vecinos();  // La lista de vecinos es propia del hilo
+    #endif
+    return NULL;
+}
+
+// Intenta intercambiar las parejas (k, k+1) con k de la paridad dada
+static void intenta_intercambios(ContextoIntercambio *c, int paridad, int replica_de[],
+                                 long long intentos[], long long aceptados[]) {
+    const ParametrosIntercambio *pi = c->pi;
+    for (int k = paridad; k + 1 < pi->n_replicas; k += 2) {
+        Replica *r_k = &c->replicas[replica_de[k]];
+        Replica *r_l = &c->replicas[replica_de[k+1]];
+        double log_P;
+        if (pi->tipo == INTERCAMBIO_FUERZA) {
+            double beta = 1.0 / (c->kb * c->Temperatura);
+            log_P = beta * (pi->valores[k] - pi->valores[k+1]) * (r_l->Ree_z - r_k->Ree_z);
+        } else {
+            double beta_k = 1.0 / (c->kb * pi->valores[k]), beta_l = 1.0 / (c->kb * pi->valores[k+1]);
+            log_P = (beta_k - beta_l) * (r_k->energia - r_l->energia);
+        }
+
+        intentos[k]++;
+        if (log_P >= 0.0 || fran() < exp(log_P)) {
+            aceptados[k]++;
+            r_k->condicion = k + 1;
+            r_l->condicion = k;
+            int tmp = replica_de[k];
+            replica_de[k] = replica_de[k+1];
+            replica_de[k+1] = tmp;
+        }
+    }
+}
+
+
+#ifdef FIXED
+int intercambio_replicas(const ParametrosIntercambio *pi, double kb, double Temperatura, double alfa, int N,
+                         double dt, double m, double K, double F_cte, const char *carpeta,
+                         ResultadoIntercambio resultados[])
+#else
+int intercambio_replicas(const ParametrosIntercambio *pi, double kb, double Temperatura, double alfa, int N,
+                         double dt, double m, double K, const char *carpeta,
+                         ResultadoIntercambio resultados[])
+#endif
+{
+    int n = pi->n_replicas;
+    if (n < 1 || !pi->valores || pi->T_fisico <= 0.0 || pi->intervalo_muestreo <= 0.0) {
+        printf("Parámetros del intercambio de réplicas no válidos\n");
+        return 0;
+    }
+    #ifndef FIXED
+    if (pi->tipo == INTERCAMBIO_FUERZA) {
+        printf("El intercambio de fuerzas necesita FIXED\n");
+        return 0;
+    }
+    #endif
+    #ifdef WLCM
+    printf("Con WLCM la flexión no tiene energía: no hay intercambio de réplicas\n");
+    return 0;
+    #endif
+    for (int k = 0; pi->tipo == INTERCAMBIO_TEMPERATURA && k < n; k++) {
+        if (pi->valores[k] <= 0.0) {
+            printf("Temperatura no válida en la réplica %d: %f\n", k, pi->valores[k]);
+            return 0;
+        }
+    }
+
+    ContextoIntercambio c;
+    memset(&c, 0, sizeof(c));
+    c.pi = pi;
+    c.N = N;
+    c.kb = kb;
+    c.Temperatura = Temperatura;
+    c.alfa = alfa;
+    c.dt = dt;
+    c.m = m;
+    c.K = K;
+    #ifdef FIXED
+    c.F_cte = F_cte;
+    #endif
+    c.a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    c.b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    c.pasos_muestreo = (int)(pi->intervalo_muestreo / dt + 0.5);
+    if (c.pasos_muestreo < 1) c.pasos_muestreo = 1;
+    c.pasos_tanda = (pi->intervalo_intercambio > 0.0) ? (int)(pi->intervalo_intercambio / dt + 0.5)
+                                                      : TANDA_SIN_INTERCAMBIO * c.pasos_muestreo;
+    if (c.pasos_tanda < 1) c.pasos_tanda = 1;
+    int muestras_tanda = c.pasos_tanda / c.pasos_muestreo + 1;
+
+    // 1. Memoria y archivos de salida por condición
+    c.replicas = calloc(n, sizeof(Replica));
+    int *replica_de = malloc(n*sizeof(int));
+    long long *intentos = calloc(n, sizeof(long long));
+    long long *aceptados = calloc(n, sizeof(long long));
+    EstimadorBloques *ree = calloc(n, sizeof(EstimadorBloques));
+    double *suma_ec = calloc(n, sizeof(double));
+    long long *n_ec = calloc(n, sizeof(long long));
+    int *viajes = calloc(n, sizeof(int));
+    FILE **archivos = calloc(n, sizeof(FILE *));
+    int ok = c.replicas && replica_de && intentos && aceptados && ree && suma_ec && n_ec && viajes && archivos;
+    for (int k = 0; ok && k < n; k++) {
+        Replica *r = &c.replicas[k];
+        r->memoria = malloc(7*3*(size_t)N*sizeof(double));
+        r->paso_muestra = malloc(muestras_tanda*sizeof(long long));
+        r->ree = malloc(muestras_tanda*sizeof(double));
+        r->energia_cinetica = malloc(muestras_tanda*sizeof(double));
+        ok = r->memoria && r->paso_muestra && r->ree && r->energia_cinetica;
+    }
+    if (!ok) printf("No se pudo reservar memoria para el intercambio de réplicas (N = %d, %d réplicas)\n", N, n);
+
+    for (int k = 0; ok && k < n; k++) {
+        char ruta[512];
+        snprintf(ruta, sizeof(ruta), "%s/condicion_%d.txt", carpeta, k);
+        archivos[k] = fopen(ruta, "w");
+        if (!archivos[k]) {
+            printf("No se pudo crear el archivo %s\n", ruta);
+            ok = 0;
+            break;
+        }
+        fprintf(archivos[k], "# %s %.6f N %d K %.1f: t replica Ree\n",
+                pi->tipo == INTERCAMBIO_FUERZA ? "F_cte" : "Temperatura", pi->valores[k], N, K);
+    }
+
+    // 2. Réplicas: cadena recta en x, en reposo, cada una en su condición y con su generador
+    for (int k = 0; ok && k < n; k++) {
+        Replica *r = &c.replicas[k];
+        r->c = &c;
+        r->id = k;
+        r->condicion = k;
+        r->condicion_aplicada = -1;
+        r->Temperatura = (pi->tipo == INTERCAMBIO_TEMPERATURA) ? pi->valores[k] : Temperatura;
+        r->extremo = (k == 0) ? 0 : -1;
+        r->x       = r->memoria;
+        r->v       = r->memoria + 3*N;
+        r->F       = r->memoria + 6*N;
+        r->x_nuevo = r->memoria + 9*N;
+        r->v_nuevo = r->memoria + 12*N;
+        r->F_nuevo = r->memoria + 15*N;
+        r->betta   = r->memoria + 18*N;
+        for (int j = 0; j < N; j++) {
+            r->x[3*j] = j * L_0;
+            r->x[3*j+1] = r->x[3*j+2] = 0.0;
+            r->v[3*j] = r->v[3*j+1] = r->v[3*j+2] = 0.0;
+        }
+        inicializa_PR_desde(&r->rng, &estado_PR_global);
+        replica_de[k] = k;
+    }
+
+    int hilos = 0;
+    if (ok) {
+        pthread_barrier_init(&c.inicio, NULL, n + 1);
+        pthread_barrier_init(&c.fin, NULL, n + 1);
+        pthread_mutex_init(&c.cerrojo, NULL);
+        pthread_cond_init(&c.arranque, NULL);
+        for (; hilos < n; hilos++)
+            if (pthread_create(&c.replicas[hilos].hilo, NULL, bucle_replica, &c.replicas[hilos]) != 0) break;
+        if (hilos < n) {
+            printf("No se pudieron lanzar los hilos de las réplicas\n");
+            ok = 0;
+        }
+        // Si falta alguno, las barreras (para n + 1) no se completarían: los lanzados salen sin usarlas
+        pthread_mutex_lock(&c.cerrojo);
+        c.salir = !ok;
+        c.arrancado = 1;
+        pthread_cond_broadcast(&c.arranque);
+        pthread_mutex_unlock(&c.cerrojo);
+    }
+
+    // 3. Tandas: integran todas las réplicas, se separan las muestras por condición y se intercambia
+    long long pasos_equilibrado = (long long)(pi->T_equilibrado / dt + 0.5);
+    long long pasos_totales = pasos_equilibrado + (long long)(pi->T_fisico / dt + 0.5);
+    int ronda = 0;
+    for (c.paso = 0; ok && c.paso < pasos_totales; c.paso += c.pasos_tanda) {
+        pthread_barrier_wait(&c.inicio);
+        pthread_barrier_wait(&c.fin);
+
+        for (int i = 0; i < n; i++) {
+            Replica *r = &c.replicas[i];
+            int k = r->condicion;
+            for (int s = 0; s < r->n_muestras; s++) {
+                if (r->paso_muestra[s] <= pasos_equilibrado) continue;
+                fprintf(archivos[k], "%.6f %d %.6f\n", r->paso_muestra[s] * dt, i, r->ree[s]);
+                anade_estimador_bloques(&ree[k], r->ree[s]);
+                suma_ec[k] += r->energia_cinetica[s];
+                n_ec[k]++;
+            }
+        }
+
+        if (pi->intervalo_intercambio > 0.0 && n > 1) {
+            intenta_intercambios(&c, ronda % 2, replica_de, intentos, aceptados);
+            ronda++;
+            for (int i = 0; i < n; i++) {
+                Replica *r = &c.replicas[i];
+                if (r->condicion == 0) {
+                    if (r->extremo == 1) viajes[i]++;
+                    r->extremo = 0;
+                } else if (r->condicion == n - 1 && r->extremo == 0) {
+                    r->extremo = 1;
+                }
+            }
+        }
+    }
+
+    if (c.arrancado) {
+        if (!c.salir) {
+            c.salir = 1;
+            pthread_barrier_wait(&c.inicio);
+        }
+        for (int i = 0; i < hilos; i++) pthread_join(c.replicas[i].hilo, NULL);
+        pthread_barrier_destroy(&c.inicio);
+        pthread_barrier_destroy(&c.fin);
+        pthread_mutex_destroy(&c.cerrojo);
+        pthread_cond_destroy(&c.arranque);
+    }
+
+    // 4. Resumen por condición
+    #ifdef FIXED
+    double grados_libertad = 3.0 * (N - 1);
+    #else
+    double grados_libertad = 3.0 * N;
+    #endif
+    if (ok) {
+        char ruta[512];
+        snprintf(ruta, sizeof(ruta), "%s/intercambio.txt", carpeta);
+        FILE *f = fopen(ruta, "w");
+        if (!f) {
+            printf("No se pudo crear el archivo %s\n", ruta);
+            ok = 0;
+        } else {
+            fprintf(f, "# Intercambio de %s N %d K %.1f: %d réplicas, T %.1f, intervalo %.4f, %d rondas\n",
+                    pi->tipo == INTERCAMBIO_FUERZA ? "fuerzas" : "temperaturas", N, K, n, pi->T_fisico,
+                    pi->intervalo_intercambio, ronda);
+            fprintf(f, "# %s Ree error T_cinetica aceptacion_con_la_siguiente viajes\n",
+                    pi->tipo == INTERCAMBIO_FUERZA ? "F_cte" : "Temperatura");
+        }
+        for (int k = 0; k < n; k++) {
+            double aceptacion = intentos[k] ? (double)aceptados[k] / intentos[k] : 0.0;
+            double T_cinetica = n_ec[k] ? 2.0 * suma_ec[k] / n_ec[k] / (grados_libertad * kb) : 0.0;
+            if (f)
+                fprintf(f, "%.6f %.6f %.6f %.4f %.4f %d\n", pi->valores[k], media_estimador_bloques(&ree[k]),
+                        error_estimador_bloques(&ree[k]), T_cinetica, aceptacion, viajes[k]);
+            printf("  -> %s = %.6f  <Ree> = %.6f +- %.6f  aceptación %.3f\n",
+                   pi->tipo == INTERCAMBIO_FUERZA ? "F_cte" : "T", pi->valores[k],
+                   media_estimador_bloques(&ree[k]), error_estimador_bloques(&ree[k]), aceptacion);
+            if (resultados) {
+                resultados[k].valor = pi->valores[k];
+                resultados[k].Ree = media_estimador_bloques(&ree[k]);
+                resultados[k].error = error_estimador_bloques(&ree[k]);
+                resultados[k].T_cinetica = T_cinetica;
+                resultados[k].intentos = intentos[k];
+                resultados[k].aceptados = aceptados[k];
+                resultados[k].viajes = viajes[k];
+            }
+        }
+        if (f) {
+            fclose(f);
+            printf("Intercambio de réplicas: %d rondas, escrito en %s\n", ronda, carpeta);
+        }
+    }
+
+    for (int k = 0; archivos && k < n; k++)
+        if (archivos[k]) fclose(archivos[k]);
+    for (int k = 0; c.replicas && k < n; k++) {
+        free(c.replicas[k].memoria);
+        free(c.replicas[k].paso_muestra);
+        free(c.replicas[k].ree);
+        free(c.replicas[k].energia_cinetica);
+    }
+    free(c.replicas);
+    free(replica_de);
+    free(intentos);
+    free(aceptados);
+    free(ree);
+    free(suma_ec);
+    free(n_ec);
+    free(viajes);
+    free(archivos);
+    return ok;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "integracion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+
+/**
+ * Intercambio de réplicas (parallel tempering) entre fuerzas o temperaturas vecinas.
+ *
+ * Cada réplica es una cadena completa que se integra con GJF en su propio hilo y con su propio
+ * generador Parisi-Rapuano (sacado del global, así que el resultado solo depende de la semilla).
+ * Cada intervalo_intercambio todas se paran y se intenta intercambiar las condiciones de las
+ * parejas vecinas (k, k+1), alternando las parejas pares e impares, con el criterio de Metropolis:
+ *  - Fuerzas (solo con FIXED): la fuerza solo añade -F Ree_z a la energía, así que
+ *      P = min(1, exp(beta (F_k - F_{k+1}) (Ree_z(k+1) - Ree_z(k))))
+ *  - Temperaturas: P = min(1, exp((beta_k - beta_{k+1}) (U(k) - U(k+1)))), con U la energía
+ *    potencial (con FIXED, menos F_cte Ree_z). Las velocidades se reescalan con sqrt(T'/T).
+ * La flexión de flexion.c no deriva de una energía: la distribución estacionaria no es la de
+ * Boltzmann y ninguno de los dos criterios es válido, así que con WLCM no hay intercambio.
+ * Se intercambian las condiciones, no las configuraciones: cada réplica sigue en su hilo.
+ *
+ * Las muestras se separan por condición (no por réplica): carpeta/condicion_<k>.txt tiene una
+ * cabecera y "t replica Ree" por línea (Ree en la última columna, como en las trayectorias, así
+ * que lee_ree_trayectoria las lee), y carpeta/intercambio.txt tiene por condición <Ree> con su
+ * error por bloques, la temperatura cinética y la aceptación con la siguiente.
+ */
+
+typedef enum {
+    INTERCAMBIO_FUERZA,
+    INTERCAMBIO_TEMPERATURA
+} TipoIntercambio;
+
+typedef struct {
+    TipoIntercambio tipo;
+    int n_replicas;
+    const double *valores;          // F_cte o Temperatura de cada condición, ordenadas
+    double T_equilibrado;           // Tiempo inicial (con intercambios) sin muestrear
+    double T_fisico;                // Tiempo muestreado
+    double intervalo_intercambio;   // Tiempo entre intentos (0: sin intercambios)
+    double intervalo_muestreo;      // Tiempo entre muestras de Ree
+} ParametrosIntercambio;
+
+typedef struct {
+    double valor;                   // F_cte o Temperatura de la condición
+    double Ree, error;              // <Ree> y su error por bloques
+    double T_cinetica;              // Temperatura cinética media, 2 <E_c> / (g kb) con g grados de libertad
+    long long intentos, aceptados;  // Intercambios con la condición siguiente
+    int viajes;                     // Idas y vueltas 0 -> n-1 -> 0 de la réplica que empezó aquí
+} ResultadoIntercambio;
+
+// Carpeta INTERCAMBIO junto a las trayectorias de K (crea las carpetas)
+void ruta_intercambio(double K, char *carpeta, size_t tam);
+
+/**
+ * Simula las réplicas con intercambios y escribe los resultados en carpeta.
+ * @param Temperatura  Temperatura de todas las réplicas con INTERCAMBIO_FUERZA.
+ * @param F_cte        Fuerza de todas las réplicas con INTERCAMBIO_TEMPERATURA.
+ * @param resultados   Array de n_replicas resultados (o NULL).
+ * @return 1 si ha terminado, 0 si hubo un error.
+ */
+#ifdef FIXED
+int intercambio_replicas(const ParametrosIntercambio *pi, double kb, double Temperatura, double alfa, int N,
+                         double dt, double m, double K, double F_cte, const char *carpeta,
+                         ResultadoIntercambio resultados[]);
+#else
+int intercambio_replicas(const ParametrosIntercambio *pi, double kb, double Temperatura, double alfa, int N,
+                         double dt, double m, double K, const char *carpeta,
+                         ResultadoIntercambio resultados[]);
+#endif
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include "telemetria.h"
+
+/*
+ * Monitor de los trabajos en marcha: lee los .tel de la carpeta de telemetría (telemetria.h) y
+ * escribe una línea por trabajo con el paso, la velocidad, el tiempo restante, las medias de
+ * Ek, Ep y Ree y los bytes escritos. Un trabajo está "parado" si su proceso ya no existe o si
+ * lleva más de -parado segundos sin publicar.
+ *
+ * Uso: monitor.exe [-carpeta TELEMETRIA] [-cada 0] [-parado 60] [-limpia]
+ *   -cada    Repite cada tantos segundos (0: una vez)
+ *   -limpia  Borra los .tel de trabajos cuyo proceso ya no existe
+ */
+
+static double ahora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+static int proceso_vivo(int pid) {
+#ifdef _WIN32
+    (void)pid;
+    return 1;
+#else
+    return kill(pid, 0) == 0 || errno == EPERM;
+#endif
+}
+
+static void formatea_duracion(double s, char *texto, size_t tam) {
+    if (!(s >= 0.0) || s > 1e8) {
+        snprintf(texto, tam, "-");
+        return;
+    }
+    long total = (long)(s + 0.5);
+    snprintf(texto, tam, "%ld:%02ld:%02ld", total / 3600, total / 60 % 60, total % 60);
+}
+
+// Una pasada por la carpeta. Devuelve el número de trabajos vistos.
+static int muestra_trabajos(const char *carpeta, double parado, int limpia) {
+    DIR *d = opendir(carpeta);
+    if (!d) {
+        printf("No hay trabajos (no existe %s)\n", carpeta);
+        return 0;
+    }
+    printf("%-28s %7s %5s %13s %6s %10s %9s %10s %10s %10s %8s %s\n", "trabajo", "pid", "N", "paso",
+           "%", "pasos/s", "restante", "<Ek>", "<Ep>", "<Ree>", "MB", "estado");
+    struct dirent *e;
+    char ruta[1024];
+    int trabajos = 0;
+    double t = ahora();
+    while ((e = readdir(d))) {
+        size_t n = strlen(e->d_name);
+        if (n < 4 || strcmp(e->d_name + n - 4, ".tel") != 0) continue;
+        snprintf(ruta, sizeof(ruta), "%s/%s", carpeta, e->d_name);
+        RegistroTelemetria r;
+        if (!lee_telemetria(ruta, &r)) continue;
+        trabajos++;
+
+        int vivo = proceso_vivo(r.pid);
+        const char *estado = r.terminado ? "terminado"
+                           : !vivo ? "parado (sin proceso)"
+                           : t - r.actualizado > parado ? "parado" : "en marcha";
+        double restante = r.pasos_por_segundo > 0.0 ? (r.pasos_totales - r.paso) / r.pasos_por_segundo : -1.0;
+        char texto_restante[32];
+        formatea_duracion(restante, texto_restante, sizeof(texto_restante));
+        printf("%-28.28s %7d %5d %13lld %5.1f%% %10.0f %9s %10.4f %10.4f %10.4f %8.1f %s\n", r.nombre, r.pid, r.N,
+               (long long)r.paso, r.pasos_totales ? 100.0 * r.paso / r.pasos_totales : 0.0, r.pasos_por_segundo,
+               texto_restante, r.media_Ek, r.media_Ep, r.media_Ree, r.bytes_salida / 1e6, estado);
+        if (limpia && !vivo && remove(ruta) == 0) printf("  borrado %s\n", ruta);
+    }
+    closedir(d);
+    if (!trabajos) printf("(ningún trabajo)\n");
+    return trabajos;
+}
+
+int main(int argc, char *argv[]) {
+    const char *carpeta = carpeta_telemetria();
+    double cada = 0.0, parado = 60.0;
+    int limpia = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-limpia") == 0) limpia = 1;
+        else if (strcmp(argv[i], "-carpeta") == 0 && i + 1 < argc) carpeta = argv[++i];
+        else if (strcmp(argv[i], "-cada") == 0 && i + 1 < argc) cada = atof(argv[++i]);
+        else if (strcmp(argv[i], "-parado") == 0 && i + 1 < argc) parado = atof(argv[++i]);
+        else {
+            printf("Uso: monitor.exe [-carpeta %s] [-cada 0] [-parado 60] [-limpia]\n", CARPETA_TELEMETRIA);
+            return 1;
+        }
+    }
+    do {
+        muestra_trabajos(carpeta, parado, limpia);
+        if (cada > 0.0) {
+            printf("\n");
+            fflush(stdout);
+            usleep((useconds_t)(cada * 1e6));
+        }
+    } while (cada > 0.0);
+    return 0;
+}
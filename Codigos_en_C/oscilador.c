@@ -2,6 +2,10 @@
 #include "integracion.h"
 #include "funciones_oscilador.h"
 #include "random.h"
+#include "barrido.h"
+#include "reponderacion.h"
+#include "intercambio.h"
+#include "protocolos.h"
 #include <time.h>
 
 
@@ -11,6 +15,10 @@
 #define ANALISIS
 #define GRAFICAS
 
+//#define BARRIDO_ADAPTATIVO // CON FIXED: EN VEZ DE F_cte_vals, BARRIDO ADAPTATIVO DE FUERZAS (barrido.c)
+//#define INTERCAMBIO_REPLICAS // CON FIXED: F_cte_vals EN PARALELO CON INTERCAMBIO DE RÉPLICAS (intercambio.c)
+//#define TIRONES // CON FIXED: RAMPA DE FUERZA DE IDA Y VUELTA CON JARZYNSKI / CROOKS (protocolos.c)
+
 int main() {
     inicializa_PR(12456); // Inicializa el generador con semilla
 
@@ -30,6 +38,7 @@ int main() {
 
     // --- Conjunto de fuerzas constantes ---
     #ifdef FIXED
+    const int N_fijo = N_s[0];  // Con un extremo fijo se simula un solo tamaño de cadena
     int N_fuerzas = 15;
     double F_cte_vals[15] = {
         0.001, 0.00215443, 0.00464159, 0.01, 0.0215443,
@@ -48,13 +57,65 @@ int main() {
 
     // --- Bucle principal ---
     #ifdef FIXED
-    #ifdef SIMULACION
-    int N_actual = 4;  // Fijo si estás en modo FIXED
+    #ifdef BARRIDO_ADAPTATIVO
+    // Las fuerzas las elige el barrido y cada una se simula solo hasta el error objetivo
+    ParametrosBarrido pb = parametros_barrido_defecto();
+    pb.T_maximo = T_fisico;
+    char archivo_barrido[512];
+    ruta_barrido(K, archivo_barrido, sizeof(archivo_barrido));
+    barrido_fuerzas(&pb, kb, Temperatura, alfa, N_fijo, dt, m, K, archivo_barrido);
+    #elif defined(INTERCAMBIO_REPLICAS)
+    // Una réplica por fuerza, cada una en su hilo; las vecinas intercambian sus fuerzas (no las configuraciones)
+    ParametrosIntercambio pi = {INTERCAMBIO_FUERZA, N_fuerzas, F_cte_vals, 20.0, T_fisico, 0.3, 0.1};
+    char carpeta_intercambio[256];
+    ruta_intercambio(K, carpeta_intercambio, sizeof(carpeta_intercambio));
+    intercambio_replicas(&pi, kb, Temperatura, alfa, N_fijo, dt, m, K, 0.0, carpeta_intercambio, NULL);
+    #elif defined(TIRONES)
+    // Muchos tirones cortos en paralelo en vez de un barrido de fuerzas en equilibrio
+    Protocolo rampa = {PROTOCOLO_RAMPA, 50.0, 0.0, F_cte_vals[N_fuerzas - 1], 0.0, 0.0, 0.0, 0.0, 0.0, 0};
+    ParametrosTirones pt = {256, 8, 200, 20.0};
+    double beta = 1.0 / (kb * Temperatura);
+    char carpeta_tirones[256], ruta_tirones[512];
+    ruta_protocolos(K, carpeta_tirones, sizeof(carpeta_tirones));
+    Tirones *ida = ejecuta_tirones(&rampa, &pt, kb, Temperatura, alfa, N_fijo, dt, m, K);
+    rampa.invertido = 1;
+    Tirones *vuelta = ejecuta_tirones(&rampa, &pt, kb, Temperatura, alfa, N_fijo, dt, m, K);
+    if (ida && vuelta) {
+        snprintf(ruta_tirones, sizeof(ruta_tirones), "%s/tirones_ida.txt", carpeta_tirones);
+        escribe_tirones(ida, beta, ruta_tirones);
+        snprintf(ruta_tirones, sizeof(ruta_tirones), "%s/tirones_vuelta.txt", carpeta_tirones);
+        escribe_tirones(vuelta, beta, ruta_tirones);
+
+        double *W_ida = malloc(pt.n_tirones * sizeof(double));
+        double *W_vuelta = malloc(pt.n_tirones * sizeof(double));
+        if (W_ida && W_vuelta) {
+            for (int i = 0; i < pt.n_tirones; i++) {
+                W_ida[i] = ida->W[i * (pt.n_puntos + 1) + pt.n_puntos];
+                W_vuelta[i] = vuelta->W[i * (pt.n_puntos + 1) + pt.n_puntos];
+            }
+            double error_crooks;
+            double G_crooks = energia_libre_crooks(W_ida, pt.n_tirones, W_vuelta, pt.n_tirones, beta, &error_crooks);
+            printf("DeltaG(0 -> %.3f): Crooks %.6f +- %.6f, escrito en %s\n", F_cte_vals[N_fuerzas - 1],
+                   G_crooks, error_crooks, carpeta_tirones);
+        } else {
+            printf("No se pudo reservar memoria para los trabajos de Crooks (%d tirones)\n", pt.n_tirones);
+        }
+        free(W_ida);
+        free(W_vuelta);
+    }
+    libera_tirones(ida);
+    libera_tirones(vuelta);
+    #elif defined(SIMULACION)
+    int N_actual = N_fijo;
     printf("Simulando con N = %d\n", N_actual);
 
-    // Inicialización de posiciones y velocidades
-    double x_0[3 * N_actual];
-    double v_0[3 * N_actual];
+    // Inicialización de posiciones y velocidades (en el heap: N puede ser muy grande)
+    double *x_0 = malloc(3 * N_actual * sizeof(double));
+    double *v_0 = malloc(3 * N_actual * sizeof(double));
+    if (!x_0 || !v_0) {
+        printf("No se pudo reservar memoria para N = %d\n", N_actual);
+        return 1;
+    }
     for (int j = 0; j < N_actual; j++) {
         x_0[3*j]   = j;
         x_0[3*j+1] = 0.0;
@@ -74,12 +135,16 @@ int main() {
         double tiempo_total = (double)(fin - inicio) / CLOCKS_PER_SEC;
         escribir_tiempo_en_ultimo_archivo(tiempo_total, carpeta, "V");
     }
+    free(x_0);
+    free(v_0);
             #endif
     #ifdef ANALISIS
     procesar_trayectorias_carpeta(K,5);
     #endif
     #ifdef GRAFICAS
     generar_grafica(K);
+    // Curva densa <Ree>(F) reponderando las trayectorias de todas las fuerzas
+    generar_grafica_reponderada(K, kb, Temperatura, 5, 200);
     #endif
     #else
     // --- Caso sin FIXED ---
@@ -89,8 +154,12 @@ int main() {
         int N_actual = N_s[i];
         printf("Simulando con N = %d\n", N_actual);
 
-        double x_0[3 * N_actual];
-        double v_0[3 * N_actual];
+        double *x_0 = malloc(3 * N_actual * sizeof(double));
+        double *v_0 = malloc(3 * N_actual * sizeof(double));
+        if (!x_0 || !v_0) {
+            printf("No se pudo reservar memoria para N = %d\n", N_actual);
+            return 1;
+        }
         for (int j = 0; j < N_actual; j++) {
             x_0[3*j]   = j;
             x_0[3*j+1] = 0.0;
@@ -104,6 +173,8 @@ int main() {
 
         double tiempo_total = (double)(fin - inicio) / CLOCKS_PER_SEC;
         escribir_tiempo_en_ultimo_archivo(tiempo_total, carpeta, "V");
+        free(x_0);
+        free(v_0);
     }
         #endif
         #ifdef ANALISIS
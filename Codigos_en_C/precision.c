@@ -0,0 +1,287 @@
+#include "precision.h"
+
+
+#ifdef WLCM
+// Enlaces {u_x, u_y, u_z, 1/r} en float, propios de cada hilo como en flexion.c
+static _Thread_local float *buffer_enlaces_float = NULL;
+static _Thread_local int capacidad_enlaces_float = 0;
+
+static float *enlaces_float(int N) {
+    if (N > capacidad_enlaces_float) {
+        float *nuevo = realloc(buffer_enlaces_float, 4*(size_t)N*sizeof(float));
+        if (!nuevo) {
+            printf("No se pudo reservar memoria para los enlaces float (N = %d)\n", N);
+            exit(1);
+        }
+        buffer_enlaces_float = nuevo;
+        capacidad_enlaces_float = N;
+    }
+    return buffer_enlaces_float;
+}
+
+// triplete_flexion en float
+static inline void triplete_flexion_float(float k, float c0, const float e_i[4], const float e_ip1[4],
+                                          float f_im1[3], float f_ip1[3]) {
+    float mascara = (e_i[3] > 0.0f && e_ip1[3] > 0.0f) ? 1.0f : 0.0f;
+    float k_im1 = mascara * k * e_i[3];
+    float k_ip1 = mascara * k * e_ip1[3];
+    for (int c = 0; c < 3; c++) {
+        f_im1[c] = k_im1 * (e_ip1[c] - c0 * e_i[c]);
+        f_ip1[c] = k_ip1 * (e_i[c] - c0 * e_ip1[c]);
+    }
+}
+#endif
+
+
+const char *nombre_precision(TipoPrecision tipo) {
+    switch (tipo) {
+        case PRECISION_DOBLE:  return "doble";
+        case PRECISION_SIMPLE: return "simple";
+        case PRECISION_MIXTA:  return "mixta";
+        default:               return "desconocida";
+    }
+}
+
+
+#ifdef FIXED
+void Fuerza_verlet_float(int N, const float x[], float F[], float K, float F_cte)
+#else
+void Fuerza_verlet_float(int N, const float x[], float F[], float K)
+#endif
+{
+    for (int i = 0; i < 3*N; i++)
+        F[i] = 0.0f;
+
+    #ifdef WLCM
+    asegura_flexion();
+    float *enlaces = enlaces_float(N);
+    #endif
+    for (int i = 0; i < N - 1; i++) {
+        int i3 = 3*i;
+        int j3 = 3*(i+1);
+
+        float dx = x[j3]   - x[i3];
+        float dy = x[j3+1] - x[i3+1];
+        float dz = x[j3+2] - x[i3+2];
+
+        float r = sqrtf(dx*dx + dy*dy + dz*dz);
+        #ifdef WLCM
+        float inv = (r > 0.0f) ? 1.0f / r : 0.0f;
+        enlaces[4*i]   = dx * inv;
+        enlaces[4*i+1] = dy * inv;
+        enlaces[4*i+2] = dz * inv;
+        enlaces[4*i+3] = inv;
+        #endif
+        if (r == 0.0f) continue;
+
+        float fac = K * (r - (float)L_0) / r;
+
+        F[i3]   += fac * dx;
+        F[i3+1] += fac * dy;
+        F[i3+2] += fac * dz;
+
+        F[j3]   -= fac * dx;
+        F[j3+1] -= fac * dy;
+        F[j3+2] -= fac * dz;
+    }
+
+    #ifdef FIXED
+    F[3*(N-1) + 2] += F_cte;
+    F[0] = F[1] = F[2] = 0.0f;
+    #endif
+
+    #ifdef WLCM
+    float c0 = (float)parametros_flexion.cos_theta0;
+    for (int i = 1; i < N - 1; i++) {
+        float f_im1[3], f_ip1[3];
+        triplete_flexion_float((float)rigidez_flexion(i), c0, &enlaces[4*(i-1)], &enlaces[4*i], f_im1, f_ip1);
+        for (int c = 0; c < 3; c++) {
+            F[3*(i-1) + c] += f_im1[c];
+            F[3*i + c]     -= f_im1[c] + f_ip1[c];
+            F[3*(i+1) + c] += f_ip1[c];
+        }
+    }
+    #ifdef FIXED
+    F[0] = F[1] = F[2] = 0.0f;
+    #endif
+    #endif
+}
+
+
+#ifdef FIXED
+int crea_cadena_precision(CadenaPrecision *c, TipoPrecision tipo, int N, const double x_0[], const double v_0[],
+                          double dt, double m, double alfa, double kb, double Temperatura, double K, double F_cte)
+#else
+int crea_cadena_precision(CadenaPrecision *c, TipoPrecision tipo, int N, const double x_0[], const double v_0[],
+                          double dt, double m, double alfa, double kb, double Temperatura, double K)
+#endif
+{
+    memset(c, 0, sizeof(CadenaPrecision));
+    #ifdef VOLUMEN_EXCLUIDO
+    if (tipo != PRECISION_DOBLE) {
+        printf("Con VOLUMEN_EXCLUIDO solo está la precisión doble\n");
+        return 1;
+    }
+    #endif
+    c->tipo = tipo;
+    c->N = N;
+    c->dt = dt;
+    c->m = m;
+    c->K = K;
+    #ifdef FIXED
+    c->F_cte = F_cte;
+    #endif
+    c->a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    c->b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    c->sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+    int n = 3*N;
+
+    if (tipo == PRECISION_DOBLE) {
+        c->x = malloc(7*(size_t)n*sizeof(double));
+        if (!c->x) {
+            printf("No se pudo reservar memoria para la cadena (N = %d)\n", N);
+            return 1;
+        }
+        c->v     = c->x + n;
+        c->F     = c->x + 2*n;
+        c->x_aux = c->x + 3*n;
+        c->v_aux = c->x + 4*n;
+        c->F_aux = c->x + 5*n;
+        c->betta = c->x + 6*n;
+        memcpy(c->x, x_0, n*sizeof(double));
+        memcpy(c->v, v_0, n*sizeof(double));
+        #ifdef FIXED
+        Fuerza_verlet(N, c->x, c->F, K, F_cte);
+        #else
+        Fuerza_verlet(N, c->x, c->F, K);
+        #endif
+        return 0;
+    }
+
+    c->xf = malloc(5*(size_t)n*sizeof(float));
+    if (!c->xf) {
+        printf("No se pudo reservar memoria para la cadena (N = %d)\n", N);
+        return 1;
+    }
+    c->vf       = c->xf + n;
+    c->Ff       = c->xf + 2*n;
+    c->Ff_nuevo = c->xf + 3*n;
+    c->betta_f  = c->xf + 4*n;
+    c->c_x       = (float)(c->b * dt);
+    c->c_F       = (float)(c->b * dt * dt / (2 * m));
+    c->c_ruido_x = (float)(c->b * dt);
+    c->c_v       = (float)(dt / (2 * m));
+    c->c_ruido_v = (float)(c->b / m);
+
+    // La mixta guarda las posiciones respecto al centro de masas inicial
+    if (tipo == PRECISION_MIXTA) {
+        for (int j = 0; j < N; j++)
+            for (int k = 0; k < 3; k++) c->referencia[k] += x_0[3*j + k] / N;
+    }
+    for (int i = 0; i < n; i++) {
+        c->xf[i] = (float)(x_0[i] - c->referencia[i % 3]);
+        c->vf[i] = (float)v_0[i];
+    }
+    #ifdef FIXED
+    Fuerza_verlet_float(N, c->xf, c->Ff, (float)K, (float)F_cte);
+    #else
+    Fuerza_verlet_float(N, c->xf, c->Ff, (float)K);
+    #endif
+    return 0;
+}
+
+void libera_cadena_precision(CadenaPrecision *c) {
+    free(c->x);
+    free(c->xf);
+    c->x = NULL;
+    c->xf = NULL;
+}
+
+
+// Pasa el centro de masas de las posiciones float a la referencia double
+static void recentra(CadenaPrecision *c) {
+    int N = c->N;
+    double cm[3] = {0.0, 0.0, 0.0};
+    for (int j = 0; j < N; j++)
+        for (int k = 0; k < 3; k++) cm[k] += c->xf[3*j + k];
+    for (int k = 0; k < 3; k++) {
+        cm[k] /= N;
+        c->referencia[k] += cm[k];
+    }
+    for (int j = 0; j < N; j++)
+        for (int k = 0; k < 3; k++) c->xf[3*j + k] = (float)((double)c->xf[3*j + k] - cm[k]);
+    c->pasos_sin_recentrar = 0;
+}
+
+static void paso_float(CadenaPrecision *c) {
+    int n = 3*c->N;
+    float *x = c->xf, *v = c->vf, *F = c->Ff, *F_nuevo = c->Ff_nuevo, *betta = c->betta_f;
+    float a = (float)c->a;
+    gaussianas_float(&estado_PR_global, betta, n, (float)c->sigma);
+    #ifdef FIXED
+    // La primera partícula está fija: ni ruido ni velocidad (Fuerza_verlet_float anula su fuerza)
+    betta[0] = betta[1] = betta[2] = 0.0f;
+    v[0] = v[1] = v[2] = 0.0f;
+    #endif
+
+    for (int i = 0; i < n; i++)
+        x[i] += c->c_x*v[i] + c->c_F*F[i] + c->c_ruido_x*betta[i];
+
+    #ifdef FIXED
+    Fuerza_verlet_float(c->N, x, F_nuevo, (float)c->K, (float)c->F_cte);
+    #else
+    Fuerza_verlet_float(c->N, x, F_nuevo, (float)c->K);
+    #endif
+
+    for (int i = 0; i < n; i++)
+        v[i] = a*v[i] + c->c_v*(a*F[i] + F_nuevo[i]) + c->c_ruido_v*betta[i];
+
+    c->Ff = F_nuevo;
+    c->Ff_nuevo = F;
+}
+
+// Paso doble: el mismo esquema que verlet_trayectoria (misma trayectoria)
+static void paso_doble(CadenaPrecision *c) {
+    int n = 3*c->N;
+    for (int i = 0; i < n; i++) c->betta[i] = gaussian() * c->sigma;
+    #ifdef FIXED
+    un_paso_verlet(c->betta, c->b, c->a, c->N, c->x, c->x_aux, c->v, c->v_aux, c->F, c->F_aux,
+                   c->dt, c->m, Fuerza_verlet, c->K, c->F_cte);
+    #else
+    un_paso_verlet(c->betta, c->b, c->a, c->N, c->x, c->x_aux, c->v, c->v_aux, c->F, c->F_aux,
+                   c->dt, c->m, Fuerza_verlet, c->K);
+    #endif
+    double *tmp;
+    tmp = c->x; c->x = c->x_aux; c->x_aux = tmp;
+    tmp = c->v; c->v = c->v_aux; c->v_aux = tmp;
+    tmp = c->F; c->F = c->F_aux; c->F_aux = tmp;
+}
+
+void avanza_cadena_precision(CadenaPrecision *c, int pasos) {
+    for (int p = 0; p < pasos; p++) {
+        if (c->tipo == PRECISION_DOBLE) {
+            paso_doble(c);
+            continue;
+        }
+        paso_float(c);
+        if (c->tipo == PRECISION_MIXTA && ++c->pasos_sin_recentrar >= RECENTRADO_PRECISION) recentra(c);
+    }
+}
+
+void posiciones_cadena_precision(const CadenaPrecision *c, double x[]) {
+    int n = 3*c->N;
+    if (c->tipo == PRECISION_DOBLE) {
+        memcpy(x, c->x, n*sizeof(double));
+        return;
+    }
+    for (int i = 0; i < n; i++) x[i] = c->referencia[i % 3] + (double)c->xf[i];
+}
+
+void velocidades_cadena_precision(const CadenaPrecision *c, double v[]) {
+    int n = 3*c->N;
+    if (c->tipo == PRECISION_DOBLE) {
+        memcpy(v, c->v, n*sizeof(double));
+        return;
+    }
+    for (int i = 0; i < n; i++) v[i] = (double)c->vf[i];
+}
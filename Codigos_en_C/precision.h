@@ -0,0 +1,86 @@
+#pragma once
+
+#include "random.h"
+#include "funciones_oscilador.h"
+#include "integracion.h"
+#include "flexion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/**
+ * Integración GJF con precisión seleccionable para el estado y el kernel de fuerzas:
+ *  - PRECISION_DOBLE:  todo en double con un_paso_verlet + Fuerza_verlet (la referencia; misma
+ *                      trayectoria que verlet_trayectoria).
+ *  - PRECISION_SIMPLE: x, v, F y el ruido en float, con posiciones absolutas.
+ *  - PRECISION_MIXTA:  como la simple, pero las posiciones float son relativas a una referencia
+ *                      double que se recentra en el centro de masas cada RECENTRADO_PRECISION
+ *                      pasos, así que la cadena puede difundir sin perder bits en los enlaces.
+ * En float el ruido sale de gaussianas_float (dos gaussianas por pareja de enteros de 32 bits,
+ * de sobra para una mantisa de 24 bits) y los bucles de x y v ocupan la mitad de memoria y el
+ * doble de elementos por registro SIMD. Los observables se calculan en double a partir de
+ * posiciones_cadena_precision.
+ *
+ * El kernel float reproduce Fuerza_verlet (muelles, FIXED y WLCM); con VOLUMEN_EXCLUIDO solo
+ * está la precisión doble (la lista de vecinos es double).
+ */
+
+#define RECENTRADO_PRECISION 1000
+
+typedef enum {
+    PRECISION_DOBLE,
+    PRECISION_SIMPLE,
+    PRECISION_MIXTA,
+    N_PRECISIONES
+} TipoPrecision;
+
+typedef struct {
+    TipoPrecision tipo;
+    int N;
+    double dt, m, K, F_cte;
+    double a, b, sigma;
+
+    // Doble
+    double *x, *v, *F;
+    double *x_aux, *v_aux, *F_aux, *betta;
+
+    // Simple y mixta
+    float *xf, *vf, *Ff, *Ff_nuevo, *betta_f;
+    float c_x, c_F, c_ruido_x;  // b dt, b dt^2 / 2m, b dt
+    float c_v, c_ruido_v;       // dt / 2m, b / m
+    double referencia[3];       // Origen double de las posiciones float (0 en simple)
+    int pasos_sin_recentrar;
+} CadenaPrecision;
+
+// Nombre legible de la precisión
+const char *nombre_precision(TipoPrecision tipo);
+
+/**
+ * Prepara la cadena a partir de x_0, v_0 (double) y reserva sus buffers.
+ * @return 0 si todo va bien, 1 si no hay memoria o la precisión no está disponible.
+ */
+#ifdef FIXED
+int crea_cadena_precision(CadenaPrecision *c, TipoPrecision tipo, int N, const double x_0[], const double v_0[],
+                          double dt, double m, double alfa, double kb, double Temperatura, double K, double F_cte);
+#else
+int crea_cadena_precision(CadenaPrecision *c, TipoPrecision tipo, int N, const double x_0[], const double v_0[],
+                          double dt, double m, double alfa, double kb, double Temperatura, double K);
+#endif
+
+void libera_cadena_precision(CadenaPrecision *c);
+
+// Avanza 'pasos' pasos de GJF
+void avanza_cadena_precision(CadenaPrecision *c, int pasos);
+
+// Copia en double las posiciones y velocidades actuales
+void posiciones_cadena_precision(const CadenaPrecision *c, double x[]);
+void velocidades_cadena_precision(const CadenaPrecision *c, double v[]);
+
+// Fuerza_verlet en float (la del kernel de las precisiones simple y mixta)
+#ifdef FIXED
+void Fuerza_verlet_float(int N, const float x[], float F[], float K, float F_cte);
+#else
+void Fuerza_verlet_float(int N, const float x[], float F[], float K);
+#endif
@@ -0,0 +1,353 @@
+#include "protocolos.h"
+
+
+double parametro_protocolo(const Protocolo *p, double t) {
+    // Al redondear los pasos por punto, pasos*dt puede pasar de la duración: lambda se queda en el final
+    if (t > p->duracion) t = p->duracion;
+    if (t < 0.0) t = 0.0;
+    if (p->invertido) t = p->duracion - t;
+    switch (p->tipo) {
+    case PROTOCOLO_RAMPA:
+        return p->F_0 + (p->F_1 - p->F_0) * t / p->duracion;
+    case PROTOCOLO_OSCILANTE:
+        return p->F_0 + p->amplitud * sin(2.0 * PI * p->frecuencia * t);
+    case PROTOCOLO_VELOCIDAD:
+        return p->z_0 + p->velocidad * t;
+    }
+    return 0.0;
+}
+
+void libera_tirones(Tirones *t) {
+    if (!t) return;
+    free(t->t);
+    free(t->lambda);
+    free(t->W);
+    free(t->Ree);
+    free(t);
+}
+
+
+EstimacionJarzynski jarzynski_en(const Tirones *t, int punto, double beta) {
+    EstimacionJarzynski e;
+    memset(&e, 0, sizeof(e));
+    int n = t->n_tirones, columnas = t->n_puntos + 1;
+    if (n < 1 || punto < 0 || punto >= columnas) return e;
+
+    // Pesos exp(-beta W) relativos al mayor, para no desbordar
+    double maximo = -INFINITY, suma_W = 0.0, suma_W2 = 0.0;
+    for (int i = 0; i < n; i++) {
+        double W = t->W[i*columnas + punto];
+        maximo = fmax(maximo, -beta * W);
+        suma_W += W;
+        suma_W2 += W * W;
+    }
+    double s = 0.0, s2 = 0.0, s_Ree = 0.0;
+    for (int i = 0; i < n; i++) {
+        double peso = exp(-beta * t->W[i*columnas + punto] - maximo);
+        s += peso;
+        s2 += peso * peso;
+        s_Ree += peso * t->Ree[i*columnas + punto];
+    }
+
+    double media_peso = s / n;
+    double varianza_peso = fmax(s2 / n - media_peso * media_peso, 0.0);
+    e.G = -(maximo + log(media_peso)) / beta;
+    e.error = (n > 1) ? sqrt(varianza_peso / (n - 1)) / media_peso / beta : INFINITY;
+    e.W_medio = suma_W / n;
+    double varianza_W = (n > 1) ? fmax(suma_W2 - n * e.W_medio * e.W_medio, 0.0) / (n - 1) : 0.0;
+    e.W_desviacion = sqrt(varianza_W);
+    e.G_cumulantes = e.W_medio - 0.5 * beta * varianza_W;
+    e.n_efectivo = s * s / s2;
+    e.Ree = s_Ree / s;
+    return e;
+}
+
+
+// 1 / (1 + exp(x)) sin desbordar
+static double fermi(double x) {
+    if (x > 0.0) {
+        double e = exp(-x);
+        return e / (1.0 + e);
+    }
+    return 1.0 / (1.0 + exp(x));
+}
+
+// Diferencia entre los dos lados de la ecuación de Bennett (creciente en G)
+static double ecuacion_bennett(const double W_ida[], int n_ida, const double W_vuelta[], int n_vuelta,
+                               double beta, double M, double G) {
+    double ida = 0.0, vuelta = 0.0;
+    for (int i = 0; i < n_ida; i++) ida += fermi(M + beta * (W_ida[i] - G));
+    for (int j = 0; j < n_vuelta; j++) vuelta += fermi(-M + beta * (W_vuelta[j] + G));
+    return ida - vuelta;
+}
+
+double energia_libre_crooks(const double W_ida[], int n_ida, const double W_vuelta[], int n_vuelta,
+                            double beta, double *error) {
+    if (error) *error = NAN;
+    if (n_ida < 1 || n_vuelta < 1) return NAN;
+    double M = log((double)n_ida / n_vuelta);
+
+    // Intervalo que contiene la raíz: más allá de todos los trabajos la ecuación cambia de signo
+    double lo = INFINITY, hi = -INFINITY;
+    for (int i = 0; i < n_ida; i++) {
+        lo = fmin(lo, W_ida[i]);
+        hi = fmax(hi, W_ida[i]);
+    }
+    for (int j = 0; j < n_vuelta; j++) {
+        lo = fmin(lo, -W_vuelta[j]);
+        hi = fmax(hi, -W_vuelta[j]);
+    }
+    double margen = (40.0 + fabs(M)) / beta;
+    lo -= margen;
+    hi += margen;
+    for (int it = 0; it < 200 && hi - lo > 1e-12 * (1.0 + fabs(lo)); it++) {
+        double G = 0.5 * (lo + hi);
+        if (ecuacion_bennett(W_ida, n_ida, W_vuelta, n_vuelta, beta, M, G) > 0.0) hi = G;
+        else lo = G;
+    }
+    double G = 0.5 * (lo + hi);
+
+    if (error) {
+        double f = 0.0, f2 = 0.0, g = 0.0, g2 = 0.0;
+        for (int i = 0; i < n_ida; i++) {
+            double v = fermi(M + beta * (W_ida[i] - G));
+            f += v;
+            f2 += v * v;
+        }
+        for (int j = 0; j < n_vuelta; j++) {
+            double v = fermi(-M + beta * (W_vuelta[j] + G));
+            g += v;
+            g2 += v * v;
+        }
+        f /= n_ida; f2 /= n_ida; g /= n_vuelta; g2 /= n_vuelta;
+        double varianza = (f2 / (f * f) - 1.0) / n_ida + (g2 / (g * g) - 1.0) / n_vuelta;
+        *error = sqrt(fmax(varianza, 0.0)) / beta;
+    }
+    return G;
+}
+
+
+int escribe_tirones(const Tirones *t, double beta, const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        printf("No se pudo crear el archivo %s\n", ruta);
+        return 0;
+    }
+    fprintf(f, "# %d tirones, %d instantes, beta %.6f\n", t->n_tirones, t->n_puntos + 1, beta);
+    fprintf(f, "# t lambda W_medio W_desviacion G error G_cumulantes n_efectivo Ree\n");
+    for (int j = 0; j <= t->n_puntos; j++) {
+        EstimacionJarzynski e = jarzynski_en(t, j, beta);
+        fprintf(f, "%.6f %.6f %.6f %.6f %.6f %.6f %.6f %.1f %.6f\n", t->t[j], t->lambda[j], e.W_medio,
+                e.W_desviacion, e.G, e.error, e.G_cumulantes, e.n_efectivo, e.Ree);
+    }
+    fclose(f);
+    return 1;
+}
+
+
+void ruta_protocolos(double K, char *carpeta, size_t tam) {
+    #ifdef WLCM
+    snprintf(carpeta, tam, "Resultados_simulacion/WLCM/%.1f/FIJOS/PROTOCOLOS", K);
+    #else
+    snprintf(carpeta, tam, "Resultados_simulacion/%.1f/FIJOS/PROTOCOLOS", K);
+    #endif
+    crea_carpetas(carpeta);
+}
+
+
+#ifdef FIXED
+
+typedef struct {
+    const Protocolo *p;
+    const ParametrosTirones *pt;
+    int N;
+    double kb, Temperatura, dt, m, K;
+    double a, b, sigma;
+    long long pasos, pasos_punto, pasos_equilibrado;
+    EstadoPR *generadores;      // [tiron]
+    Tirones *res;
+    int siguiente;              // Siguiente tirón sin asignar
+    pthread_mutex_t cerrojo;
+} ContextoTirones;
+
+typedef struct {
+    ContextoTirones *c;
+    double *memoria;
+    double *x, *v, *F;
+    double *x_nuevo, *v_nuevo, *F_nuevo;
+    double *betta;
+    pthread_t hilo;
+} EspacioTiron;
+
+// Rigidez de la trampa del hilo (Fuerza_verlet solo recibe un parámetro, el centro de la trampa)
+static _Thread_local double k_trampa_hilo = 0.0;
+
+static void fuerza_trampa(int N, double x[], double F[], double K, double lambda) {
+    Fuerza_verlet(N, x, F, K, 0.0);
+    F[3*(N-1)+2] += k_trampa_hilo * (lambda - (x[3*(N-1)+2] - x[2]));
+}
+
+// Parte de H que depende de lambda, con z = Ree_z
+static double hamiltoniano_lambda(const Protocolo *p, double z, double lambda) {
+    if (p->tipo == PROTOCOLO_VELOCIDAD) return 0.5 * p->k_trampa * (z - lambda) * (z - lambda);
+    return -lambda * z;
+}
+
+static void paso_tiron(ContextoTirones *c, EspacioTiron *e, EstadoPR *rng, double lambda) {
+    int N = c->N;
+    for (int i = 0; i < 3*N; i++) e->betta[i] = gaussian_r(rng) * c->sigma;
+    un_paso_verlet(e->betta, c->b, c->a, N, e->x, e->x_nuevo, e->v, e->v_nuevo, e->F, e->F_nuevo, c->dt, c->m,
+                   c->p->tipo == PROTOCOLO_VELOCIDAD ? fuerza_trampa : Fuerza_verlet, c->K, lambda);
+
+    double *tmp;
+    tmp = e->x; e->x = e->x_nuevo; e->x_nuevo = tmp;
+    tmp = e->v; e->v = e->v_nuevo; e->v_nuevo = tmp;
+    tmp = e->F; e->F = e->F_nuevo; e->F_nuevo = tmp;
+}
+
+// Equilibra en lambda(0) desde la cadena recta y ejecuta el protocolo, guardando W y Ree_z
+static void tiron(ContextoTirones *c, EspacioTiron *e, int i) {
+    int N = c->N;
+    const Protocolo *p = c->p;
+    EstadoPR *rng = &c->generadores[i];
+    int columnas = c->pt->n_puntos + 1;
+    double *W = &c->res->W[(size_t)i*columnas];
+    double *Ree = &c->res->Ree[(size_t)i*columnas];
+
+    for (int j = 0; j < N; j++) {
+        e->x[3*j] = j * L_0;
+        e->x[3*j+1] = e->x[3*j+2] = 0.0;
+        e->v[3*j] = e->v[3*j+1] = e->v[3*j+2] = 0.0;
+    }
+    double lambda = parametro_protocolo(p, 0.0);
+    if (p->tipo == PROTOCOLO_VELOCIDAD) fuerza_trampa(N, e->x, e->F, c->K, lambda);
+    else Fuerza_verlet(N, e->x, e->F, c->K, lambda);
+    for (long long paso = 0; paso < c->pasos_equilibrado; paso++) paso_tiron(c, e, rng, lambda);
+
+    double trabajo = 0.0;
+    W[0] = 0.0;
+    Ree[0] = e->x[3*(N-1)+2] - e->x[2];
+    for (long long paso = 1; paso <= c->pasos; paso++) {
+        double lambda_nuevo = parametro_protocolo(p, paso * c->dt);
+        double z = e->x[3*(N-1)+2] - e->x[2];
+        trabajo += hamiltoniano_lambda(p, z, lambda_nuevo) - hamiltoniano_lambda(p, z, lambda);
+        lambda = lambda_nuevo;
+        paso_tiron(c, e, rng, lambda);
+        if (paso % c->pasos_punto == 0) {
+            int j = (int)(paso / c->pasos_punto);
+            W[j] = trabajo;
+            Ree[j] = e->x[3*(N-1)+2] - e->x[2];
+        }
+    }
+}
+
+static void *bucle_tirones(void *arg) {
+    EspacioTiron *e = arg;
+    ContextoTirones *c = e->c;
+    k_trampa_hilo = c->p->k_trampa;
+    for (;;) {
+        pthread_mutex_lock(&c->cerrojo);
+        int i = c->siguiente++;
+        pthread_mutex_unlock(&c->cerrojo);
+        if (i >= c->pt->n_tirones) break;
+        tiron(c, e, i);
+    }
+    #ifdef VOLUMEN_EXCLUIDO
+    libera_vecinos();  // La lista de vecinos es propia del hilo
+    #endif
+    return NULL;
+}
+
+Tirones *ejecuta_tirones(const Protocolo *p, const ParametrosTirones *pt, double kb, double Temperatura,
+                         double alfa, int N, double dt, double m, double K) {
+    if (pt->n_tirones < 1 || pt->n_puntos < 1 || !(p->duracion > 0.0) ||
+        (p->tipo == PROTOCOLO_VELOCIDAD && !(p->k_trampa > 0.0))) {
+        printf("Parámetros del protocolo no válidos\n");
+        return NULL;
+    }
+    #ifdef WLCM
+    printf("Con WLCM la flexión no tiene energía: ni Jarzynski ni Crooks son válidos\n");
+    return NULL;
+    #endif
+    int n_hilos = pt->n_hilos < 1 ? 1 : pt->n_hilos;
+    if (n_hilos > pt->n_tirones) n_hilos = pt->n_tirones;
+    int columnas = pt->n_puntos + 1;
+
+    ContextoTirones c;
+    memset(&c, 0, sizeof(c));
+    c.p = p;
+    c.pt = pt;
+    c.N = N;
+    c.kb = kb;
+    c.Temperatura = Temperatura;
+    c.dt = dt;
+    c.m = m;
+    c.K = K;
+    c.a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    c.b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    c.sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+    c.pasos_punto = (long long)(p->duracion / dt / pt->n_puntos + 0.5);
+    if (c.pasos_punto < 1) c.pasos_punto = 1;
+    c.pasos = c.pasos_punto * pt->n_puntos;
+    c.pasos_equilibrado = (long long)(pt->T_equilibrado / dt + 0.5);
+
+    Tirones *res = calloc(1, sizeof(Tirones));
+    c.generadores = malloc(pt->n_tirones*sizeof(EstadoPR));
+    EspacioTiron *espacios = calloc(n_hilos, sizeof(EspacioTiron));
+    int ok = res && c.generadores && espacios;
+    if (ok) {
+        res->n_tirones = pt->n_tirones;
+        res->n_puntos = pt->n_puntos;
+        res->t = malloc(columnas*sizeof(double));
+        res->lambda = malloc(columnas*sizeof(double));
+        res->W = malloc((size_t)pt->n_tirones*columnas*sizeof(double));
+        res->Ree = malloc((size_t)pt->n_tirones*columnas*sizeof(double));
+        ok = res->t && res->lambda && res->W && res->Ree;
+    }
+    for (int h = 0; ok && h < n_hilos; h++) {
+        EspacioTiron *e = &espacios[h];
+        e->c = &c;
+        e->memoria = malloc(7*3*(size_t)N*sizeof(double));
+        if (!e->memoria) {
+            ok = 0;
+            break;
+        }
+        e->x       = e->memoria;
+        e->v       = e->memoria + 3*N;
+        e->F       = e->memoria + 6*N;
+        e->x_nuevo = e->memoria + 9*N;
+        e->v_nuevo = e->memoria + 12*N;
+        e->F_nuevo = e->memoria + 15*N;
+        e->betta   = e->memoria + 18*N;
+    }
+    if (!ok) {
+        printf("No se pudo reservar memoria para %d tirones (N = %d)\n", pt->n_tirones, N);
+    } else {
+        c.res = res;
+        for (int j = 0; j < columnas; j++) {
+            res->t[j] = j * c.pasos_punto * dt;
+            res->lambda[j] = parametro_protocolo(p, res->t[j]);
+        }
+        // Un generador por tirón, en orden: el resultado no depende del reparto entre hilos
+        for (int i = 0; i < pt->n_tirones; i++) inicializa_PR_desde(&c.generadores[i], &estado_PR_global);
+
+        pthread_mutex_init(&c.cerrojo, NULL);
+        int lanzados = 1;
+        for (; lanzados < n_hilos; lanzados++)
+            if (pthread_create(&espacios[lanzados].hilo, NULL, bucle_tirones, &espacios[lanzados]) != 0) break;
+        bucle_tirones(&espacios[0]);  // El hilo principal también tira
+        for (int h = 1; h < lanzados; h++) pthread_join(espacios[h].hilo, NULL);
+        pthread_mutex_destroy(&c.cerrojo);
+    }
+
+    for (int h = 0; espacios && h < n_hilos; h++) free(espacios[h].memoria);
+    free(espacios);
+    free(c.generadores);
+    if (!ok) {
+        libera_tirones(res);
+        return NULL;
+    }
+    return res;
+}
+
+#endif
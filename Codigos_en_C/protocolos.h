@@ -0,0 +1,106 @@
+#pragma once
+
+#include "integracion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+
+/**
+ * Protocolos fuera del equilibrio y energías libres por Jarzynski / Crooks.
+ *
+ * Un protocolo mueve un parámetro lambda(t) durante un tiempo 'duracion':
+ *  - PROTOCOLO_RAMPA:      fuerza F(t) = F_0 + (F_1 - F_0) t / duracion sobre la última partícula.
+ *  - PROTOCOLO_OSCILANTE:  fuerza F(t) = F_0 + amplitud sin(2 pi frecuencia t).
+ *  - PROTOCOLO_VELOCIDAD:  trampa armónica k_trampa/2 (Ree_z - lambda)^2 con lambda = z_0 + v t.
+ * Con fuerza, H = U - F Ree_z; con trampa, H = U + k_trampa/2 (Ree_z - lambda)^2. El trabajo se
+ * acumula en cada paso como H(x, lambda_nuevo) - H(x, lambda), que cumple la igualdad de
+ * Jarzynski <exp(-beta W)> = exp(-beta DeltaG) sin error de discretización en W.
+ *
+ * Cada tirón es independiente: su propio generador (sacado del global en orden, así que el
+ * resultado no depende del número de hilos), su equilibrado en lambda(0) desde la cadena recta y
+ * el protocolo. Los tirones se reparten entre hilos.
+ *
+ * Con los trabajos W_t en n_puntos + 1 instantes se estima en cada lambda(t):
+ *  - DeltaG(t) = -kT ln <exp(-beta W_t)>, su error (método delta) y el de cumulantes
+ *    <W> - beta var(W) / 2, con el tamaño efectivo de Kish de los pesos exp(-beta W_t).
+ *  - <Ree>_lambda(t) de equilibrio reponderando Ree_z(t) con exp(-beta W_t) (Hummer-Szabo): con
+ *    una rampa de fuerza da la curva fuerza-extensión entera en un solo lote de tirones.
+ * Con tirones de ida y de vuelta (protocolo invertido) energia_libre_crooks da DeltaG por el
+ * cociente de aceptación de Bennett, el estimador de máxima verosimilitud de Crooks.
+ * Ambas igualdades suponen una dinámica que muestrea exp(-beta H); la flexión de flexion.c no
+ * deriva de una energía, así que con WLCM ejecuta_tirones no tira.
+ */
+
+typedef enum {
+    PROTOCOLO_RAMPA,
+    PROTOCOLO_OSCILANTE,
+    PROTOCOLO_VELOCIDAD
+} TipoProtocolo;
+
+typedef struct {
+    TipoProtocolo tipo;
+    double duracion;
+    double F_0, F_1;                 // Rampa: fuerzas inicial y final (oscilante: F_0 es la media)
+    double amplitud, frecuencia;     // Oscilante
+    double k_trampa, z_0, velocidad; // Velocidad constante
+    int invertido;                   // 1: lambda(duracion - t), para Crooks
+} Protocolo;
+
+typedef struct {
+    int n_tirones;
+    int n_hilos;
+    int n_puntos;                    // Instantes guardados, además de t = 0
+    double T_equilibrado;            // Equilibrado de cada tirón en lambda(0)
+} ParametrosTirones;
+
+typedef struct {
+    int n_tirones, n_puntos;
+    double *t, *lambda;              // [punto], n_puntos + 1
+    double *W;                       // [tiron*(n_puntos+1) + punto] Trabajo acumulado
+    double *Ree;                     // [tiron*(n_puntos+1) + punto] Ree_z
+} Tirones;
+
+typedef struct {
+    double G, error;                 // Jarzynski y su error
+    double G_cumulantes;             // Desarrollo en cumulantes hasta segundo orden
+    double W_medio, W_desviacion;
+    double n_efectivo;               // Tamaño efectivo de Kish de los pesos exp(-beta W)
+    double Ree;                      // <Ree_z> de equilibrio en lambda(t) (reponderado)
+} EstimacionJarzynski;
+
+// lambda(t): fuerza (rampa, oscilante) o centro de la trampa (velocidad), con t recortado a [0, duracion]
+double parametro_protocolo(const Protocolo *p, double t);
+
+void libera_tirones(Tirones *t);
+
+// Estimaciones en el instante 'punto' (0..n_puntos)
+EstimacionJarzynski jarzynski_en(const Tirones *t, int punto, double beta);
+
+/**
+ * DeltaG de ida por Bennett (BAR) con trabajos de ida W_ida y de vuelta W_vuelta.
+ * @param error  Salida: error estadístico (puede ser NULL).
+ * @return DeltaG, o NAN si no hay trabajos de los dos sentidos.
+ */
+double energia_libre_crooks(const double W_ida[], int n_ida, const double W_vuelta[], int n_vuelta,
+                            double beta, double *error);
+
+/**
+ * Escribe "t lambda <W> desviacion G error G_cumulantes n_efectivo Ree" por instante.
+ * @return 1 si se ha escrito, 0 si no.
+ */
+int escribe_tirones(const Tirones *t, double beta, const char *ruta);
+
+// Carpeta PROTOCOLOS junto a las trayectorias de K (crea las carpetas)
+void ruta_protocolos(double K, char *carpeta, size_t tam);
+
+#ifdef FIXED
+/**
+ * Ejecuta los tirones del protocolo (con FIXED).
+ * @return Los trabajos y Ree_z en cada instante (liberar con libera_tirones), o NULL si falla.
+ */
+Tirones *ejecuta_tirones(const Protocolo *p, const ParametrosTirones *pt, double kb, double Temperatura,
+                         double alfa, int N, double dt, double m, double K);
+#endif
@@ -1,38 +1,53 @@
-#include <stdlib.h>
-#include <math.h>
-#include <time.h>
-#include <stdio.h>
-#include <dirent.h>
-#define PI 3.14159265358979323846
+#include "random.h"
+#include <string.h>
 
 
 
 // Variables que hay que definir para Parisi-Rapuano
 #define NormRANu (2.3283063671E-10F)
-unsigned int irr[256];
-unsigned int ir1;
-unsigned char ind_ran,ig1,ig2,ig3;
 
+// Estado global usado por fran() y gaussian()
+EstadoPR estado_PR_global;
+
+// Constantes de Philox4x32 (multiplicadores y pasos de la clave de Random123)
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define RONDAS_PHILOX 10
+#define BLOQUE_CONTADOR 64              // Parejas por bloque en gaussianas_contador
+
+RuidoContador ruido_contador_global;
+
+
+// Devuelve el siguiente entero de 32 bits de un generador Parisi-Rapuano
+unsigned int iran_r(EstadoPR *e)
+{
+    e->ig1 = (e->ind_ran - 24) & 255; // Asegura que el índice esté en [0, 255]
+    e->ig2 = (e->ind_ran - 55) & 255; // Asegura que el índice esté en [0, 255]
+    e->ig3 = (e->ind_ran - 61) & 255; // Asegura que el índice esté en [0, 255]
+    e->irr[e->ind_ran] = e->irr[e->ig1] + e->irr[e->ig2];
+    e->ir1 = (e->irr[e->ind_ran] ^ e->irr[e->ig3]);
+    e->ind_ran = (e->ind_ran + 1) & 255; // Incrementa y asegura que esté en [0, 255]
+    return e->ir1;
+}
+
+// Número aleatorio uniforme en (0,1) de un generador concreto
+double fran_r(EstadoPR *e)
+{
+    return iran_r(e) * (double)NormRANu; // Asegura que el cálculo sea en double
+}
 
 //Esta función devuelve un numero aleatorio uniforme en (0,1)
 double fran(void) // Cambiado a double
 {
-    double r; // Cambiado a double
-    ig1 = (ind_ran - 24) & 255; // Asegura que el índice esté en [0, 255]
-    ig2 = (ind_ran - 55) & 255; // Asegura que el índice esté en [0, 255]
-    ig3 = (ind_ran - 61) & 255; // Asegura que el índice esté en [0, 255]
-    irr[ind_ran] = irr[ig1] + irr[ig2];
-    ir1 = (irr[ind_ran] ^ irr[ig3]);
-    ind_ran = (ind_ran + 1) & 255; // Incrementa y asegura que esté en [0, 255]
-    r = ir1 * (double)NormRANu; // Asegura que el cálculo sea en double
-    return r;
+    return fran_r(&estado_PR_global);
 }
-void inicializa_PR(int SEMILLA)
+
+void inicializa_PR_r(EstadoPR *e, int SEMILLA)
 {
     int INI,FACTOR,SUM,i;
 
-    srand(SEMILLA);
-
     INI=SEMILLA;
     FACTOR=67397;
     SUM=7364893;
@@ -40,22 +55,128 @@ void inicializa_PR(int SEMILLA)
     for(i=0;i<256;i++)
     {
         INI=(INI*FACTOR+SUM);
-        irr[i]=INI;
+        e->irr[i]=INI;
     }
-    ind_ran=ig1=ig2=ig3=0;
+    e->ind_ran=e->ig1=e->ig2=e->ig3=0;
 }
 
-// Función que genera un número aleatorio N(0,1) con Box-Muller
-double gaussian() {
+void inicializa_PR(int SEMILLA)
+{
+    srand(SEMILLA);
+    inicializa_PR_r(&estado_PR_global, SEMILLA);
+}
+
+/**
+ * Inicializa un generador hijo con 256 palabras sacadas de un generador madre, de forma que
+ * varios hilos o réplicas tengan secuencias independientes a partir de una sola semilla.
+ */
+void inicializa_PR_desde(EstadoPR *hijo, EstadoPR *madre)
+{
+    for (int i = 0; i < 256; i++)
+        hijo->irr[i] = iran_r(madre);
+    hijo->ir1 = 0;
+    hijo->ind_ran = hijo->ig1 = hijo->ig2 = hijo->ig3 = 0;
+}
+
+// N(0,1) con Box-Muller a partir de un generador concreto
+double gaussian_r(EstadoPR *e) {
     double u1, u2;
     do {
-        u1 = fran();
+        u1 = fran_r(e);
     } while (u1 <= 1e-10); // evitamos log(0)
-    u2 = fran();
+    u2 = fran_r(e);
 
     return sqrt(-2.0 * log(u1)) * cos(2.0 *PI * u2);
 }
 
+// Función que genera un número aleatorio N(0,1) con Box-Muller
+double gaussian() {
+    return gaussian_r(&estado_PR_global);
+}
+
+void gaussianas_float(EstadoPR *e, float out[], int n, float sigma) {
+    for (int i = 0; i < n; i += 2) {
+        // (iran + 1/2) / 2^32 está en (0, 1): nunca log(0)
+        float u1 = ((float)iran_r(e) + 0.5f) * NormRANu;
+        float u2 = ((float)iran_r(e) + 0.5f) * NormRANu;
+        float r = sigma * sqrtf(-2.0f * logf(u1));
+        float angulo = 2.0f * (float)PI * u2;
+        out[i] = r * cosf(angulo);
+        if (i + 1 < n) out[i+1] = r * sinf(angulo);
+    }
+}
+
+static inline void ronda_philox(uint32_t c[4], uint32_t k0, uint32_t k1) {
+    uint64_t p0 = (uint64_t)PHILOX_M0 * c[0];
+    uint64_t p1 = (uint64_t)PHILOX_M1 * c[2];
+    uint32_t c1 = c[1], c3 = c[3];
+    c[0] = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+    c[1] = (uint32_t)p1;
+    c[2] = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+    c[3] = (uint32_t)p0;
+}
+
+void philox4x32_10(const uint32_t contador[4], const uint32_t clave[2], uint32_t salida[4]) {
+    uint32_t c[4] = {contador[0], contador[1], contador[2], contador[3]};
+    uint32_t k0 = clave[0], k1 = clave[1];
+    for (int ronda = 0; ronda < RONDAS_PHILOX; ronda++) {
+        if (ronda) {
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        ronda_philox(c, k0, k1);
+    }
+    memcpy(salida, c, sizeof(c));
+}
+
+void inicializa_ruido_contador(RuidoContador *r, uint64_t semilla, uint32_t replica) {
+    r->clave[0] = (uint32_t)semilla;
+    r->clave[1] = (uint32_t)(semilla >> 32);
+    r->replica = replica;
+    r->paso = 0;
+}
+
+void inicializa_ruido_contador_desde(RuidoContador *r, EstadoPR *madre, uint32_t replica) {
+    uint64_t alta = iran_r(madre);
+    inicializa_ruido_contador(r, alta << 32 | iran_r(madre), replica);
+}
+
+// Las dos uniformes de la pareja k: u1 en (0, 1] (nunca log(0)) y u2 en [0, 1)
+static inline void uniformes_contador(const RuidoContador *r, uint32_t k, double *u1, double *u2) {
+    uint32_t c[4] = {k, r->replica, (uint32_t)r->paso, (uint32_t)(r->paso >> 32)}, w[4];
+    philox4x32_10(c, r->clave, w);
+    *u1 = (double)((((uint64_t)w[0] << 32 | w[1]) >> 11) + 1) * 0x1p-53;
+    *u2 = (double)(((uint64_t)w[2] << 32 | w[3]) >> 11) * 0x1p-53;
+}
+
+double gaussiana_contador(const RuidoContador *r, uint32_t indice) {
+    double u1, u2;
+    uniformes_contador(r, indice >> 1, &u1, &u2);
+    double radio = sqrt(-2.0 * log(u1));
+    double angulo = 2.0 * PI * u2;
+    return indice & 1 ? radio * sin(angulo) : radio * cos(angulo);
+}
+
+void gaussianas_contador(const RuidoContador *r, uint32_t inicio, int n, double sigma, double out[]) {
+    // Por bloques: primero todos los Philox (enteros) y luego todas las transformaciones
+    double radio[BLOQUE_CONTADOR], angulo[BLOQUE_CONTADOR];
+    uint32_t fin = inicio + (uint32_t)n;
+    for (uint32_t k0 = inicio >> 1; k0 <= (fin - 1) >> 1 && n > 0; k0 += BLOQUE_CONTADOR) {
+        uint32_t k_fin = (fin - 1) >> 1;
+        int parejas = k_fin - k0 + 1 < BLOQUE_CONTADOR ? (int)(k_fin - k0 + 1) : BLOQUE_CONTADOR;
+        for (int j = 0; j < parejas; j++) uniformes_contador(r, k0 + j, &radio[j], &angulo[j]);
+        for (int j = 0; j < parejas; j++) {
+            radio[j] = sqrt(-2.0 * log(radio[j]));
+            angulo[j] = 2.0 * PI * angulo[j];
+        }
+        for (int j = 0; j < parejas; j++) {
+            uint32_t par = 2*(k0 + j), impar = par + 1;
+            if (par >= inicio && par < fin) out[par - inicio] = sigma * (radio[j] * cos(angulo[j]));
+            if (impar >= inicio && impar < fin) out[impar - inicio] = sigma * (radio[j] * sin(angulo[j]));
+        }
+    }
+}
+
 //Función histograma 1D
 /** 
  * @param H     Puntero al array donde se almacenará el histograma (debe tener tamaño Thist).
@@ -97,101 +218,3 @@ void histogram (double *H, int N, double *data, int Thist, double *max, double *
         H[i]=H[i]* normalization_factor;
     }
 }
-
-// Función principal de procesamiento
-void generar_histogramas(const char *carpeta_in, 
-                         const char *carpeta_out_vel, 
-                         const char *carpeta_out_pos, 
-                         const char *prefijo, 
-                         int bins) {
-    DIR *dir;
-    struct dirent *ent;
-
-    dir = opendir(carpeta_in);
-    if (!dir) {
-        perror("No se pudo abrir la carpeta de entrada");
-        return;
-    }
-
-    while ((ent = readdir(dir)) != NULL) {
-        if (strncmp(ent->d_name, prefijo, strlen(prefijo)) == 0 && strstr(ent->d_name, ".txt")) {
-            // Ruta al archivo de entrada
-            char ruta_in[512];
-            snprintf(ruta_in, sizeof(ruta_in), "%s/%s", carpeta_in, ent->d_name);
-
-            FILE *fin = fopen(ruta_in, "r");
-            if (!fin) {
-                perror("No se pudo abrir archivo de entrada");
-                continue;
-            }
-
-            char linea[512];
-            // saltar la primera línea
-            if (!fgets(linea, sizeof(linea), fin)) {
-                fclose(fin);
-                continue;
-            }
-
-            // reservar memoria dinámica para datos
-            int capacidad = 1000, N = 0;
-            double *posiciones = malloc(capacidad * sizeof(double));
-            double *velocidades = malloc(capacidad * sizeof(double));
-
-            while (fgets(linea, sizeof(linea), fin)) {
-                double c1, pos, vel, c4, c5, c6;
-                if (sscanf(linea, "%lf %lf %lf %lf %lf %lf", &c1, &pos, &vel, &c4, &c5, &c6) == 6) {
-                    if (N >= capacidad) {
-                        capacidad *= 2;
-                        posiciones = realloc(posiciones, capacidad * sizeof(double));
-                        velocidades = realloc(velocidades, capacidad * sizeof(double));
-                    }
-                    posiciones[N] = pos;
-                    velocidades[N] = vel;
-                    N++;
-                }
-            }
-            fclose(fin);
-
-            // arrays para histogramas
-            double *H_pos = malloc(bins * sizeof(double));
-            double *H_vel = malloc(bins * sizeof(double));
-
-            double min_p, max_p, delta_p;
-            double min_v, max_v, delta_v;
-
-            histogram(H_pos, N, posiciones, bins, &max_p, &min_p, &delta_p);
-            histogram(H_vel, N, velocidades, bins, &max_v, &min_v, &delta_v);
-
-            // crear archivos de salida
-            char ruta_pos[512], ruta_vel[512];
-            snprintf(ruta_pos, sizeof(ruta_pos), "%s/%s", carpeta_out_pos, ent->d_name);
-            snprintf(ruta_vel, sizeof(ruta_vel), "%s/%s", carpeta_out_vel, ent->d_name);
-
-            FILE *fpos = fopen(ruta_pos, "w");
-            FILE *fvel = fopen(ruta_vel, "w");
-
-            if (fpos) {
-                for (int i = 0; i < bins; i++) {
-                    double x_centro = min_p + (i + 0.5) * delta_p;
-                    fprintf(fpos, "%lf %lf\n", x_centro, H_pos[i]);
-                }
-                fclose(fpos);
-            }
-
-            if (fvel) {
-                for (int i = 0; i < bins; i++) {
-                    double v_centro = min_v + (i + 0.5) * delta_v;
-                    fprintf(fvel, "%lf %lf\n", v_centro, H_vel[i]);
-                }
-                fclose(fvel);
-            }
-
-
-            free(posiciones);
-            free(velocidades);
-            free(H_pos);
-            free(H_vel);
-        }
-    }
-    closedir(dir);
-}
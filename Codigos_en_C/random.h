@@ -4,9 +4,20 @@
 #include <math.h>
 #include <time.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #define PI 3.14159265358979323846
 
+// Estado de un generador Parisi-Rapuano (uno por hilo o réplica)
+typedef struct {
+    unsigned int irr[256];
+    unsigned int ir1;
+    unsigned char ind_ran, ig1, ig2, ig3;
+} EstadoPR;
+
+// Generador global que usan fran() y gaussian()
+extern EstadoPR estado_PR_global;
+
 // Devuelve un número aleatorio uniforme en (0,1)
 double fran(void);
 
@@ -16,12 +27,52 @@ void inicializa_PR(int SEMILLA);
 // Genera un número aleatorio N(0,1) con Box-Muller
 double gaussian(void);
 
+// Versiones con estado explícito
+unsigned int iran_r(EstadoPR *e);
+double fran_r(EstadoPR *e);
+double gaussian_r(EstadoPR *e);
+void inicializa_PR_r(EstadoPR *e, int SEMILLA);
+void inicializa_PR_desde(EstadoPR *hijo, EstadoPR *madre);
+
+/**
+ * Rellena out[0..n) con N(0, sigma^2) en float. Cada pareja de enteros de 32 bits da dos
+ * gaussianas (Box-Muller con seno y coseno), así que cuesta la mitad de llamadas que gaussian_r.
+ */
+void gaussianas_float(EstadoPR *e, float out[], int n, float sigma);
+
+/**
+ * Ruido por contador (Philox4x32-10, Salmon et al. 2011): la gaussiana número 'indice' del paso
+ * 'paso' es una función pura de (clave, replica, paso, indice), sin estado que avance. Así el
+ * ruido de cada grado de libertad no depende del orden en que se recorren ni de cómo se
+ * reparten entre hilos, y un núcleo optimizado se puede comparar bit a bit con el de referencia.
+ *
+ * Contador de Philox: (indice/2, replica, paso bajo, paso alto). Los cuatro enteros de salida dan
+ * dos uniformes de 53 bits y Box-Muller las gaussianas 2k (coseno) y 2k+1 (seno). La gaussiana
+ * sale igual pedida sola (gaussiana_contador) o en bloque (gaussianas_contador).
+ * El índice de la componente c de la partícula j es 3j + c.
+ */
+typedef struct {
+    uint32_t clave[2];
+    uint32_t replica;
+    uint64_t paso;                      // Paso en curso: lo pone quien integra
+} RuidoContador;
+
+// Ruido por contador de verlet_trayectoria y del paso fusionado (con RUIDO_CONTADOR)
+extern RuidoContador ruido_contador_global;
+
+// Una ronda completa de Philox4x32-10
+void philox4x32_10(const uint32_t contador[4], const uint32_t clave[2], uint32_t salida[4]);
+
+void inicializa_ruido_contador(RuidoContador *r, uint64_t semilla, uint32_t replica);
+
+// La semilla sale de dos enteros del generador Parisi-Rapuano: inicializa_PR sigue decidiendo el ruido
+void inicializa_ruido_contador_desde(RuidoContador *r, EstadoPR *madre, uint32_t replica);
+
+// Gaussiana N(0,1) número 'indice' del paso r->paso
+double gaussiana_contador(const RuidoContador *r, uint32_t indice);
+
+// out[k] = sigma * gaussiana_contador(r, inicio + k) para k en [0, n)
+void gaussianas_contador(const RuidoContador *r, uint32_t inicio, int n, double sigma, double out[]);
+
 // Función histograma 1D
 void histogram (double *H, int N, double *data, int Thist, double *max, double *min, double *delta);
-
-// Función principal de procesamiento
-void generar_histogramas(const char *carpeta_in, 
-                         const char *carpeta_out_vel, 
-                         const char *carpeta_out_pos, 
-                         const char *prefijo, 
-                         int bins);
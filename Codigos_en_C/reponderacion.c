@@ -0,0 +1,372 @@
+#include "reponderacion.h"
+#include <dirent.h>
+
+
+Reponderacion *crea_reponderacion(double kb, double Temperatura) {
+    Reponderacion *r = calloc(1, sizeof(Reponderacion));
+    if (!r) return NULL;
+    r->beta = 1.0 / (kb * Temperatura);
+    return r;
+}
+
+void libera_reponderacion(Reponderacion *r) {
+    if (!r) return;
+    free(r->F);
+    free(r->N);
+    free(r->g);
+    free(r->f);
+    free(r->x);
+    free(r->peso);
+    free(r->estado);
+    free(r->log_denominador);
+    free(r);
+}
+
+// Amplía los arrays de estados y muestras para que quepan n_nuevas muestras más
+static int reserva_reponderacion(Reponderacion *r, long long n_nuevas) {
+    if (r->n_estados == r->capacidad_estados) {
+        int capacidad = r->capacidad_estados ? 2*r->capacidad_estados : 16;
+        double *F = realloc(r->F, capacidad*sizeof(double));
+        if (F) r->F = F;
+        double *N = realloc(r->N, capacidad*sizeof(double));
+        if (N) r->N = N;
+        double *g = realloc(r->g, capacidad*sizeof(double));
+        if (g) r->g = g;
+        double *f = realloc(r->f, capacidad*sizeof(double));
+        if (f) r->f = f;
+        if (!F || !N || !g || !f) return 0;
+        r->capacidad_estados = capacidad;
+    }
+    if (r->n_muestras + n_nuevas > r->capacidad_muestras) {
+        long long capacidad = r->capacidad_muestras ? 2*r->capacidad_muestras : 4096;
+        while (capacidad < r->n_muestras + n_nuevas) capacidad *= 2;
+        double *x = realloc(r->x, capacidad*sizeof(double));
+        if (x) r->x = x;
+        double *peso = realloc(r->peso, capacidad*sizeof(double));
+        if (peso) r->peso = peso;
+        int *estado = realloc(r->estado, capacidad*sizeof(int));
+        if (estado) r->estado = estado;
+        double *log_denominador = realloc(r->log_denominador, capacidad*sizeof(double));
+        if (log_denominador) r->log_denominador = log_denominador;
+        if (!x || !peso || !estado || !log_denominador) return 0;
+        r->capacidad_muestras = capacidad;
+    }
+    return 1;
+}
+
+// Ineficiencia estadística por bloques: g = max_b b var(medias de bloques de b) / var(x)
+static double ineficiencia(const double x[], long long n) {
+    if (n < 32) return 1.0;
+    double media = 0.0, var = 0.0;
+    for (long long i = 0; i < n; i++) media += x[i];
+    media /= n;
+    for (long long i = 0; i < n; i++) var += (x[i] - media) * (x[i] - media);
+    var /= n;
+    if (var <= 0.0) return 1.0;
+
+    double g = 1.0;
+    for (long long b = 2; n / b >= 16; b *= 2) {
+        long long bloques = n / b;
+        double var_b = 0.0;
+        for (long long k = 0; k < bloques; k++) {
+            double m_b = 0.0;
+            for (long long i = k*b; i < (k+1)*b; i++) m_b += x[i];
+            m_b /= b;
+            var_b += (m_b - media) * (m_b - media);
+        }
+        var_b /= bloques;
+        if (b * var_b / var > g) g = b * var_b / var;
+    }
+    return g;
+}
+
+static void anade_estado(Reponderacion *r, double F, double N, double g) {
+    int k = r->n_estados++;
+    r->F[k] = F;
+    r->N[k] = N;
+    r->g[k] = g;
+    r->f[k] = 0.0;
+    r->convergido = 0;
+}
+
+int anade_estado_muestras(Reponderacion *r, double F, const double x[], long long n) {
+    if (n <= 0 || !reserva_reponderacion(r, n)) return 0;
+    for (long long i = 0; i < n; i++) {
+        r->x[r->n_muestras + i] = x[i];
+        r->peso[r->n_muestras + i] = 1.0;
+        r->estado[r->n_muestras + i] = r->n_estados;
+    }
+    r->n_muestras += n;
+    anade_estado(r, F, (double)n, ineficiencia(x, n));
+    return 1;
+}
+
+int anade_estado_histograma(Reponderacion *r, double F, const Histograma *h) {
+    if (h->n == 0 || !reserva_reponderacion(r, h->n_bins)) return 0;
+    double N = 0.0;
+    for (int i = 0; i < h->n_bins; i++) {
+        if (h->cuentas[i] == 0.0) continue;
+        r->x[r->n_muestras] = centro_bin(h, i);
+        r->peso[r->n_muestras] = h->cuentas[i];
+        r->estado[r->n_muestras] = r->n_estados;
+        r->n_muestras++;
+        N += h->cuentas[i];
+    }
+    anade_estado(r, F, N, 1.0);
+    return 1;
+}
+
+// ln sum_j N_j exp(f_j + beta F_j x) para cada muestra, con el máximo restado para no desbordar
+static void calcula_denominadores(Reponderacion *r) {
+    int K = r->n_estados;
+    double log_N[K];
+    for (int j = 0; j < K; j++) log_N[j] = log(r->N[j]) + r->f[j];
+
+    for (long long n = 0; n < r->n_muestras; n++) {
+        double bx = r->beta * r->x[n];
+        double maximo = -INFINITY;
+        for (int j = 0; j < K; j++) {
+            double e = log_N[j] + r->F[j] * bx;
+            if (e > maximo) maximo = e;
+        }
+        double suma = 0.0;
+        for (int j = 0; j < K; j++) suma += exp(log_N[j] + r->F[j] * bx - maximo);
+        r->log_denominador[n] = maximo + log(suma);
+    }
+}
+
+// ln sum_n peso_n exp(beta F x_n - log_denominador_n) (= -f(F))
+static double log_suma_pesos(const Reponderacion *r, double F) {
+    double maximo = -INFINITY;
+    for (long long n = 0; n < r->n_muestras; n++) {
+        double e = r->beta * F * r->x[n] - r->log_denominador[n];
+        if (e > maximo) maximo = e;
+    }
+    double suma = 0.0;
+    for (long long n = 0; n < r->n_muestras; n++)
+        suma += r->peso[n] * exp(r->beta * F * r->x[n] - r->log_denominador[n] - maximo);
+    return maximo + log(suma);
+}
+
+int resuelve_reponderacion(Reponderacion *r, double tolerancia, int max_iteraciones) {
+    int K = r->n_estados;
+    if (K == 0) return -1;
+
+    for (int it = 1; it <= max_iteraciones; it++) {
+        calcula_denominadores(r);
+        double cambio = 0.0;
+        double f_0 = -log_suma_pesos(r, r->F[0]);
+        for (int k = 0; k < K; k++) {
+            double f_nueva = -log_suma_pesos(r, r->F[k]) - f_0;
+            cambio = fmax(cambio, fabs(f_nueva - r->f[k]));
+            r->f[k] = f_nueva;
+        }
+        if (cambio < tolerancia) {
+            calcula_denominadores(r);
+            r->iteraciones = it;
+            r->convergido = 1;
+            return it;
+        }
+    }
+    calcula_denominadores(r);
+    r->iteraciones = max_iteraciones;
+    r->convergido = 0;
+    printf("La reponderación no ha convergido en %d iteraciones\n", max_iteraciones);
+    return -1;
+}
+
+PuntoReponderado reponderacion_en(const Reponderacion *r, double F) {
+    PuntoReponderado p = {F, 0.0, 0.0, 0.0, 0};
+    if (r->n_muestras == 0) return p;
+
+    // Pesos relativos al máximo: w_n = peso_n exp(beta F x_n - log_denominador_n - maximo)
+    double maximo = -INFINITY;
+    for (long long n = 0; n < r->n_muestras; n++) {
+        double e = r->beta * F * r->x[n] - r->log_denominador[n];
+        if (e > maximo) maximo = e;
+    }
+
+    int K = r->n_estados;
+    double suma_w = 0.0, suma_wx = 0.0, suma_w2 = 0.0;
+    double w_estado[K];
+    for (int k = 0; k < K; k++) w_estado[k] = 0.0;
+    for (long long n = 0; n < r->n_muestras; n++) {
+        double w = r->peso[n] * exp(r->beta * F * r->x[n] - r->log_denominador[n] - maximo);
+        suma_w += w;
+        suma_wx += w * r->x[n];
+        suma_w2 += w * w / r->peso[n];  // peso_n copias de peso w/peso_n
+        w_estado[r->estado[n]] += w;
+    }
+    p.Ree = suma_wx / suma_w;
+
+    double var = 0.0;
+    for (long long n = 0; n < r->n_muestras; n++) {
+        double w = r->peso[n] * exp(r->beta * F * r->x[n] - r->log_denominador[n] - maximo);
+        var += w * (r->x[n] - p.Ree) * (r->x[n] - p.Ree);
+    }
+    var /= suma_w;
+
+    // Ineficiencia media de los estados, pesada por lo que aporta cada uno a esta fuerza
+    double g = 0.0;
+    for (int k = 0; k < K; k++) g += r->g[k] * w_estado[k] / suma_w;
+
+    p.n_efectivo = suma_w * suma_w / suma_w2;
+    p.error = sqrt(var * g / p.n_efectivo);
+    p.fiable = p.n_efectivo >= N_EFECTIVO_MINIMO;
+    return p;
+}
+
+double solapamiento_estados(const Reponderacion *r, int k, int l) {
+    double suma = 0.0;
+    for (long long n = 0; n < r->n_muestras; n++) {
+        double bx = r->beta * r->x[n];
+        double W_k = exp(r->f[k] + r->F[k] * bx - r->log_denominador[n]);
+        double W_l = exp(r->f[l] + r->F[l] * bx - r->log_denominador[n]);
+        suma += r->peso[n] * W_k * W_l;
+    }
+    return suma * r->N[l];
+}
+
+int escribe_curva_reponderada(const Reponderacion *r, double F_min, double F_max, int n_puntos, const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+    if (!f) {
+        printf("No se pudo crear el archivo %s\n", ruta);
+        return 0;
+    }
+
+    fprintf(f, "# Reponderación de %d simulaciones, %lld muestras, %d iteraciones%s\n", r->n_estados,
+            r->n_muestras, r->iteraciones, r->convergido ? "" : " (SIN CONVERGER)");
+    fprintf(f, "# F_simulada N g f solapamiento_con_la_siguiente\n");
+    for (int k = 0; k < r->n_estados; k++) {
+        double O = (k + 1 < r->n_estados) ? solapamiento_estados(r, k, k + 1) : 0.0;
+        fprintf(f, "# %.6f %.0f %.2f %.6f %.4f\n", r->F[k], r->N[k], r->g[k], r->f[k], O);
+    }
+    fprintf(f, "# F Ree error n_efectivo fiable\n");
+
+    double razon = (n_puntos > 1) ? pow(F_max / F_min, 1.0 / (n_puntos - 1)) : 1.0;
+    for (int i = 0; i < n_puntos; i++) {
+        PuntoReponderado p = reponderacion_en(r, F_min * pow(razon, i));
+        fprintf(f, "%.6f %.6f %.6f %.1f %d\n", p.F, p.Ree, p.error, p.n_efectivo, p.fiable);
+    }
+    fclose(f);
+    return 1;
+}
+
+double *lee_ree_trayectoria(const char *archivo, int N_start, long long *n) {
+    *n = 0;
+    FILE *file = fopen(archivo, "r");
+    if (!file) {
+        printf("No se pudo abrir el archivo %s\n", archivo);
+        return NULL;
+    }
+
+    long long capacidad = 4096;
+    double *ree = malloc(capacidad*sizeof(double));
+    if (!ree) {
+        fclose(file);
+        return NULL;
+    }
+
+    // Las líneas pueden ser muy largas (posiciones y velocidades): se lee carácter a carácter
+    // guardando solo el último número de cada línea. Las que empiezan por '#' (la línea
+    // "# INESTABLE ..." de una trayectoria cortada) no tienen datos.
+    char ultimo[64], actual[64];
+    int largo = 0, linea = 0, c, inicio = 1, comentario = 0;
+    ultimo[0] = '\0';
+    while ((c = getc(file)) != EOF) {
+        if (inicio && c == '#') comentario = 1;
+        inicio = c == '\n';
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            if (largo > 0) {
+                actual[largo] = '\0';
+                memcpy(ultimo, actual, largo + 1);
+                largo = 0;
+            }
+            if (c != '\n') continue;
+
+            // Fin de línea: la primera es la cabecera, luego se saltan N_start salidas
+            if (comentario) {
+                comentario = 0;
+                ultimo[0] = '\0';
+                continue;
+            }
+            linea++;
+            if (linea > 1 + N_start && ultimo[0] != '\0') {
+                if (*n == capacidad) {
+                    double *nuevo = realloc(ree, 2*capacidad*sizeof(double));
+                    if (!nuevo) break;
+                    ree = nuevo;
+                    capacidad *= 2;
+                }
+                ree[(*n)++] = strtod(ultimo, NULL);
+            }
+            ultimo[0] = '\0';
+        } else if (largo < (int)sizeof(actual) - 1) {
+            actual[largo++] = (char)c;
+        }
+    }
+    fclose(file);
+    return ree;
+}
+
+
+#ifdef FIXED
+void generar_grafica_reponderada(double K, double kb, double Temperatura, int N_start, int n_puntos) {
+    #ifdef WLCM
+    printf("Con WLCM la flexión no tiene energía: las trayectorias no se pueden reponderar\n");
+    return;
+    #endif
+    char carpeta[256];
+    snprintf(carpeta, sizeof(carpeta), "Resultados_simulacion/%.1f/FIJOS", K);
+
+    DIR *dir = opendir(carpeta);
+    if (!dir) {
+        printf("No se pudo abrir la carpeta %s\n", carpeta);
+        return;
+    }
+
+    Reponderacion *r = crea_reponderacion(kb, Temperatura);
+    if (!r) {
+        closedir(dir);
+        return;
+    }
+
+    double F_min = INFINITY, F_max = -INFINITY;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "V_", 2) != 0) continue;
+        char *ext = strrchr(entry->d_name, '.');
+        if (!ext || strcmp(ext, ".txt") != 0) continue;
+
+        char archivo_parametros[512];
+        snprintf(archivo_parametros, sizeof(archivo_parametros), "PARAMETROS/%.1f/FIJOS/%s", K, entry->d_name);
+        double F_cte = leer_F_cte_desde_parametros(archivo_parametros);
+        if (F_cte < 0.0) continue;
+
+        char nombre_archivo[512];
+        snprintf(nombre_archivo, sizeof(nombre_archivo), "%s/%s", carpeta, entry->d_name);
+        long long n;
+        double *ree = lee_ree_trayectoria(nombre_archivo, N_start, &n);
+        if (ree && n > 0 && anade_estado_muestras(r, F_cte, ree, n)) {
+            if (F_cte < F_min) F_min = F_cte;
+            if (F_cte > F_max) F_max = F_cte;
+        }
+        free(ree);
+    }
+    closedir(dir);
+
+    if (r->n_estados == 0) {
+        printf("No hay trayectorias para reponderar en %s\n", carpeta);
+        libera_reponderacion(r);
+        return;
+    }
+    if (F_min <= 0.0) F_min = 1e-3;  // Rejilla logarítmica
+
+    resuelve_reponderacion(r, 1e-7, 10000);
+    char ruta[512];
+    snprintf(ruta, sizeof(ruta), "%s/RES_IMPORTANTES/grafica_reponderada.txt", carpeta);
+    if (escribe_curva_reponderada(r, F_min, F_max, n_puntos, ruta))
+        printf("Archivo grafica_reponderada.txt creado en %s/RES_IMPORTANTES\n", carpeta);
+    libera_reponderacion(r);
+}
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "funciones_oscilador.h"
+#include "histograma.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/**
+ * Reponderación de la curva fuerza-extensión (MBAR / WHAM sin bins).
+ *
+ * Con el extremo fijo la fuerza constante solo añade -F Ree_z a la energía, así que las muestras
+ * de Ree_z de unas pocas simulaciones a fuerzas F_k bastan para estimar <Ree>(F) a cualquier F
+ * intermedia. Las energías libres f_k de cada estado se obtienen de forma autoconsistente:
+ *   f_k = -ln sum_n exp(beta F_k x_n) / sum_j N_j exp(f_j + beta F_j x_n)
+ * y el promedio a una fuerza F pesa cada muestra con exp(beta F x_n) / sum_j N_j exp(f_j + beta F_j x_n).
+ *
+ * Las muestras pueden venir de las trayectorias (Ree en la última columna de V_i.txt) o de
+ * histogramas en streaming (cada bin es una muestra con peso = cuentas). El error usa el tamaño
+ * efectivo de Kish dividido por la ineficiencia estadística g de cada estado (por bloques), y se
+ * dan diagnósticos de solapamiento entre estados y en cada fuerza pedida.
+ */
+
+#define N_EFECTIVO_MINIMO 50.0  // Por debajo, el punto reponderado no es fiable
+
+typedef struct {
+    double beta;
+    int n_estados, capacidad_estados;
+    double *F;                // [estado] Fuerza de cada simulación
+    double *N;                // [estado] Número (ponderado) de muestras
+    double *g;                // [estado] Ineficiencia estadística (1 = muestras independientes)
+    double *f;                // [estado] Energía libre reducida (f_0 = 0)
+
+    long long n_muestras, capacidad_muestras;
+    double *x;                // [muestra] Ree_z
+    double *peso;             // [muestra] Multiplicidad (1, o las cuentas de un bin)
+    int *estado;              // [muestra] Estado del que viene
+    double *log_denominador;  // [muestra] ln sum_j N_j exp(f_j + beta F_j x_n)
+
+    int iteraciones;
+    int convergido;
+} Reponderacion;
+
+typedef struct {
+    double F;
+    double Ree, error;
+    double n_efectivo;        // Tamaño efectivo de Kish (sin corregir por g)
+    int fiable;               // n_efectivo >= N_EFECTIVO_MINIMO
+} PuntoReponderado;
+
+Reponderacion *crea_reponderacion(double kb, double Temperatura);
+void libera_reponderacion(Reponderacion *r);
+
+/**
+ * Añade una simulación a fuerza F con sus muestras de Ree_z (en orden temporal: se usa para
+ * estimar la ineficiencia estadística).
+ * @return 1 si se ha añadido, 0 si no hay memoria.
+ */
+int anade_estado_muestras(Reponderacion *r, double F, const double x[], long long n);
+
+/**
+ * Añade una simulación a fuerza F a partir de su histograma de Ree_z (por ejemplo, el de
+ * DistribucionesCadena). Se supone g = 1; el bin debe ser pequeño frente a kT / |F - F'|.
+ */
+int anade_estado_histograma(Reponderacion *r, double F, const Histograma *h);
+
+/**
+ * Resuelve las energías libres por iteración autoconsistente.
+ * @return Número de iteraciones, o -1 si no converge en max_iteraciones.
+ */
+int resuelve_reponderacion(Reponderacion *r, double tolerancia, int max_iteraciones);
+
+// <Ree>, su error y el tamaño efectivo a la fuerza F (tras resuelve_reponderacion)
+PuntoReponderado reponderacion_en(const Reponderacion *r, double F);
+
+// Solapamiento O_kl entre dos estados (O_kk ~ 1 si está aislado, O_kl ~ 0 si no hay solapamiento)
+double solapamiento_estados(const Reponderacion *r, int k, int l);
+
+/**
+ * Escribe "F Ree error n_efectivo fiable" en n_puntos fuerzas espaciadas en log entre F_min y
+ * F_max, con una cabecera con las fuerzas simuladas y el solapamiento entre vecinas.
+ * @return 1 si se ha escrito, 0 si no.
+ */
+int escribe_curva_reponderada(const Reponderacion *r, double F_min, double F_max, int n_puntos, const char *ruta);
+
+/**
+ * Lee Ree (la última columna) de una trayectoria de verlet_trayectoria, saltando la cabecera y
+ * las primeras N_start salidas. Devuelve un array nuevo con *n muestras (NULL si falla).
+ */
+double *lee_ree_trayectoria(const char *archivo, int N_start, long long *n);
+
+#ifdef FIXED
+/**
+ * Curva densa <Ree>(F) a partir de las trayectorias de la carpeta FIJOS (las fuerzas se leen de
+ * RES_IMPORTANTES): escribe grafica_reponderada.txt junto a grafica.txt. Con WLCM la flexión no
+ * deriva de una energía y las trayectorias no muestrean exp(-beta H), así que no hace nada.
+ */
+void generar_grafica_reponderada(double K, double kb, double Temperatura, int N_start, int n_puntos);
+#endif
@@ -0,0 +1,127 @@
+#include "salud.h"
+#include <stdarg.h>
+
+// El laplaciano de U solo se conoce para los muelles armónicos
+#if !defined(WLCM) && !defined(VOLUMEN_EXCLUIDO)
+#define TEMPERATURA_CONFIGURACIONAL
+#endif
+
+#ifdef FIXED
+void inicializa_salud(SaludSimulacion *s, int N, double K, double kb, double Temperatura, double m, double dt,
+                      double F_cte)
+#else
+void inicializa_salud(SaludSimulacion *s, int N, double K, double kb, double Temperatura, double m, double dt)
+#endif
+{
+    memset(s, 0, sizeof(SaludSimulacion));
+    s->N = N;
+    s->K = K;
+    s->kb = kb;
+    s->Temperatura = Temperatura;
+    s->m = m;
+    s->dt = dt;
+    s->estado = SALUD_BIEN;
+    s->enlace_limite = ESTIRAMIENTO_MAXIMO * L_0 + DESVIACIONES_ENLACE * sqrt(kb * Temperatura / K);
+    #ifdef FIXED
+    s->enlace_limite += fabs(F_cte) / K;
+    #endif
+}
+
+static EstadoSalud inestable(SaludSimulacion *s, double t, const char *formato, ...) {
+    char motivo[192];
+    va_list args;
+    va_start(args, formato);
+    vsnprintf(motivo, sizeof(motivo), formato, args);
+    va_end(args);
+    // Verlet es estable si dt * omega_max < 2, con omega_max = 2 sqrt(K/m) la del modo más rápido de la cadena
+    double omega_dt = 2.0 * sqrt(s->K / s->m) * s->dt;
+    snprintf(s->diagnostico, sizeof(s->diagnostico), "t = %.6f: %s (dt = %g, dt*omega_max = %.3g; Verlet necesita < 2)",
+             t, motivo, s->dt, omega_dt);
+    s->estado = SALUD_INESTABLE;
+    return s->estado;
+}
+
+EstadoSalud revisa_salud(SaludSimulacion *s, double t, const double x[], const double v[], const double F[]) {
+    if (s->estado == SALUD_INESTABLE) return s->estado;
+    int N = s->N;
+
+    // 1. NaN e infinitos
+    for (int i = 0; i < 3*N; i++) {
+        if (!isfinite(x[i]) || !isfinite(v[i]) || (F && !isfinite(F[i]))) {
+            const char *que = !isfinite(x[i]) ? "posición" : !isfinite(v[i]) ? "velocidad" : "fuerza";
+            return inestable(s, t, "%s no finita en la partícula %d", que, i / 3);
+        }
+    }
+
+    // 2. Enlaces y laplaciano de los muelles: K (3 - 2 L_0 / r) por cada extremo móvil
+    double mayor = 0.0, laplaciano = 0.0;
+    int enlace_mayor = 0;
+    for (int j = 0; j < N - 1; j++) {
+        double dx = x[3*(j+1)] - x[3*j];
+        double dy = x[3*(j+1)+1] - x[3*j+1];
+        double dz = x[3*(j+1)+2] - x[3*j+2];
+        double r = sqrt(dx*dx + dy*dy + dz*dz);
+        if (r > mayor) {
+            mayor = r;
+            enlace_mayor = j;
+        }
+        if (r > 0.0) {
+            double extremo = s->K * (3.0 - 2.0 * L_0 / r);
+            #ifdef FIXED
+            laplaciano += j == 0 ? extremo : 2.0 * extremo;
+            #else
+            laplaciano += 2.0 * extremo;
+            #endif
+        }
+    }
+    if (mayor / L_0 > s->estiramiento_maximo) s->estiramiento_maximo = mayor / L_0;
+    if (mayor > s->enlace_limite)
+        return inestable(s, t, "el enlace %d-%d mide %.3g (límite %.3g)", enlace_mayor, enlace_mayor + 1, mayor,
+                         s->enlace_limite);
+
+    // 3. Temperatura cinética instantánea
+    double Ek = 0.0;
+    for (int i = 0; i < 3*N; i++) Ek += 0.5 * s->m * v[i] * v[i];
+    #ifdef FIXED
+    double T_cinetica = 2.0 * Ek / (3.0 * (N - 1) * s->kb);   // La partícula 0 no se mueve
+    #else
+    double T_cinetica = 2.0 * Ek / (3.0 * N * s->kb);
+    #endif
+    if (s->Temperatura > 0.0 && T_cinetica > FACTOR_INESTABLE * s->Temperatura)
+        return inestable(s, t, "temperatura cinética %.4g, %.0f veces Temperatura", T_cinetica,
+                         T_cinetica / s->Temperatura);
+    s->suma_T_cinetica += T_cinetica;
+    #ifdef TEMPERATURA_CONFIGURACIONAL
+    if (F) {
+        double fuerza2 = 0.0;
+        for (int i = 0; i < 3*N; i++) fuerza2 += F[i] * F[i];
+        s->suma_fuerza2 += fuerza2;
+        s->suma_laplaciano += laplaciano;
+    }
+    #endif
+    s->revisiones++;
+
+    // 4. Deriva de las medias (solo avisa, una vez)
+    if (s->estado == SALUD_BIEN && s->revisiones >= REVISIONES_MINIMAS_SALUD && s->Temperatura > 0.0) {
+        double T = s->Temperatura;
+        double medias[2] = {temperatura_cinetica_salud(s), temperatura_configuracional_salud(s)};
+        const char *nombres[2] = {"cinética", "configuracional"};
+        for (int k = 0; k < 2; k++) {
+            if (isnan(medias[k]) || (medias[k] <= FACTOR_AVISO * T && medias[k] >= T / FACTOR_AVISO)) continue;
+            snprintf(s->diagnostico, sizeof(s->diagnostico),
+                     "t = %.6f: temperatura %s media %.4g frente a Temperatura = %g (dt = %g quizá demasiado grande)",
+                     t, nombres[k], medias[k], T, s->dt);
+            s->estado = SALUD_AVISO;
+            break;
+        }
+    }
+    return s->estado;
+}
+
+double temperatura_cinetica_salud(const SaludSimulacion *s) {
+    return s->revisiones ? s->suma_T_cinetica / s->revisiones : NAN;
+}
+
+double temperatura_configuracional_salud(const SaludSimulacion *s) {
+    return s->suma_laplaciano > 0.0 ? s->suma_fuerza2 / (s->kb * s->suma_laplaciano) : NAN;
+}
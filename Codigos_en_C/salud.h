@@ -0,0 +1,69 @@
+#pragma once
+
+#include "funciones_oscilador.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/**
+ * Vigilancia de la estabilidad numérica de una trayectoria. Se llama en cada salida (O(N), nada
+ * frente a los pasos que hay entre salidas) y detecta las que explotan cuando dt es demasiado
+ * grande para K (o para K_BENDING con WLCM), para cortarlas con un diagnóstico en vez de seguir
+ * escribiendo NaN durante millones de pasos.
+ *
+ * La trayectoria es inestable si:
+ *   - alguna posición, velocidad o fuerza es NaN o infinita,
+ *   - algún enlace mide más de ESTIRAMIENTO_MAXIMO L_0 más lo que lo estiran F_cte (F_cte / K) y
+ *     DESVIACIONES_ENLACE fluctuaciones térmicas (sqrt(kb T / K)), para no cortar muelles blandos,
+ *   - la temperatura cinética instantánea pasa de FACTOR_INESTABLE veces Temperatura.
+ * Además se acumulan las temperaturas cinética (2 Ek / 3N kb) y configuracional
+ * (<|F|^2> / kb <laplaciano de U>, solo con los muelles: sin WLCM ni VOLUMEN_EXCLUIDO) y, tras
+ * REVISIONES_MINIMAS_SALUD salidas, se avisa si alguna se aparta más de FACTOR_AVISO veces de
+ * Temperatura. El aviso no corta la trayectoria. Con FIXED la partícula 0 está fija y la
+ * temperatura cinética se reparte entre 3(N-1) grados de libertad.
+ */
+
+#define ESTIRAMIENTO_MAXIMO 3.0
+#define DESVIACIONES_ENLACE 10.0
+#define FACTOR_INESTABLE 50.0
+#define FACTOR_AVISO 2.0
+#define REVISIONES_MINIMAS_SALUD 100
+#define TAM_DIAGNOSTICO_SALUD 320
+
+typedef enum {
+    SALUD_BIEN,
+    SALUD_AVISO,
+    SALUD_INESTABLE
+} EstadoSalud;
+
+typedef struct {
+    int N;
+    double K, kb, Temperatura, m, dt;
+    long revisiones;
+    double suma_T_cinetica;
+    double suma_fuerza2, suma_laplaciano;
+    double enlace_limite;               // Longitud a partir de la que un enlace está roto
+    double estiramiento_maximo;         // Enlace más largo visto, en unidades de L_0
+    EstadoSalud estado;
+    char diagnostico[TAM_DIAGNOSTICO_SALUD];
+} SaludSimulacion;
+
+#ifdef FIXED
+void inicializa_salud(SaludSimulacion *s, int N, double K, double kb, double Temperatura, double m, double dt,
+                      double F_cte);
+#else
+void inicializa_salud(SaludSimulacion *s, int N, double K, double kb, double Temperatura, double m, double dt);
+#endif
+
+/**
+ * Revisa el estado en el tiempo t. Una vez inestable, sigue inestable.
+ * @param F  Fuerzas en x (NULL: sin temperatura configuracional ni comprobación de fuerzas).
+ * @return El estado; s->diagnostico explica el motivo si no es SALUD_BIEN.
+ */
+EstadoSalud revisa_salud(SaludSimulacion *s, double t, const double x[], const double v[], const double F[]);
+
+// Medias de las temperaturas desde inicializa_salud (la configuracional es NaN si no se calcula)
+double temperatura_cinetica_salud(const SaludSimulacion *s);
+double temperatura_configuracional_salud(const SaludSimulacion *s);
@@ -0,0 +1,147 @@
+#include "simulacion.h"
+
+
+struct Simulacion {
+    ConfiguracionSimulacion c;
+    EstadoPR generador;
+    RuidoContador ruido;            // Con RUIDO_CONTADOR: clave sacada de 'generador' y paso actual
+    double a, b, sigma;
+    double t;
+    int propia;                     // 1 si la memoria la reservó crea_simulacion
+    double *x, *v, *F;
+    double *x_nuevo, *v_nuevo, *F_nuevo, *betta;
+};
+
+// Los arrays van detrás de la estructura, alineados a double
+#define CABECERA_SIMULACION ((sizeof(struct Simulacion) + sizeof(double) - 1) / sizeof(double) * sizeof(double))
+
+
+ConfiguracionSimulacion configuracion_simulacion_defecto(void) {
+    ConfiguracionSimulacion c = {4, 0.0003, 1.0, 0.5, 1.0, 1.0, 1000.0, 0.0, 12456};
+    return c;
+}
+
+size_t tam_simulacion(int N) {
+    return CABECERA_SIMULACION + 7*3*(size_t)N*sizeof(double);
+}
+
+static int configuracion_valida(const ConfiguracionSimulacion *c) {
+    if (c->N < 2 || !(c->dt > 0.0) || !(c->m > 0.0) || c->alfa < 0.0 || c->Temperatura < 0.0) {
+        printf("Configuración de la simulación no válida (N = %d, dt = %g, m = %g, alfa = %g, T = %g)\n",
+               c->N, c->dt, c->m, c->alfa, c->Temperatura);
+        return 0;
+    }
+    return 1;
+}
+
+static void calcula_fuerzas(Simulacion *s) {
+    #ifdef FIXED
+    Fuerza_verlet(s->c.N, s->x, s->F, s->c.K, s->c.F_cte);
+    #else
+    Fuerza_verlet(s->c.N, s->x, s->F, s->c.K);
+    #endif
+}
+
+Simulacion *crea_simulacion(const ConfiguracionSimulacion *c, void *memoria) {
+    if (!configuracion_valida(c)) return NULL;
+    int propia = memoria == NULL;
+    if (propia) memoria = malloc(tam_simulacion(c->N));
+    if (!memoria) {
+        printf("No se pudo reservar memoria para la simulación (N = %d)\n", c->N);
+        return NULL;
+    }
+    Simulacion *s = memoria;
+    memset(s, 0, sizeof(Simulacion));
+    s->propia = propia;
+    int n = 3*c->N;
+    s->x       = (double *)((char *)memoria + CABECERA_SIMULACION);
+    s->v       = s->x + n;
+    s->F       = s->x + 2*n;
+    s->x_nuevo = s->x + 3*n;
+    s->v_nuevo = s->x + 4*n;
+    s->F_nuevo = s->x + 5*n;
+    s->betta   = s->x + 6*n;
+    s->c = *c;
+    configura_simulacion(s, c);
+    reinicia_simulacion(s, NULL, NULL, c->semilla);
+    return s;
+}
+
+int configura_simulacion(Simulacion *s, const ConfiguracionSimulacion *c) {
+    if (!configuracion_valida(c)) return 1;
+    if (c->N != s->c.N) {
+        printf("configura_simulacion no puede cambiar N (%d -> %d)\n", s->c.N, c->N);
+        return 1;
+    }
+    s->c = *c;
+    s->a = (1.0 - c->alfa * c->dt / (2.0 * c->m)) / (1.0 + c->alfa * c->dt / (2.0 * c->m));
+    s->b = 1.0 / (1.0 + c->alfa * c->dt / (2.0 * c->m));
+    s->sigma = sqrt(2 * c->alfa * c->Temperatura * c->kb * c->dt);
+    calcula_fuerzas(s);
+    return 0;
+}
+
+void reinicia_simulacion(Simulacion *s, const double x[], const double v[], int semilla) {
+    int N = s->c.N;
+    for (int j = 0; j < N; j++) {
+        for (int k = 0; k < 3; k++) {
+            s->x[3*j + k] = x ? x[3*j + k] : (k == 0 ? j * L_0 : 0.0);
+            s->v[3*j + k] = v ? v[3*j + k] : 0.0;
+        }
+    }
+    s->c.semilla = semilla;
+    inicializa_PR_r(&s->generador, semilla);
+    #ifdef RUIDO_CONTADOR
+    inicializa_ruido_contador_desde(&s->ruido, &s->generador, 0);
+    #endif
+    s->t = 0.0;
+    calcula_fuerzas(s);
+}
+
+void avanza_simulacion(Simulacion *s, long pasos) {
+    int n = 3*s->c.N;
+    for (long p = 0; p < pasos; p++) {
+        #ifdef RUIDO_CONTADOR
+        gaussianas_contador(&s->ruido, 0, n, s->sigma, s->betta);
+        s->ruido.paso++;
+        #else
+        for (int i = 0; i < n; i++) s->betta[i] = gaussian_r(&s->generador) * s->sigma;
+        #endif
+        #ifdef FIXED
+        un_paso_verlet(s->betta, s->b, s->a, s->c.N, s->x, s->x_nuevo, s->v, s->v_nuevo, s->F, s->F_nuevo,
+                       s->c.dt, s->c.m, Fuerza_verlet, s->c.K, s->c.F_cte);
+        #else
+        un_paso_verlet(s->betta, s->b, s->a, s->c.N, s->x, s->x_nuevo, s->v, s->v_nuevo, s->F, s->F_nuevo,
+                       s->c.dt, s->c.m, Fuerza_verlet, s->c.K);
+        #endif
+        double *tmp;
+        tmp = s->x; s->x = s->x_nuevo; s->x_nuevo = tmp;
+        tmp = s->v; s->v = s->v_nuevo; s->v_nuevo = tmp;
+        tmp = s->F; s->F = s->F_nuevo; s->F_nuevo = tmp;
+    }
+    s->t += pasos * s->c.dt;
+}
+
+void observa_simulacion(const Simulacion *s, ObservablesSimulacion *o) {
+    int N = s->c.N;
+    o->t = s->t;
+    o->Ek = Energia_cinetica_instantanea(N, s->v, s->c.m);
+    o->Ep = Energia_potencial_instantanea(N, s->x, s->c.m, s->c.K);
+    o->Et = o->Ek + o->Ep;
+    o->Rg = calcula_radio_giro(N, s->x);
+    o->Ree = s->x[3*(N-1) + 2] - s->x[2];
+}
+
+void estado_simulacion(const Simulacion *s, double x[], double v[]) {
+    size_t tam = 3*(size_t)s->c.N*sizeof(double);
+    if (x) memcpy(x, s->x, tam);
+    if (v) memcpy(v, s->v, tam);
+}
+
+EstadoSalud revisa_salud_simulacion(const Simulacion *s, SaludSimulacion *salud) {
+    return revisa_salud(salud, s->t, s->x, s->v, s->F);
+}
+
+void destruye_simulacion(Simulacion *s) {
+    if (s && s->propia) free(s);
+}
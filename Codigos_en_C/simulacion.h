@@ -0,0 +1,85 @@
+#pragma once
+
+#include "random.h"
+#include "funciones_oscilador.h"
+#include "integracion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/**
+ * API embebible del simulador: crear, configurar, avanzar n pasos, leer observables y destruir,
+ * sin ficheros ni estado global. Sirve para lanzar miles de simulaciones cortas dentro de un
+ * mismo proceso (o en varios hilos, una simulación por hilo) sin fork/exec por ejecución.
+ *
+ * Cada simulación lleva su propio generador Parisi-Rapuano, así que varias simulaciones pueden
+ * avanzar intercaladas o en hilos distintos sin interferir. El paso es el GJF de un_paso_verlet
+ * con Fuerza_verlet: con la misma semilla la trayectoria es bit a bit la de verlet_trayectoria
+ * tras inicializa_PR(semilla) (para N <= N_CADENA_LARGA; con RUIDO_CONTADOR, para cualquier N,
+ * porque el ruido por contador no depende del recorrido del paso fusionado). Con VOLUMEN_EXCLUIDO
+ * la lista de vecinos es del hilo, así que alternar simulaciones en un hilo la reconstruye en cada
+ * cambio.
+ *
+ * La memoria puede ponerla quien llama (tam_simulacion(N) bytes, alineados para double), de
+ * forma que crear y destruir simulaciones no reserva nada.
+ */
+
+typedef struct Simulacion Simulacion;
+
+typedef struct {
+    int N;
+    double dt, m, alfa;
+    double kb, Temperatura;
+    double K;
+    double F_cte;                   // Con FIXED: fuerza sobre la última partícula (si no, se ignora)
+    int semilla;
+} ConfiguracionSimulacion;
+
+typedef struct {
+    double t;
+    double Ek, Ep, Et;
+    double Rg, Ree;                 // Ree = z_{N-1} - z_0, como en verlet_trayectoria
+} ObservablesSimulacion;
+
+// Los parámetros de oscilador.c con N = 4 y F_cte = 0
+ConfiguracionSimulacion configuracion_simulacion_defecto(void);
+
+// Bytes que necesita una simulación de N partículas
+size_t tam_simulacion(int N);
+
+/**
+ * Crea una simulación con la cadena recta a lo largo de x y en reposo.
+ * @param memoria  Bloque de tam_simulacion(c->N) bytes, o NULL para reservarlo aquí.
+ * @return La simulación, o NULL si la configuración no es válida o no hay memoria.
+ */
+Simulacion *crea_simulacion(const ConfiguracionSimulacion *c, void *memoria);
+
+/**
+ * Cambia los parámetros (mismo N) sin tocar el estado ni el generador.
+ * @return 0 si todo va bien, 1 si la configuración no es válida.
+ */
+int configura_simulacion(Simulacion *s, const ConfiguracionSimulacion *c);
+
+/**
+ * Pone el estado inicial, el tiempo a 0 y vuelve a sembrar el generador.
+ * @param x, v  Posiciones y velocidades (3N); NULL: cadena recta a lo largo de x / en reposo.
+ */
+void reinicia_simulacion(Simulacion *s, const double x[], const double v[], int semilla);
+
+void avanza_simulacion(Simulacion *s, long pasos);
+
+void observa_simulacion(const Simulacion *s, ObservablesSimulacion *o);
+
+// Copia posiciones y velocidades en buffers de quien llama (cualquiera puede ser NULL)
+void estado_simulacion(const Simulacion *s, double x[], double v[]);
+
+/**
+ * Revisa la estabilidad numérica en el estado actual (salud.h), p. ej. tras cada avanza_simulacion.
+ * @param salud  Iniciada con inicializa_salud y los parámetros de la configuración.
+ */
+EstadoSalud revisa_salud_simulacion(const Simulacion *s, SaludSimulacion *salud);
+
+// Libera la memoria si la reservó crea_simulacion
+void destruye_simulacion(Simulacion *s);
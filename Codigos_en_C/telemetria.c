@@ -0,0 +1,196 @@
+#include "telemetria.h"
+#include <stddef.h>
+#include <time.h>
+#include <sys/stat.h> // mkdir
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
+
+_Static_assert(sizeof(RegistroTelemetria) == TAM_REGISTRO_TELEMETRIA, "El registro de telemetría debe ocupar TAM_REGISTRO_TELEMETRIA bytes");
+
+// Lo que se copia dentro de la sección impar: todo lo que va detrás de 'secuencia'
+#define INICIO_DATOS offsetof(RegistroTelemetria, paso)
+#define INTENTOS_LECTURA 1000
+
+struct Telemetria {
+    char ruta[512];
+    RegistroTelemetria local;           // Copia del escritor
+    RegistroTelemetria *mapa;           // El fichero (en Windows, NULL y se escribe con fwrite)
+    FILE *archivo;
+    double suma_Ek, suma_Ep, suma_Ree;
+    long paso_publicado;
+    double reloj_publicado;
+};
+
+static double reloj(clockid_t id) {
+    struct timespec t;
+    clock_gettime(id, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+const char *carpeta_telemetria(void) {
+    const char *carpeta = getenv("TELEMETRIA_CADENA");
+    return carpeta && *carpeta ? carpeta : CARPETA_TELEMETRIA;
+}
+
+Telemetria *abre_telemetria(const char *nombre, int N, double dt, long pasos) {
+    static int trabajos = 0;            // Para distinguir varios trabajos del mismo proceso
+    const char *carpeta = carpeta_telemetria();
+#ifdef _WIN32
+    mkdir(carpeta);
+#else
+    mkdir(carpeta, 0755);
+#endif
+    const char *base = strrchr(nombre, '/');
+    if (!base) base = strrchr(nombre, '\\');
+    base = base ? base + 1 : nombre;
+
+    Telemetria *t = calloc(1, sizeof(Telemetria));
+    if (!t) return NULL;
+    int trabajo = __atomic_fetch_add(&trabajos, 1, __ATOMIC_RELAXED);
+    snprintf(t->ruta, sizeof(t->ruta), "%s/%d_%d_%s.tel", carpeta, (int)getpid(), trabajo, base);
+
+    RegistroTelemetria *r = &t->local;
+    memcpy(r->magia, MAGIA_TELEMETRIA, 8);
+    r->version = VERSION_TELEMETRIA;
+    r->pid = (int32_t)getpid();
+    r->pasos_totales = pasos;
+    r->N = N;
+    r->dt = dt;
+    r->inicio = r->actualizado = reloj(CLOCK_REALTIME);
+    snprintf(r->nombre, sizeof(r->nombre), "%s", base);
+    t->reloj_publicado = reloj(CLOCK_MONOTONIC);
+
+#ifdef _WIN32
+    t->archivo = fopen(t->ruta, "wb");
+    if (!t->archivo) {
+        printf("No se pudo crear la telemetría %s\n", t->ruta);
+        free(t);
+        return NULL;
+    }
+    fwrite(r, sizeof(RegistroTelemetria), 1, t->archivo);
+    fflush(t->archivo);
+#else
+    int fd = open(t->ruta, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || write(fd, r, sizeof(RegistroTelemetria)) != sizeof(RegistroTelemetria)) {
+        printf("No se pudo crear la telemetría %s\n", t->ruta);
+        if (fd >= 0) close(fd);
+        free(t);
+        return NULL;
+    }
+    t->mapa = mmap(NULL, sizeof(RegistroTelemetria), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (t->mapa == MAP_FAILED) {
+        printf("No se pudo mapear la telemetría %s\n", t->ruta);
+        remove(t->ruta);
+        free(t);
+        return NULL;
+    }
+#endif
+    return t;
+}
+
+void acumula_telemetria(Telemetria *t, double Ek, double Ep, double Ree) {
+    if (!t) return;
+    t->suma_Ek += Ek;
+    t->suma_Ep += Ep;
+    t->suma_Ree += Ree;
+    t->local.muestras++;
+}
+
+// Copia el registro local al fichero entre dos valores de 'secuencia' (impar durante la copia)
+static void escribe_registro(Telemetria *t) {
+    uint64_t secuencia = t->local.secuencia + 1;
+#ifdef _WIN32
+    t->local.secuencia = secuencia + 1;
+    fseek(t->archivo, 0, SEEK_SET);
+    fwrite(&t->local, sizeof(RegistroTelemetria), 1, t->archivo);
+    fflush(t->archivo);
+#else
+    RegistroTelemetria *m = t->mapa;
+    __atomic_store_n(&m->secuencia, secuencia, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy((char *)m + INICIO_DATOS, (const char *)&t->local + INICIO_DATOS, sizeof(RegistroTelemetria) - INICIO_DATOS);
+    __atomic_store_n(&m->secuencia, secuencia + 1, __ATOMIC_RELEASE);
+    t->local.secuencia = secuencia + 1;
+#endif
+}
+
+static void actualiza(Telemetria *t, long paso, long long bytes_salida) {
+    RegistroTelemetria *r = &t->local;
+    double ahora = reloj(CLOCK_MONOTONIC);
+    if (ahora > t->reloj_publicado) r->pasos_por_segundo = (paso - t->paso_publicado) / (ahora - t->reloj_publicado);
+    t->paso_publicado = paso;
+    t->reloj_publicado = ahora;
+    r->paso = paso;
+    r->actualizado = reloj(CLOCK_REALTIME);
+    r->bytes_salida = bytes_salida;
+    if (r->muestras) {
+        r->media_Ek = t->suma_Ek / r->muestras;
+        r->media_Ep = t->suma_Ep / r->muestras;
+        r->media_Ree = t->suma_Ree / r->muestras;
+    }
+    escribe_registro(t);
+}
+
+void publica_telemetria(Telemetria *t, long paso, long long bytes_salida) {
+    if (!t || paso - t->paso_publicado < PASOS_TELEMETRIA) return;
+    actualiza(t, paso, bytes_salida);
+}
+
+void cierra_telemetria(Telemetria *t) {
+    if (!t) return;
+    t->local.terminado = 1;
+    actualiza(t, (long)t->local.pasos_totales, t->local.bytes_salida);
+#ifdef _WIN32
+    fclose(t->archivo);
+#else
+    munmap(t->mapa, sizeof(RegistroTelemetria));
+#endif
+    remove(t->ruta);
+    remove(carpeta_telemetria());       // Solo si ha quedado vacía
+    free(t);
+}
+
+int lee_telemetria(const char *ruta, RegistroTelemetria *r) {
+    int ok = 0;
+#ifdef _WIN32
+    // Sin mapa: dos copias seguidas iguales y con 'secuencia' par
+    FILE *f = fopen(ruta, "rb");
+    if (!f) return 0;
+    RegistroTelemetria otra;
+    for (int intento = 0; intento < INTENTOS_LECTURA && !ok; intento++) {
+        fseek(f, 0, SEEK_SET);
+        if (fread(r, sizeof(RegistroTelemetria), 1, f) != 1) break;
+        fseek(f, 0, SEEK_SET);
+        if (fread(&otra, sizeof(RegistroTelemetria), 1, f) != 1) break;
+        ok = !(r->secuencia & 1) && memcmp(r, &otra, sizeof(RegistroTelemetria)) == 0;
+    }
+    fclose(f);
+#else
+    int fd = open(ruta, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(RegistroTelemetria)) {
+        close(fd);
+        return 0;
+    }
+    const RegistroTelemetria *m = mmap(NULL, sizeof(RegistroTelemetria), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) return 0;
+    for (int intento = 0; intento < INTENTOS_LECTURA && !ok; intento++) {
+        uint64_t antes = __atomic_load_n(&m->secuencia, __ATOMIC_ACQUIRE);
+        if (antes & 1) continue;
+        memcpy(r, m, sizeof(RegistroTelemetria));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        ok = __atomic_load_n(&m->secuencia, __ATOMIC_RELAXED) == antes;
+        r->secuencia = antes;
+    }
+    munmap((void *)m, sizeof(RegistroTelemetria));
+#endif
+    return ok && memcmp(r->magia, MAGIA_TELEMETRIA, 8) == 0 && r->version == VERSION_TELEMETRIA;
+}
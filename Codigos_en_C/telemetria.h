@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+
+/**
+ * Estado en vivo de una simulación en un fichero pequeño de tamaño fijo, mapeado en memoria,
+ * para ver desde fuera (monitor.c) el paso, la velocidad, el tiempo restante y las medias de
+ * los observables de cada trabajo en marcha.
+ *
+ * Cada trabajo tiene su fichero <carpeta>/<pid>_<nombre>.tel con un RegistroTelemetria. El
+ * escritor no usa cerrojos: 'secuencia' es impar mientras se copia el registro y el lector
+ * repite la lectura si la ve impar o distinta antes y después de copiar (seqlock). Se publica
+ * como mucho cada PASOS_TELEMETRIA pasos, así que el coste es un clock_gettime y unos cientos
+ * de bytes cada varios miles de pasos. Al terminar, el fichero se borra; los que quedan son de
+ * trabajos en marcha o que se cortaron.
+ *
+ * La carpeta es la de la variable de entorno TELEMETRIA_CADENA o, si no está, CARPETA_TELEMETRIA
+ * en el directorio actual.
+ */
+
+#define MAGIA_TELEMETRIA "CADTEL01"
+#define VERSION_TELEMETRIA 1
+#define TAM_REGISTRO_TELEMETRIA 256
+#define PASOS_TELEMETRIA 5000
+#define CARPETA_TELEMETRIA "TELEMETRIA"
+
+typedef struct {
+    char magia[8];
+    int32_t version;
+    int32_t pid;
+    uint64_t secuencia;                 // Impar mientras se escribe
+    int64_t paso;
+    int64_t pasos_totales;
+    int32_t N;
+    int32_t terminado;
+    double dt;
+    double inicio;                      // Segundos desde 1970 al abrir
+    double actualizado;                 // Segundos desde 1970 en la última publicación
+    double pasos_por_segundo;           // Entre las dos últimas publicaciones
+    double media_Ek, media_Ep, media_Ree;
+    int64_t muestras;                   // Salidas que entran en las medias
+    int64_t bytes_salida;
+    char nombre[128];
+    char reservado[TAM_REGISTRO_TELEMETRIA - 248];
+} RegistroTelemetria;
+
+typedef struct Telemetria Telemetria;
+
+// Carpeta de los .tel (TELEMETRIA_CADENA o CARPETA_TELEMETRIA)
+const char *carpeta_telemetria(void);
+
+/**
+ * Crea el .tel del trabajo.
+ * @param nombre  Nombre para el monitor (se usa el último componente de la ruta).
+ * @return La telemetría, o NULL si no se puede crear (la simulación sigue sin ella).
+ */
+Telemetria *abre_telemetria(const char *nombre, int N, double dt, long pasos);
+
+// Añade una salida a las medias de Ek, Ep y Ree
+void acumula_telemetria(Telemetria *t, double Ek, double Ep, double Ree);
+
+// Publica el estado si han pasado PASOS_TELEMETRIA pasos desde la última vez
+void publica_telemetria(Telemetria *t, long paso, long long bytes_salida);
+
+// Publica el estado final y borra el .tel
+void cierra_telemetria(Telemetria *t);
+
+/**
+ * Lee un .tel con una copia coherente del registro.
+ * @return 1 si se ha leído, 0 si no existe, no es un .tel o no se obtuvo una copia coherente.
+ */
+int lee_telemetria(const char *ruta, RegistroTelemetria *r);
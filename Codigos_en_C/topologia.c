@@ -0,0 +1,556 @@
+#include "topologia.h"
+
+
+static const Topologia *topologia_activa = NULL;
+
+
+Topologia *crea_topologia(int N) {
+    if (N < 1) return NULL;
+    Topologia *t = calloc(1, sizeof(Topologia));
+    if (!t) return NULL;
+    t->N = N;
+    t->fija = calloc(N, 1);
+    t->tirada = calloc(N, 1);
+    t->fijas = malloc(N*sizeof(int));
+    t->tiradas = malloc(N*sizeof(int));
+    if (!t->fija || !t->tirada || !t->fijas || !t->tiradas) {
+        printf("No se pudo reservar memoria para la topología (N = %d)\n", N);
+        libera_topologia(t);
+        return NULL;
+    }
+    return t;
+}
+
+void libera_topologia(Topologia *t) {
+    if (!t) return;
+    if (topologia_activa == t) topologia_activa = NULL;
+    free(t->enlace_i); free(t->enlace_j); free(t->K_enlace); free(t->L_enlace);
+    free(t->inicio_color_enlaces);
+    free(t->angulo_a); free(t->angulo_b); free(t->angulo_c); free(t->k_angulo); free(t->cos_angulo);
+    free(t->inicio_color_angulos);
+    free(t->inicio_vecinos); free(t->vecinos);
+    free(t->inicio_molecula); free(t->particulas_molecula);
+    free(t->fija); free(t->tirada); free(t->fijas); free(t->tiradas);
+    free(t);
+}
+
+// realloc de *p a n elementos de 'tam' bytes; deja *p como estaba si falla
+static int crece(void **p, int n, size_t tam) {
+    void *nuevo = realloc(*p, (size_t)n * tam);
+    if (!nuevo) return 1;
+    *p = nuevo;
+    return 0;
+}
+
+int anade_enlace_topologia(Topologia *t, int i, int j, double K, double L) {
+    if (t->cerrada || i < 0 || j < 0 || i >= t->N || j >= t->N || i == j) {
+        printf("Enlace %d-%d no válido (N = %d%s)\n", i, j, t->N, t->cerrada ? ", topología cerrada" : "");
+        return 1;
+    }
+    if (t->n_enlaces == t->capacidad_enlaces) {
+        int capacidad = t->capacidad_enlaces ? 2*t->capacidad_enlaces : 16;
+        if (crece((void **)&t->enlace_i, capacidad, sizeof(int)) || crece((void **)&t->enlace_j, capacidad, sizeof(int))
+            || crece((void **)&t->K_enlace, capacidad, sizeof(double))
+            || crece((void **)&t->L_enlace, capacidad, sizeof(double))) {
+            printf("No se pudo reservar memoria para %d enlaces\n", capacidad);
+            return 1;
+        }
+        t->capacidad_enlaces = capacidad;
+    }
+    int b = t->n_enlaces++;
+    t->enlace_i[b] = i;
+    t->enlace_j[b] = j;
+    t->K_enlace[b] = K;
+    t->L_enlace[b] = L;
+    return 0;
+}
+
+int anade_angulo_topologia(Topologia *t, int a, int b, int c, double k, double theta_0) {
+    if (t->cerrada || a < 0 || b < 0 || c < 0 || a >= t->N || b >= t->N || c >= t->N || a == b || b == c || a == c) {
+        printf("Ángulo %d-%d-%d no válido (N = %d%s)\n", a, b, c, t->N, t->cerrada ? ", topología cerrada" : "");
+        return 1;
+    }
+    if (t->n_angulos == t->capacidad_angulos) {
+        int capacidad = t->capacidad_angulos ? 2*t->capacidad_angulos : 16;
+        if (crece((void **)&t->angulo_a, capacidad, sizeof(int)) || crece((void **)&t->angulo_b, capacidad, sizeof(int))
+            || crece((void **)&t->angulo_c, capacidad, sizeof(int))
+            || crece((void **)&t->k_angulo, capacidad, sizeof(double))
+            || crece((void **)&t->cos_angulo, capacidad, sizeof(double))) {
+            printf("No se pudo reservar memoria para %d ángulos\n", capacidad);
+            return 1;
+        }
+        t->capacidad_angulos = capacidad;
+    }
+    int n = t->n_angulos++;
+    t->angulo_a[n] = a;
+    t->angulo_b[n] = b;
+    t->angulo_c[n] = c;
+    t->k_angulo[n] = k;
+    t->cos_angulo[n] = cos(theta_0);
+    return 0;
+}
+
+void fija_particula_topologia(Topologia *t, int i) {
+    if (i < 0 || i >= t->N || t->fija[i]) return;
+    t->fija[i] = 1;
+    t->fijas[t->n_fijas++] = i;
+}
+
+void tira_particula_topologia(Topologia *t, int i) {
+    if (i < 0 || i >= t->N || t->tirada[i]) return;
+    t->tirada[i] = 1;
+    t->tiradas[t->n_tiradas++] = i;
+}
+
+/**
+ * Coloreado voraz: cada elemento (enlace o ángulo, de 'por_elemento' partículas en miembros) toma
+ * el menor color que no tiene ningún elemento ya coloreado que comparta alguna de sus partículas.
+ * Con grado máximo D usa como mucho por_elemento (D - 1) + 1 colores.
+ * @param miembros  Partículas de cada elemento: miembros[k][e] es la k-ésima del elemento e.
+ * @param color     Salida: color de cada elemento.
+ * @return Número de colores, -1 si falta memoria.
+ */
+static int colorea(int N, int n, int por_elemento, int *const miembros[], int color[]) {
+    if (n == 0) return 0;
+    int *inicio = calloc(N + 1, sizeof(int));
+    int *incidentes = malloc((size_t)por_elemento * n * sizeof(int));
+    int *lleno = malloc((N + 1) * sizeof(int));
+    if (!inicio || !incidentes || !lleno) {
+        free(inicio); free(incidentes); free(lleno);
+        return -1;
+    }
+    for (int k = 0; k < por_elemento; k++)
+        for (int e = 0; e < n; e++) inicio[miembros[k][e] + 1]++;
+    int grado_max = 0;
+    for (int i = 0; i < N; i++) {
+        if (inicio[i + 1] > grado_max) grado_max = inicio[i + 1];
+        inicio[i + 1] += inicio[i];
+    }
+    memcpy(lleno, inicio, (N + 1)*sizeof(int));
+    for (int k = 0; k < por_elemento; k++)
+        for (int e = 0; e < n; e++) incidentes[lleno[miembros[k][e]]++] = e;
+
+    // usado[c] == e + 1 si el color c ya lo tiene un vecino del elemento e (sin borrar entre elementos)
+    int max_colores = por_elemento * grado_max + 1;
+    int *usado = calloc(max_colores, sizeof(int));
+    if (!usado) {
+        free(inicio); free(incidentes); free(lleno);
+        return -1;
+    }
+    int n_colores = 0;
+    for (int e = 0; e < n; e++) color[e] = -1;
+    for (int e = 0; e < n; e++) {
+        for (int k = 0; k < por_elemento; k++) {
+            int i = miembros[k][e];
+            for (int p = inicio[i]; p < inicio[i + 1]; p++) {
+                int otro = incidentes[p];
+                if (color[otro] >= 0) usado[color[otro]] = e + 1;
+            }
+        }
+        int c = 0;
+        while (usado[c] == e + 1) c++;
+        color[e] = c;
+        if (c + 1 > n_colores) n_colores = c + 1;
+    }
+    free(inicio); free(incidentes); free(lleno); free(usado);
+    return n_colores;
+}
+
+// Orden estable por color: orden[destino] = origen; inicio_color[c] es el primero del color c
+static int ordena_por_color(int n, int n_colores, const int color[], int orden[], int **inicio_color) {
+    int *inicio = calloc(n_colores + 1, sizeof(int));
+    int *lleno = malloc((n_colores + 1) * sizeof(int));
+    if (!inicio || !lleno) {
+        free(inicio); free(lleno);
+        return 1;
+    }
+    for (int e = 0; e < n; e++) inicio[color[e] + 1]++;
+    for (int c = 0; c < n_colores; c++) inicio[c + 1] += inicio[c];
+    memcpy(lleno, inicio, (n_colores + 1)*sizeof(int));
+    for (int e = 0; e < n; e++) orden[lleno[color[e]]++] = e;
+    free(lleno);
+    *inicio_color = inicio;
+    return 0;
+}
+
+static void permuta_int(int v[], const int orden[], int n, int tmp[]) {
+    for (int e = 0; e < n; e++) tmp[e] = v[orden[e]];
+    memcpy(v, tmp, n*sizeof(int));
+}
+
+static void permuta_double(double v[], const int orden[], int n, double tmp[]) {
+    for (int e = 0; e < n; e++) tmp[e] = v[orden[e]];
+    memcpy(v, tmp, n*sizeof(double));
+}
+
+// Colorea y reordena una lista (enlaces con 2 partículas, ángulos con 3)
+static int colorea_lista(int N, int n, int por_elemento, int *miembros[], double *valores[], int n_valores,
+                         int *n_colores, int **inicio_color) {
+    *n_colores = 0;
+    if (n == 0) return 0;
+    int *color = malloc(n*sizeof(int)), *orden = malloc(n*sizeof(int));
+    double *tmp = malloc(n*sizeof(double));
+    int fallo = !color || !orden || !tmp;
+    if (!fallo) {
+        *n_colores = colorea(N, n, por_elemento, miembros, color);
+        fallo = *n_colores < 0 || ordena_por_color(n, *n_colores, color, orden, inicio_color);
+    }
+    if (!fallo) {
+        for (int k = 0; k < por_elemento; k++) permuta_int(miembros[k], orden, n, (int *)tmp);
+        for (int k = 0; k < n_valores; k++) permuta_double(valores[k], orden, n, tmp);
+    }
+    free(color); free(orden); free(tmp);
+    return fallo;
+}
+
+// Vecinos enlazados de cada partícula
+static int construye_vecinos(Topologia *t) {
+    int N = t->N;
+    t->inicio_vecinos = calloc(N + 1, sizeof(int));
+    t->vecinos = malloc((2*(size_t)t->n_enlaces + 1)*sizeof(int));
+    int *lleno = malloc((N + 1)*sizeof(int));
+    if (!t->inicio_vecinos || !t->vecinos || !lleno) {
+        free(lleno);
+        return 1;
+    }
+    for (int b = 0; b < t->n_enlaces; b++) {
+        t->inicio_vecinos[t->enlace_i[b] + 1]++;
+        t->inicio_vecinos[t->enlace_j[b] + 1]++;
+    }
+    for (int i = 0; i < N; i++) t->inicio_vecinos[i + 1] += t->inicio_vecinos[i];
+    memcpy(lleno, t->inicio_vecinos, (N + 1)*sizeof(int));
+    for (int b = 0; b < t->n_enlaces; b++) {
+        t->vecinos[lleno[t->enlace_i[b]]++] = t->enlace_j[b];
+        t->vecinos[lleno[t->enlace_j[b]]++] = t->enlace_i[b];
+    }
+    free(lleno);
+    return 0;
+}
+
+static int raiz(int padre[], int i) {
+    while (padre[i] != i) {
+        padre[i] = padre[padre[i]];
+        i = padre[i];
+    }
+    return i;
+}
+
+// Moléculas: componentes conexas de los enlaces, numeradas por su menor partícula
+static int construye_moleculas(Topologia *t) {
+    int N = t->N;
+    int *padre = malloc(N*sizeof(int)), *molecula = malloc(N*sizeof(int));
+    t->inicio_molecula = calloc(N + 1, sizeof(int));
+    t->particulas_molecula = malloc(N*sizeof(int));
+    if (!padre || !molecula || !t->inicio_molecula || !t->particulas_molecula) {
+        free(padre); free(molecula);
+        return 1;
+    }
+    for (int i = 0; i < N; i++) padre[i] = i;
+    for (int b = 0; b < t->n_enlaces; b++) {
+        int ri = raiz(padre, t->enlace_i[b]), rj = raiz(padre, t->enlace_j[b]);
+        if (ri != rj) padre[ri > rj ? ri : rj] = ri < rj ? ri : rj;
+    }
+    // La raíz es la menor partícula de su componente, así que aparece antes que el resto
+    t->n_moleculas = 0;
+    for (int i = 0; i < N; i++) {
+        int r = raiz(padre, i);
+        molecula[i] = (r == i) ? t->n_moleculas++ : molecula[r];
+        t->inicio_molecula[molecula[i] + 1]++;
+    }
+    for (int m = 0; m < t->n_moleculas; m++) t->inicio_molecula[m + 1] += t->inicio_molecula[m];
+    memcpy(padre, t->inicio_molecula, t->n_moleculas*sizeof(int));
+    for (int i = 0; i < N; i++) t->particulas_molecula[padre[molecula[i]]++] = i;
+    free(padre);
+    free(molecula);
+    return 0;
+}
+
+int cierra_topologia(Topologia *t) {
+    if (t->cerrada) return 0;
+    // Lineal: enlace b = (b, b+1) y, si hay ángulos, el n es (n, n+1, n+2) para todos
+    t->lineal = t->n_enlaces == t->N - 1 && (t->n_angulos == 0 || t->n_angulos == t->N - 2);
+    for (int b = 0; t->lineal && b < t->n_enlaces; b++)
+        t->lineal = t->enlace_i[b] == b && t->enlace_j[b] == b + 1;
+    for (int n = 0; t->lineal && n < t->n_angulos; n++)
+        t->lineal = t->angulo_a[n] == n && t->angulo_b[n] == n + 1 && t->angulo_c[n] == n + 2;
+
+    int fallo = 0;
+    if (!t->lineal) {
+        int *miembros[2] = {t->enlace_i, t->enlace_j};
+        double *valores[2] = {t->K_enlace, t->L_enlace};
+        fallo |= colorea_lista(t->N, t->n_enlaces, 2, miembros, valores, 2, &t->n_colores_enlaces,
+                               &t->inicio_color_enlaces);
+        int *miembros_angulos[3] = {t->angulo_a, t->angulo_b, t->angulo_c};
+        double *valores_angulos[2] = {t->k_angulo, t->cos_angulo};
+        fallo |= colorea_lista(t->N, t->n_angulos, 3, miembros_angulos, valores_angulos, 2, &t->n_colores_angulos,
+                               &t->inicio_color_angulos);
+    }
+    fallo |= construye_vecinos(t);
+    fallo |= construye_moleculas(t);
+    if (fallo) {
+        printf("No se pudo cerrar la topología (N = %d, %d enlaces, %d ángulos)\n", t->N, t->n_enlaces,
+               t->n_angulos);
+        return 1;
+    }
+    t->cerrada = 1;
+    return 0;
+}
+
+
+// Con WLCM, ángulos de los tripletes consecutivos del camino con la flexión de parametros_flexion
+static int anade_angulos_camino(Topologia *t, const int camino[], int n) {
+    #ifdef WLCM
+    asegura_flexion();
+    double theta_0 = acos(parametros_flexion.cos_theta0);
+    for (int k = 1; k < n - 1; k++)
+        if (anade_angulo_topologia(t, camino[k-1], camino[k], camino[k+1], rigidez_flexion(camino[k]), theta_0))
+            return 1;
+    #else
+    (void)t; (void)camino; (void)n;
+    #endif
+    return 0;
+}
+
+// Enlaces (y ángulos) de la cadena camino[0] - camino[1] - ... - camino[n-1]
+static int anade_camino(Topologia *t, const int camino[], int n, double K) {
+    for (int k = 0; k < n - 1; k++)
+        if (anade_enlace_topologia(t, camino[k], camino[k+1], K, L_0)) return 1;
+    return anade_angulos_camino(t, camino, n);
+}
+
+// Cierra o, si algo ha fallado antes, libera
+static Topologia *termina(Topologia *t, int fallo) {
+    if (fallo || cierra_topologia(t)) {
+        libera_topologia(t);
+        return NULL;
+    }
+    return t;
+}
+
+Topologia *topologia_cadenas(int n_cadenas, int N_cadena, double K) {
+    if (n_cadenas < 1 || N_cadena < 1) return NULL;
+    Topologia *t = crea_topologia(n_cadenas * N_cadena);
+    int *camino = malloc(N_cadena*sizeof(int));
+    if (!t || !camino) {
+        libera_topologia(t);
+        free(camino);
+        return NULL;
+    }
+    int fallo = 0;
+    for (int c = 0; c < n_cadenas && !fallo; c++) {
+        for (int k = 0; k < N_cadena; k++) camino[k] = c*N_cadena + k;
+        fallo = anade_camino(t, camino, N_cadena, K);
+        #ifdef FIXED
+        fija_particula_topologia(t, camino[0]);
+        tira_particula_topologia(t, camino[N_cadena - 1]);
+        #endif
+    }
+    free(camino);
+    return termina(t, fallo);
+}
+
+Topologia *topologia_lineal(int N, double K) {
+    return topologia_cadenas(1, N, K);
+}
+
+Topologia *topologia_anillo(int N, double K) {
+    if (N < 3) return NULL;
+    Topologia *t = crea_topologia(N);
+    // Camino 0, 1, ..., N-1, 0, 1: todos los enlaces y todos los ángulos del anillo
+    int *camino = malloc((N + 2)*sizeof(int));
+    if (!t || !camino) {
+        libera_topologia(t);
+        free(camino);
+        return NULL;
+    }
+    for (int k = 0; k < N + 2; k++) camino[k] = k % N;
+    int fallo = 0;
+    for (int k = 0; k < N && !fallo; k++) fallo = anade_enlace_topologia(t, camino[k], camino[k+1], K, L_0);
+    if (!fallo) fallo = anade_angulos_camino(t, camino, N + 2);
+    free(camino);
+    return termina(t, fallo);
+}
+
+Topologia *topologia_estrella(int brazos, int por_brazo, double K) {
+    if (brazos < 1 || por_brazo < 1) return NULL;
+    Topologia *t = crea_topologia(1 + brazos*por_brazo);
+    int *camino = malloc((por_brazo + 1)*sizeof(int));
+    if (!t || !camino) {
+        libera_topologia(t);
+        free(camino);
+        return NULL;
+    }
+    int fallo = 0;
+    camino[0] = 0;
+    for (int a = 0; a < brazos && !fallo; a++) {
+        for (int k = 0; k < por_brazo; k++) camino[k + 1] = 1 + a*por_brazo + k;
+        fallo = anade_camino(t, camino, por_brazo + 1, K);
+    }
+    free(camino);
+    return termina(t, fallo);
+}
+
+Topologia *topologia_cepillo(int N_columna, int separacion, int N_lado, double K) {
+    if (N_columna < 1 || separacion < 1 || N_lado < 0) return NULL;
+    int lados = (N_columna + separacion - 1) / separacion;
+    Topologia *t = crea_topologia(N_columna + lados*N_lado);
+    int largo = N_columna > N_lado + 1 ? N_columna : N_lado + 1;
+    int *camino = malloc(largo*sizeof(int));
+    if (!t || !camino) {
+        libera_topologia(t);
+        free(camino);
+        return NULL;
+    }
+    for (int k = 0; k < N_columna; k++) camino[k] = k;
+    int fallo = anade_camino(t, camino, N_columna, K);
+    for (int l = 0; l < lados && !fallo; l++) {
+        camino[0] = l * separacion;
+        for (int k = 0; k < N_lado; k++) camino[k + 1] = N_columna + l*N_lado + k;
+        fallo = anade_camino(t, camino, N_lado + 1, K);
+    }
+    free(camino);
+    return termina(t, fallo);
+}
+
+
+void Fuerza_topologia(const Topologia *t, const double x[], double F[], double F_cte) {
+    int N = t->N;
+    for (int i = 0; i < 3*N; i++)
+        F[i] = 0.0;
+
+    // 1. ENLACES
+    const int *ei = t->enlace_i, *ej = t->enlace_j;
+    const double *K = t->K_enlace, *L = t->L_enlace;
+    if (t->lineal) {
+        // El bucle de Fuerza_verlet, con K y L de cada enlace; los enlaces se guardan para los ángulos
+        double *enlaces = t->n_angulos ? enlaces_flexion(N) : NULL;
+        for (int b = 0; b < N - 1; b++) {
+            int i3 = 3*b, j3 = 3*(b+1);
+            double dx = x[j3]   - x[i3];
+            double dy = x[j3+1] - x[i3+1];
+            double dz = x[j3+2] - x[i3+2];
+            double r = sqrt(dx*dx + dy*dy + dz*dz);
+            if (enlaces) enlace_flexion(dx, dy, dz, r, &enlaces[4*b]);
+            if (r == 0.0) continue;
+            double fac = K[b] * (r - L[b]) / r;
+            F[i3]   += fac * dx; F[i3+1] += fac * dy; F[i3+2] += fac * dz;
+            F[j3]   -= fac * dx; F[j3+1] -= fac * dy; F[j3+2] -= fac * dz;
+        }
+        // 2. ÁNGULOS (n, n+1, n+2) con los dos enlaces ya calculados
+        for (int n = 0; n < t->n_angulos; n++) {
+            double f_a[3], f_c[3];
+            if (enlaces) {
+                triplete_flexion(t->k_angulo[n], t->cos_angulo[n], &enlaces[4*n], &enlaces[4*(n+1)], f_a, f_c);
+            } else {
+                // Sin memoria para el buffer: el ángulo calcula sus dos enlaces
+                double e_ab[4], e_bc[4];
+                enlace_posiciones(x, n, e_ab);
+                enlace_posiciones(x, n+1, e_bc);
+                triplete_flexion(t->k_angulo[n], t->cos_angulo[n], e_ab, e_bc, f_a, f_c);
+            }
+            // Desenrollado a mano: así f_a y f_c se quedan en registros y no pasan por la pila
+            double *F_a = &F[3*n], *F_b = &F[3*(n+1)], *F_c = &F[3*(n+2)];
+            F_a[0] += f_a[0]; F_a[1] += f_a[1]; F_a[2] += f_a[2];
+            F_c[0] += f_c[0]; F_c[1] += f_c[1]; F_c[2] += f_c[2];
+            F_b[0] -= f_a[0] + f_c[0]; F_b[1] -= f_a[1] + f_c[1]; F_b[2] -= f_a[2] + f_c[2];
+        }
+    } else {
+        for (int c = 0; c < t->n_colores_enlaces; c++) {
+            // Ningún par de enlaces del color comparte partícula: las sumas no chocan
+            #pragma GCC ivdep
+            for (int b = t->inicio_color_enlaces[c]; b < t->inicio_color_enlaces[c+1]; b++) {
+                int i3 = 3*ei[b], j3 = 3*ej[b];
+                double dx = x[j3]   - x[i3];
+                double dy = x[j3+1] - x[i3+1];
+                double dz = x[j3+2] - x[i3+2];
+                double r = sqrt(dx*dx + dy*dy + dz*dz);
+                double fac = (r > 0.0) ? K[b] * (r - L[b]) / r : 0.0;
+                F[i3]   += fac * dx; F[i3+1] += fac * dy; F[i3+2] += fac * dz;
+                F[j3]   -= fac * dx; F[j3+1] -= fac * dy; F[j3+2] -= fac * dz;
+            }
+        }
+
+        // 2. ÁNGULOS (flexion.h), también por colores
+        for (int c = 0; c < t->n_colores_angulos; c++) {
+            #pragma GCC ivdep
+            for (int n = t->inicio_color_angulos[c]; n < t->inicio_color_angulos[c+1]; n++) {
+                int a3 = 3*t->angulo_a[n], b3 = 3*t->angulo_b[n], c3 = 3*t->angulo_c[n];
+                double e_ab[4], e_bc[4], f_a[3], f_c[3];
+                double dx = x[b3] - x[a3], dy = x[b3+1] - x[a3+1], dz = x[b3+2] - x[a3+2];
+                enlace_flexion(dx, dy, dz, sqrt(dx*dx + dy*dy + dz*dz), e_ab);
+                dx = x[c3] - x[b3]; dy = x[c3+1] - x[b3+1]; dz = x[c3+2] - x[b3+2];
+                enlace_flexion(dx, dy, dz, sqrt(dx*dx + dy*dy + dz*dz), e_bc);
+                triplete_flexion(t->k_angulo[n], t->cos_angulo[n], e_ab, e_bc, f_a, f_c);
+                for (int k = 0; k < 3; k++) {
+                    F[a3+k] += f_a[k];
+                    F[c3+k] += f_c[k];
+                    F[b3+k] -= f_a[k] + f_c[k];
+                }
+            }
+        }
+    }
+
+    // 3. PARTÍCULAS TIRADAS Y FIJAS
+    for (int k = 0; k < t->n_tiradas; k++)
+        F[3*t->tiradas[k] + 2] += F_cte;
+    for (int k = 0; k < t->n_fijas; k++) {
+        int i3 = 3*t->fijas[k];
+        F[i3] = F[i3+1] = F[i3+2] = 0.0;
+    }
+}
+
+double Energia_topologia(const Topologia *t, const double x[]) {
+    double V = 0.0;
+    for (int b = 0; b < t->n_enlaces; b++) {
+        int i3 = 3*t->enlace_i[b], j3 = 3*t->enlace_j[b];
+        double dx = x[j3] - x[i3], dy = x[j3+1] - x[i3+1], dz = x[j3+2] - x[i3+2];
+        double d = sqrt(dx*dx + dy*dy + dz*dz) - t->L_enlace[b];
+        V += 0.5 * t->K_enlace[b] * d * d;
+    }
+    return V;
+}
+
+double radio_giro_molecula(const Topologia *t, const double x[], int m) {
+    const int *p = t->particulas_molecula + t->inicio_molecula[m];
+    int n = t->inicio_molecula[m+1] - t->inicio_molecula[m];
+    double cm[3] = {0.0, 0.0, 0.0};
+    for (int k = 0; k < n; k++)
+        for (int d = 0; d < 3; d++) cm[d] += x[3*p[k] + d];
+    for (int d = 0; d < 3; d++) cm[d] /= n;
+    double Rg2 = 0.0;
+    for (int k = 0; k < n; k++)
+        for (int d = 0; d < 3; d++) {
+            double r = x[3*p[k] + d] - cm[d];
+            Rg2 += r * r;
+        }
+    return sqrt(Rg2 / n);
+}
+
+double radio_giro_topologia(const Topologia *t, const double x[]) {
+    double suma = 0.0;
+    for (int m = 0; m < t->n_moleculas; m++) suma += radio_giro_molecula(t, x, m);
+    return t->n_moleculas ? suma / t->n_moleculas : 0.0;
+}
+
+
+void configura_topologia(const Topologia *t) {
+    topologia_activa = t;
+}
+
+#ifdef FIXED
+void Fuerza_verlet_topologia(int N, double x[], double F[], double K, double F_cte)
+#else
+void Fuerza_verlet_topologia(int N, double x[], double F[], double K)
+#endif
+{
+    (void)K;    // Cada enlace lleva su propia K en la topología
+    if (!topologia_activa || !topologia_activa->cerrada || topologia_activa->N != N) {
+        printf("Fuerza_verlet_topologia sin una topología cerrada de N = %d (configura_topologia)\n", N);
+        exit(1);
+    }
+    #ifdef FIXED
+    Fuerza_topologia(topologia_activa, x, F, F_cte);
+    #else
+    Fuerza_topologia(topologia_activa, x, F, 0.0);
+    #endif
+}
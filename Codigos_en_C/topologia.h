@@ -0,0 +1,129 @@
+#pragma once
+
+#include "funciones_oscilador.h"
+#include "flexion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/**
+ * Topología general de enlaces: anillos, estrellas, cepillos y varias cadenas en la misma caja,
+ * en vez de la cadena lineal (i, i+1) que suponen Fuerza_verlet y compañía.
+ *
+ * Se crea con crea_topologia, se añaden enlaces (con su K y su longitud de equilibrio), ángulos
+ * (con su rigidez y su theta_0, la flexión de flexion.h) y se cierra con cierra_topologia, que:
+ *   - colorea los enlaces y los ángulos para que dos del mismo color no compartan partícula y los
+ *     ordena por color (listas comprimidas: los del color c están en [inicio_color[c],
+ *     inicio_color[c+1])). Dentro de un color la suma de fuerzas no tiene conflictos, así que el
+ *     bucle no depende del orden y se puede vectorizar o repartir entre hilos;
+ *   - guarda los vecinos enlazados de cada partícula y las moléculas (componentes conexas) en
+ *     listas comprimidas;
+ *   - reconoce la cadena lineal (enlace b = (b, b+1) para todo b y, si hay ángulos, el n en
+ *     (n, n+1, n+2)) y la deja en su orden, para usar el bucle contiguo de Fuerza_verlet sin
+ *     índices ni colores, con la flexión sobre los enlaces ya calculados.
+ * Las partículas fijas (fuerza nula, como la 0 con FIXED) y las tiradas (F_cte en z, como la
+ * última con FIXED) se marcan en cualquier momento. La energía y el radio de giro solo cuentan
+ * los enlaces, como Energia_potencial_instantanea; el volumen excluido (vecinos.c) no entra,
+ * porque su lista solo excluye los pares (i, i+1).
+ */
+
+typedef struct {
+    int N;
+    int cerrada;
+    int lineal;                     // Enlace b = (b, b+1) y ángulo n = (n, n+1, n+2): bucle contiguo
+
+    // Enlaces i-j, ordenados por color al cerrar
+    int n_enlaces, capacidad_enlaces;
+    int *enlace_i, *enlace_j;
+    double *K_enlace, *L_enlace;
+    int n_colores_enlaces;
+    int *inicio_color_enlaces;      // n_colores_enlaces + 1 (NULL si lineal, igual que los ángulos)
+
+    // Ángulos a-b-c (b en el centro), ordenados por color al cerrar
+    int n_angulos, capacidad_angulos;
+    int *angulo_a, *angulo_b, *angulo_c;
+    double *k_angulo, *cos_angulo;
+    int n_colores_angulos;
+    int *inicio_color_angulos;
+
+    // Vecinos enlazados de la partícula i en vecinos[inicio_vecinos[i] .. inicio_vecinos[i+1])
+    int *inicio_vecinos, *vecinos;
+
+    // Partículas de la molécula m en particulas_molecula[inicio_molecula[m] .. inicio_molecula[m+1])
+    int n_moleculas;
+    int *inicio_molecula, *particulas_molecula;
+
+    // Máscaras por partícula y las mismas partículas en lista
+    unsigned char *fija, *tirada;
+    int n_fijas, n_tiradas;
+    int *fijas, *tiradas;
+} Topologia;
+
+// Topología vacía de N partículas (NULL si falla)
+Topologia *crea_topologia(int N);
+
+void libera_topologia(Topologia *t);
+
+/**
+ * Añade el enlace armónico 0.5 K (r - L)^2 entre i y j.
+ * @return 0 si se añade, 1 si los índices no valen o la topología ya está cerrada.
+ */
+int anade_enlace_topologia(Topologia *t, int i, int j, double K, double L);
+
+/**
+ * Añade la flexión del triplete a-b-c (triplete_flexion de flexion.h, con b en el centro).
+ * @param k        Rigidez.
+ * @param theta_0  Ángulo de equilibrio.
+ * @return 0 si se añade, 1 si los índices no valen o la topología ya está cerrada.
+ */
+int anade_angulo_topologia(Topologia *t, int a, int b, int c, double k, double theta_0);
+
+// Fuerza nula sobre la partícula i / F_cte en z sobre la partícula i
+void fija_particula_topologia(Topologia *t, int i);
+void tira_particula_topologia(Topologia *t, int i);
+
+// Colorea, ordena y construye las listas de vecinos y moléculas. @return 0 si va bien, 1 si no.
+int cierra_topologia(Topologia *t);
+
+/**
+ * Topologías habituales, ya cerradas, con todos los enlaces de constante K y longitud L_0. Con
+ * WLCM llevan los ángulos de cada tramo lineal con la rigidez y theta_0 de parametros_flexion.
+ * La lineal y las cadenas sueltas fijan la primera partícula de cada cadena y tiran de la última
+ * si FIXED, como Fuerza_verlet; en el resto se marcan a mano.
+ */
+Topologia *topologia_lineal(int N, double K);
+Topologia *topologia_anillo(int N, double K);
+// Centro (partícula 0) y 'brazos' brazos de 'por_brazo' partículas
+Topologia *topologia_estrella(int brazos, int por_brazo, double K);
+// Columna de N_columna partículas con una cadena lateral de N_lado cada 'separacion'
+Topologia *topologia_cepillo(int N_columna, int separacion, int N_lado, double K);
+// n_cadenas cadenas lineales de N_cadena partículas, una tras otra en los índices
+Topologia *topologia_cadenas(int n_cadenas, int N_cadena, double K);
+
+/**
+ * Fuerzas de la topología: enlaces, ángulos, F_cte en z sobre las tiradas y cero en las fijas.
+ * @param F  Salida (3N), se sobrescribe.
+ */
+void Fuerza_topologia(const Topologia *t, const double x[], double F[], double F_cte);
+
+// Energía de los enlaces
+double Energia_topologia(const Topologia *t, const double x[]);
+
+// Radio de giro de la molécula m y media de los de todas las moléculas
+double radio_giro_molecula(const Topologia *t, const double x[], int m);
+double radio_giro_topologia(const Topologia *t, const double x[]);
+
+/**
+ * Para pasar una topología a verlet_trayectoria y un_paso_verlet, que reciben la fuerza con la
+ * firma de Fuerza_verlet: configura_topologia fija la topología (no se copia) y
+ * Fuerza_verlet_topologia la usa. K no se usa (cada enlace tiene la suya); F_cte solo con FIXED.
+ */
+void configura_topologia(const Topologia *t);
+
+#ifdef FIXED
+void Fuerza_verlet_topologia(int N, double x[], double F[], double K, double F_cte);
+#else
+void Fuerza_verlet_topologia(int N, double x[], double F[], double K);
+#endif
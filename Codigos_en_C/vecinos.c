@@ -0,0 +1,225 @@
+#include "vecinos.h"
+
+
+typedef struct {
+    int N;
+    int n_pares, cap_pares;
+    int *pares;             // Pares (i, j) con j > i + 1, seguidos
+    double *x_ref;          // Posiciones en la última reconstrucción
+    int n_celdas;           // Tamaño de la tabla hash de celdas (potencia de 2)
+    int *cabeza;            // Primera partícula de cada celda
+    int *siguiente;         // Siguiente partícula de la misma celda
+    int valida;
+    long reconstrucciones;
+} ListaVecinos;
+
+// Una lista por hilo: cada réplica de intercambio.c integra su cadena en su propio hilo
+static _Thread_local ListaVecinos lista = {0};
+
+
+// Celda (entera) de una coordenada
+static inline long celda(double x, double lado) {
+    return (long)floor(x / lado);
+}
+
+static inline int hash_celda(long cx, long cy, long cz, int n_celdas) {
+    unsigned long h = (unsigned long)cx * 73856093UL ^ (unsigned long)cy * 19349663UL ^ (unsigned long)cz * 83492791UL;
+    return (int)(h & (unsigned long)(n_celdas - 1));
+}
+
+static int reserva_lista(int N) {
+    libera_vecinos();
+
+    int n_celdas = 1;
+    while (n_celdas < 2*N) n_celdas *= 2;
+
+    lista.N = N;
+    lista.n_celdas = n_celdas;
+    lista.x_ref = malloc(3*(size_t)N*sizeof(double));
+    lista.cabeza = malloc(n_celdas*sizeof(int));
+    lista.siguiente = malloc(N*sizeof(int));
+    lista.cap_pares = 8*N;
+    lista.pares = malloc(2*(size_t)lista.cap_pares*sizeof(int));
+    if (!lista.x_ref || !lista.cabeza || !lista.siguiente || !lista.pares) {
+        printf("No se pudo reservar memoria para la lista de vecinos (N = %d)\n", N);
+        libera_vecinos();
+        return 0;
+    }
+    return 1;
+}
+
+static void anade_par(int i, int j) {
+    if (lista.n_pares == lista.cap_pares) {
+        int *nuevo = realloc(lista.pares, 4*(size_t)lista.cap_pares*sizeof(int));
+        if (!nuevo) {
+            printf("No se pudo ampliar la lista de vecinos\n");
+            exit(1);
+        }
+        lista.pares = nuevo;
+        lista.cap_pares *= 2;
+    }
+    lista.pares[2*lista.n_pares] = i;
+    lista.pares[2*lista.n_pares + 1] = j;
+    lista.n_pares++;
+}
+
+// Construye la lista de Verlet con celdas enlazadas
+static void construye_lista(int N, double x[]) {
+    double lado = RC_WCA + PIEL_VECINOS;
+    double r2_lista = lado * lado;
+    int n_celdas = lista.n_celdas;
+
+    // 1. Repartir las partículas en celdas
+    for (int h = 0; h < n_celdas; h++) lista.cabeza[h] = -1;
+    for (int i = 0; i < N; i++) {
+        int h = hash_celda(celda(x[3*i], lado), celda(x[3*i+1], lado), celda(x[3*i+2], lado), n_celdas);
+        lista.siguiente[i] = lista.cabeza[h];
+        lista.cabeza[h] = i;
+    }
+
+    // 2. Recorrer las 27 celdas vecinas de cada partícula. Dos celdas distintas pueden caer en la
+    //    misma entrada de la tabla: cada entrada se visita una sola vez y la distancia filtra el resto.
+    lista.n_pares = 0;
+    for (int i = 0; i < N; i++) {
+        long cx = celda(x[3*i], lado), cy = celda(x[3*i+1], lado), cz = celda(x[3*i+2], lado);
+        int visitadas[27];
+        int n_visitadas = 0;
+
+        for (int ox = -1; ox <= 1; ox++)
+        for (int oy = -1; oy <= 1; oy++)
+        for (int oz = -1; oz <= 1; oz++) {
+            int h = hash_celda(cx + ox, cy + oy, cz + oz, n_celdas);
+            int repetida = 0;
+            for (int k = 0; k < n_visitadas; k++) {
+                if (visitadas[k] == h) { repetida = 1; break; }
+            }
+            if (repetida) continue;
+            visitadas[n_visitadas++] = h;
+
+            for (int j = lista.cabeza[h]; j != -1; j = lista.siguiente[j]) {
+                if (j <= i + 1) continue;
+                double dx = x[3*j]   - x[3*i];
+                double dy = x[3*j+1] - x[3*i+1];
+                double dz = x[3*j+2] - x[3*i+2];
+                if (dx*dx + dy*dy + dz*dz < r2_lista) anade_par(i, j);
+            }
+        }
+    }
+
+    memcpy(lista.x_ref, x, 3*(size_t)N*sizeof(double));
+    lista.valida = 1;
+    lista.reconstrucciones++;
+}
+
+// Reconstruye la lista si cambia N o alguna partícula se ha movido más de media piel
+static int actualiza_lista(int N, double x[]) {
+    if (lista.N != N || !lista.pares) {
+        if (!reserva_lista(N)) return 0;
+    }
+
+    if (lista.valida) {
+        double limite2 = 0.25 * PIEL_VECINOS * PIEL_VECINOS;
+        for (int i = 0; i < N; i++) {
+            double dx = x[3*i]   - lista.x_ref[3*i];
+            double dy = x[3*i+1] - lista.x_ref[3*i+1];
+            double dz = x[3*i+2] - lista.x_ref[3*i+2];
+            if (dx*dx + dy*dy + dz*dz > limite2) {
+                lista.valida = 0;
+                break;
+            }
+        }
+    }
+
+    if (!lista.valida) construye_lista(N, x);
+    return 1;
+}
+
+// Factor de fuerza WCA, -U'(r)/r, y energía del par. Devuelve 0 fuera del corte.
+static inline int par_wca(double r2, double *fac, double *U) {
+    if (r2 >= RC_WCA * RC_WCA || r2 == 0.0) return 0;
+    double s2 = SIGMA_WCA * SIGMA_WCA / r2;
+    double s6 = s2 * s2 * s2;
+    double s12 = s6 * s6;
+    *fac = 24.0 * EPSILON_WCA * (2.0*s12 - s6) / r2;
+    *U = 4.0 * EPSILON_WCA * (s12 - s6) + EPSILON_WCA;
+    return 1;
+}
+
+static inline void suma_par(int i, int j, double x[], double F[]) {
+    double dx = x[3*j]   - x[3*i];
+    double dy = x[3*j+1] - x[3*i+1];
+    double dz = x[3*j+2] - x[3*i+2];
+    double fac, U;
+    if (!par_wca(dx*dx + dy*dy + dz*dz, &fac, &U)) return;
+
+    F[3*i]   -= fac * dx;
+    F[3*i+1] -= fac * dy;
+    F[3*i+2] -= fac * dz;
+
+    F[3*j]   += fac * dx;
+    F[3*j+1] += fac * dy;
+    F[3*j+2] += fac * dz;
+}
+
+
+void Fuerza_volumen_excluido(int N, double x[], double F[]) {
+    if (!actualiza_lista(N, x)) return;
+    for (int p = 0; p < lista.n_pares; p++)
+        suma_par(lista.pares[2*p], lista.pares[2*p + 1], x, F);
+}
+
+double Energia_volumen_excluido(int N, double x[]) {
+    if (!actualiza_lista(N, x)) return 0.0;
+    double V = 0.0;
+    for (int p = 0; p < lista.n_pares; p++) {
+        int i = lista.pares[2*p], j = lista.pares[2*p + 1];
+        double dx = x[3*j]   - x[3*i];
+        double dy = x[3*j+1] - x[3*i+1];
+        double dz = x[3*j+2] - x[3*i+2];
+        double fac, U;
+        if (par_wca(dx*dx + dy*dy + dz*dz, &fac, &U)) V += U;
+    }
+    return V;
+}
+
+double Laplaciano_volumen_excluido(int N, double x[], int i_min) {
+    if (!actualiza_lista(N, x)) return 0.0;
+    double lap = 0.0;
+    for (int p = 0; p < lista.n_pares; p++) {
+        int i = lista.pares[2*p], j = lista.pares[2*p + 1];
+        double dx = x[3*j]   - x[3*i];
+        double dy = x[3*j+1] - x[3*i+1];
+        double dz = x[3*j+2] - x[3*i+2];
+        double r2 = dx*dx + dy*dy + dz*dz;
+        double fac, U;
+        if (!par_wca(r2, &fac, &U)) continue;
+
+        // lap_i U = U'' + 2U'/r = 24 eps (22 (s/r)^12 - 5 (s/r)^6) / r^2, igual para las dos partículas
+        double s2 = SIGMA_WCA * SIGMA_WCA / r2;
+        double s6 = s2 * s2 * s2;
+        double lap_par = 24.0 * EPSILON_WCA * (22.0*s6*s6 - 5.0*s6) / r2;
+        lap += (i >= i_min) ? 2.0*lap_par : lap_par;
+    }
+    return lap;
+}
+
+void Fuerza_volumen_excluido_directa(int N, double x[], double F[]) {
+    for (int i = 0; i < N; i++)
+        for (int j = i + 2; j < N; j++)
+            suma_par(i, j, x, F);
+}
+
+void estadisticas_vecinos(long *reconstrucciones, int *n_pares) {
+    if (reconstrucciones) *reconstrucciones = lista.reconstrucciones;
+    if (n_pares) *n_pares = lista.n_pares;
+}
+
+void libera_vecinos(void) {
+    free(lista.pares);
+    free(lista.x_ref);
+    free(lista.cabeza);
+    free(lista.siguiente);
+    long reconstrucciones = lista.reconstrucciones;
+    memset(&lista, 0, sizeof(lista));
+    lista.reconstrucciones = reconstrucciones;
+}
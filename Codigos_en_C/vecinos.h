@@ -0,0 +1,43 @@
+#pragma once
+
+#include "funciones_oscilador.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/**
+ * Volumen excluido: repulsión WCA (Lennard-Jones cortado en su mínimo y desplazado) entre
+ * partículas no enlazadas, U(r) = 4 eps [(s/r)^12 - (s/r)^6] + eps para r < 2^(1/6) s.
+ * Los pares (i, i+1) ya están unidos por el muelle y se excluyen.
+ *
+ * Los pares se buscan con una lista de Verlet de radio r_c + PIEL_VECINOS construida con celdas
+ * enlazadas (de lado r_c + PIEL_VECINOS, guardadas en una tabla hash de tamaño ~2N, así que la
+ * memoria es O(N) aunque la cadena esté muy estirada o muy enrollada). La lista solo se
+ * reconstruye cuando alguna partícula se ha movido más de PIEL_VECINOS/2 desde la última
+ * construcción, así que el coste por llamada es O(N).
+ *
+ * La lista es un estado del módulo propio de cada hilo: sirve para una sola cadena a la vez en
+ * cada hilo (se reconstruye sola si cambia N o las posiciones saltan).
+ */
+
+#define RC_WCA (1.122462048309373 * SIGMA_WCA)  // 2^(1/6) sigma
+
+// Suma a F las fuerzas WCA entre partículas no enlazadas
+void Fuerza_volumen_excluido(int N, double x[], double F[]);
+
+// Energía WCA total de la configuración
+double Energia_volumen_excluido(int N, double x[]);
+
+// Laplaciano de la energía WCA (para la temperatura configuracional). Con i_min = 1 no cuenta la partícula 0.
+double Laplaciano_volumen_excluido(int N, double x[], int i_min);
+
+// Fuerzas WCA por fuerza bruta O(N^2), como referencia para las pruebas
+void Fuerza_volumen_excluido_directa(int N, double x[], double F[]);
+
+// Número de reconstrucciones de la lista y número de pares en la lista actual
+void estadisticas_vecinos(long *reconstrucciones, int *n_pares);
+
+// Libera la lista de vecinos del hilo (se vuelve a crear en la siguiente llamada)
+void libera_vecinos(void);
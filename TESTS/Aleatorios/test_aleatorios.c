@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "random.h"
+
+/*
+ * Test y benchmark de los generadores de random.c, sin escribir ficheros.
+ *  1. La misma semilla da la misma secuencia.
+ *  2. fran: media 1/2 y varianza 1/12, Kolmogorov-Smirnov frente a U(0,1) y correlaciones
+ *     serie en los retardos 1, 24, 55 y 61 (los del Parisi-Rapuano).
+ *  3. Cada generador gaussiano de la tabla (gaussian, gaussianas_float): media, varianza,
+ *     asimetría y curtosis frente a N(0,1), Kolmogorov-Smirnov y las mismas correlaciones.
+ *  4. Ruido por contador (Philox): vectores conocidos de Random123 y la misma gaussiana pedida en
+ *     cualquier orden o reparto en bloques; pasos y réplicas distintos, sin correlación.
+ *  5. Muestras por segundo de cada generador.
+ * Los momentos y correlaciones pasan si están dentro de SIGMAS errores y el KS si p > P_MINIMA.
+ * Para comprobar un generador nuevo basta con añadirlo a la tabla 'gaussianos'.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_aleatorios.exe [muestras]
+ */
+
+#define SIGMAS 5.0
+#define P_MINIMA 1e-3
+#define MUESTRAS_KS 1000000
+#define N_RETARDOS 4
+#define MUESTRAS_VELOCIDAD 20000000
+
+static const int retardos[N_RETARDOS] = {1, 24, 55, 61};
+
+typedef struct {
+    const char *nombre;
+    double (*muestra)(void);
+} Generador;
+
+// gaussianas_float de 256 en 256, con la misma interfaz que gaussian()
+static float reserva_float[256];
+static int quedan_float = 0;
+
+static double gaussiana_float(void) {
+    if (quedan_float == 0) {
+        gaussianas_float(&estado_PR_global, reserva_float, 256, 1.0f);
+        quedan_float = 256;
+    }
+    return reserva_float[256 - quedan_float--];
+}
+
+// Ruido por contador recorrido como en verlet_trayectoria: 3N gaussianas por paso
+#define INDICES_PASO 300
+static RuidoContador ruido_prueba;
+static double reserva_contador[INDICES_PASO];
+static int quedan_contador = 0;
+
+static double gaussiana_contador_bloques(void) {
+    if (quedan_contador == 0) {
+        gaussianas_contador(&ruido_prueba, 0, INDICES_PASO, 1.0, reserva_contador);
+        ruido_prueba.paso++;
+        quedan_contador = INDICES_PASO;
+    }
+    return reserva_contador[INDICES_PASO - quedan_contador--];
+}
+
+// La misma secuencia, de una en una
+static double gaussiana_contador_suelta(void) {
+    double g = gaussiana_contador(&ruido_prueba, INDICES_PASO - quedan_contador--);
+    if (quedan_contador <= 0) {
+        ruido_prueba.paso++;
+        quedan_contador = INDICES_PASO;
+    }
+    return g;
+}
+
+static const Generador gaussianos[] = {
+    {"gaussian", gaussian},
+    {"gaussianas_float", gaussiana_float},
+    {"gaussianas_contador", gaussiana_contador_bloques},
+    {"gaussiana_contador", gaussiana_contador_suelta},
+};
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+static int compara_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double cdf_uniforme(double x) { return x < 0.0 ? 0.0 : (x > 1.0 ? 1.0 : x); }
+static double cdf_normal(double x) { return 0.5 * erfc(-x / sqrt(2.0)); }
+
+// p-valor de Kolmogorov-Smirnov (distribución asintótica, con la corrección de Stephens)
+static double kolmogorov_smirnov(double *datos, int n, double (*cdf)(double), double *D_salida) {
+    qsort(datos, n, sizeof(double), compara_doubles);
+    double D = 0.0;
+    for (int i = 0; i < n; i++) {
+        double F = cdf(datos[i]);
+        double d = fmax(F - (double)i / n, (double)(i + 1) / n - F);
+        if (d > D) D = d;
+    }
+    *D_salida = D;
+    double lambda = (sqrt((double)n) + 0.12 + 0.11 / sqrt((double)n)) * D;
+    double p = 0.0;
+    for (int k = 1; k <= 100; k++) {
+        double termino = 2.0 * exp(-2.0 * k * k * lambda * lambda);
+        p += (k % 2 ? termino : -termino);
+        if (termino < 1e-12) break;
+    }
+    return fmin(fmax(p, 0.0), 1.0);
+}
+
+static int comprueba(const char *que, double valor, double esperado, double error) {
+    int ok = fabs(valor - esperado) <= SIGMAS * error;
+    printf("  %-24s %12.6f  (esperado %9.6f +- %.6f)  %s\n", que, valor, esperado, error, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+/**
+ * Momentos y correlaciones serie en streaming.
+ * @param media, varianza Momentos esperados.
+ * @param mu4 Cuarto momento central esperado (para el error de la varianza).
+ * @return Número de comprobaciones que fallan.
+ */
+static int momentos_y_correlaciones(double (*muestra)(void), long n, double media, double varianza, double mu4,
+                                    int gaussiano) {
+    double historia[64];
+    double s1 = 0.0, s2 = 0.0, s3 = 0.0, s4 = 0.0;
+    double producto[N_RETARDOS] = {0.0};
+    for (long i = 0; i < n; i++) {
+        double x = muestra() - media;
+        s1 += x;
+        s2 += x*x;
+        s3 += x*x*x;
+        s4 += x*x*x*x;
+        for (int r = 0; r < N_RETARDOS; r++)
+            if (i >= retardos[r]) producto[r] += x * historia[(i - retardos[r]) & 63];
+        historia[i & 63] = x;
+    }
+    int fallos = 0;
+    double sigma = sqrt(varianza);
+    fallos += !comprueba("media", media + s1 / n, media, sigma / sqrt((double)n));
+    fallos += !comprueba("varianza", s2 / n, varianza, sqrt((mu4 - varianza*varianza) / n));
+    if (gaussiano) {
+        // Con la media conocida, var(x^3) = 15 y var(x^4) = 96 para N(0,1)
+        fallos += !comprueba("asimetría", s3 / n / pow(varianza, 1.5), 0.0, sqrt(15.0 / n));
+        fallos += !comprueba("curtosis (exceso)", s4 / n / (varianza*varianza) - 3.0, 0.0, sqrt(96.0 / n));
+    }
+    for (int r = 0; r < N_RETARDOS; r++) {
+        char que[32];
+        snprintf(que, sizeof(que), "correlación retardo %d", retardos[r]);
+        fallos += !comprueba(que, producto[r] / (n - retardos[r]) / varianza, 0.0, 1.0 / sqrt((double)(n - retardos[r])));
+    }
+    return fallos;
+}
+
+static int ks(double (*muestra)(void), double (*cdf)(double), double *datos) {
+    for (int i = 0; i < MUESTRAS_KS; i++) datos[i] = muestra();
+    double D;
+    double p = kolmogorov_smirnov(datos, MUESTRAS_KS, cdf, &D);
+    int ok = p > P_MINIMA;
+    printf("  %-24s D = %.6f, p = %.4f  %s\n", "Kolmogorov-Smirnov", D, p, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+// Vectores de prueba de Philox4x32-10 (kat_vectors de Random123)
+static int vectores_philox(void) {
+    const uint32_t casos[3][10] = {
+        {0, 0, 0, 0, 0, 0, 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+        {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+         0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+        {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+         0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1},
+    };
+    int ok = 1;
+    for (int k = 0; k < 3; k++) {
+        uint32_t salida[4];
+        philox4x32_10(casos[k], casos[k] + 4, salida);
+        ok = ok && memcmp(salida, casos[k] + 6, sizeof(salida)) == 0;
+    }
+    printf("  %-24s %s\n", "vectores de Random123", ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+// Recorridos al revés, en bloques de tamaño aleatorio y de uno en uno: los mismos bits
+static int orden_indiferente(void) {
+    enum { n = 3*1000 };
+    static double referencia[n], otra[n];
+    RuidoContador r;
+    inicializa_ruido_contador(&r, 0x0123456789abcdefull, 3);
+    r.paso = 1234567;
+    gaussianas_contador(&r, 0, n, 0.7, referencia);
+    long distintos = 0;
+    for (int i = n - 1; i >= 0; i--) otra[i] = 0.7 * gaussiana_contador(&r, i);
+    for (int i = 0; i < n; i++) distintos += memcmp(&otra[i], &referencia[i], sizeof(double)) != 0;
+    inicializa_PR(99);
+    for (int repeticion = 0; repeticion < 20; repeticion++) {
+        memset(otra, 0, sizeof(otra));
+        for (int inicio = 0; inicio < n; ) {
+            int largo = 1 + (int)(fran() * 200);
+            if (inicio + largo > n) largo = n - inicio;
+            gaussianas_contador(&r, inicio, largo, 0.7, otra + inicio);
+            inicio += largo;
+        }
+        distintos += memcmp(otra, referencia, sizeof(otra)) != 0;
+    }
+    printf("  %-24s %ld distintos  %s\n", "orden y bloques", distintos, distintos ? "FALLA" : "PASA");
+    return distintos == 0;
+}
+
+// Correlación entre la misma gaussiana de dos flujos (paso siguiente, réplica vecina, clave vecina)
+static int flujos_independientes(long n) {
+    RuidoContador a, b, c, d;
+    inicializa_ruido_contador(&a, 777, 0);
+    b = a;
+    c = a;
+    inicializa_ruido_contador(&d, 778, 0);
+    c.replica = 1;
+    double s_ab = 0.0, s_ac = 0.0, s_ad = 0.0;
+    for (long i = 0; i < n; i++) {
+        a.paso = c.paso = d.paso = (uint64_t)i / INDICES_PASO;
+        b.paso = a.paso + 1;
+        uint32_t k = (uint32_t)(i % INDICES_PASO);
+        double x = gaussiana_contador(&a, k);
+        s_ab += x * gaussiana_contador(&b, k);
+        s_ac += x * gaussiana_contador(&c, k);
+        s_ad += x * gaussiana_contador(&d, k);
+    }
+    int fallos = 0;
+    fallos += !comprueba("correlación paso+1", s_ab / n, 0.0, 1.0 / sqrt((double)n));
+    fallos += !comprueba("correlación réplica 1", s_ac / n, 0.0, 1.0 / sqrt((double)n));
+    fallos += !comprueba("correlación semilla+1", s_ad / n, 0.0, 1.0 / sqrt((double)n));
+    return fallos;
+}
+
+static void velocidad(const char *nombre, double (*muestra)(void)) {
+    volatile double sumidero = 0.0;
+    double suma = 0.0;
+    double t0 = segundos();
+    for (long i = 0; i < MUESTRAS_VELOCIDAD; i++) suma += muestra();
+    double t = segundos() - t0;
+    sumidero = suma;
+    (void)sumidero;
+    printf("  %-24s %8.1f millones de muestras/s (%.2f ns/muestra)\n", nombre, MUESTRAS_VELOCIDAD / t / 1e6,
+           1e9 * t / MUESTRAS_VELOCIDAD);
+}
+
+int main(int argc, char *argv[]) {
+    long n = argc > 1 ? atol(argv[1]) : 10000000;
+    int fallos = 0;
+    double *datos = malloc(MUESTRAS_KS*sizeof(double));
+    if (!datos) return 1;
+
+    // 1. Reproducibilidad
+    inicializa_PR(2024);
+    double primeras[8];
+    for (int i = 0; i < 8; i++) primeras[i] = fran();
+    inicializa_PR(2024);
+    int ok = 1;
+    for (int i = 0; i < 8; i++) ok = ok && fran() == primeras[i];
+    printf("Misma semilla, misma secuencia  %s\n", ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 2. Uniforme
+    printf("\nfran (%ld muestras)\n", n);
+    inicializa_PR(12345);
+    fallos += momentos_y_correlaciones(fran, n, 0.5, 1.0 / 12.0, 1.0 / 80.0, 0);
+    if (!ks(fran, cdf_uniforme, datos)) fallos++;
+
+    // 3. Gaussianos
+    for (size_t g = 0; g < sizeof(gaussianos) / sizeof(gaussianos[0]); g++) {
+        printf("\n%s (%ld muestras)\n", gaussianos[g].nombre, n);
+        inicializa_PR(54321);
+        quedan_float = 0;
+        inicializa_ruido_contador_desde(&ruido_prueba, &estado_PR_global, 0);
+        quedan_contador = 0;
+        if (gaussianos[g].muestra == gaussiana_contador_suelta) quedan_contador = INDICES_PASO;
+        fallos += momentos_y_correlaciones(gaussianos[g].muestra, n, 0.0, 1.0, 3.0, 1);
+        if (!ks(gaussianos[g].muestra, cdf_normal, datos)) fallos++;
+    }
+
+    // 4. Ruido por contador
+    printf("\nRuido por contador\n");
+    if (!vectores_philox()) fallos++;
+    if (!orden_indiferente()) fallos++;
+    fallos += flujos_independientes(n / 10);
+
+    // 5. Velocidad
+    printf("\nVelocidad\n");
+    inicializa_PR(1);
+    velocidad("fran", fran);
+    for (size_t g = 0; g < sizeof(gaussianos) / sizeof(gaussianos[0]); g++)
+        velocidad(gaussianos[g].nombre, gaussianos[g].muestra);
+
+    free(datos);
+    printf("\n%s\n", fallos ? "FALLA" : "PASA");
+    return fallos ? 1 : 0;
+}
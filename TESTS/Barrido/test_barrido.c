@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "barrido.h"
+
+/*
+ * Test del barrido adaptativo de fuerzas (barrido.c), con una cadena corta (FIXED).
+ *  1. La curva es coherente: <Ree> crece con F dentro de las barras de error, es compatible con 0
+ *     a fuerza pequeña y no pasa de (N-1) L_0 más el estiramiento F/K de los muelles. La curva de
+ *     Langevin se imprime como referencia: el modelo se separa de ella y eso también se refina.
+ *  2. Los puntos añadidos se concentran donde la curva se dobla o se separa de Langevin
+ *     (F ~ 0.1-8 kT/L_0) y no en las zonas casi planas de los extremos.
+ *  3. Cada punto se para al llegar al error objetivo: el tiempo total es menor que el de la misma
+ *     rejilla con T_maximo en todos los puntos.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_barrido.exe [error_objetivo]
+ */
+
+#define N_CADENA 4
+#define K_MUELLE 1000.0
+#define SIGMAS 4.0
+
+int main(int argc, char *argv[]) {
+#ifndef FIXED
+    (void)argc; (void)argv;
+    printf("El barrido de fuerzas necesita FIXED\n");
+    return 0;
+#else
+    ParametrosBarrido pb = parametros_barrido_defecto();
+    pb.F_min = 0.01;
+    pb.F_max = 20.0;
+    pb.n_inicial = 4;
+    pb.max_puntos = 8;
+    pb.error_objetivo = argc > 1 ? atof(argv[1]) : 0.06;
+    pb.T_equilibrado = 10.0;
+    pb.T_trozo = 20.0;
+    pb.T_maximo = 400.0;
+    int fallos = 0;
+
+    inicializa_PR(777);
+    const char *archivo = "barrido_test.txt";
+    clock_t t0 = clock();
+    int n = barrido_fuerzas(&pb, 1.0, 1.0, 0.5, N_CADENA, 0.0003, 1.0, K_MUELLE, archivo);
+    clock_t t1 = clock();
+    if (n < pb.n_inicial) {
+        printf("El barrido no ha terminado (%d puntos)\n", n);
+        return 1;
+    }
+
+    FILE *f = fopen(archivo, "r");
+    char linea[512];
+    double F[64], Ree[64], error[64], T[64];
+    int leidos = 0;
+    while (fgets(linea, sizeof(linea), f) && leidos < 64) {
+        if (linea[0] == '#') continue;
+        if (sscanf(linea, "%lf %lf %lf %lf", &F[leidos], &Ree[leidos], &error[leidos], &T[leidos]) == 4) leidos++;
+    }
+    fclose(f);
+    remove(archivo);
+
+    // 1. Coherencia de la curva
+    printf("\n%10s %10s %10s %10s %10s\n", "F_cte", "Ree", "error", "Langevin", "T");
+    int incoherentes = 0;
+    double T_total = 0.0;
+    for (int i = 0; i < leidos; i++) {
+        double maximo = (N_CADENA - 1) * (L_0 + F[i] / K_MUELLE);
+        int ok = Ree[i] <= maximo + SIGMAS * error[i];
+        if (i == 0) ok = ok && fabs(Ree[i]) <= SIGMAS * error[i] + ree_langevin(F[i], N_CADENA, 1.0, 1.0);
+        if (i > 0) ok = ok && Ree[i] >= Ree[i-1] - SIGMAS * (error[i] + error[i-1]);
+        if (!ok) incoherentes++;
+        printf("%10.4f %10.4f %10.4f %10.4f %10.1f %s\n", F[i], Ree[i], error[i],
+               ree_langevin(F[i], N_CADENA, 1.0, 1.0), T[i], ok ? "" : "<- INCOHERENTE");
+        T_total += T[i];
+    }
+    int ok = incoherentes == 0;
+    printf("Puntos coherentes: %d/%d  %s\n", leidos - incoherentes, leidos, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 2. Refinamiento donde se dobla la curva
+    int en_curva = 0, fuera_curva = 0;
+    double razon = pow(pb.F_max / pb.F_min, 1.0 / (pb.n_inicial - 1));
+    for (int i = 0; i < leidos; i++) {
+        int inicial = 0;
+        for (int j = 0; j < pb.n_inicial; j++)
+            if (fabs(F[i] / (pb.F_min * pow(razon, j)) - 1.0) < 1e-4) inicial = 1;
+        if (inicial) continue;
+        if (F[i] >= 0.1 && F[i] <= 8.0) en_curva++;
+        else fuera_curva++;
+    }
+    ok = en_curva > fuera_curva;
+    printf("Puntos añadidos en la zona curva: %d, fuera: %d  %s\n", en_curva, fuera_curva, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 3. Tiempo frente a la rejilla fija
+    double T_fijo = leidos * pb.T_maximo;
+    ok = T_total < T_fijo;
+    printf("Tiempo simulado: %.0f frente a %.0f con T_maximo en cada punto (%.1fx), %.1f s de CPU  %s\n",
+           T_total, T_fijo, T_fijo / T_total, (double)(t1 - t0) / CLOCKS_PER_SEC, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    return fallos ? 1 : 0;
+#endif
+}
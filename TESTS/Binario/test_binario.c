@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+#include "binario.h"
+
+/*
+ * Test de las trayectorias binarias (binario.c).
+ *  1. Lo escrito se lee igual bit a bit, y con la salida aún abierta el lector ve exactamente
+ *     los registros ya volcados.
+ *  2. Un fichero que no es una trayectoria binaria se rechaza.
+ *  3. Con SALIDA_BINARIA, el .bin de verlet_trayectoria coincide con el .txt (a 1e-6).
+ *  4. Tiempo de leer la misma tabla del texto (fscanf) y del binario (mmap).
+ * Los ficheros se crean en el directorio actual y se borran al terminar.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_binario.exe [registros]
+ */
+
+#define N_PRUEBA 16
+#define RUTA_BIN "prueba_binario.bin"
+#define RUTA_TXT "prueba_binario.txt"
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+static double valor(long r, int c) { return sin(0.001 * r + 0.37 * c) * (1.0 + c); }
+
+static int escritura_y_lectura(long registros) {
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    double *fila = malloc(columnas*sizeof(double));
+    SalidaBinaria *s = abre_salida_binaria(RUTA_BIN, N_PRUEBA, 1, 0.001);
+    if (!s || !fila) return 0;
+
+    int ok = 1;
+    long mitad = registros / 2;
+    for (long r = 0; r < registros; r++) {
+        for (int c = 0; c < columnas; c++) fila[c] = valor(r, c);
+        escribe_registro_binario(s, fila);
+        if (r + 1 == mitad) {
+            // Lectura en vivo: solo los registros volcados
+            TrayectoriaBinaria t;
+            ok = ok && abre_trayectoria_binaria(RUTA_BIN, &t);
+            ok = ok && t.registros == (mitad / REGISTROS_VOLCADO) * REGISTROS_VOLCADO;
+            cierra_trayectoria_binaria(&t);
+            printf("En vivo tras %ld registros se ven %ld  %s\n", mitad,
+                   (long)((mitad / REGISTROS_VOLCADO) * REGISTROS_VOLCADO), ok ? "PASA" : "FALLA");
+        }
+    }
+    cierra_salida_binaria(s);
+
+    TrayectoriaBinaria t;
+    int iguales = abre_trayectoria_binaria(RUTA_BIN, &t) && t.registros == registros && t.columnas == columnas
+                  && t.cabecera->N == N_PRUEBA && t.cabecera->dt == 0.001;
+    for (long r = 0; iguales && r < registros; r++)
+        for (int c = 0; c < columnas; c++)
+            if (t.datos[r*columnas + c] != valor(r, c)) iguales = 0;
+    cierra_trayectoria_binaria(&t);
+    printf("%ld registros de %d columnas, leídos bit a bit  %s\n", registros, columnas, iguales ? "PASA" : "FALLA");
+    free(fila);
+    return ok && iguales;
+}
+
+static int rechaza_texto(void) {
+    FILE *f = fopen(RUTA_TXT, "w");
+    if (!f) return 0;
+    for (int i = 0; i < 100; i++) fprintf(f, "%.6f %.6f\n", i * 0.1, i * 0.2);
+    fclose(f);
+    TrayectoriaBinaria t;
+    int ok = !abre_trayectoria_binaria(RUTA_TXT, &t);
+    printf("Un .txt no se acepta como binario  %s\n", ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+#if defined(SALIDA_BINARIA) && !defined(SALIDA_COMPRIMIDA)
+// Borra lo que verlet_trayectoria deja en <carpeta>/*_prueba_binario.txt
+static void borra_auxiliares(const char *carpeta) {
+    DIR *d = opendir(carpeta);
+    if (!d) return;
+    struct dirent *e;
+    char ruta[512];
+    while ((e = readdir(d))) {
+        if (!strstr(e->d_name, "_" RUTA_TXT)) continue;
+        snprintf(ruta, sizeof(ruta), "%s/%s", carpeta, e->d_name);
+        remove(ruta);
+    }
+    closedir(d);
+    remove(carpeta);  // Solo si ha quedado vacía
+}
+
+static int coincide_con_texto(void) {
+    int N = 4;
+    double x_0[12], v_0[12];
+    for (int i = 0; i < N; i++) {
+        x_0[3*i] = 0.0; x_0[3*i+1] = 0.0; x_0[3*i+2] = i;
+        v_0[3*i] = v_0[3*i+1] = v_0[3*i+2] = 0.0;
+    }
+    inicializa_PR(5);
+    #ifdef FIXED
+    verlet_trayectoria("prueba", 1.0, 1.0, 0.5, N, 0.001, 1.0, 20000, Fuerza_verlet, RUTA_TXT, x_0, v_0, 100.0, 1.0);
+    #else
+    verlet_trayectoria("prueba", 1.0, 1.0, 0.5, N, 0.001, 1.0, 20000, Fuerza_verlet, RUTA_TXT, x_0, v_0, 100.0);
+    #endif
+    TrayectoriaBinaria t;
+    FILE *f = fopen(RUTA_TXT, "r");
+    if (!f || !abre_trayectoria_binaria(RUTA_BIN, &t)) return 0;
+    char linea[8192];
+    fgets(linea, sizeof(linea), f);
+    long r = 0;
+    double maximo = 0.0;
+    while (fgets(linea, sizeof(linea), f) && r < t.registros) {
+        char *p = linea;
+        for (int c = 0; c < t.columnas; c++) {
+            double d = fabs(strtod(p, &p) - t.datos[r*t.columnas + c]);
+            if (d > maximo) maximo = d;
+        }
+        r++;
+    }
+    fclose(f);
+    int ok = r == t.registros && r > 0 && maximo <= 1e-6;
+    printf("verlet_trayectoria: %ld filas, diferencia máxima con el .txt %.2e  %s\n", r, maximo, ok ? "PASA" : "FALLA");
+    cierra_trayectoria_binaria(&t);
+    borra_auxiliares("DISTRIBUCIONES");
+    borra_auxiliares("CORRELACIONES");
+    borra_auxiliares("ESTIMADORES");
+    borra_auxiliares("FORMA");
+    return ok;
+}
+#endif
+
+static void compara_lectura(long registros) {
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    FILE *f = fopen(RUTA_TXT, "w");
+    SalidaBinaria *s = abre_salida_binaria(RUTA_BIN, N_PRUEBA, 1, 0.001);
+    double *fila = malloc(columnas*sizeof(double));
+    if (!f || !s || !fila) return;
+    for (long r = 0; r < registros; r++) {
+        for (int c = 0; c < columnas; c++) {
+            fila[c] = valor(r, c);
+            fprintf(f, c ? " %.6f" : "%.6f", fila[c]);
+        }
+        fprintf(f, "\n");
+        escribe_registro_binario(s, fila);
+    }
+    fclose(f);
+    cierra_salida_binaria(s);
+
+    double t0 = segundos(), suma_texto = 0.0, x;
+    f = fopen(RUTA_TXT, "r");
+    while (fscanf(f, "%lf", &x) == 1) suma_texto += x;
+    fclose(f);
+    double t1 = segundos();
+    TrayectoriaBinaria t;
+    double suma_binario = 0.0;
+    if (abre_trayectoria_binaria(RUTA_BIN, &t)) {
+        for (long i = 0; i < t.registros * t.columnas; i++) suma_binario += t.datos[i];
+        cierra_trayectoria_binaria(&t);
+    }
+    double t2 = segundos();
+    printf("Leer %ld x %d: texto %.3f s, binario %.4f s (x%.0f)  [sumas %.3f, %.3f]\n", registros, columnas,
+           t1 - t0, t2 - t1, (t1 - t0) / (t2 - t1), suma_texto, suma_binario);
+    free(fila);
+}
+
+int main(int argc, char *argv[]) {
+    long registros = argc > 1 ? atol(argv[1]) : 100000;
+    int fallos = 0;
+
+    if (!escritura_y_lectura(registros + 17)) fallos++;
+    if (!rechaza_texto()) fallos++;
+    #if defined(SALIDA_BINARIA) && !defined(SALIDA_COMPRIMIDA)
+    if (!coincide_con_texto()) fallos++;
+    #else
+    printf("Sin SALIDA_BINARIA (o con SALIDA_COMPRIMIDA) no se compara con verlet_trayectoria\n");
+    #endif
+    compara_lectura(registros);
+
+    remove(RUTA_BIN);
+    remove(RUTA_TXT);
+    return fallos ? 1 : 0;
+}
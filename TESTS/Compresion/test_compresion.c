@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "simulacion.h"
+#include "compresion.h"
+
+/*
+ * Test de la compresión de trayectorias (compresion.c), con filas de una simulación real
+ * (simulacion.h) guardadas cada 'cada' pasos como en la salida de verlet_trayectoria.
+ *  1. Sin pérdidas se recupera bit a bit, también con NaN, infinitos y -0.
+ *  2. Cuantizada, el error de cada valor no pasa de la precisión pedida, y valores saturados (±2^62
+ *     pasos) con signos alternos, que desbordan las predicciones, se recuperan exactos.
+ *  3. Tamaño frente al .txt (%.6f) y al .bin, y velocidad de compresión frente a fprintf.
+ *  4. descomprime_a_binario da el .bin de las mismas filas.
+ *  5. Un fichero que no es .cmp se rechaza y uno truncado se lee hasta el corte.
+ * Los ficheros se crean en el directorio actual y se borran al terminar.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_compresion.exe [filas] [pasos entre filas]
+ */
+
+#define N_PRUEBA 16
+#define RUTA_CMP "prueba_compresion.cmp"
+#define RUTA_BIN "prueba_compresion.bin"
+#define RUTA_TXT "prueba_compresion.txt"
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+// filas x columnas_binarias(N_PRUEBA, 1) de una cadena con un extremo fijo y fuerza 1
+static double *genera_filas(long filas, long cada) {
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    double *datos = malloc(filas*columnas*sizeof(double));
+    ConfiguracionSimulacion c = configuracion_simulacion_defecto();
+    c.N = N_PRUEBA;
+    c.F_cte = 1.0;
+    Simulacion *s = crea_simulacion(&c, NULL);
+    if (!s || !datos) return NULL;
+    avanza_simulacion(s, 10*cada);
+    ObservablesSimulacion o;
+    for (long r = 0; r < filas; r++) {
+        avanza_simulacion(s, cada);
+        observa_simulacion(s, &o);
+        double *fila = datos + r*columnas;
+        fila[0] = o.t;
+        estado_simulacion(s, fila + 1, fila + 1 + 3*N_PRUEBA);
+        fila[1 + 6*N_PRUEBA] = o.Ek;
+        fila[2 + 6*N_PRUEBA] = o.Ep;
+        fila[3 + 6*N_PRUEBA] = o.Et;
+        fila[4 + 6*N_PRUEBA] = o.Rg;
+        fila[5 + 6*N_PRUEBA] = o.Ree;
+    }
+    destruye_simulacion(s);
+    return datos;
+}
+
+static long long comprime(const double *datos, long filas, ModoCompresion modo, double precision, double *tiempo) {
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    Compresor *c = abre_compresor(RUTA_CMP, modo, precision, N_PRUEBA, 1, 0.0003);
+    if (!c) return -1;
+    double t0 = segundos();
+    for (long r = 0; r < filas; r++) comprime_registro(c, datos + r*columnas);
+    long long bytes = bytes_compresor(c);
+    cierra_compresor(c);
+    if (tiempo) *tiempo = segundos() - t0;
+    return bytes;
+}
+
+// Lee RUTA_CMP y devuelve el mayor error absoluto frente a datos (o -1 si no se leen todas las filas)
+static double error_maximo(const double *datos, long filas, double *tiempo) {
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    Descompresor *d = abre_descompresor(RUTA_CMP);
+    double *fila = malloc(columnas*sizeof(double));
+    if (!d || !fila) return -1.0;
+    double maximo = 0.0, t0 = segundos();
+    long r = 0;
+    while (lee_registro_comprimido(d, fila)) {
+        for (int c = 0; c < columnas && r < filas; c++) {
+            double e = fabs(fila[c] - datos[r*columnas + c]);
+            if (e > maximo) maximo = e;
+        }
+        r++;
+    }
+    if (tiempo) *tiempo = segundos() - t0;
+    cierra_descompresor(d);
+    free(fila);
+    return r == filas ? maximo : -1.0;
+}
+
+static int sin_perdidas(const double *datos, long filas) {
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    // Unas filas con valores especiales al final
+    long extra = 4;
+    double *todos = malloc((filas + extra)*columnas*sizeof(double));
+    memcpy(todos, datos, filas*columnas*sizeof(double));
+    double especiales[] = {NAN, INFINITY, -INFINITY, -0.0, 1e300, -1e-300, 5e-324};
+    for (long k = 0; k < extra*columnas; k++) {
+        double *v = todos + filas*columnas + k;
+        *v = k % 3 ? especiales[k % 7] : datos[k % (filas*columnas)];
+    }
+    if (comprime(todos, filas + extra, COMPRESION_SIN_PERDIDAS, 0.0, NULL) < 0) return 0;
+
+    Descompresor *d = abre_descompresor(RUTA_CMP);
+    double *fila = malloc(columnas*sizeof(double));
+    long r = 0;
+    int iguales = d != NULL;
+    while (iguales && lee_registro_comprimido(d, fila)) {
+        if (r >= filas + extra || memcmp(fila, todos + r*columnas, columnas*sizeof(double)) != 0) iguales = 0;
+        r++;
+    }
+    iguales = iguales && r == filas + extra && cabecera_descompresor(d)->registros == filas + extra;
+    cierra_descompresor(d);
+    printf("Sin pérdidas: %ld filas (con NaN, inf y -0) bit a bit  %s\n", filas + extra, iguales ? "PASA" : "FALLA");
+    free(fila);
+    free(todos);
+    return iguales;
+}
+
+static int cuantizada(const double *datos, long filas) {
+    double precisiones[] = {1e-6, 1e-4, 1e-3, 1e-2};
+    int ok = 1;
+    for (int k = 0; k < 4; k++) {
+        if (comprime(datos, filas, COMPRESION_CUANTIZADA, precisiones[k], NULL) < 0) return 0;
+        double e = error_maximo(datos, filas, NULL);
+        // Redondeo de q*paso: unos ulp por encima de la precisión
+        int bien = e >= 0.0 && e <= precisiones[k] * (1.0 + 1e-9);
+        printf("Cuantizada con precisión %g: error máximo %.3g  %s\n", precisiones[k], e, bien ? "PASA" : "FALLA");
+        ok = ok && bien;
+    }
+    printf("Precisión 0 (se espera mensaje):\n");
+    ok = ok && abre_compresor(RUTA_CMP, COMPRESION_CUANTIZADA, 0.0, N_PRUEBA, 1, 0.0003) == NULL;
+    return ok;
+}
+
+// Con precisión 0.5 (paso 1) los valores ±2^62 son exactos: la predicción lineal 2*q1 - q2 llega a
+// ±3*2^62 y el residuo a ±4*2^62, que solo se recuperan si la aritmética da la vuelta igual al leer
+static int saturados(void) {
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    long filas = 6;
+    double *datos = malloc(filas*columnas*sizeof(double));
+    if (!datos) return 0;
+    for (long r = 0; r < filas; r++)
+        for (int c = 0; c < columnas; c++)
+            datos[r*columnas + c] = ((r + c) % 2 ? -1.0 : 1.0) * ldexp(1.0, 62);
+    int ok = comprime(datos, filas, COMPRESION_CUANTIZADA, 0.5, NULL) >= 0 && error_maximo(datos, filas, NULL) == 0.0;
+    printf("Cuantizada con valores saturados de signos alternos: exactos  %s\n", ok ? "PASA" : "FALLA");
+    free(datos);
+    return ok;
+}
+
+static int tamanos(const double *datos, long filas, long cada) {
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    FILE *f = fopen(RUTA_TXT, "w");
+    if (!f) return 0;
+    double t0 = segundos();
+    for (long r = 0; r < filas; r++) {
+        for (int c = 0; c < columnas; c++) fprintf(f, c ? " %.6f" : "%.6f", datos[r*columnas + c]);
+        fprintf(f, "\n");
+    }
+    long long texto = ftell(f);
+    fclose(f);
+    double t_texto = segundos() - t0;
+    long long binario = sizeof(CabeceraBinaria) + filas*columnas*(long long)sizeof(double);
+    double mb = filas*columnas*sizeof(double) / 1e6;
+
+    printf("%ld filas de %d columnas cada %ld pasos: texto %lld bytes (%.0f MB/s con fprintf), binario %lld\n",
+           filas, columnas, cada, texto, mb / t_texto, binario);
+    double precisiones[] = {0.0, 1e-6, 1e-4, 1e-3, 1e-2};
+    long long anterior = binario;
+    int ok = 1;
+    for (int k = 0; k < 5; k++) {
+        double t_comprime, t_lee;
+        ModoCompresion modo = precisiones[k] > 0.0 ? COMPRESION_CUANTIZADA : COMPRESION_SIN_PERDIDAS;
+        long long bytes = comprime(datos, filas, modo, precisiones[k], &t_comprime);
+        error_maximo(datos, filas, &t_lee);
+        char etiqueta[32];
+        if (k) snprintf(etiqueta, sizeof(etiqueta), "precisión %g", precisiones[k]);
+        else snprintf(etiqueta, sizeof(etiqueta), "sin pérdidas");
+        printf("  %-16s %9lld bytes  x%.1f texto  x%.1f binario  comprime %.0f MB/s  descomprime %.0f MB/s\n",
+               etiqueta, bytes, (double)texto / bytes, (double)binario / bytes, mb / t_comprime, mb / t_lee);
+        // Cada modo más grueso ocupa menos que el anterior (y sin pérdidas menos que el binario)
+        ok = ok && bytes > 0 && bytes < anterior;
+        anterior = bytes;
+    }
+    printf("Tamaños decrecientes con la precisión  %s\n", ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+static int a_binario(const double *datos, long filas) {
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    if (comprime(datos, filas, COMPRESION_SIN_PERDIDAS, 0.0, NULL) < 0) return 0;
+    long long escritas = descomprime_a_binario(RUTA_CMP, RUTA_BIN);
+    TrayectoriaBinaria t;
+    int ok = escritas == filas && abre_trayectoria_binaria(RUTA_BIN, &t);
+    if (ok) {
+        ok = t.registros == filas && t.columnas == columnas && t.cabecera->N == N_PRUEBA
+             && memcmp(t.datos, datos, filas*columnas*sizeof(double)) == 0;
+        cierra_trayectoria_binaria(&t);
+    }
+    printf("descomprime_a_binario: %lld filas iguales al original  %s\n", escritas, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+static int rechaza_invalidos(const double *datos, long filas) {
+    FILE *f = fopen(RUTA_TXT, "w");
+    if (!f) return 0;
+    for (int i = 0; i < 100; i++) fprintf(f, "%.6f %.6f\n", i * 0.1, i * 0.2);
+    fclose(f);
+    printf("Un .txt como .cmp (se espera mensaje):\n");
+    int ok = abre_descompresor(RUTA_TXT) == NULL;
+
+    // Truncado a mitad de fichero: se leen las filas completas anteriores al corte
+    long long bytes = comprime(datos, filas, COMPRESION_CUANTIZADA, 1e-4, NULL);
+    if (truncate(RUTA_CMP, bytes / 2) != 0) return 0;
+    int columnas = columnas_binarias(N_PRUEBA, 1);
+    Descompresor *d = abre_descompresor(RUTA_CMP);
+    double *fila = malloc(columnas*sizeof(double));
+    long r = 0;
+    int bien = d != NULL;
+    while (bien && lee_registro_comprimido(d, fila)) {
+        for (int c = 0; c < columnas; c++) if (fabs(fila[c] - datos[r*columnas + c]) > 1e-4 * (1.0 + 1e-9)) bien = 0;
+        r++;
+    }
+    cierra_descompresor(d);
+    free(fila);
+    ok = ok && bien && r > 0 && r < filas;
+    printf("Se rechaza un .txt y un .cmp truncado se lee hasta la fila %ld de %ld  %s\n", r, filas,
+           ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    long filas = argc > 1 ? atol(argv[1]) : 2000;
+    long cada = argc > 2 ? atol(argv[2]) : 333;
+    int fallos = 0;
+
+    double *datos = genera_filas(filas, cada);
+    if (!datos) return 1;
+    if (!sin_perdidas(datos, filas)) fallos++;
+    if (!cuantizada(datos, filas)) fallos++;
+    if (!saturados()) fallos++;
+    if (!tamanos(datos, filas, cada)) fallos++;
+    if (!a_binario(datos, filas)) fallos++;
+    if (!rechaza_invalidos(datos, filas)) fallos++;
+
+    free(datos);
+    remove(RUTA_CMP);
+    remove(RUTA_BIN);
+    remove(RUTA_TXT);
+    return fallos ? 1 : 0;
+}
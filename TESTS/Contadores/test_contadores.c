@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include "integracion.h"
+#include "contadores.h"
+
+/*
+ * Test de los contadores hardware por fase (contadores.c).
+ *  1. Se abren siempre: con perf_event_open disponible cuentan eventos y, si no, se quedan en
+ *     solo tiempos con el motivo (no falla en contenedores ni con perf_event_paranoid alto).
+ *  2. Se mide uno de cada PASOS_CONTADORES pasos y fuera de ellos fase_contadores no suma nada;
+ *     con NULL todas las llamadas son inocuas.
+ *  3. Una fase con el triple de trabajo que otra cuenta, si hay contadores, tres veces más
+ *     instrucciones. El cociente de tiempos depende de la carga de la máquina: solo avisa.
+ *  4. actualiza_posiciones_verlet + Fuerza + actualiza_velocidades_verlet, el paso por partes que
+ *     se usa al medir, reproduce un_paso_verlet bit a bit.
+ *  5. escribe_contadores_hardware deja CONTADORES/contadores_<archivo> con una línea por fase y,
+ *     con CONTADORES_HARDWARE, verlet_trayectoria la escribe con las fases del paso.
+ * Los ficheros se crean en el directorio actual y se borran al terminar.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_contadores.exe
+ */
+
+#define RUTA_TXT "prueba_contadores.txt"
+#define PASOS_MUESTREO 64000
+#define TRABAJO 20000
+
+static volatile double sumidero;
+
+static void trabaja(int n) {
+    double s = 0.0;
+    for (int i = 0; i < n; i++) s += 1.0 / (1.0 + i);
+    sumidero = s;
+}
+
+static int abre(void) {
+    ContadoresHardware *c = abre_contadores_hardware();
+    int ok = c && (contadores_disponibles(c) || motivo_contadores(c)[0] != '\0');
+    if (c && contadores_disponibles(c))
+        printf("Contadores disponibles: ciclos %d, instrucciones %d, fallos de caché %d, fallos de salto %d  %s\n",
+               evento_disponible(c, EVENTO_CICLOS), evento_disponible(c, EVENTO_INSTRUCCIONES),
+               evento_disponible(c, EVENTO_FALLOS_CACHE), evento_disponible(c, EVENTO_FALLOS_SALTO),
+               ok ? "PASA" : "FALLA");
+    else
+        printf("Contadores no disponibles, solo tiempos (%s)  %s\n", motivo_contadores(c), ok ? "PASA" : "FALLA");
+    cierra_contadores_hardware(c);
+    return ok;
+}
+
+static int muestreo(void) {
+    ContadoresHardware *c = abre_contadores_hardware();
+    long long medidos = 0;
+    int fuera = 0;      // Fases que suman fuera de un paso medido
+    for (int paso = 0; paso < PASOS_MUESTREO; paso++) {
+        int medido = empieza_paso_contadores(c);
+        medidos += medido;
+        long long antes = fase_medida_contadores(c, FASE_RUIDO)->veces;
+        fase_contadores(c, FASE_RUIDO);
+        if (!medido && fase_medida_contadores(c, FASE_RUIDO)->veces != antes) fuera++;
+        termina_paso_contadores(c);
+    }
+    double esperados = (double)PASOS_MUESTREO / PASOS_CONTADORES;
+    int ok = medidos == pasos_medidos_contadores(c) && pasos_totales_contadores(c) == PASOS_MUESTREO
+             && fabs(medidos - esperados) < 0.1*esperados && fuera == 0;
+    cierra_contadores_hardware(c);
+
+    // Sin contadores (NULL) no hace nada
+    ok = ok && !empieza_paso_contadores(NULL);
+    fase_contadores(NULL, FASE_FUERZA);
+    termina_paso_contadores(NULL);
+    cierra_contadores_hardware(NULL);
+
+    printf("Muestreo: %lld pasos medidos de %d (%.0f esperados), %d fases fuera  %s\n", medidos, PASOS_MUESTREO,
+           esperados, fuera, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+static int reparto(void) {
+    ContadoresHardware *c = abre_contadores_hardware();
+    for (int paso = 0; paso < 200*PASOS_CONTADORES; paso++) {
+        if (!empieza_paso_contadores(c)) continue;
+        trabaja(TRABAJO);
+        fase_contadores(c, FASE_RUIDO);
+        trabaja(3*TRABAJO);
+        fase_contadores(c, FASE_FUERZA);
+        termina_paso_contadores(c);
+    }
+    const FaseMedida *uno = fase_medida_contadores(c, FASE_RUIDO), *tres = fase_medida_contadores(c, FASE_FUERZA);
+    double cociente_ns = tres->ns / uno->ns;
+    int ok = uno->veces > 0 && uno->veces == tres->veces;
+    if (!(cociente_ns > 2.0 && cociente_ns < 4.5))
+        printf("Aviso: cociente de tiempos %.2f lejos de 3 (¿máquina cargada?)\n", cociente_ns);
+    if (evento_disponible(c, EVENTO_INSTRUCCIONES)) {
+        double cociente = tres->cuenta[EVENTO_INSTRUCCIONES] / uno->cuenta[EVENTO_INSTRUCCIONES];
+        ok = ok && cociente > 2.8 && cociente < 3.2;
+        printf("Trabajo 1:3 -> tiempo %.2f, instrucciones %.3f  %s\n", cociente_ns, cociente, ok ? "PASA" : "FALLA");
+    } else {
+        printf("Trabajo 1:3 -> tiempo %.2f  %s\n", cociente_ns, ok ? "PASA" : "FALLA");
+    }
+    cierra_contadores_hardware(c);
+    return ok;
+}
+
+static int paso_por_partes(void) {
+    int N = 7, pasos = 100;
+    double K = 100.0, F_cte = 1.0, dt = 0.001, m = 1.0, alfa = 0.5;
+    double a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    double b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    double mem[2][6][21], betta[21];
+    memset(mem, 0, sizeof(mem));
+    for (int i = 0; i < N; i++) mem[0][0][3*i+2] = mem[1][0][3*i+2] = i;
+    (void)F_cte;
+    inicializa_PR(11);
+    for (int paso = 0; paso < pasos; paso++) {
+        for (int i = 0; i < 3*N; i++) betta[i] = gaussian() * 0.01;
+        double (*r)[21] = mem[0], (*p)[21] = mem[1];  // x, v, F antiguos y x, v, F nuevos
+        #ifdef FIXED
+        un_paso_verlet(betta, b, a, N, r[0], r[3], r[1], r[4], r[2], r[5], dt, m, Fuerza_verlet, K, F_cte);
+        #else
+        un_paso_verlet(betta, b, a, N, r[0], r[3], r[1], r[4], r[2], r[5], dt, m, Fuerza_verlet, K);
+        #endif
+        actualiza_posiciones_verlet(betta, b, N, p[0], p[3], p[1], p[2], dt, m);
+        #ifdef FIXED
+        Fuerza_verlet(N, p[3], p[5], K, F_cte);
+        #else
+        Fuerza_verlet(N, p[3], p[5], K);
+        #endif
+        actualiza_velocidades_verlet(betta, b, a, N, p[1], p[4], p[2], p[5], dt, m);
+        for (int k = 0; k < 2; k++)
+            for (int j = 0; j < 3; j++) memcpy(mem[k][j], mem[k][j+3], sizeof(mem[k][j]));
+    }
+    int ok = memcmp(mem[0], mem[1], sizeof(mem[0])) == 0;
+    printf("Paso por partes igual que un_paso_verlet tras %d pasos  %s\n", pasos, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+// Fases con su línea en el informe y columnas numéricas (o nan) en cada una
+static int lee_informe(const char *ruta, const char *fases[], int n_fases) {
+    FILE *f = fopen(ruta, "r");
+    if (!f) return 0;
+    char linea[1024];
+    int encontradas = 0, columnas_bien = 1;
+    while (fgets(linea, sizeof(linea), f)) {
+        if (linea[0] == '#') continue;
+        char nombre[64];
+        double v[11];
+        int leidas = sscanf(linea, "%63s %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf", nombre, &v[0], &v[1], &v[2],
+                            &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9], &v[10]);
+        if (leidas != 12 || !(v[0] > 0.0)) columnas_bien = 0;
+        for (int k = 0; k < n_fases; k++)
+            if (strcmp(nombre, fases[k]) == 0) encontradas++;
+    }
+    fclose(f);
+    return columnas_bien && encontradas == n_fases;
+}
+
+// Borra lo que queda en <carpeta>/*_prueba_contadores.txt
+static void borra_auxiliares(const char *carpeta) {
+    DIR *d = opendir(carpeta);
+    if (!d) return;
+    struct dirent *e;
+    char ruta[512];
+    while ((e = readdir(d))) {
+        if (!strstr(e->d_name, "_" RUTA_TXT)) continue;
+        snprintf(ruta, sizeof(ruta), "%s/%s", carpeta, e->d_name);
+        remove(ruta);
+    }
+    closedir(d);
+    remove(carpeta);  // Solo si ha quedado vacía
+}
+
+static int informe(void) {
+    ContadoresHardware *c = abre_contadores_hardware();
+    for (int paso = 0; paso < 100*PASOS_CONTADORES; paso++) {
+        empieza_paso_contadores(c);
+        trabaja(1000);
+        fase_contadores(c, FASE_RUIDO);
+        trabaja(2000);
+        fase_contadores(c, FASE_FUERZA);
+        termina_paso_contadores(c);
+    }
+    escribe_contadores_hardware(c, 10, ".", RUTA_TXT);
+    cierra_contadores_hardware(c);
+    const char *fases[] = {"ruido", "fuerza"};
+    int ok = lee_informe("CONTADORES/contadores_" RUTA_TXT, fases, 2);
+    printf("escribe_contadores_hardware: una línea por fase medida  %s\n", ok ? "PASA" : "FALLA");
+    remove("CONTADORES/contadores_" RUTA_TXT);
+
+    #ifdef CONTADORES_HARDWARE
+    int N = 8, pasos = 20000;
+    double x_0[24], v_0[24];
+    for (int i = 0; i < N; i++) {
+        x_0[3*i] = 0.0; x_0[3*i+1] = 0.0; x_0[3*i+2] = i;
+        v_0[3*i] = v_0[3*i+1] = v_0[3*i+2] = 0.0;
+    }
+    inicializa_PR(3);
+    #ifdef FIXED
+    verlet_trayectoria("prueba", 1.0, 1.0, 2.0, N, 0.001, 1.0, pasos, Fuerza_verlet, RUTA_TXT, x_0, v_0, 100.0, 1.0);
+    #else
+    verlet_trayectoria("prueba", 1.0, 1.0, 2.0, N, 0.001, 1.0, pasos, Fuerza_verlet, RUTA_TXT, x_0, v_0, 100.0);
+    #endif
+    const char *fases_paso[] = {"ruido", "fuerza", "actualizacion", "salida"};
+    int ok_trayectoria = lee_informe("CONTADORES/contadores_" RUTA_TXT, fases_paso, 4);
+    printf("verlet_trayectoria: ruido, fuerza, actualizacion y salida en el informe  %s\n",
+           ok_trayectoria ? "PASA" : "FALLA");
+    ok = ok && ok_trayectoria;
+    remove(RUTA_TXT);
+    borra_auxiliares("DISTRIBUCIONES");
+    borra_auxiliares("CORRELACIONES");
+    borra_auxiliares("ESTIMADORES");
+    borra_auxiliares("FORMA");
+    #endif
+    borra_auxiliares("CONTADORES");
+    return ok;
+}
+
+int main(void) {
+    int fallos = 0;
+    if (!abre()) fallos++;
+    if (!muestreo()) fallos++;
+    if (!reparto()) fallos++;
+    if (!paso_por_partes()) fallos++;
+    if (!informe()) fallos++;
+    return fallos ? 1 : 0;
+}
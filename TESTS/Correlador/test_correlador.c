@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+
+/*
+ * Test del correlador multi-tau (correlador.c).
+ *  1. Los retrasos del nivel 0 coinciden con la covarianza directa O(T * p) de la serie guardada.
+ *  2. Proceso de Ornstein-Uhlenbeck A_{n+1} = phi A_n + sqrt(1 - phi^2) xi en 3D: la correlación
+ *     normalizada debe seguir phi^tau también en los niveles promediados, y el tiempo de
+ *     relajación debe ser -1/ln(phi).
+ *  3. Paseo aleatorio: el desplazamiento cuadrático medio debe ser 3 tau.
+ *  4. Ritmo de muestras por segundo y memoria del correlador frente a guardar la serie.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_correlador.exe [muestras]
+ */
+
+#define PHI 0.99
+#define TOLERANCIA_EXACTA 1e-10
+#define TOLERANCIA_ESTADISTICA 0.05
+
+static int comprueba(const char *nombre, double obtenido, double esperado, double tolerancia) {
+    double dif = fabs(obtenido - esperado);
+    int ok = dif <= tolerancia;
+    printf("  %-34s %12.6f (esperado %12.6f)  %s\n", nombre, obtenido, esperado, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 2000000;
+    int fallos = 0;
+    inicializa_PR(2024);
+
+    int max_filas = NIVELES_CORRELADOR * PUNTOS_CORRELADOR;
+    double *tau = malloc(max_filas*sizeof(double));
+    double *C = malloc(max_filas*sizeof(double));
+    double *normalizada = malloc(max_filas*sizeof(double));
+    double *D = malloc(max_filas*sizeof(double));
+
+    // 1. Nivel 0 frente a la correlación directa de una serie corta
+    int n_corta = 5000;
+    double *serie = malloc(3*n_corta*sizeof(double));
+    Correlador *c = crea_correlador(3);
+    for (int t = 0; t < n_corta; t++) {
+        for (int d = 0; d < 3; d++) serie[3*t + d] = gaussian();
+        anade_correlador(c, &serie[3*t]);
+    }
+    resultados_correlador(c, tau, C, NULL, D);
+    // Misma estimación de la covarianza: serie relativa a la primera muestra, menos su media al cuadrado
+    double media[3] = {0.0, 0.0, 0.0}, media2 = 0.0;
+    for (int t = 0; t < n_corta; t++)
+        for (int d = 0; d < 3; d++) media[d] += (serie[3*t + d] - serie[d]) / n_corta;
+    for (int d = 0; d < 3; d++) media2 += media[d] * media[d];
+    double dif_max = 0.0;
+    for (int j = 0; j < PUNTOS_CORRELADOR; j++) {
+        double suma_C = 0.0, suma_D = 0.0;
+        for (int t = j; t < n_corta; t++) {
+            for (int d = 0; d < 3; d++) {
+                suma_C += (serie[3*t + d] - serie[d]) * (serie[3*(t-j) + d] - serie[d]);
+                suma_D += (serie[3*t + d] - serie[3*(t-j) + d]) * (serie[3*t + d] - serie[3*(t-j) + d]);
+            }
+        }
+        dif_max = fmax(dif_max, fabs(C[j] - (suma_C / (n_corta - j) - media2)));
+        dif_max = fmax(dif_max, fabs(D[j] - suma_D / (n_corta - j)));
+    }
+    printf("Nivel 0 frente a la correlación directa: dif. máxima %.2e  %s\n", dif_max,
+           dif_max < TOLERANCIA_EXACTA ? "PASA" : "FALLA");
+    if (dif_max >= TOLERANCIA_EXACTA) fallos++;
+    libera_correlador(c);
+    free(serie);
+
+    // 2. Ornstein-Uhlenbeck
+    c = crea_correlador(3);
+    double A[3] = {gaussian(), gaussian(), gaussian()};
+    double desplazado[3];  // Con media 100: la covarianza no debe perder precisión
+    double ruido = sqrt(1.0 - PHI*PHI);
+    clock_t t0 = clock();
+    for (int t = 0; t < n; t++) {
+        for (int d = 0; d < 3; d++) {
+            A[d] = PHI * A[d] + ruido * gaussian();
+            desplazado[d] = A[d] + 100.0;
+        }
+        anade_correlador(c, desplazado);
+    }
+    clock_t t1 = clock();
+    int filas = resultados_correlador(c, tau, C, normalizada, D);
+    printf("Ornstein-Uhlenbeck, phi = %.2f, %d muestras, %d retrasos:\n", PHI, n, filas);
+    int retrasos[4] = {1, 10, 96, 320};
+    for (int r = 0; r < 4; r++) {
+        for (int i = 0; i < filas; i++) {
+            if (tau[i] != retrasos[r]) continue;
+            char nombre[64];
+            snprintf(nombre, sizeof(nombre), "C(%d)/C(0)", retrasos[r]);
+            if (!comprueba(nombre, normalizada[i], pow(PHI, retrasos[r]), TOLERANCIA_ESTADISTICA)) fallos++;
+        }
+    }
+    double tiempo = tiempo_relajacion(c, 1.0), esperado = -1.0 / log(PHI);
+    if (!comprueba("Tiempo de relajación", tiempo, esperado, TOLERANCIA_ESTADISTICA * esperado)) fallos++;
+
+    double segundos = (double)(t1 - t0) / CLOCKS_PER_SEC;
+    size_t memoria = sizeof(Correlador) + (size_t)NIVELES_CORRELADOR*PUNTOS_CORRELADOR*(3 + 2)*sizeof(double);
+    printf("  %.1f millones de muestras por segundo (con el ruido), memoria ~%.1f kB frente a %.1f MB de la serie\n",
+           segundos > 0 ? n / segundos / 1e6 : 0.0, memoria / 1024.0, 3.0*n*sizeof(double) / 1048576.0);
+    libera_correlador(c);
+
+    // 3. Paseo aleatorio: MSD = 3 tau
+    c = crea_correlador(3);
+    double r[3] = {0.0, 0.0, 0.0};
+    for (int t = 0; t < n; t++) {
+        for (int d = 0; d < 3; d++) r[d] += gaussian();
+        anade_correlador(c, r);
+    }
+    filas = resultados_correlador(c, tau, NULL, NULL, D);
+    printf("Paseo aleatorio:\n");
+    int msd[3] = {1, 15, 1024};
+    for (int k = 0; k < 3; k++) {
+        for (int i = 0; i < filas; i++) {
+            if (tau[i] != msd[k]) continue;
+            char nombre[64];
+            snprintf(nombre, sizeof(nombre), "MSD(%d)/(3 tau)", msd[k]);
+            if (!comprueba(nombre, D[i] / (3.0 * tau[i]), 1.0, TOLERANCIA_ESTADISTICA)) fallos++;
+        }
+    }
+    libera_correlador(c);
+
+    free(tau); free(C); free(normalizada); free(D);
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,276 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+
+/*
+ * Benchmark de escalado con N para cadenas largas.
+ *  1. Comprueba que un_paso_verlet_fusionado reproduce bit a bit el camino de referencia
+ *     (ruido + un_paso_verlet + Fuerza_verlet + copia) para varios N pequeños.
+ *  2. Mide el coste por paso y por partícula de ambos caminos de N = 4 a N = 100000 (el mejor de
+ *     REPETICIONES, alternando los caminos), el del ruido solo y la ganancia del fusionado sin
+ *     contar el ruido, que es igual en los dos. Comprueba que el coste del fusionado es lineal
+ *     en N (coste por partícula acotado).
+ *  3. Reparte el coste del camino de referencia entre ruido, actualización y fuerza, y da el del
+ *     fusionado, con ciclos, IPC y fallos de caché y de salto por partícula (contadores.c) para
+ *     ver con qué N pasa a estar limitado por la memoria. Solo informa; sin permiso para los
+ *     contadores hardware da solo los tiempos.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: benchmark_escalado.exe [particulas_por_medida]
+ */
+
+#define N_TAMANOS 9
+#define PASOS_EQUIVALENCIA 200
+#define FACTOR_LINEALIDAD 2.0   // Máximo cociente entre el coste por partícula con N grande y el mínimo
+#define REPETICIONES 5
+
+static double alfa = 0.5, kb = 1.0, Temperatura = 1.0, dt = 0.0003, m = 1.0, K = 1000.0;
+#ifdef FIXED
+static double F_cte = 1.0;
+#endif
+
+static void cadena_recta(int N, double x[], double v[]) {
+    for (int j = 0; j < N; j++) {
+        x[3*j] = j; x[3*j+1] = 0.0; x[3*j+2] = 0.0;
+        v[3*j] = v[3*j+1] = v[3*j+2] = 0.0;
+    }
+}
+
+static void fuerza(int N, double x[], double F[]) {
+    #ifdef FIXED
+    Fuerza_verlet(N, x, F, K, F_cte);
+    #else
+    Fuerza_verlet(N, x, F, K);
+    #endif
+}
+
+// Camino de referencia: exactamente el bucle de verlet_trayectoria sin paso fusionado
+static void pasos_referencia(int N, int pasos, double *mem) {
+    double *x = mem, *v = mem + 3*N, *F = mem + 6*N;
+    double *x_n = mem + 9*N, *v_n = mem + 12*N, *F_n = mem + 15*N, *betta = mem + 18*N;
+    double a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    double b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    double sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+
+    for (int paso = 0; paso < pasos; paso++) {
+        #ifdef RUIDO_CONTADOR
+        ruido_contador_global.paso = paso;
+        gaussianas_contador(&ruido_contador_global, 0, 3*N, sigma, betta);
+        #else
+        for (int i = 0; i < 3*N; i++) betta[i] = gaussian() * sigma;
+        #endif
+        #ifdef FIXED
+        un_paso_verlet(betta, b, a, N, x, x_n, v, v_n, F, F_n, dt, m, Fuerza_verlet, K, F_cte);
+        #else
+        un_paso_verlet(betta, b, a, N, x, x_n, v, v_n, F, F_n, dt, m, Fuerza_verlet, K);
+        #endif
+        memcpy(x, x_n, 3*N*sizeof(double));
+        memcpy(v, v_n, 3*N*sizeof(double));
+        memcpy(F, F_n, 3*N*sizeof(double));
+    }
+}
+
+static void pasos_fusionado(int N, int pasos, double *mem) {
+    double *x = mem, *v = mem + 3*N, *F = mem + 6*N;
+    double a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    double b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    double sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+
+    for (int paso = 0; paso < pasos; paso++) {
+        #ifdef RUIDO_CONTADOR
+        ruido_contador_global.paso = paso;
+        #endif
+        #ifdef FIXED
+        un_paso_verlet_fusionado(sigma, b, a, N, x, v, F, dt, m, K, F_cte);
+        #else
+        un_paso_verlet_fusionado(sigma, b, a, N, x, v, F, dt, m, K);
+        #endif
+    }
+}
+
+// Solo el ruido, que cuesta lo mismo en los dos caminos
+static void pasos_ruido(int N, int pasos, double *mem) {
+    double *betta = mem + 18*N;
+    double sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+
+    for (int paso = 0; paso < pasos; paso++) {
+        #ifdef RUIDO_CONTADOR
+        ruido_contador_global.paso = paso;
+        gaussianas_contador(&ruido_contador_global, 0, 3*N, sigma, betta);
+        #else
+        for (int i = 0; i < 3*N; i++) betta[i] = gaussian() * sigma;
+        #endif
+    }
+}
+
+// Como pasos_referencia y pasos_fusionado, marcando cada fase en los pasos que mide c
+static void pasos_fases(int N, int pasos, double *mem, int fusionado, ContadoresHardware *c) {
+    double *x = mem, *v = mem + 3*N, *F = mem + 6*N;
+    double *x_n = mem + 9*N, *v_n = mem + 12*N, *F_n = mem + 15*N, *betta = mem + 18*N;
+    double a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    double b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    double sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+
+    for (int paso = 0; paso < pasos; paso++) {
+        empieza_paso_contadores(c);
+        if (fusionado) {
+            #ifdef FIXED
+            un_paso_verlet_fusionado(sigma, b, a, N, x, v, F, dt, m, K, F_cte);
+            #else
+            un_paso_verlet_fusionado(sigma, b, a, N, x, v, F, dt, m, K);
+            #endif
+            fase_contadores(c, FASE_FUSIONADO);
+        } else {
+            for (int i = 0; i < 3*N; i++) betta[i] = gaussian() * sigma;
+            fase_contadores(c, FASE_RUIDO);
+            actualiza_posiciones_verlet(betta, b, N, x, x_n, v, F, dt, m);
+            fase_contadores(c, FASE_ACTUALIZACION);
+            fuerza(N, x_n, F_n);
+            fase_contadores(c, FASE_FUERZA);
+            actualiza_velocidades_verlet(betta, b, a, N, v, v_n, F, F_n, dt, m);
+            memcpy(x, x_n, 3*N*sizeof(double));
+            memcpy(v, v_n, 3*N*sizeof(double));
+            memcpy(F, F_n, 3*N*sizeof(double));
+            fase_contadores(c, FASE_ACTUALIZACION);
+        }
+        termina_paso_contadores(c);
+    }
+}
+
+static void imprime_fase(int N, const char *nombre, const ContadoresHardware *c, FaseContadores fase) {
+    const FaseMedida *f = fase_medida_contadores(c, fase);
+    double pasos = (double)pasos_medidos_contadores(c);
+    double ciclos = evento_disponible(c, EVENTO_CICLOS) ? f->cuenta[EVENTO_CICLOS] / pasos / N : NAN;
+    double instrucciones = evento_disponible(c, EVENTO_INSTRUCCIONES) ? f->cuenta[EVENTO_INSTRUCCIONES] / pasos / N : NAN;
+    double cache = evento_disponible(c, EVENTO_FALLOS_CACHE) ? f->cuenta[EVENTO_FALLOS_CACHE] / pasos / N : NAN;
+    double salto = evento_disponible(c, EVENTO_FALLOS_SALTO) ? f->cuenta[EVENTO_FALLOS_SALTO] / pasos / N : NAN;
+    printf("%8d %-14s %10.2f %10.2f %8.3f %12.5f %12.5f\n", N, nombre, f->ns / pasos / N, ciclos,
+           instrucciones / ciclos, cache, salto);
+}
+
+static void mide_fases(int N, long particulas_por_medida) {
+    double *mem = calloc(21*(size_t)N, sizeof(double));
+    int pasos = (int)(particulas_por_medida / N);
+    if (pasos < 10*PASOS_CONTADORES) pasos = 10*PASOS_CONTADORES;
+
+    for (int fusionado = 0; fusionado <= 1; fusionado++) {
+        ContadoresHardware *c = abre_contadores_hardware();
+        if (!c) break;
+        cadena_recta(N, mem, mem + 3*N);
+        fuerza(N, mem, mem + 6*N);
+        pasos_fases(N, pasos, mem, fusionado, c);
+        if (pasos_medidos_contadores(c) > 0) {
+            if (fusionado) imprime_fase(N, "fusionado", c, FASE_FUSIONADO);
+            else {
+                imprime_fase(N, "ruido", c, FASE_RUIDO);
+                imprime_fase(N, "actualizacion", c, FASE_ACTUALIZACION);
+                imprime_fase(N, "fuerza", c, FASE_FUERZA);
+            }
+        }
+        cierra_contadores_hardware(c);
+    }
+    free(mem);
+}
+
+static int comprueba_equivalencia(int N) {
+    double *ref = calloc(21*N, sizeof(double));
+    double *fus = calloc(9*N, sizeof(double));
+
+    cadena_recta(N, ref, ref + 3*N);
+    fuerza(N, ref, ref + 6*N);
+    memcpy(fus, ref, 9*N*sizeof(double));
+
+    inicializa_PR(2024);
+    #ifdef RUIDO_CONTADOR
+    inicializa_ruido_contador_desde(&ruido_contador_global, &estado_PR_global, 0);
+    #endif
+    pasos_referencia(N, PASOS_EQUIVALENCIA, ref);
+    inicializa_PR(2024);
+    #ifdef RUIDO_CONTADOR
+    inicializa_ruido_contador_desde(&ruido_contador_global, &estado_PR_global, 0);
+    #endif
+    pasos_fusionado(N, PASOS_EQUIVALENCIA, fus);
+
+    int iguales = memcmp(ref, fus, 9*N*sizeof(double)) == 0;
+    free(ref);
+    free(fus);
+    return iguales;
+}
+
+typedef enum { CAMINO_REFERENCIA, CAMINO_FUSIONADO, CAMINO_RUIDO, N_CAMINOS } Camino;
+
+// ns por paso y por partícula de cada camino: el mejor de REPETICIONES, alternando los caminos
+static void mide(int N, long particulas_por_medida, double coste[N_CAMINOS]) {
+    double *mem = calloc(21*(size_t)N, sizeof(double));
+    int pasos = (int)(particulas_por_medida / N / REPETICIONES);
+    if (pasos < 10) pasos = 10;
+
+    for (int c = 0; c < N_CAMINOS; c++) coste[c] = INFINITY;
+    for (int r = 0; r < REPETICIONES; r++) {
+        for (int c = 0; c < N_CAMINOS; c++) {
+            cadena_recta(N, mem, mem + 3*N);
+            fuerza(N, mem, mem + 6*N);
+            clock_t inicio = clock();
+            if (c == CAMINO_REFERENCIA)     pasos_referencia(N, pasos, mem);
+            else if (c == CAMINO_FUSIONADO) pasos_fusionado(N, pasos, mem);
+            else                            pasos_ruido(N, pasos, mem);
+            clock_t fin = clock();
+            double ns = 1e9*(double)(fin - inicio)/CLOCKS_PER_SEC/((double)pasos*N);
+            if (ns < coste[c]) coste[c] = ns;
+        }
+    }
+    free(mem);
+}
+
+int main(int argc, char *argv[]) {
+    long particulas_por_medida = argc > 1 ? atol(argv[1]) : 5000000;
+    int tamanos[N_TAMANOS] = {4, 16, 64, 256, 1024, 4096, 16384, 65536, 100000};
+    int fallos = 0;
+
+    // 1. Equivalencia bit a bit
+    int N_eq[] = {1, 2, 3, 4, 5, 8, 50};
+    for (unsigned k = 0; k < sizeof(N_eq)/sizeof(N_eq[0]); k++) {
+        int ok = comprueba_equivalencia(N_eq[k]);
+        printf("Equivalencia fusionado/referencia N = %-4d %s\n", N_eq[k], ok ? "PASA" : "FALLA");
+        if (!ok) fallos++;
+    }
+
+    // 2. Escalado
+    inicializa_PR(12456);
+    #ifdef RUIDO_CONTADOR
+    inicializa_ruido_contador_desde(&ruido_contador_global, &estado_PR_global, 0);
+    #endif
+    printf("\n%8s %18s %18s %14s %16s\n", "N", "referencia ns/part", "fusionado ns/part", "ruido ns/part",
+           "ganancia sin ruido");
+    double coste[N_TAMANOS];
+    for (int k = 0; k < N_TAMANOS; k++) {
+        double c[N_CAMINOS];
+        mide(tamanos[k], particulas_por_medida, c);
+        coste[k] = c[CAMINO_FUSIONADO];
+        double resto_ref = c[CAMINO_REFERENCIA] - c[CAMINO_RUIDO];
+        double resto_fus = c[CAMINO_FUSIONADO] - c[CAMINO_RUIDO];
+        printf("%8d %18.2f %18.2f %14.2f %15.2fx\n", tamanos[k], c[CAMINO_REFERENCIA], c[CAMINO_FUSIONADO],
+               c[CAMINO_RUIDO], resto_fus > 0 ? resto_ref / resto_fus : NAN);
+    }
+
+    // Lineal: el coste por partícula con N grande no se dispara respecto al mejor
+    double minimo = coste[0];
+    for (int k = 1; k < N_TAMANOS; k++) if (coste[k] < minimo) minimo = coste[k];
+    double cociente = coste[N_TAMANOS-1]/minimo;
+    int lineal = cociente < FACTOR_LINEALIDAD;
+    printf("\nCoste por partícula N = %d / mínimo = %.2f -> %s\n", tamanos[N_TAMANOS-1], cociente,
+           lineal ? "PASA (lineal)" : "FALLA");
+    if (!lineal) fallos++;
+
+    // 3. Coste por fase (informativo)
+    ContadoresHardware *prueba = abre_contadores_hardware();
+    if (contadores_disponibles(prueba)) printf("\nContadores hardware por fase y por partícula:\n");
+    else printf("\nContadores hardware no disponibles (%s); solo tiempos por fase:\n", motivo_contadores(prueba));
+    cierra_contadores_hardware(prueba);
+    printf("%8s %-14s %10s %10s %8s %12s %12s\n", "N", "fase", "ns/part", "ciclos/part", "IPC",
+           "fallos_cache", "fallos_salto");
+    for (int k = 0; k < N_TAMANOS; k++) mide_fases(tamanos[k], particulas_por_medida);
+
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <string.h>
+#include "simulacion.h"
+#include "barrido.h"
+#include "estimadores.h"
+
+/*
+ * Test de los estimadores con menos varianza (estimadores.c).
+ *  1. extension_enlace_armonico tiende a la función de Langevin con muelles rígidos y es impar en F.
+ *  2. Con configuraciones independientes de la cadena ideal a Temperatura (muestreo exacto de los
+ *     enlaces) los tres estimadores de <Ree> coinciden con (N-1) <r_z> y el de variables de
+ *     control tiene menos error que la media simple (la esperanza condicionada solo quita la
+ *     varianza de un enlace de N-1, menos que el ruido del error por bloques). Solo sin WLCM ni
+ *     VOLUMEN_EXCLUIDO, porque las fuerzas de Fuerza_verlet tienen que ser las de esa cadena.
+ *  3. En una simulación (Simulacion) el estimador con variables de control coincide con la media
+ *     simple con menos error; la esperanza condicionada se da solo si es coherente.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_estimadores.exe [muestras]
+ */
+
+#define N_PRUEBA 8
+#define K_PRUEBA 10.0
+#define F_PRUEBA 2.0
+#define PUNTOS_TABLA 4000
+
+static int langevin(void) {
+    double rigido = extension_enlace_armonico(1e6, 1.5, 1.0, 1.0);
+    double esperado = ree_langevin(1.5, 2, 1.0, 1.0);
+    double impar = extension_enlace_armonico(K_PRUEBA, -F_PRUEBA, 1.0, 1.0)
+                   + extension_enlace_armonico(K_PRUEBA, F_PRUEBA, 1.0, 1.0);
+    int ok = fabs(rigido - esperado) < 1e-3 && fabs(impar) < 1e-12
+             && extension_enlace_armonico(K_PRUEBA, 0.0, 1.0, 1.0) == 0.0;
+    printf("Enlace rígido: %.6f, Langevin %.6f; impar en F (%.1e)  %s\n", rigido, esperado, impar, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+#if !defined(WLCM) && !defined(VOLUMEN_EXCLUIDO)
+// Tabla de la distribución acumulada de la longitud de un enlace con la fuerza F a lo largo de z (kT = 1)
+static void tabla_longitud(double r[], double acumulada[]) {
+    double maximo = L_0 + F_PRUEBA / K_PRUEBA + 30.0 / sqrt(K_PRUEBA);
+    double suma = 0.0, y;
+    for (int i = 0; i < PUNTOS_TABLA; i++) {
+        r[i] = maximo * (i + 0.5) / PUNTOS_TABLA;
+        y = F_PRUEBA * r[i];
+        double log_p = 2.0*log(r[i]) - 0.5*K_PRUEBA*(r[i] - L_0)*(r[i] - L_0) + y + log1p(-exp(-2.0*y)) - log(2.0*y);
+        suma += exp(log_p - F_PRUEBA * L_0);  // Escala fija para no desbordar
+        acumulada[i] = suma;
+    }
+    for (int i = 0; i < PUNTOS_TABLA; i++) acumulada[i] /= suma;
+}
+
+static double muestrea_longitud(EstadoPR *e, const double r[], const double acumulada[]) {
+    double u = fran_r(e);
+    int a = 0, b = PUNTOS_TABLA - 1;
+    while (a < b) {
+        int c = (a + b) / 2;
+        if (acumulada[c] < u) a = c + 1;
+        else b = c;
+    }
+    double h = r[1] - r[0];
+    double previa = a ? acumulada[a - 1] : 0.0;
+    return r[a] - 0.5*h + h * (u - previa) / (acumulada[a] - previa);
+}
+
+static int muestreo_exacto(long muestras) {
+    double *r = malloc(PUNTOS_TABLA*sizeof(double)), *acumulada = malloc(PUNTOS_TABLA*sizeof(double));
+    double x[3*N_PRUEBA], F[3*N_PRUEBA];
+    #ifdef FIXED
+    EstimadoresCadena *e = crea_estimadores_cadena(N_PRUEBA, K_PRUEBA, 1.0, 1.0, F_PRUEBA);
+    #else
+    EstimadoresCadena *e = crea_estimadores_cadena(N_PRUEBA, K_PRUEBA, 1.0, 1.0);
+    #endif
+    if (!r || !acumulada || !e) return 0;
+    tabla_longitud(r, acumulada);
+    EstadoPR g;
+    inicializa_PR_r(&g, 77);
+    for (long k = 0; k < muestras; k++) {
+        x[0] = x[1] = x[2] = 0.0;
+        for (int j = 1; j < N_PRUEBA; j++) {
+            // Longitud de la tabla; cos(theta) de exp(F r cos(theta)) en [-1, 1]
+            double l = muestrea_longitud(&g, r, acumulada);
+            #ifdef FIXED
+            double y = F_PRUEBA * l;
+            double c = 1.0 + log(1.0 - fran_r(&g) * (1.0 - exp(-2.0*y))) / y;
+            #else
+            double c = 2.0 * fran_r(&g) - 1.0;
+            #endif
+            double s = sqrt(fmax(0.0, 1.0 - c*c)), phi = 2.0 * acos(-1.0) * fran_r(&g);
+            x[3*j]     = x[3*(j-1)]     + l * s * cos(phi);
+            x[3*j + 1] = x[3*(j-1) + 1] + l * s * sin(phi);
+            x[3*j + 2] = x[3*(j-1) + 2] + l * c;
+        }
+        #ifdef FIXED
+        Fuerza_verlet(N_PRUEBA, x, F, K_PRUEBA, F_PRUEBA);
+        #else
+        Fuerza_verlet(N_PRUEBA, x, F, K_PRUEBA);
+        #endif
+        acumula_estimadores_cadena(e, x, F, calcula_radio_giro(N_PRUEBA, x), x[3*(N_PRUEBA-1) + 2] - x[2]);
+    }
+    ResultadoEstimadores res;
+    resume_estimadores_cadena(e, &res);
+    double teoria = res.Ree_ideal;
+    int ok = fabs(res.Ree - teoria) <= 3.0 * res.error_Ree
+             && fabs(res.Ree_control - teoria) <= 3.0 * res.error_Ree_control + 1e-9
+             && fabs(res.Ree_condicionada - teoria) <= 3.0 * res.error_Ree_condicionada
+             && res.error_Ree_control < res.error_Ree
+             && fabs(res.Rg_control - res.Rg) <= 3.0 * res.error_Rg && res.error_Rg_control <= res.error_Rg;
+    printf("Cadena ideal exacta (%ld muestras), teoría %.5f:\n", muestras, teoria);
+    printf("  simple %.5f +- %.5f  control %.5f +- %.5f  condicionada %.5f +- %.5f\n", res.Ree, res.error_Ree,
+           res.Ree_control, res.error_Ree_control, res.Ree_condicionada, res.error_Ree_condicionada);
+    printf("  Rg simple %.5f +- %.5f  control %.5f +- %.5f  %s\n", res.Rg, res.error_Rg, res.Rg_control,
+           res.error_Rg_control, ok ? "PASA" : "FALLA");
+    libera_estimadores_cadena(e);
+    free(r);
+    free(acumulada);
+    return ok;
+}
+#endif
+
+static int simulacion(long muestras) {
+    ConfiguracionSimulacion c = configuracion_simulacion_defecto();
+    c.N = 16;
+    c.K = K_PRUEBA;
+    c.F_cte = F_PRUEBA;
+    c.dt = 0.001;
+    Simulacion *s = crea_simulacion(&c, NULL);
+    #ifdef FIXED
+    EstimadoresCadena *e = crea_estimadores_cadena(c.N, c.K, c.kb, c.Temperatura, c.F_cte);
+    #else
+    EstimadoresCadena *e = crea_estimadores_cadena(c.N, c.K, c.kb, c.Temperatura);
+    #endif
+    double *x = malloc(3*c.N*sizeof(double)), *F = malloc(3*c.N*sizeof(double));
+    if (!s || !e || !x || !F) return 0;
+    avanza_simulacion(s, 20000);
+    ObservablesSimulacion o;
+    for (long k = 0; k < muestras; k++) {
+        avanza_simulacion(s, 100);
+        observa_simulacion(s, &o);
+        estado_simulacion(s, x, NULL);
+        #ifdef FIXED
+        Fuerza_verlet(c.N, x, F, c.K, c.F_cte);
+        #else
+        Fuerza_verlet(c.N, x, F, c.K);
+        #endif
+        acumula_estimadores_cadena(e, x, F, o.Rg, o.Ree);
+    }
+    ResultadoEstimadores res;
+    resume_estimadores_cadena(e, &res);
+    double factor = (res.error_Ree / res.error_Ree_control) * (res.error_Ree / res.error_Ree_control);
+    int ok = fabs(res.Ree_control - res.Ree) <= 3.0 * res.error_Ree && factor > 1.5
+             && fabs(res.Rg_control - res.Rg) <= 3.0 * res.error_Rg && res.error_Rg_control <= res.error_Rg;
+    printf("Simulación N = %d (%ld muestras): simple %.5f +- %.5f  control %.5f +- %.5f (%.1f veces menos tiempo)  %s\n",
+           c.N, muestras, res.Ree, res.error_Ree, res.Ree_control, res.error_Ree_control, factor, ok ? "PASA" : "FALLA");
+    printf("  Rg simple %.5f +- %.5f  control %.5f +- %.5f; condicionada %.5f +- %.5f, cadena ideal %.5f\n", res.Rg,
+           res.error_Rg, res.Rg_control, res.error_Rg_control, res.Ree_condicionada, res.error_Ree_condicionada,
+           res.Ree_ideal);
+    libera_estimadores_cadena(e);
+    destruye_simulacion(s);
+    free(x);
+    free(F);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    long muestras = argc > 1 ? atol(argv[1]) : 200000;
+    int fallos = 0;
+    if (!langevin()) fallos++;
+    #if !defined(WLCM) && !defined(VOLUMEN_EXCLUIDO)
+    if (!muestreo_exacto(muestras)) fallos++;
+    #else
+    printf("Cadena ideal exacta: no se comprueba con flexión ni volumen excluido (Fuerza_verlet no es la de la cadena ideal)\n");
+    #endif
+    if (!simulacion(muestras / 4)) fallos++;
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+
+/*
+ * Micro-benchmark de la flexión worm-like chain (flexion.c).
+ *  1. Las fuerzas de Fuerza_flexion coinciden con el bucle original de Fuerza_verlet
+ *     (cos(THETA_0), dos sqrt y seis divisiones por triplete), con rigidez uniforme y por segmentos.
+ *  2. Mide la fuerza completa de la cadena (estiramiento + flexión) con el camino original y con
+ *     el nuevo, en el que la flexión reutiliza los enlaces del estiramiento. Descontando el
+ *     tiempo del estiramiento solo, la flexión nueva debe ser FACTOR_MINIMO veces más rápida.
+ * Funciona con o sin WLCM: la rigidez y el ángulo se fijan aquí con configura_flexion.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: benchmark_flexion.exe [N] [repeticiones]
+ */
+
+#define K_REFERENCIA 10.0
+#define THETA_REFERENCIA 0
+#define FACTOR_MINIMO 2.0
+#define RONDAS 5
+#define TOLERANCIA 1e-12
+
+// El bloque WLCM de Fuerza_verlet antes de flexion.c, con rigidez k[i] si k != NULL
+static void flexion_original(int N, double x[], double F[], const double k[]) {
+    for (int i = 1; i < N - 1; i++) {
+        int im1_3 = 3 * (i - 1);
+        int i_3   = 3 * i;
+        int ip1_3 = 3 * (i + 1);
+
+        double r_i_x = x[i_3]     - x[im1_3];
+        double r_i_y = x[i_3 + 1] - x[im1_3 + 1];
+        double r_i_z = x[i_3 + 2] - x[im1_3 + 2];
+
+        double r_ip1_x = x[ip1_3]     - x[i_3];
+        double r_ip1_y = x[ip1_3 + 1] - x[i_3 + 1];
+        double r_ip1_z = x[ip1_3 + 2] - x[i_3 + 2];
+
+        double mag_ri  = sqrt(r_i_x*r_i_x + r_i_y*r_i_y + r_i_z*r_i_z);
+        double mag_rip1 = sqrt(r_ip1_x*r_ip1_x + r_ip1_y*r_ip1_y + r_ip1_z*r_ip1_z);
+
+        if (mag_ri == 0.0 || mag_rip1 == 0.0) continue;
+
+        double u_i_x = r_i_x / mag_ri; double u_i_y = r_i_y / mag_ri; double u_i_z = r_i_z / mag_ri;
+        double u_ip1_x = r_ip1_x / mag_rip1; double u_ip1_y = r_ip1_y / mag_rip1; double u_ip1_z = r_ip1_z / mag_rip1;
+
+        double cos_theta0 = cos(THETA_REFERENCIA);
+        double K_B = k ? k[i] : K_REFERENCIA;
+
+        double f_im1_x = (K_B / mag_ri) * (u_ip1_x - cos_theta0 * u_i_x);
+        double f_im1_y = (K_B / mag_ri) * (u_ip1_y - cos_theta0 * u_i_y);
+        double f_im1_z = (K_B / mag_ri) * (u_ip1_z - cos_theta0 * u_i_z);
+
+        double f_ip1_x = (K_B / mag_rip1) * (u_i_x - cos_theta0 * u_ip1_x);
+        double f_ip1_y = (K_B / mag_rip1) * (u_i_y - cos_theta0 * u_ip1_y);
+        double f_ip1_z = (K_B / mag_rip1) * (u_i_z - cos_theta0 * u_ip1_z);
+
+        F[im1_3]     += f_im1_x;
+        F[im1_3 + 1] += f_im1_y;
+        F[im1_3 + 2] += f_im1_z;
+
+        F[ip1_3]     += f_ip1_x;
+        F[ip1_3 + 1] += f_ip1_y;
+        F[ip1_3 + 2] += f_ip1_z;
+
+        F[i_3]       -= (f_im1_x + f_ip1_x);
+        F[i_3 + 1]   -= (f_im1_y + f_ip1_y);
+        F[i_3 + 2]   -= (f_im1_z + f_ip1_z);
+    }
+}
+
+#define K_MUELLE 1000.0
+
+// Bucle de estiramiento de Fuerza_verlet. Con enlaces != NULL guarda los enlaces para la flexión.
+static void estiramiento(int N, double x[], double F[], double *enlaces) {
+    for (int i = 0; i < 3*N; i++) F[i] = 0.0;
+    for (int i = 0; i < N - 1; i++) {
+        int i3 = 3*i;
+        int j3 = 3*(i+1);
+
+        double dx = x[j3]   - x[i3];
+        double dy = x[j3+1] - x[i3+1];
+        double dz = x[j3+2] - x[i3+2];
+
+        double r = sqrt(dx*dx + dy*dy + dz*dz);
+        if (enlaces) enlace_flexion(dx, dy, dz, r, &enlaces[4*i]);
+        if (r == 0.0) continue;
+
+        double fac = K_MUELLE * (r - L_0) / r;
+        F[i3]   += fac * dx;
+        F[i3+1] += fac * dy;
+        F[i3+2] += fac * dz;
+        F[j3]   -= fac * dx;
+        F[j3+1] -= fac * dy;
+        F[j3+2] -= fac * dz;
+    }
+}
+
+static double ns_por_particula(clock_t t0, clock_t t1, int repeticiones, int N) {
+    return 1e9*(double)(t1 - t0)/CLOCKS_PER_SEC/((double)repeticiones*N);
+}
+
+// Cadena con enlaces de longitud ~L_0 y ángulos aleatorios
+static void cadena_aleatoria(int N, double x[]) {
+    x[0] = x[1] = x[2] = 0.0;
+    for (int j = 1; j < N; j++) {
+        double cos_t = 2.0*fran() - 1.0, phi = 2.0*PI*fran();
+        double sin_t = sqrt(1.0 - cos_t*cos_t), l = L_0*(0.9 + 0.2*fran());
+        x[3*j]   = x[3*(j-1)]   + l*sin_t*cos(phi);
+        x[3*j+1] = x[3*(j-1)+1] + l*sin_t*sin(phi);
+        x[3*j+2] = x[3*(j-1)+2] + l*cos_t;
+    }
+}
+
+static double diferencia_relativa(int N, double x[], const double k[]) {
+    double *F_o = calloc(3*N, sizeof(double)), *F_n = calloc(3*N, sizeof(double));
+    flexion_original(N, x, F_o, k);
+    Fuerza_flexion(N, x, F_n);
+
+    double dif = 0.0, maximo = 1e-300;
+    for (int i = 0; i < 3*N; i++) {
+        if (fabs(F_o[i] - F_n[i]) > dif) dif = fabs(F_o[i] - F_n[i]);
+        if (fabs(F_o[i]) > maximo) maximo = fabs(F_o[i]);
+    }
+    free(F_o); free(F_n);
+    return dif / maximo;
+}
+
+int main(int argc, char *argv[]) {
+    int N = argc > 1 ? atoi(argv[1]) : 10000;
+    int repeticiones = argc > 2 ? atoi(argv[2]) : 500;
+    int fallos = 0;
+
+    inicializa_PR(12456);
+    double *x = malloc(3*N*sizeof(double)), *F = calloc(3*N, sizeof(double));
+    double *k = malloc(N*sizeof(double));
+    cadena_aleatoria(N, x);
+    for (int i = 0; i < N; i++) k[i] = K_REFERENCIA * (0.5 + fran());
+
+    // 1. Equivalencia con el bucle original
+    configura_flexion(K_REFERENCIA, NULL, 0, THETA_REFERENCIA);
+    double dif_u = diferencia_relativa(N, x, NULL);
+    configura_flexion(K_REFERENCIA, k, N, THETA_REFERENCIA);
+    double dif_s = diferencia_relativa(N, x, k);
+    int ok = dif_u < TOLERANCIA && dif_s < TOLERANCIA;
+    printf("Rigidez uniforme: dif. relativa = %.2e, por segmentos: %.2e  %s\n", dif_u, dif_s, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 2. Tiempo por llamada de la fuerza completa (el mínimo de RONDAS rondas, para filtrar ruido)
+    configura_flexion(K_REFERENCIA, NULL, 0, THETA_REFERENCIA);
+    double *enlaces = enlaces_flexion(N);
+    if (!enlaces) {
+        free(x); free(F); free(k);
+        return 1;
+    }
+    double t_e = 1e300, t_o = 1e300, t_n = 1e300;
+    for (int ronda = 0; ronda < RONDAS; ronda++) {
+        clock_t t0 = clock();
+        for (int r = 0; r < repeticiones; r++) estiramiento(N, x, F, NULL);
+        clock_t t1 = clock();
+        for (int r = 0; r < repeticiones; r++) {
+            estiramiento(N, x, F, NULL);
+            flexion_original(N, x, F, NULL);
+        }
+        clock_t t2 = clock();
+        for (int r = 0; r < repeticiones; r++) {
+            estiramiento(N, x, F, enlaces);
+            suma_flexion(N, enlaces, F);
+        }
+        clock_t t3 = clock();
+
+        t_e = fmin(t_e, ns_por_particula(t0, t1, repeticiones, N));
+        t_o = fmin(t_o, ns_por_particula(t1, t2, repeticiones, N));
+        t_n = fmin(t_n, ns_por_particula(t2, t3, repeticiones, N));
+    }
+
+    double speedup = (t_o - t_e) / (t_n - t_e);
+    ok = speedup >= FACTOR_MINIMO;
+    printf("\nN = %d, %d repeticiones (ns por partícula)\n", N, repeticiones);
+    printf("Estiramiento solo: %.2f  Con flexión original: %.2f  Con flexión nueva: %.2f\n", t_e, t_o, t_n);
+    printf("Flexión original: %.2f  nueva: %.2f  Speedup de la flexión: %.2f (fuerza total %.2f)  %s\n",
+           t_o - t_e, t_n - t_e, speedup, t_o / t_n, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    printf("(F[3] = %g)\n", F[3]);  // Evita que el compilador elimine los bucles
+    free(x); free(F); free(k);
+    libera_flexion();
+    return fallos ? 1 : 0;
+}
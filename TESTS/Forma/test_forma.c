@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+#include "forma.h"
+
+/*
+ * Test de la forma de la cadena (forma.c).
+ *  1. Los autovalores de matrices simétricas giradas (también degeneradas) son los de partida.
+ *  2. En una cadena al azar lejos del origen el tensor, Rg^2 y el vector extremo a extremo de la
+ *     pasada única coinciden con el cálculo en dos pasadas; calcula_radio_giro también.
+ *  3. Formas conocidas: varilla (kappa^2 = 1, l1 = (N^2 - 1)/12, C(s) = 1) y anillo plano regular
+ *     (kappa^2 = 1/4, l1 = l2 = R^2/2, C(s) = cos(2 pi s/N)).
+ *  4. Con FORMA, verlet_trayectoria escribe FORMA/forma_<archivo> con una muestra cada PASOS_FORMA pasos.
+ *  5. Coste de una evaluación por partícula frente al de un paso: evaluando cada PASOS_FORMA
+ *     pasos no puede añadir más de COSTE_MAXIMO del tiempo de la integración.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_forma.exe
+ */
+
+#define RUTA_TXT "prueba_forma.txt"
+#define TOLERANCIA 1e-9
+#define COSTE_MAXIMO 0.2
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+// S = R diag(l) R^T con R el giro de ángulo 'angulo' alrededor del eje unitario (a, b, c)
+static void tensor_girado(const double l[3], double angulo, double a, double b, double c, double S[6]) {
+    double co = cos(angulo), si = sin(angulo), t = 1.0 - co;
+    double R[3][3] = {{t*a*a + co,   t*a*b - si*c, t*a*c + si*b},
+                      {t*a*b + si*c, t*b*b + co,   t*b*c - si*a},
+                      {t*a*c - si*b, t*b*c + si*a, t*c*c + co}};
+    double M[3][3];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) {
+            M[i][j] = 0.0;
+            for (int k = 0; k < 3; k++) M[i][j] += R[i][k] * l[k] * R[j][k];
+        }
+    S[0] = M[0][0]; S[1] = M[1][1]; S[2] = M[2][2]; S[3] = M[0][1]; S[4] = M[0][2]; S[5] = M[1][2];
+}
+
+static int autovalores(void) {
+    double casos[][3] = {{5.0, 2.0, 1.0}, {3.0, 3.0, 0.5}, {4.0, 1.0, 1.0}, {2.0, 2.0, 2.0}, {7.0, 0.0, 0.0}};
+    double peor = 0.0;
+    for (size_t k = 0; k < sizeof(casos)/sizeof(casos[0]); k++) {
+        double S[6], l[3];
+        tensor_girado(casos[k], 0.7 + k, 1.0/sqrt(3.0), 1.0/sqrt(3.0), 1.0/sqrt(3.0), S);
+        autovalores_simetrica3(S, l);
+        for (int i = 0; i < 3; i++) peor = fmax(peor, fabs(l[i] - casos[k][i]));
+    }
+    int ok = peor < TOLERANCIA;
+    printf("Autovalores de tensores girados (con degenerados): error %.1e  %s\n", peor, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+static int dos_pasadas(void) {
+    int N = 200;
+    double *x = malloc(3*N*sizeof(double)), *u = malloc(3*N*sizeof(double));
+    EstadoPR g;
+    inicializa_PR_r(&g, 7);
+    // Paseo al azar que empieza lejos del origen
+    x[0] = 1000.0; x[1] = -500.0; x[2] = 2000.0;
+    for (int i = 1; i < N; i++)
+        for (int d = 0; d < 3; d++) x[3*i + d] = x[3*(i-1) + d] + gaussian_r(&g);
+    FormaCadena f;
+    calcula_forma(N, x, &f, u);
+
+    double cm[3] = {0.0, 0.0, 0.0}, S[6] = {0.0};
+    for (int i = 0; i < N; i++)
+        for (int d = 0; d < 3; d++) cm[d] += x[3*i + d] / N;
+    for (int i = 0; i < N; i++) {
+        double d[3] = {x[3*i] - cm[0], x[3*i+1] - cm[1], x[3*i+2] - cm[2]};
+        S[0] += d[0]*d[0] / N; S[1] += d[1]*d[1] / N; S[2] += d[2]*d[2] / N;
+        S[3] += d[0]*d[1] / N; S[4] += d[0]*d[2] / N; S[5] += d[1]*d[2] / N;
+    }
+    double error = 0.0;
+    for (int k = 0; k < 6; k++) error = fmax(error, fabs(f.S[k] - S[k]));
+    for (int d = 0; d < 3; d++) error = fmax(error, fabs(f.Ree[d] - (x[3*(N-1) + d] - x[d])));
+    double Rg = calcula_radio_giro(N, x);
+    error = fmax(error, fabs(Rg*Rg - (S[0] + S[1] + S[2])));
+    error = fmax(error, fabs(f.lambda[0] + f.lambda[1] + f.lambda[2] - f.Rg2));
+    // Los enlaces son unitarios
+    for (int i = 0; i < N - 1; i++)
+        error = fmax(error, fabs(u[3*i]*u[3*i] + u[3*i+1]*u[3*i+1] + u[3*i+2]*u[3*i+2] - 1.0));
+    int ok = error < TOLERANCIA * f.Rg2;
+    printf("Pasada única frente a dos pasadas (N = %d, lejos del origen): error %.1e (Rg^2 = %.2f)  %s\n", N, error,
+           f.Rg2, ok ? "PASA" : "FALLA");
+    free(x);
+    free(u);
+    return ok;
+}
+
+static int formas_conocidas(void) {
+    int N = 40;
+    double x[3*40], u[3*40];
+    FormaCadena f;
+
+    // Varilla a lo largo de x
+    for (int i = 0; i < N; i++) { x[3*i] = i * L_0; x[3*i+1] = 0.0; x[3*i+2] = 0.0; }
+    calcula_forma(N, x, &f, u);
+    double l1 = (N*N - 1.0) / 12.0, l1_varilla = f.lambda[0], kappa_varilla = f.anisotropia;
+    int ok_varilla = fabs(f.lambda[0] - l1) < TOLERANCIA * l1 && fabs(f.lambda[1]) < TOLERANCIA * l1
+                     && fabs(f.anisotropia - 1.0) < TOLERANCIA && fabs(f.asfericidad - l1) < TOLERANCIA * l1
+                     && fabs(correlacion_orientacion(N, u, 7) - 1.0) < TOLERANCIA;
+
+    // Polígono regular de radio R en el plano xz (el anillo abierto por un enlace)
+    double R = 3.0, pi = acos(-1.0);
+    for (int i = 0; i < N; i++) { x[3*i] = R*cos(2*pi*i/N); x[3*i+1] = 0.0; x[3*i+2] = R*sin(2*pi*i/N); }
+    calcula_forma(N, x, &f, u);
+    int s = 5;
+    int ok_anillo = fabs(f.lambda[0] - R*R/2) < TOLERANCIA && fabs(f.lambda[1] - R*R/2) < TOLERANCIA
+                    && fabs(f.lambda[2]) < TOLERANCIA && fabs(f.anisotropia - 0.25) < TOLERANCIA
+                    && fabs(f.acilindricidad - R*R/2) < TOLERANCIA
+                    && fabs(correlacion_orientacion(N, u, s) - cos(2*pi*s/N)) < TOLERANCIA;
+    printf("Varilla: kappa^2 = %.6f, l1 = %.4f (%.4f); anillo plano: kappa^2 = %.6f, C(%d) = %.6f  %s\n",
+           kappa_varilla, l1_varilla, l1, f.anisotropia, s, correlacion_orientacion(N, u, s),
+           ok_varilla && ok_anillo ? "PASA" : "FALLA");
+    return ok_varilla && ok_anillo;
+}
+
+#ifdef FORMA
+// Borra lo que verlet_trayectoria deja en <carpeta>/*_prueba_forma.txt
+static void borra_auxiliares(const char *carpeta) {
+    DIR *d = opendir(carpeta);
+    if (!d) return;
+    struct dirent *e;
+    char ruta[512];
+    while ((e = readdir(d))) {
+        if (!strstr(e->d_name, "_" RUTA_TXT)) continue;
+        snprintf(ruta, sizeof(ruta), "%s/%s", carpeta, e->d_name);
+        remove(ruta);
+    }
+    closedir(d);
+    remove(carpeta);  // Solo si ha quedado vacía
+}
+
+static int trayectoria(void) {
+    int N = 16, pasos = 20000;
+    double x_0[3*16], v_0[3*16];
+    for (int i = 0; i < N; i++) {
+        x_0[3*i] = 0.0; x_0[3*i+1] = 0.0; x_0[3*i+2] = i * L_0;
+        v_0[3*i] = v_0[3*i+1] = v_0[3*i+2] = 0.0;
+    }
+    inicializa_PR(3);
+    // alfa = 2: con WLCM y poca fricción esta cadena corta se calienta y salud.c la cortaría
+    #ifdef FIXED
+    verlet_trayectoria("prueba", 1.0, 1.0, 2.0, N, 0.001, 1.0, pasos, Fuerza_verlet, RUTA_TXT, x_0, v_0, 100.0, 1.0);
+    #else
+    verlet_trayectoria("prueba", 1.0, 1.0, 2.0, N, 0.001, 1.0, pasos, Fuerza_verlet, RUTA_TXT, x_0, v_0, 100.0);
+    #endif
+    FILE *f = fopen("FORMA/forma_" RUTA_TXT, "r");
+    long long muestras = 0;
+    int observables = 0, finitos = 1;
+    char linea[256], nombre[64];
+    double media, error;
+    if (f) {
+        if (fscanf(f, "# %lld muestras\n", &muestras) != 1) muestras = 0;
+        while (fgets(linea, sizeof(linea), f)) {
+            if (linea[0] == '#') continue;
+            if (sscanf(linea, "%63s %lf %lf", nombre, &media, &error) == 3) {
+                observables++;
+                finitos &= isfinite(media) && isfinite(error);
+            }
+        }
+        fclose(f);
+    }
+    long long esperadas = PASOS_FORMA > 0 ? pasos / PASOS_FORMA : 0;
+    int ok = f && (PASOS_FORMA <= 0 || muestras == esperadas) && observables >= 11 && finitos;
+    printf("verlet_trayectoria: %lld muestras de forma (%lld esperadas), %d observables  %s\n", muestras, esperadas,
+           observables, ok ? "PASA" : "FALLA");
+    remove(RUTA_TXT);
+    borra_auxiliares("FORMA");
+    borra_auxiliares("DISTRIBUCIONES");
+    borra_auxiliares("CORRELACIONES");
+    borra_auxiliares("ESTIMADORES");
+    return ok;
+}
+#endif
+
+static int coste(void) {
+    int N = 1000, repeticiones = 2000;
+    double *memoria = calloc(7*3*N, sizeof(double));
+    double *x = memoria, *v = memoria + 3*N, *F = memoria + 6*N, *x2 = memoria + 9*N, *v2 = memoria + 12*N;
+    double *F2 = memoria + 15*N, *betta = memoria + 18*N;
+    for (int i = 0; i < N; i++) x[3*i + 2] = i * L_0;
+    inicializa_PR(5);   // Sin FORMA no pasa antes por trayectoria()
+    EstadisticaForma *e = crea_estadistica_forma(N);
+    double t0 = segundos();
+    for (int r = 0; r < repeticiones; r++) acumula_estadistica_forma(e, x);
+    double evaluacion = (segundos() - t0) / repeticiones;
+    t0 = segundos();
+    for (int r = 0; r < repeticiones; r++) {
+        for (int i = 0; i < 3*N; i++) betta[i] = gaussian() * 0.03;
+        #ifdef FIXED
+        un_paso_verlet(betta, 1.0, 1.0, N, x, x2, v, v2, F, F2, 0.001, 1.0, Fuerza_verlet, 100.0, 1.0);
+        #else
+        un_paso_verlet(betta, 1.0, 1.0, N, x, x2, v, v2, F, F2, 0.001, 1.0, Fuerza_verlet, 100.0);
+        #endif
+    }
+    double paso = (segundos() - t0) / repeticiones;
+    double fraccion = PASOS_FORMA > 0 ? evaluacion / (PASOS_FORMA * paso) : 0.0;
+    int ok = fraccion < COSTE_MAXIMO;
+    printf("N = %d: forma %.2f ns/partícula (%d separaciones), paso %.2f ns/partícula; cada %d pasos: %.1f %% más  %s\n",
+           N, 1e9 * evaluacion / N, e->n_separaciones, 1e9 * paso / N, PASOS_FORMA, 100.0 * fraccion,
+           ok ? "PASA" : "FALLA");
+    libera_estadistica_forma(e);
+    free(memoria);
+    return ok;
+}
+
+int main(void) {
+    int fallos = 0;
+    setenv("TELEMETRIA_CADENA", "prueba_forma_telemetria", 1);
+    if (!autovalores()) fallos++;
+    if (!dos_pasadas()) fallos++;
+    if (!formas_conocidas()) fallos++;
+    #ifdef FORMA
+    if (!trayectoria()) fallos++;
+    #endif
+    if (!coste()) fallos++;
+    remove("prueba_forma_telemetria");
+    return fallos ? 1 : 0;
+}
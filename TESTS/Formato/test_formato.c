@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "formato.h"
+
+/*
+ * Test del texto sin printf (formato.c).
+ *  1. formatea_fijo6 escribe lo mismo que "%.6f" en casos límite (empates al par, acarreo a la
+ *     parte entera, -0, subnormales, |x| >= 2^63, inf, nan) y en muchos valores aleatorios.
+ *  2. lee_decimal da el mismo double y el mismo final que strtod.
+ *  3. Un fichero de trayectoria escrito con SalidaTexto es idéntico byte a byte al de fprintf.
+ *  4. Velocidad de escritura: fprintf, SalidaTexto y fwrite binario.
+ * Los ficheros se crean en el directorio actual y se borran al terminar.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_formato.exe [valores aleatorios]
+ */
+
+#define N_PRUEBA 16
+#define FILAS_PRUEBA 20000
+#define RUTA_PRINTF "prueba_formato_printf.txt"
+#define RUTA_TEXTO "prueba_formato_texto.txt"
+#define RUTA_BIN "prueba_formato.bin"
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+static uint64_t estado_xorshift = 88172645463325252ull;
+static uint64_t xorshift(void) {
+    estado_xorshift ^= estado_xorshift << 13;
+    estado_xorshift ^= estado_xorshift >> 7;
+    estado_xorshift ^= estado_xorshift << 17;
+    return estado_xorshift;
+}
+
+// Valores de muchas escalas: bits aleatorios, diádicos (empates exactos) y decimales cerca de x.xxxxxx5
+static double valor_aleatorio(long i) {
+    uint64_t r = xorshift();
+    double x;
+    switch (i % 4) {
+        case 0: memcpy(&x, &r, 8); return x;
+        case 1: return ldexp((double)(int64_t)r, -(int)(r % 80));
+        case 2: return ((int64_t)(r % 2000000000) - 1000000000) / 1e6 + (double)(r % 3) * 5e-7 - 5e-7;
+        default: return ((int64_t)(r >> 20) - (1ll << 43)) * ldexp(1.0, -(int)(r % 30));
+    }
+}
+
+// Compara un valor con "%.6f" y con strtod. Devuelve 1 si coincide todo.
+static int compara(double x, int muestra) {
+    char propio[TAM_MAXIMO_FIJO6], referencia[TAM_MAXIMO_FIJO6];
+    int n = formatea_fijo6(x, propio);
+    int m = snprintf(referencia, sizeof(referencia), "%.6f", x);
+    int ok = n == m && strcmp(propio, referencia) == 0;
+
+    char *fin_propio, *fin_referencia;
+    double y = lee_decimal(referencia, &fin_propio), z = strtod(referencia, &fin_referencia);
+    ok = ok && fin_propio == fin_referencia && (memcmp(&y, &z, 8) == 0 || (isnan(y) && isnan(z)));
+    if (!ok && muestra) printf("  %a: \"%s\" frente a \"%s\"\n", x, propio, referencia);
+    return ok;
+}
+
+static int casos_limite(void) {
+    double casos[] = {
+        0.0, -0.0, 1.0, -1.0, 0.5, 0.0078125, 0.0234375, 1e-6, 5e-7, 4.9999999999e-7, 1.5e-6, 2.5e-6,
+        0.9999995, 0.99999949999, 9.9999995, -0.9999995, 123456.7890125, 0.1, 0.2, 0.3,
+        4.9e-324, 2.2250738585072014e-308, 1e-300, 9007199254740993.0, 4503599627370495.5,
+        9223372036854774784.0, 9223372036854775808.0, 1e19, 1e300, -1.7976931348623157e308,
+        INFINITY, -INFINITY, NAN, -NAN
+    };
+    int n = sizeof(casos) / sizeof(casos[0]), fallos = 0;
+    for (int k = 0; k < n; k++) if (!compara(casos[k], 1)) fallos++;
+
+    // Textos que lee_decimal pasa a strtod o que no son números
+    const char *textos[] = {"  1e5 x", "-2.5E-3", "0x1p3", "inf", "-nan", "abc", "", "+7.25", "1.5e",
+                            "123456789012345678901234", "0.00000000000000000000000123", ".5", "5."};
+    for (size_t k = 0; k < sizeof(textos) / sizeof(textos[0]); k++) {
+        char *fin_propio, *fin_referencia;
+        double y = lee_decimal(textos[k], &fin_propio), z = strtod(textos[k], &fin_referencia);
+        if (fin_propio != fin_referencia || !(memcmp(&y, &z, 8) == 0 || (isnan(y) && isnan(z)))) {
+            printf("  lee_decimal(\"%s\") = %a frente a %a\n", textos[k], y, z);
+            fallos++;
+        }
+    }
+    printf("%d casos límite y %d textos especiales  %s\n", n, (int)(sizeof(textos) / sizeof(textos[0])),
+           fallos ? "FALLA" : "PASA");
+    return fallos == 0;
+}
+
+static int aleatorios(long n) {
+    long fallos = 0;
+    for (long i = 0; i < n; i++) if (!compara(valor_aleatorio(i), fallos < 10)) fallos++;
+    printf("%ld valores aleatorios iguales a %%.6f y a strtod (%ld distintos)  %s\n", n, fallos,
+           fallos ? "FALLA" : "PASA");
+    return fallos == 0;
+}
+
+// Filas como las de verlet_trayectoria: t, 6N valores de orden 1, 5 observables
+static void fila_trayectoria(long r, double fila[]) {
+    fila[0] = 0.1 * r + 0.099;
+    for (int c = 1; c < 1 + 6*N_PRUEBA + 5; c++) fila[c] = (c < 1 + 3*N_PRUEBA ? c / 3 : 0) + sin(0.37*r + c);
+}
+
+static int trayectoria_identica(void) {
+    int columnas = 1 + 6*N_PRUEBA + 5;
+    double *filas = malloc((size_t)FILAS_PRUEBA*columnas*sizeof(double));
+    for (long r = 0; r < FILAS_PRUEBA; r++) fila_trayectoria(r, filas + r*columnas);
+    FILE *a = fopen(RUTA_PRINTF, "w"), *b = fopen(RUTA_TEXTO, "w");
+    FILE *c = fopen(RUTA_BIN, "wb");
+    if (!a || !b || !c || !filas) return 0;
+
+    double t0 = segundos();
+    fprintf(a, "%.6f %d\t%s\n", 0.0003, 1000, "entrada.txt");
+    for (long r = 0; r < FILAS_PRUEBA; r++) {
+        const double *fila = filas + r*columnas;
+        fprintf(a, "%.6f", fila[0]);
+        for (int k = 1; k < columnas; k++) fprintf(a, " %.6f", fila[k]);
+        fprintf(a, "\n");
+    }
+    fclose(a);
+    double t1 = segundos();
+
+    fprintf(b, "%.6f %d\t%s\n", 0.0003, 1000, "entrada.txt");
+    SalidaTexto *s = abre_salida_texto(b);
+    for (long r = 0; r < FILAS_PRUEBA; r++) {
+        const double *fila = filas + r*columnas;
+        anade_fijo6(s, 0, fila[0]);
+        for (int k = 1; k < columnas; k++) anade_fijo6(s, ' ', fila[k]);
+        termina_linea_texto(s);
+    }
+    cierra_salida_texto(s);
+    fclose(b);
+    double t2 = segundos();
+
+    for (long r = 0; r < FILAS_PRUEBA; r++) fwrite(filas + r*columnas, sizeof(double), columnas, c);
+    fclose(c);
+    double t3 = segundos();
+
+    // Byte a byte
+    a = fopen(RUTA_PRINTF, "rb");
+    b = fopen(RUTA_TEXTO, "rb");
+    long bytes = 0;
+    int ca, cb, iguales = 1;
+    do {
+        ca = fgetc(a);
+        cb = fgetc(b);
+        if (ca != cb) iguales = 0;
+        bytes++;
+    } while (iguales && ca != EOF);
+    fclose(a);
+    fclose(b);
+    free(filas);
+
+    double mb = (double)FILAS_PRUEBA * columnas * sizeof(double) / 1e6;
+    printf("%d filas de %d columnas (%ld bytes) idénticas a fprintf  %s\n", FILAS_PRUEBA, columnas, bytes - 1,
+           iguales ? "PASA" : "FALLA");
+    printf("Escritura (MB de doubles por segundo): fprintf %.0f, SalidaTexto %.0f (x%.1f), fwrite binario %.0f\n",
+           mb / (t1 - t0), mb / (t2 - t1), (t1 - t0) / (t2 - t1), mb / (t3 - t2));
+    return iguales;
+}
+
+static void velocidad_lectura(void) {
+    FILE *f = fopen(RUTA_TEXTO, "r");
+    if (!f) return;
+    fseek(f, 0, SEEK_END);
+    long tam = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *texto = malloc(tam + 1);
+    texto[fread(texto, 1, tam, f)] = '\0';
+    fclose(f);
+
+    char *p = strchr(texto, '\n') + 1, *fin;
+    double suma_strtod = 0.0, suma_propia = 0.0, t0 = segundos();
+    for (double x = strtod(p, &fin); fin != p; p = fin, x = strtod(p, &fin)) suma_strtod += x;
+    double t1 = segundos();
+    p = strchr(texto, '\n') + 1;
+    for (double x = lee_decimal(p, &fin); fin != p; p = fin, x = lee_decimal(p, &fin)) suma_propia += x;
+    double t2 = segundos();
+    printf("Lectura de %ld bytes: strtod %.3f s, lee_decimal %.3f s (x%.1f)  [sumas %.6f, %.6f]\n", tam,
+           t1 - t0, t2 - t1, (t1 - t0) / (t2 - t1), suma_strtod, suma_propia);
+    free(texto);
+}
+
+int main(int argc, char *argv[]) {
+    long n = argc > 1 ? atol(argv[1]) : 2000000;
+    int fallos = 0;
+
+    if (!casos_limite()) fallos++;
+    if (!aleatorios(n)) fallos++;
+    if (!trayectoria_identica()) fallos++;
+    velocidad_lectura();
+
+    remove(RUTA_PRINTF);
+    remove(RUTA_TEXTO);
+    remove(RUTA_BIN);
+    return fallos ? 1 : 0;
+}
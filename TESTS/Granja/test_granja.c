@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <dirent.h>
+#include <utime.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "granja.h"
+
+/*
+ * Test de la granja de barridos (granja.c).
+ *  1. Varios procesos a la vez sobre el mismo manifiesto terminan cada punto exactamente una vez.
+ *  2. Los resultados no dependen de qué trabajador hizo cada punto (igual que en serie).
+ *  3. Volver a lanzar la granja no repite ningún punto hecho.
+ *  4. Un punto en curso en otro proceso no se reclama; si ese proceso muere (SIGKILL) el punto
+ *     queda cortado y el siguiente trabajador lo retoma.
+ *  5. Un manifiesto mal formado se rechaza.
+ * Las carpetas se crean en el directorio actual y se borran al terminar.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_granja.exe [procesos]
+ */
+
+#define MANIFIESTO "prueba_granja.txt"
+#define CARPETA_PARALELO "prueba_granja_paralelo"
+#define CARPETA_SERIE "prueba_granja_serie"
+#define PUNTOS_PRUEBA 12
+
+static void borra_carpeta(const char *carpeta) {
+    DIR *d = opendir(carpeta);
+    if (!d) return;
+    struct dirent *e;
+    char ruta[1024];
+    while ((e = readdir(d))) {
+        if (e->d_name[0] == '.') continue;
+        snprintf(ruta, sizeof(ruta), "%s/%s", carpeta, e->d_name);
+        remove(ruta);
+    }
+    closedir(d);
+    remove(carpeta);
+}
+
+// Los trabajadores escriben una línea por punto: se descarta mientras 'callar' (dup2 sobre /dev/null)
+static void silencia(int callar) {
+    static int guardada = -1;
+    fflush(stdout);
+    if (callar) {
+        guardada = dup(STDOUT_FILENO);
+        int nulo = open("/dev/null", O_WRONLY);
+        dup2(nulo, STDOUT_FILENO);
+        close(nulo);
+    } else if (guardada >= 0) {
+        dup2(guardada, STDOUT_FILENO);
+        close(guardada);
+        guardada = -1;
+    }
+}
+
+static void escribe_manifiesto(void) {
+    FILE *f = fopen(MANIFIESTO, "w");
+    fprintf(f, "# Barrido de prueba\ncada 50\nequilibrado 500\n");
+    for (int i = 0; i < PUNTOS_PRUEBA; i++)
+        fprintf(f, "1000 %d %g 1 %d %d\n", 4 + 4*(i % 2), 0.1 * (i + 1), 100 + i, 5000 + 1000*(i % 3));
+    fclose(f);
+}
+
+static void ruta(const Granja *g, int i, const char *extension, char *r, size_t tam) {
+    char nombre[TAM_NOMBRE_PUNTO];
+    nombre_punto_granja(&g->puntos[i], nombre);
+    snprintf(r, tam, "%s/%s%s", g->carpeta, nombre, extension);
+}
+
+// Lanza 'procesos' trabajadores; cada uno devuelve en su código de salida los puntos que terminó
+static int paralelo(const Granja *g, int procesos) {
+    for (int p = 0; p < procesos; p++) {
+        if (fork() == 0) {
+            silencia(1);
+            _exit(trabaja_granja(g));
+        }
+    }
+    int total = 0, estado;
+    while (wait(&estado) > 0) total += WIFEXITED(estado) ? WEXITSTATUS(estado) : 1000;
+    int hechos = 0;
+    for (int i = 0; i < g->n_puntos; i++) hechos += estado_punto_granja(g, i) == PUNTO_HECHO;
+    int ok = total == g->n_puntos && hechos == g->n_puntos;
+    printf("%d trabajadores: %d puntos terminados en total, %d de %d hechos  %s\n", procesos, total, hechos,
+           g->n_puntos, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+static int igual_que_serie(const Granja *g, const Granja *serie) {
+    int distintos = 0;
+    silencia(1);
+    trabaja_granja(serie);
+    silencia(0);
+    for (int i = 0; i < g->n_puntos; i++) {
+        ResultadoPunto a, b;
+        if (!lee_resultado_granja(g, i, &a) || !lee_resultado_granja(serie, i, &b) || a.media_Ree != b.media_Ree
+            || a.error_Ree != b.error_Ree || a.media_Rg != b.media_Rg || a.media_Ek != b.media_Ek) distintos++;
+    }
+    printf("Resultados en paralelo iguales a los de un solo trabajador (%d distintos)  %s\n", distintos,
+           distintos ? "FALLA" : "PASA");
+    return distintos == 0;
+}
+
+static int no_repite(const Granja *g) {
+    char r[1024];
+    struct stat antes[PUNTOS_PRUEBA], despues;
+    for (int i = 0; i < g->n_puntos; i++) {
+        ruta(g, i, ".txt", r, sizeof(r));
+        stat(r, &antes[i]);
+    }
+    silencia(1);
+    int repetidos = trabaja_granja(g);
+    silencia(0);
+    for (int i = 0; i < g->n_puntos; i++) {
+        ruta(g, i, ".txt", r, sizeof(r));
+        if (stat(r, &despues) != 0 || despues.st_mtim.tv_nsec != antes[i].st_mtim.tv_nsec
+            || despues.st_mtime != antes[i].st_mtime) repetidos++;
+    }
+    printf("Al volver a lanzar no se repite ningún punto (%d repetidos)  %s\n", repetidos, repetidos ? "FALLA" : "PASA");
+    return repetidos == 0;
+}
+
+// Deja el .bloqueo como si se hubiera creado hace 'segundos'
+static void envejece(const char *r, int segundos) {
+    struct utimbuf t = {time(NULL) - segundos, time(NULL) - segundos};
+    utime(r, &t);
+}
+
+static int retoma_cortado(const Granja *g) {
+    int i = 3;
+    char hecho[1024], bloqueo[1024];
+    ruta(g, i, ".hecho", hecho, sizeof(hecho));
+    ruta(g, i, ".bloqueo", bloqueo, sizeof(bloqueo));
+    remove(hecho);
+
+    // Un "trabajador" que tiene el punto y no lo suelta
+    int tubo[2];
+    if (pipe(tubo) != 0) return 0;
+    pid_t hijo = fork();
+    if (hijo == 0) {
+        int fd = open(bloqueo, O_RDWR | O_CREAT | O_EXCL, 0644);
+        flock(fd, LOCK_EX);
+        if (write(tubo[1], "x", 1) != 1) _exit(1);
+        pause();
+        _exit(0);
+    }
+    char c;
+    if (read(tubo[0], &c, 1) != 1) return 0;
+    envejece(bloqueo, 2*GRACIA_BLOQUEO);
+    EstadoPunto en_curso = estado_punto_granja(g, i);
+    silencia(1);
+    int respetado = trabaja_granja(g) == 0;
+
+    kill(hijo, SIGKILL);
+    waitpid(hijo, NULL, 0);
+    EstadoPunto cortado = estado_punto_granja(g, i);
+    int retomado = trabaja_granja(g) == 1 && estado_punto_granja(g, i) == PUNTO_HECHO;
+    silencia(0);
+    int ok = en_curso == PUNTO_EN_CURSO && respetado && cortado == PUNTO_CORTADO && retomado;
+    printf("Punto de otro proceso respetado; tras SIGKILL cortado y retomado  %s\n", ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+static int rechaza_mal_formados(void) {
+    const char *malos[] = {"1000 4 0.1 1 5\n", "1000 4 0.1 1 5 100 7\n", "paso 0.1\n", "dt\n", "1000 4 0.1 1 5 0\n"};
+    int rechazados = 0, n = sizeof(malos) / sizeof(malos[0]);
+    for (int k = 0; k < n; k++) {
+        FILE *f = fopen(MANIFIESTO, "w");
+        fprintf(f, "1000 4 0.1 1 5 100\n%s", malos[k]);
+        fclose(f);
+        Granja g;
+        silencia(1);
+        int error = lee_manifiesto_granja(MANIFIESTO, CARPETA_SERIE, &g);
+        silencia(0);
+        if (error) rechazados++;
+        else libera_granja(&g);
+    }
+    printf("%d de %d manifiestos mal formados rechazados  %s\n", rechazados, n, rechazados == n ? "PASA" : "FALLA");
+    return rechazados == n;
+}
+
+int main(int argc, char *argv[]) {
+    int procesos = argc > 1 ? atoi(argv[1]) : 4;
+    int fallos = 0;
+    setenv("TELEMETRIA_CADENA", "prueba_granja_telemetria", 1);
+    borra_carpeta(CARPETA_PARALELO);
+    borra_carpeta(CARPETA_SERIE);
+    escribe_manifiesto();
+
+    Granja g, serie;
+    if (lee_manifiesto_granja(MANIFIESTO, CARPETA_PARALELO, &g) != 0
+        || lee_manifiesto_granja(MANIFIESTO, CARPETA_SERIE, &serie) != 0 || g.n_puntos != PUNTOS_PRUEBA) {
+        printf("No se pudo leer el manifiesto de prueba  FALLA\n");
+        return 1;
+    }
+    fflush(stdout);
+    if (!paralelo(&g, procesos)) fallos++;
+    if (!igual_que_serie(&g, &serie)) fallos++;
+    if (!no_repite(&g)) fallos++;
+    if (!retoma_cortado(&g)) fallos++;
+    if (!rechaza_mal_formados()) fallos++;
+
+    libera_granja(&g);
+    libera_granja(&serie);
+    borra_carpeta(CARPETA_PARALELO);
+    borra_carpeta(CARPETA_SERIE);
+    remove(MANIFIESTO);
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+
+/*
+ * Benchmark del motor de hilos para una sola cadena larga.
+ *  1. A temperatura cero (sin ruido) la trayectoria no depende del reparto entre hilos:
+ *     compara el motor con 1..4 hilos contra el paso fusionado en serie.
+ *  2. Mide el tiempo real por paso con N grande para 1, 2, 4, ... hilos y el speedup.
+ * Devuelve 0 si la comprobación pasa y 1 si no.
+ *
+ * Uso: benchmark_hilos.exe [N] [pasos] [max_hilos]
+ */
+
+#define PASOS_COMPROBACION 500
+
+static double alfa = 0.5, kb = 1.0, dt = 0.0003, m = 1.0, K = 1000.0;
+#ifdef FIXED
+static double F_cte = 1.0;
+#endif
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+// Cadena ligeramente ondulada para que las fuerzas no sean triviales
+static void configuracion_inicial(int N, double x[], double v[]) {
+    for (int j = 0; j < N; j++) {
+        x[3*j] = j; x[3*j+1] = 0.1*sin(0.3*j); x[3*j+2] = 0.1*cos(0.7*j);
+        v[3*j] = v[3*j+1] = v[3*j+2] = 0.0;
+    }
+}
+
+static MotorHilos *crea(int N, int n_hilos, double x[], double v[], double Temperatura) {
+    #ifdef FIXED
+    return crea_motor_hilos(N, n_hilos, x, v, kb, Temperatura, alfa, dt, m, K, F_cte);
+    #else
+    return crea_motor_hilos(N, n_hilos, x, v, kb, Temperatura, alfa, dt, m, K);
+    #endif
+}
+
+static double diferencia_con_serie(int N, int n_hilos) {
+    double *x = malloc(3*N*sizeof(double)), *v = malloc(3*N*sizeof(double)), *F = malloc(3*N*sizeof(double));
+    configuracion_inicial(N, x, v);
+
+    MotorHilos *motor = crea(N, n_hilos, x, v, 0.0);
+    if (!motor) {
+        free(x); free(v); free(F);
+        return INFINITY;
+    }
+    avanza_motor_hilos(motor, PASOS_COMPROBACION);
+    double *x_h = posiciones_motor_hilos(motor);
+
+    double a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    double b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    #ifdef FIXED
+    Fuerza_verlet(N, x, F, K, F_cte);
+    #else
+    Fuerza_verlet(N, x, F, K);
+    #endif
+    for (int paso = 0; paso < PASOS_COMPROBACION; paso++) {
+        #ifdef FIXED
+        un_paso_verlet_fusionado(0.0, b, a, N, x, v, F, dt, m, K, F_cte);
+        #else
+        un_paso_verlet_fusionado(0.0, b, a, N, x, v, F, dt, m, K);
+        #endif
+    }
+
+    double dif = 0.0;
+    for (int i = 0; i < 3*N; i++) {
+        double d = fabs(x[i] - x_h[i]);
+        if (d > dif) dif = d;
+    }
+    destruye_motor_hilos(motor);
+    free(x); free(v); free(F);
+    return dif;
+}
+
+int main(int argc, char *argv[]) {
+    int N = argc > 1 ? atoi(argv[1]) : 50000;
+    int pasos = argc > 2 ? atoi(argv[2]) : 200;
+    int max_hilos = argc > 3 ? atoi(argv[3]) : 8;
+    int fallos = 0;
+
+    inicializa_PR(12456);
+
+    // 1. Independencia del reparto a T = 0
+    for (int h = 1; h <= 4; h++) {
+        double dif = diferencia_con_serie(1000, h);
+        int ok = dif < 1e-12;
+        printf("T = 0, %d hilo(s): max |x_hilos - x_serie| = %.3e  %s\n", h, dif, ok ? "PASA" : "FALLA");
+        if (!ok) fallos++;
+    }
+
+    // 2. Escalado con el número de hilos
+    double *x = malloc(3*N*sizeof(double)), *v = malloc(3*N*sizeof(double));
+    configuracion_inicial(N, x, v);
+    printf("\nN = %d, %d pasos\n%8s %14s %10s\n", N, pasos, "hilos", "us/paso", "speedup");
+    double t_1 = 0.0;
+    for (int h = 1; h <= max_hilos; h *= 2) {
+        MotorHilos *motor = crea(N, h, x, v, 1.0);
+        if (!motor) break;
+        avanza_motor_hilos(motor, 10);  // Calentamiento
+        double t0 = segundos();
+        avanza_motor_hilos(motor, pasos);
+        double t = (segundos() - t0)/pasos;
+        destruye_motor_hilos(motor);
+        if (h == 1) t_1 = t;
+        printf("%8d %14.1f %10.2f\n", h, 1e6*t, t_1/t);
+    }
+    free(x); free(v);
+
+    return fallos ? 1 : 0;
+}
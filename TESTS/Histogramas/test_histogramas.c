@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+
+/*
+ * Test del histograma en streaming (histograma.c).
+ *  1. Rango automático: las cuentas acumuladas muestra a muestra, con la rejilla ensanchándose
+ *     sobre la marcha, coinciden con binear de golpe todas las muestras guardadas en la rejilla final.
+ *  2. Combinación: cuatro flujos (como cuatro réplicas o hilos) con rangos distintos, combinados,
+ *     coinciden con el binneado de referencia en la rejilla combinada, con la misma n y media.
+ *  3. Rango fijo: las muestras fuera de [min, max) van a 'fuera' y el resto a su bin.
+ *  4. Rango automático con valores desorbitados: una primera muestra de 1e300 y un valor aislado
+ *     más allá de NIVEL_MAXIMO_HISTOGRAMA van a 'fuera' sin ensanchar la rejilla.
+ *  5. Ritmo de muestras por segundo.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_histogramas.exe [muestras]
+ */
+
+#define BINS 64
+#define ANCHO_0 1e-3
+#define FLUJOS 4
+#define TOLERANCIA 1e-12
+
+// Binneado de referencia de las muestras guardadas en la rejilla de h
+static int compara_con_referencia(const Histograma *h, const double *muestras, int n) {
+    double *cuentas = calloc(h->n_bins, sizeof(double));
+    int fuera = 0;
+    for (int i = 0; i < n; i++) {
+        double t = (muestras[i] - h->min) / h->ancho;
+        if (t < 0.0 || t >= h->n_bins) { fuera++; continue; }
+        cuentas[(int)t]++;
+    }
+    int distintos = 0;
+    for (int j = 0; j < h->n_bins; j++)
+        if (cuentas[j] != h->cuentas[j]) distintos++;
+    free(cuentas);
+    return distintos + fuera;
+}
+
+// Media directa de las muestras
+static double media_directa(const double *muestras, int n) {
+    double suma = 0.0;
+    for (int i = 0; i < n; i++) suma += muestras[i];
+    return suma / n;
+}
+
+// Muestras gaussianas centradas en 'centro' con anchura 'ancho'
+static void genera_muestras(double *muestras, int n, double centro, double ancho) {
+    for (int i = 0; i < n; i++) muestras[i] = centro + ancho * gaussian();
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int fallos = 0;
+    inicializa_PR(12345);
+
+    double *muestras = calloc((size_t)n, sizeof(double));
+
+    // 1. Rango automático frente a la referencia
+    genera_muestras(muestras, n, 7.3, 2.0);
+    Histograma *h = crea_histograma_auto(BINS, ANCHO_0);
+    for (int i = 0; i < n; i++) anade_histograma(h, muestras[i]);
+    int distintos = compara_con_referencia(h, muestras, n);
+    double dif_media = fabs(media_histograma(h) - media_directa(muestras, n));
+    int ok = distintos == 0 && h->n == n && dif_media < TOLERANCIA * 10.0;
+    printf("Rango automático: nivel %d, ancho %g, [%g, %g), bins distintos %d, dif. media %.2e  %s\n",
+           h->nivel, h->ancho, h->min, h->min + BINS*h->ancho, distintos, dif_media, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 2. Combinación de flujos con centros y anchuras distintas
+    int n_flujo = n / FLUJOS;
+    Histograma *total = crea_histograma_auto(BINS, ANCHO_0);
+    for (int f = 0; f < FLUJOS; f++) {
+        Histograma *parcial = crea_histograma_auto(BINS, ANCHO_0);
+        genera_muestras(&muestras[f*n_flujo], n_flujo, -3.0 + 4.0*f, 0.1 * (f + 1));
+        for (int i = 0; i < n_flujo; i++) anade_histograma(parcial, muestras[f*n_flujo + i]);
+        if (!combina_histogramas(total, parcial)) fallos++;
+        libera_histograma(parcial);
+    }
+    distintos = compara_con_referencia(total, muestras, FLUJOS*n_flujo);
+    double media = media_directa(muestras, FLUJOS*n_flujo);
+    dif_media = fabs(media_histograma(total) - media) / fabs(media);
+    ok = distintos == 0 && total->n == (long long)FLUJOS*n_flujo && dif_media < TOLERANCIA * 10.0;
+    printf("Combinación de %d flujos: nivel %d, bins distintos %d, n %lld, dif. relativa media %.2e  %s\n",
+           FLUJOS, total->nivel, distintos, total->n, dif_media, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 3. Rango fijo
+    Histograma *fijo = crea_histograma(10, 0.0, 1.0);
+    double prueba[6] = {-0.1, 0.0, 0.55, 0.999, 1.0, NAN};
+    for (int i = 0; i < 6; i++) anade_histograma(fijo, prueba[i]);
+    ok = fijo->n == 3 && fijo->fuera == 3 && fijo->cuentas[0] == 1 && fijo->cuentas[5] == 1 && fijo->cuentas[9] == 1;
+    printf("Rango fijo: n %lld, fuera %lld  %s\n", fijo->n, fijo->fuera, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 4. Valores desorbitados en el rango automático
+    Histograma *lejos = crea_histograma_auto(BINS, ANCHO_0);
+    anade_histograma(lejos, 1e300);
+    for (int i = 0; i < 1000; i++) anade_histograma(lejos, 1.0 + 1e-3 * (i % 10));
+    int nivel = lejos->nivel;
+    anade_histograma(lejos, -1e12);
+    ok = lejos->fuera == 2 && lejos->n == 1000 && lejos->nivel == nivel && nivel < NIVEL_MAXIMO_HISTOGRAMA;
+    printf("Valores desorbitados: n %lld, fuera %lld, nivel %d  %s\n", lejos->n, lejos->fuera, lejos->nivel,
+           ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+    libera_histograma(lejos);
+
+    // 5. Ritmo
+    reinicia_histograma(h);
+    clock_t t0 = clock();
+    for (int i = 0; i < n; i++) anade_histograma(h, muestras[i]);
+    clock_t t1 = clock();
+    double segundos = (double)(t1 - t0) / CLOCKS_PER_SEC;
+    printf("\n%d muestras en %.3f s: %.1f millones de muestras por segundo\n",
+           n, segundos, segundos > 0 ? n / segundos / 1e6 : 0.0);
+
+    libera_histograma(h);
+    libera_histograma(total);
+    libera_histograma(fijo);
+    free(muestras);
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <time.h>
+#include "integradores.h"
+
+/*
+ * Compara los integradores de Langevin (GJF, BAOAB, OBABO, Euler-Maruyama) para varios dt.
+ * Para cada uno mide <Ree>, <Rg>, la temperatura configuracional y la cinética con su error
+ * (por bloques) y el coste por paso. La referencia es la media de N_REFERENCIAS simulaciones
+ * independientes de BAOAB con el dt más pequeño, y cada medida se compara con ella dentro de una
+ * tolerancia relativa más 2 errores combinados. En modo FIXED la primera partícula está fija y la
+ * temperatura cinética se cuenta sobre 3(N-1) grados de libertad. Al final indica, para cada
+ * integrador, el mayor dt que reproduce la referencia dentro de las tolerancias.
+ *
+ * Uso: benchmark_integradores.exe [T_fisico]
+ */
+
+#define N_PART 8
+#define N_DT 6
+#define N_BLOQUES 20
+#define TOLERANCIA 0.02     // Tolerancia relativa en <Rg> (más 2 errores estadísticos)
+#define TOLERANCIA_T 0.05   // Tolerancia relativa en T_conf (más 2 errores estadísticos)
+#define N_REFERENCIAS 4     // Simulaciones independientes que promedia la referencia
+
+typedef struct {
+    double Ree, err_Ree;
+    double Rg, err_Rg;
+    double T_conf, err_T_conf, T_kin;
+    double ns_paso;
+    int estable;
+} Resultado;
+
+// Media y error de una serie dividida en N_BLOQUES bloques
+static void media_bloques(double bloques[], int n, double *media, double *error) {
+    double s = 0, s2 = 0;
+    for (int i = 0; i < n; i++) { s += bloques[i]; s2 += bloques[i]*bloques[i]; }
+    *media = s/n;
+    double var = s2/n - (*media)*(*media);
+    *error = var > 0 ? sqrt(var/(n-1)) : 0.0;
+}
+
+static Resultado mide(TipoIntegrador tipo, double dt, double T_fisico, double K, double kb,
+                      double Temperatura, double alfa, double m, double F_cte) {
+    Resultado res = {0};
+    Integrador integ;
+    double x[3*N_PART], v[3*N_PART], F[3*N_PART];
+
+    for (int j = 0; j < N_PART; j++) {
+        x[3*j] = j; x[3*j+1] = 0.0; x[3*j+2] = 0.0;
+        v[3*j] = v[3*j+1] = v[3*j+2] = 0.0;
+    }
+
+    #ifdef FIXED
+    crea_integrador(&integ, tipo, N_PART, dt, m, alfa, kb, Temperatura, Fuerza_verlet, K, F_cte);
+    #else
+    (void)F_cte;
+    crea_integrador(&integ, tipo, N_PART, dt, m, alfa, kb, Temperatura, Fuerza_verlet, K);
+    #endif
+    fuerza_integrador(&integ, x, F);
+
+    int pasos = (int)(T_fisico/dt);
+    int termalizacion = pasos/10;
+    int muestreo = (int)(0.05/dt); if (muestreo < 1) muestreo = 1;
+    int pasos_bloque = (pasos - termalizacion)/N_BLOQUES;
+
+    double bloque_Ree[N_BLOQUES] = {0}, bloque_Rg[N_BLOQUES] = {0};
+    double bloque_grad2[N_BLOQUES] = {0}, bloque_lap[N_BLOQUES] = {0}, bloque_T_conf[N_BLOQUES];
+    int muestras_bloque[N_BLOQUES] = {0};
+    double grad2 = 0, lap = 0, Ek = 0;
+    int n_muestras = 0;
+    res.estable = 1;
+
+    clock_t inicio = clock();
+    for (int paso = 0; paso < pasos; paso++) {
+        integ.paso(&integ, x, v, F);
+
+        if (paso >= termalizacion && (paso - termalizacion) % muestreo == 0) {
+            int b = (paso - termalizacion)/pasos_bloque;
+            if (b >= N_BLOQUES) b = N_BLOQUES - 1;
+
+            double Ree = x[3*(N_PART-1)+2] - x[2];
+            double Rg = calcula_radio_giro(N_PART, x);
+            if (!isfinite(Ree) || !isfinite(Rg) || Rg > 10.0*N_PART*L_0) { res.estable = 0; break; }
+            bloque_Ree[b] += Ree; bloque_Rg[b] += Rg; muestras_bloque[b]++;
+
+            // T_conf como cociente de medias: <|grad U|^2> / (kb <lap U>)
+            double T_c = Temperatura_configuracional(N_PART, x, F, K, kb);
+            double g2 = 0;
+            #ifdef FIXED
+            for (int i = 3; i < 3*N_PART; i++) g2 += F[i]*F[i];
+            #else
+            for (int i = 0; i < 3*N_PART; i++) g2 += F[i]*F[i];
+            #endif
+            double l = T_c > 0 ? g2/(kb*T_c) : 0.0;
+            grad2 += g2;
+            lap += l;
+            bloque_grad2[b] += g2;
+            bloque_lap[b] += l;
+            Ek += Energia_cinetica_instantanea(N_PART, v, m);
+            n_muestras++;
+        }
+    }
+    clock_t fin = clock();
+    libera_integrador(&integ);
+
+    res.ns_paso = 1e9*(double)(fin - inicio)/CLOCKS_PER_SEC/pasos;
+    if (!res.estable || n_muestras == 0) return res;
+
+    for (int b = 0; b < N_BLOQUES; b++) {
+        bloque_Ree[b] /= muestras_bloque[b] > 0 ? muestras_bloque[b] : 1;
+        bloque_Rg[b]  /= muestras_bloque[b] > 0 ? muestras_bloque[b] : 1;
+        bloque_T_conf[b] = bloque_lap[b] > 0 ? bloque_grad2[b]/(kb*bloque_lap[b]) : 0.0;
+    }
+    media_bloques(bloque_Ree, N_BLOQUES, &res.Ree, &res.err_Ree);
+    media_bloques(bloque_Rg, N_BLOQUES, &res.Rg, &res.err_Rg);
+    double media_T_conf;
+    media_bloques(bloque_T_conf, N_BLOQUES, &media_T_conf, &res.err_T_conf);
+    res.T_conf = lap > 0 ? grad2/(kb*lap) : 0.0;
+    #ifdef FIXED
+    int grados = 3*(N_PART - 1);
+    #else
+    int grados = 3*N_PART;
+    #endif
+    res.T_kin = 2.0*Ek/n_muestras/(grados*kb);
+    return res;
+}
+
+int main(int argc, char *argv[]) {
+    inicializa_PR(12456);
+
+    double T_fisico = argc > 1 ? atof(argv[1]) : 500.0;
+    double K = 100.0;
+    double kb = 1.0, Temperatura = 1.0, alfa = 0.5, m = 1.0;
+    double F_cte = 1.0;
+    double dts[N_DT] = {0.001, 0.0025, 0.005, 0.01, 0.02, 0.04};
+
+    Resultado tabla[N_INTEGRADORES][N_DT];
+
+    printf("N = %d, K = %.1f, T = %.2f, alfa = %.2f, T_fisico = %.1f\n", N_PART, K, Temperatura, alfa, T_fisico);
+    printf("%-15s %8s %10s %9s %10s %9s %8s %8s %10s\n",
+           "integrador", "dt", "<Ree>", "error", "<Rg>", "error", "T_conf", "T_kin", "ns/paso");
+
+    for (int t = 0; t < N_INTEGRADORES; t++) {
+        for (int d = 0; d < N_DT; d++) {
+            tabla[t][d] = mide((TipoIntegrador)t, dts[d], T_fisico, K, kb, Temperatura, alfa, m, F_cte);
+            Resultado *r = &tabla[t][d];
+            if (!r->estable) {
+                printf("%-15s %8.4f %s\n", nombre_integrador((TipoIntegrador)t), dts[d], "   inestable");
+                continue;
+            }
+            printf("%-15s %8.4f %10.5f %9.5f %10.5f %9.5f %8.4f %8.4f %10.1f\n",
+                   nombre_integrador((TipoIntegrador)t), dts[d], r->Ree, r->err_Ree, r->Rg, r->err_Rg,
+                   r->T_conf, r->T_kin, r->ns_paso);
+        }
+    }
+
+    // Referencia: media de N_REFERENCIAS simulaciones independientes de BAOAB con el dt más pequeño
+    Resultado referencia = tabla[INTEGRADOR_BAOAB][0], *ref = &referencia;
+    double var_Rg = ref->err_Rg*ref->err_Rg, var_T_conf = ref->err_T_conf*ref->err_T_conf;
+    for (int k = 1; k < N_REFERENCIAS; k++) {
+        inicializa_PR(12456 + k);
+        Resultado r = mide(INTEGRADOR_BAOAB, dts[0], T_fisico, K, kb, Temperatura, alfa, m, F_cte);
+        ref->Rg += r.Rg;
+        ref->T_conf += r.T_conf;
+        var_Rg += r.err_Rg*r.err_Rg;
+        var_T_conf += r.err_T_conf*r.err_T_conf;
+    }
+    ref->Rg /= N_REFERENCIAS;
+    ref->T_conf /= N_REFERENCIAS;
+    ref->err_Rg = sqrt(var_Rg)/N_REFERENCIAS;
+    ref->err_T_conf = sqrt(var_T_conf)/N_REFERENCIAS;
+    printf("\nReferencia (BAOAB, dt = %.4f, %d simulaciones): <Rg> = %.5f +- %.5f, T_conf = %.4f +- %.4f\n",
+           dts[0], N_REFERENCIAS, ref->Rg, ref->err_Rg, ref->T_conf, ref->err_T_conf);
+    printf("Mayor dt con |<Rg>-ref| < %.0f%% + 2 err y |T_conf-ref| < %.0f%% + 2 err:\n",
+           100*TOLERANCIA, 100*TOLERANCIA_T);
+    for (int t = 0; t < N_INTEGRADORES; t++) {
+        int mejor = -1;
+        for (int d = 0; d < N_DT; d++) {
+            Resultado *r = &tabla[t][d];
+            if (!r->estable) break;
+            double tol_Rg = TOLERANCIA*fabs(ref->Rg) + 2.0*sqrt(r->err_Rg*r->err_Rg + ref->err_Rg*ref->err_Rg);
+            if (fabs(r->Rg - ref->Rg) > tol_Rg) break;
+            double tol_T = TOLERANCIA_T*ref->T_conf +
+                           2.0*sqrt(r->err_T_conf*r->err_T_conf + ref->err_T_conf*ref->err_T_conf);
+            if (fabs(r->T_conf - ref->T_conf) > tol_T) break;
+            mejor = d;
+        }
+        if (mejor < 0)
+            printf("  %-15s ninguno\n", nombre_integrador((TipoIntegrador)t));
+        else
+            printf("  %-15s dt = %.4f  (%.1f ns/paso, %.2f us por unidad de tiempo simulado)\n",
+                   nombre_integrador((TipoIntegrador)t), dts[mejor], tabla[t][mejor].ns_paso,
+                   1e-3*tabla[t][mejor].ns_paso/dts[mejor]);
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "intercambio.h"
+
+/*
+ * Test del intercambio de réplicas (intercambio.c) con una cadena corta (FIXED).
+ *  1. Con intercambios de fuerzas, <Ree> de cada condición coincide (dentro de 4 errores) con
+ *     la de las mismas réplicas sin intercambios: los intercambios no sesgan el muestreo.
+ *  2. Entre dos condiciones iguales se acepta siempre; entre vecinas la aceptación está en (0, 1)
+ *     y las réplicas recorren la escalera (idas y vueltas completas).
+ *  3. Con la misma semilla el resultado es idéntico bit a bit, sea cual sea el orden de los hilos.
+ *  4. Con intercambios de temperaturas, la temperatura cinética de cada condición es la suya
+ *     (las muestras se separan por condición y las velocidades se reescalan).
+ * Con WLCM solo se comprueba que el intercambio se rechaza.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_intercambio.exe [T_fisico]
+ */
+
+#define N_CADENA 4
+#define K_MUELLE 1000.0
+#define N_REPLICAS 4
+#define SIGMAS 4.0
+
+#ifdef FIXED
+static double alfa = 0.5, kb = 1.0, dt = 0.0003, m = 1.0, Temperatura = 1.0;
+
+static int simula(ParametrosIntercambio *pi, double F_cte, const char *carpeta, ResultadoIntercambio res[], int semilla) {
+    inicializa_PR(semilla);
+    memset(res, 0, pi->n_replicas*sizeof(ResultadoIntercambio));
+    return intercambio_replicas(pi, kb, Temperatura, alfa, N_CADENA, dt, m, K_MUELLE, F_cte, carpeta, res);
+}
+
+static void borra_salidas(const char *carpeta, int n) {
+    char ruta[512];
+    for (int k = 0; k < n; k++) {
+        snprintf(ruta, sizeof(ruta), "%s/condicion_%d.txt", carpeta, k);
+        remove(ruta);
+    }
+    snprintf(ruta, sizeof(ruta), "%s/intercambio.txt", carpeta);
+    remove(ruta);
+    remove(carpeta);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+#ifndef FIXED
+    (void)argc;
+    (void)argv;
+    printf("El intercambio de fuerzas necesita FIXED\n");
+    return 0;
+#else
+    double T_fisico = argc > 1 ? atof(argv[1]) : 300.0;
+    int fallos = 0, ok;
+    char carpeta[] = "intercambio_test";
+    crea_carpetas(carpeta);
+
+    double fuerzas[N_REPLICAS] = {0.5, 1.0, 1.5, 2.0};
+    ParametrosIntercambio pi = {INTERCAMBIO_FUERZA, N_REPLICAS, fuerzas, 10.0, T_fisico, 0.3, 0.1};
+    ResultadoIntercambio con[N_REPLICAS], sin[N_REPLICAS], repetido[N_REPLICAS];
+
+#ifdef WLCM
+    // Con WLCM la flexión no tiene energía: se rechaza cualquier intercambio
+    ok = !simula(&pi, 0.0, carpeta, con, 11);
+    printf("Con WLCM no hay intercambio de réplicas  %s\n", ok ? "PASA" : "FALLA");
+    remove(carpeta);
+    return ok ? 0 : 1;
+#endif
+
+    // 1. Sin sesgo frente a las réplicas independientes
+    clock_t t0 = clock();
+    if (!simula(&pi, 0.0, carpeta, con, 11)) return 1;
+    clock_t t1 = clock();
+    ParametrosIntercambio pi_sin = pi;
+    pi_sin.intervalo_intercambio = 0.0;
+    if (!simula(&pi_sin, 0.0, carpeta, sin, 12)) return 1;
+
+    printf("\n%8s %10s %10s %10s %10s %10s %6s\n", "F_cte", "Ree", "error", "Ree_indep", "error", "acept", "viajes");
+    int viajes = 0;
+    for (int k = 0; k < N_REPLICAS; k++) {
+        double e = sqrt(con[k].error * con[k].error + sin[k].error * sin[k].error);
+        int ok = fabs(con[k].Ree - sin[k].Ree) <= SIGMAS * e;
+        double aceptacion = con[k].intentos ? (double)con[k].aceptados / con[k].intentos : 0.0;
+        if (k < N_REPLICAS - 1) ok = ok && aceptacion > 0.0 && aceptacion < 1.0;
+        viajes += con[k].viajes;
+        printf("%8.3f %10.5f %10.5f %10.5f %10.5f %10.3f %6d %s\n", fuerzas[k], con[k].Ree, con[k].error,
+               sin[k].Ree, sin[k].error, aceptacion, con[k].viajes, ok ? "PASA" : "FALLA");
+        if (!ok) fallos++;
+    }
+    ok = viajes > 0;
+    printf("Idas y vueltas completas: %d (%.2f s de CPU con intercambios)  %s\n", viajes,
+           (double)(t1 - t0) / CLOCKS_PER_SEC, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 2. Condiciones iguales: siempre se acepta
+    double iguales[2] = {1.0, 1.0};
+    ParametrosIntercambio pi_iguales = {INTERCAMBIO_FUERZA, 2, iguales, 0.0, 20.0, 0.3, 0.1};
+    ResultadoIntercambio res_iguales[2];
+    simula(&pi_iguales, 0.0, carpeta, res_iguales, 13);
+    ok = res_iguales[0].intentos > 0 && res_iguales[0].aceptados == res_iguales[0].intentos;
+    printf("Fuerzas iguales: %lld de %lld aceptados  %s\n", res_iguales[0].aceptados, res_iguales[0].intentos,
+           ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 3. Reproducibilidad
+    simula(&pi, 0.0, carpeta, repetido, 11);
+    ok = 1;
+    for (int k = 0; k < N_REPLICAS; k++)
+        ok = ok && repetido[k].Ree == con[k].Ree && repetido[k].aceptados == con[k].aceptados;
+    printf("Misma semilla, mismo resultado  %s\n", ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 4. Temperaturas
+    double temperaturas[N_REPLICAS] = {1.0, 1.2, 1.44, 1.728};
+    ParametrosIntercambio pi_T = {INTERCAMBIO_TEMPERATURA, N_REPLICAS, temperaturas, 10.0, T_fisico / 2, 0.3, 0.1};
+    ResultadoIntercambio res_T[N_REPLICAS];
+    simula(&pi_T, 1.0, carpeta, res_T, 14);
+    printf("\n%8s %10s %10s\n", "T", "T_cin", "acept");
+    for (int k = 0; k < N_REPLICAS; k++) {
+        double aceptacion = res_T[k].intentos ? (double)res_T[k].aceptados / res_T[k].intentos : 0.0;
+        ok = fabs(res_T[k].T_cinetica / temperaturas[k] - 1.0) < 0.08;
+        printf("%8.3f %10.4f %10.3f %s\n", temperaturas[k], res_T[k].T_cinetica, aceptacion, ok ? "PASA" : "FALLA");
+        if (!ok) fallos++;
+    }
+
+    borra_salidas(carpeta, N_REPLICAS);
+    return fallos ? 1 : 0;
+#endif
+}
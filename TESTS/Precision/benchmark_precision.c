@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "precision.h"
+#include "histograma.h"
+
+/*
+ * Benchmark y validación de las precisiones de precision.c.
+ *  1. La precisión doble reproduce bit a bit el bucle de un_paso_verlet con el mismo generador.
+ *  2. Con los mismos pasos en cada precisión, <Ree> y <Rg> (errores por bloques) de la simple y
+ *     la mixta coinciden con los de la doble dentro de SIGMAS errores combinados. Se imprime el
+ *     tiempo por paso y error * sqrt(tiempo), que compara las precisiones a igual coste.
+ *  3. Con la cadena a DESPLAZAMIENTO del origen la mixta sigue coincidiendo con la doble (la
+ *     simple se imprime sin comprobar: pierde bits en los enlaces).
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: benchmark_precision.exe [pasos] [N]
+ */
+
+#define SIGMAS 4.0
+#define PASOS_COMPROBACION 200
+#define PASOS_EQUILIBRADO 20000
+#define CADA 10
+#define DESPLAZAMIENTO 1e5
+
+static double alfa = 0.5, kb = 1.0, Temperatura = 1.0, dt = 0.001, m = 1.0, K = 1000.0;
+#ifdef FIXED
+static double F_cte = 1.0;
+#endif
+
+typedef struct {
+    double Ree, error_Ree, Rg, error_Rg;
+    double segundos;
+} Resultado;
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+static void configuracion_inicial(int N, double x[], double v[], double desplazamiento) {
+    for (int j = 0; j < N; j++) {
+        x[3*j] = desplazamiento; x[3*j+1] = 0.0; x[3*j+2] = j * L_0;
+        v[3*j] = v[3*j+1] = v[3*j+2] = 0.0;
+    }
+}
+
+static int crea(CadenaPrecision *c, TipoPrecision tipo, int N, double x[], double v[]) {
+    #ifdef FIXED
+    return crea_cadena_precision(c, tipo, N, x, v, dt, m, alfa, kb, Temperatura, K, F_cte);
+    #else
+    return crea_cadena_precision(c, tipo, N, x, v, dt, m, alfa, kb, Temperatura, K);
+    #endif
+}
+
+static int comprueba_doble(int N) {
+    double *x = malloc(3*N*sizeof(double)), *v = malloc(3*N*sizeof(double));
+    double *x_n = malloc(3*N*sizeof(double)), *v_n = malloc(3*N*sizeof(double));
+    double *F = malloc(3*N*sizeof(double)), *F_n = malloc(3*N*sizeof(double));
+    double *betta = malloc(3*N*sizeof(double)), *x_c = malloc(3*N*sizeof(double));
+    configuracion_inicial(N, x, v, 0.0);
+
+    CadenaPrecision c;
+    if (crea(&c, PRECISION_DOBLE, N, x, v)) return 0;
+    inicializa_PR(7);
+    avanza_cadena_precision(&c, PASOS_COMPROBACION);
+    posiciones_cadena_precision(&c, x_c);
+
+    double a = (1.0 - alfa * dt / (2.0 * m)) / (1.0 + alfa * dt / (2.0 * m));
+    double b = 1.0 / (1.0 + alfa * dt / (2.0 * m));
+    double sigma = sqrt(2 * alfa * Temperatura * kb * dt);
+    inicializa_PR(7);
+    #ifdef FIXED
+    Fuerza_verlet(N, x, F, K, F_cte);
+    #else
+    Fuerza_verlet(N, x, F, K);
+    #endif
+    for (int paso = 0; paso < PASOS_COMPROBACION; paso++) {
+        for (int i = 0; i < 3*N; i++) betta[i] = gaussian() * sigma;
+        #ifdef FIXED
+        un_paso_verlet(betta, b, a, N, x, x_n, v, v_n, F, F_n, dt, m, Fuerza_verlet, K, F_cte);
+        #else
+        un_paso_verlet(betta, b, a, N, x, x_n, v, v_n, F, F_n, dt, m, Fuerza_verlet, K);
+        #endif
+        memcpy(x, x_n, 3*N*sizeof(double));
+        memcpy(v, v_n, 3*N*sizeof(double));
+        memcpy(F, F_n, 3*N*sizeof(double));
+    }
+    int iguales = memcmp(x, x_c, 3*N*sizeof(double)) == 0;
+
+    libera_cadena_precision(&c);
+    free(x); free(v); free(x_n); free(v_n); free(F); free(F_n); free(betta); free(x_c);
+    return iguales;
+}
+
+static int mide(TipoPrecision tipo, int N, long pasos, double desplazamiento, int semilla, Resultado *r) {
+    double *x = malloc(3*N*sizeof(double)), *v = malloc(3*N*sizeof(double));
+    configuracion_inicial(N, x, v, desplazamiento);
+
+    CadenaPrecision c;
+    if (crea(&c, tipo, N, x, v)) {
+        free(x); free(v);
+        return 0;
+    }
+    inicializa_PR(semilla);
+    avanza_cadena_precision(&c, PASOS_EQUILIBRADO);
+
+    EstimadorBloques ree, rg;
+    memset(&ree, 0, sizeof(ree));
+    memset(&rg, 0, sizeof(rg));
+    r->segundos = 0.0;
+    for (long paso = 0; paso < pasos; paso += CADA) {
+        double t0 = segundos();
+        avanza_cadena_precision(&c, CADA);
+        r->segundos += segundos() - t0;
+
+        posiciones_cadena_precision(&c, x);
+        double d2 = 0.0;
+        for (int k = 0; k < 3; k++) {
+            double d = x[3*(N-1) + k] - x[k];
+            d2 += d*d;
+        }
+        anade_estimador_bloques(&ree, sqrt(d2));
+        anade_estimador_bloques(&rg, calcula_radio_giro(N, x));
+    }
+    r->Ree = media_estimador_bloques(&ree);
+    r->error_Ree = error_estimador_bloques(&ree);
+    r->Rg = media_estimador_bloques(&rg);
+    r->error_Rg = error_estimador_bloques(&rg);
+
+    libera_cadena_precision(&c);
+    free(x); free(v);
+    return 1;
+}
+
+static int coinciden(const Resultado *a, const Resultado *b) {
+    return fabs(a->Ree - b->Ree) <= SIGMAS * sqrt(a->error_Ree*a->error_Ree + b->error_Ree*b->error_Ree)
+        && fabs(a->Rg - b->Rg) <= SIGMAS * sqrt(a->error_Rg*a->error_Rg + b->error_Rg*b->error_Rg);
+}
+
+static void imprime(TipoPrecision tipo, const Resultado *r, const Resultado *doble, long pasos) {
+    printf("%-8s %9.5f %9.5f %9.5f %9.5f %9.1f %8.2f %10.5f",
+           nombre_precision(tipo), r->Ree, r->error_Ree, r->Rg, r->error_Rg,
+           1e9 * r->segundos / pasos, doble->segundos / r->segundos, r->error_Ree * sqrt(r->segundos));
+}
+
+int main(int argc, char *argv[]) {
+    long pasos = argc > 1 ? atol(argv[1]) : 1000000;
+    int N = argc > 2 ? atoi(argv[2]) : 16;
+    int fallos = 0;
+
+    // 1. Doble frente a un_paso_verlet
+    int ok = comprueba_doble(N);
+    printf("Precisión doble frente a un_paso_verlet (%d pasos): %s\n\n", PASOS_COMPROBACION, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 2. Mismos pasos en las tres precisiones
+    printf("N = %d, %ld pasos\n", N, pasos);
+    printf("%-8s %9s %9s %9s %9s %9s %8s %10s\n", "", "Ree", "error", "Rg", "error", "ns/paso", "speedup",
+           "err*sqrt(t)");
+    Resultado r[N_PRECISIONES];
+    for (int p = 0; p < N_PRECISIONES; p++) {
+        if (!mide((TipoPrecision)p, N, pasos, 0.0, 11 + p, &r[p])) {
+            printf("%-8s no disponible\n", nombre_precision((TipoPrecision)p));
+            if (p == PRECISION_DOBLE) return 1;
+            continue;
+        }
+        imprime((TipoPrecision)p, &r[p], &r[PRECISION_DOBLE], pasos);
+        if (p == PRECISION_DOBLE) {
+            printf("\n");
+            continue;
+        }
+        ok = coinciden(&r[p], &r[PRECISION_DOBLE]);
+        printf("  %s\n", ok ? "PASA" : "FALLA");
+        if (!ok) fallos++;
+    }
+
+    // 3. Lejos del origen
+    printf("\nCadena a %.0e del origen\n", DESPLAZAMIENTO);
+    Resultado lejos;
+    for (int p = PRECISION_SIMPLE; p < N_PRECISIONES; p++) {
+        if (!mide((TipoPrecision)p, N, pasos, DESPLAZAMIENTO, 21 + p, &lejos)) continue;
+        imprime((TipoPrecision)p, &lejos, &r[PRECISION_DOBLE], pasos);
+        ok = coinciden(&lejos, &r[PRECISION_DOBLE]);
+        if (p == PRECISION_SIMPLE) {
+            printf("  %s\n", ok ? "coincide" : "no coincide");
+            continue;
+        }
+        printf("  %s\n", ok ? "PASA" : "FALLA");
+        if (!ok) fallos++;
+    }
+
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "protocolos.h"
+#include "barrido.h"
+
+/*
+ * Test de los protocolos fuera del equilibrio (protocolos.c) con una cadena corta (FIXED).
+ * Con la partícula 0 fija y muelles rígidos la cadena es casi la freely-jointed chain, con
+ * DeltaG(0 -> F) = -kT (N-1) ln(sinh(f) / f), f = F L_0 / kT, y <Ree> la curva de Langevin.
+ *  1. Una rampa de fuerza 0 -> F_1: Jarzynski da DeltaG dentro de 4 errores (más una tolerancia
+ *     de 0.03 por los muelles), y <W> >= DeltaG (segunda ley).
+ *  2. Con la rampa inversa, Bennett / Crooks da el mismo DeltaG.
+ *  3. La <Ree> reponderada a lo largo de la rampa sigue la curva de Langevin.
+ *  4. Bennett con trabajos gaussianos que cumplen Crooks exactamente recupera DeltaG.
+ *  5. El resultado no depende del número de hilos (bit a bit).
+ *  6. Tirando con una trampa a velocidad constante, <W> >= DeltaG y DeltaG(t) crece con la trampa.
+ * Con WLCM solo se comprueba que los tirones se rechazan.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_protocolos.exe [tirones]
+ */
+
+#define N_CADENA 4
+#define K_MUELLE 1000.0
+#define SIGMAS 4.0
+#define TOLERANCIA_MUELLES 0.03
+
+#ifdef FIXED
+static double alfa = 0.5, kb = 1.0, Temperatura = 1.0, dt = 0.0003, m = 1.0;
+
+static double G_exacta(double F) {
+    double f = F * L_0 / (kb * Temperatura);
+    return -kb * Temperatura * (N_CADENA - 1) * log(sinh(f) / f);
+}
+
+static Tirones *tira(const Protocolo *p, int n_tirones, int n_hilos, int semilla) {
+    ParametrosTirones pt = {n_tirones, n_hilos, 20, 5.0};
+    inicializa_PR(semilla);
+    return ejecuta_tirones(p, &pt, kb, Temperatura, alfa, N_CADENA, dt, m, K_MUELLE);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+#ifndef FIXED
+    (void)argc;
+    (void)argv;
+    printf("Los protocolos necesitan FIXED\n");
+    return 0;
+#else
+    int n_tirones = argc > 1 ? atoi(argv[1]) : 128;
+    double beta = 1.0 / (kb * Temperatura);
+    double F_1 = 2.0;
+    int fallos = 0;
+
+    // 1. Rampa de ida
+    Protocolo rampa = {PROTOCOLO_RAMPA, 10.0, 0.0, F_1, 0.0, 0.0, 0.0, 0.0, 0.0, 0};
+#ifdef WLCM
+    // Con WLCM la flexión no tiene energía: no se tira
+    int rechazado = tira(&rampa, 4, 1, 21) == NULL;
+    printf("Con WLCM no hay tirones  %s\n", rechazado ? "PASA" : "FALLA");
+    return rechazado ? 0 : 1;
+#endif
+    clock_t t0 = clock();
+    Tirones *ida = tira(&rampa, n_tirones, 4, 21);
+    clock_t t1 = clock();
+    if (!ida) return 1;
+    EstimacionJarzynski e = jarzynski_en(ida, ida->n_puntos, beta);
+    double G = G_exacta(F_1);
+    int ok = fabs(e.G - G) <= SIGMAS * e.error + TOLERANCIA_MUELLES && e.W_medio >= e.G;
+    printf("Rampa 0 -> %.1f (%d tirones, %.2f s de CPU): DeltaG Jarzynski %.4f +- %.4f, cumulantes %.4f, "
+           "exacta %.4f, <W> %.4f, n_ef %.1f  %s\n", F_1, n_tirones, (double)(t1 - t0) / CLOCKS_PER_SEC,
+           e.G, e.error, e.G_cumulantes, G, e.W_medio, e.n_efectivo, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 2. Crooks con la rampa inversa
+    Protocolo inversa = rampa;
+    inversa.invertido = 1;
+    Tirones *vuelta = tira(&inversa, n_tirones / 2, 4, 22);
+    if (!vuelta) return 1;
+    double *W_ida = malloc(ida->n_tirones*sizeof(double));
+    double *W_vuelta = malloc(vuelta->n_tirones*sizeof(double));
+    for (int i = 0; i < ida->n_tirones; i++) W_ida[i] = ida->W[i*(ida->n_puntos + 1) + ida->n_puntos];
+    for (int i = 0; i < vuelta->n_tirones; i++) W_vuelta[i] = vuelta->W[i*(vuelta->n_puntos + 1) + vuelta->n_puntos];
+    double error_bar;
+    double G_bar = energia_libre_crooks(W_ida, ida->n_tirones, W_vuelta, vuelta->n_tirones, beta, &error_bar);
+    ok = fabs(G_bar - G) <= SIGMAS * error_bar + TOLERANCIA_MUELLES;
+    printf("Crooks (Bennett): DeltaG %.4f +- %.4f  %s\n", G_bar, error_bar, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 3. Curva fuerza-extensión reponderada
+    printf("\n%8s %10s %10s %10s %10s\n", "F", "Ree", "Langevin", "G", "exacta");
+    int lejos = 0;
+    for (int j = 1; j <= ida->n_puntos; j += 3) {
+        EstimacionJarzynski ej = jarzynski_en(ida, j, beta);
+        double F = ida->lambda[j];
+        printf("%8.3f %10.4f %10.4f %10.4f %10.4f\n", F, ej.Ree, ree_langevin(F, N_CADENA, kb, Temperatura),
+               ej.G, G_exacta(F));
+        if (fabs(ej.Ree - ree_langevin(F, N_CADENA, kb, Temperatura)) > 0.25) lejos++;
+    }
+    ok = lejos == 0;
+    printf("<Ree> reponderada frente a Langevin  %s\n", ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 4. Bennett con trabajos gaussianos: W_ida ~ N(G + beta s^2/2, s^2), W_vuelta ~ N(-G + beta s^2/2, s^2)
+    double G_modelo = 1.7, s = 1.5;
+    int n_modelo = 2000;
+    double *Wa = malloc(n_modelo*sizeof(double)), *Wb = malloc(n_modelo*sizeof(double));
+    for (int i = 0; i < n_modelo; i++) {
+        Wa[i] = G_modelo + 0.5 * beta * s * s + s * gaussian();
+        Wb[i] = -G_modelo + 0.5 * beta * s * s + s * gaussian();
+    }
+    double error_modelo;
+    double G_est = energia_libre_crooks(Wa, n_modelo, Wb, n_modelo / 2, beta, &error_modelo);
+    ok = fabs(G_est - G_modelo) <= SIGMAS * error_modelo && error_modelo < 0.1;
+    printf("\nBennett con trabajos gaussianos: %.4f +- %.4f (exacta %.4f)  %s\n", G_est, error_modelo, G_modelo,
+           ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 5. Independencia del número de hilos
+    Tirones *un_hilo = tira(&rampa, 8, 1, 23), *cuatro = tira(&rampa, 8, 4, 23);
+    ok = un_hilo && cuatro;
+    for (int i = 0; ok && i < 8 * (un_hilo->n_puntos + 1); i++) ok = un_hilo->W[i] == cuatro->W[i];
+    printf("1 hilo y 4 hilos, mismos trabajos  %s\n", ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 6. Trampa a velocidad constante
+    Protocolo trampa = {PROTOCOLO_VELOCIDAD, 10.0, 0.0, 0.0, 0.0, 0.0, 20.0, 0.0, 0.2, 0};
+    Tirones *tt = tira(&trampa, n_tirones / 2, 4, 24);
+    if (!tt) return 1;
+    EstimacionJarzynski ea = jarzynski_en(tt, tt->n_puntos / 2, beta), eb = jarzynski_en(tt, tt->n_puntos, beta);
+    ok = eb.W_medio >= eb.G && eb.G > ea.G && isfinite(eb.error);
+    printf("Trampa: DeltaG(%.2f) = %.4f, DeltaG(%.2f) = %.4f +- %.4f, <W> = %.4f  %s\n",
+           tt->lambda[tt->n_puntos / 2], ea.G, tt->lambda[tt->n_puntos], eb.G, eb.error, eb.W_medio,
+           ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    free(W_ida);
+    free(W_vuelta);
+    free(Wa);
+    free(Wb);
+    libera_tirones(ida);
+    libera_tirones(vuelta);
+    libera_tirones(un_hilo);
+    libera_tirones(cuatro);
+    libera_tirones(tt);
+    return fallos ? 1 : 0;
+#endif
+}
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "reponderacion.h"
+#include "random.h"
+
+/*
+ * Test de la reponderación MBAR (reponderacion.c) con un modelo exacto: si sin fuerza
+ * P_0(x) ~ exp(-x^2 / 2 sigma^2), con fuerza F la distribución es gaussiana con media
+ * beta F sigma^2. Así <x>(F) se conoce a cualquier fuerza.
+ *  1. Con muestras de cuatro fuerzas, <x>(F) en fuerzas intermedias coincide con la exacta
+ *     dentro de 4 errores, y los errores son del orden del real (ni 3 veces mayores ni menores).
+ *  2. Con muestras correlacionadas (AR(1)) la ineficiencia estadística g sale ~ (1+phi)/(1-phi).
+ *  3. Los histogramas en streaming dan el mismo resultado que las muestras.
+ *  4. Diagnósticos: las fuerzas vecinas solapan más que las alejadas, y una fuerza fuera del
+ *     rango simulado sale como no fiable.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_reponderacion.exe [muestras por estado]
+ */
+
+#define SIGMA_X 0.5
+#define N_ESTADOS 4
+#define SIGMAS 4.0
+#define PHI 0.9
+
+static const double F_simuladas[N_ESTADOS] = {0.0, 1.0, 2.0, 3.0};
+
+static double media_exacta(double F) {
+    return F * SIGMA_X * SIGMA_X;  // beta = 1
+}
+
+int main(int argc, char *argv[]) {
+    long long n = argc > 1 ? atoll(argv[1]) : 20000;
+    int fallos = 0;
+    inicializa_PR(4321);
+
+    Reponderacion *r = crea_reponderacion(1.0, 1.0);
+    Reponderacion *r_hist = crea_reponderacion(1.0, 1.0);
+    Reponderacion *r_corr = crea_reponderacion(1.0, 1.0);
+    double *x = malloc(n*sizeof(double));
+
+    for (int k = 0; k < N_ESTADOS; k++) {
+        double mu = media_exacta(F_simuladas[k]);
+        Histograma *h = crea_histograma_auto(400, 1e-4);
+        for (long long i = 0; i < n; i++) {
+            x[i] = mu + SIGMA_X * gaussian();
+            anade_histograma(h, x[i]);
+        }
+        anade_estado_muestras(r, F_simuladas[k], x, n);
+        anade_estado_histograma(r_hist, F_simuladas[k], h);
+        libera_histograma(h);
+
+        // Serie AR(1) con la misma distribución estacionaria
+        x[0] = mu + SIGMA_X * gaussian();
+        for (long long i = 1; i < n; i++)
+            x[i] = mu + PHI * (x[i-1] - mu) + SIGMA_X * sqrt(1.0 - PHI*PHI) * gaussian();
+        anade_estado_muestras(r_corr, F_simuladas[k], x, n);
+    }
+
+    clock_t t0 = clock();
+    int it = resuelve_reponderacion(r, 1e-9, 10000);
+    clock_t t1 = clock();
+    resuelve_reponderacion(r_hist, 1e-9, 10000);
+    resuelve_reponderacion(r_corr, 1e-9, 10000);
+    printf("%d estados x %lld muestras: %d iteraciones en %.3f s\n", N_ESTADOS, n, it,
+           (double)(t1 - t0) / CLOCKS_PER_SEC);
+    if (it < 0) fallos++;
+
+    // 1. Fuerzas intermedias
+    printf("\n%8s %10s %10s %10s %10s %10s\n", "F", "exacta", "MBAR", "error", "histograma", "n_ef");
+    double F_prueba[5] = {0.25, 0.5, 1.5, 2.2, 2.75};
+    double chi2 = 0.0;
+    for (int i = 0; i < 5; i++) {
+        PuntoReponderado p = reponderacion_en(r, F_prueba[i]);
+        PuntoReponderado q = reponderacion_en(r_hist, F_prueba[i]);
+        double exacta = media_exacta(F_prueba[i]);
+        int ok = fabs(p.Ree - exacta) <= SIGMAS * p.error && p.fiable
+              && fabs(q.Ree - p.Ree) <= SIGMAS * p.error;
+        chi2 += (p.Ree - exacta) * (p.Ree - exacta) / (p.error * p.error);
+        printf("%8.3f %10.6f %10.6f %10.6f %10.6f %10.0f %s\n", F_prueba[i], exacta, p.Ree, p.error,
+               q.Ree, p.n_efectivo, ok ? "PASA" : "FALLA");
+        if (!ok) fallos++;
+    }
+    // El error estimado debe ser del orden del real: chi^2 / 5 ni muy grande ni muy pequeño
+    int ok = chi2 / 5 < 9.0 && chi2 / 5 > 1.0 / 9.0;
+    printf("chi^2 / puntos = %.2f  %s\n", chi2 / 5, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 2. Ineficiencia estadística de las series correlacionadas
+    double g_esperada = (1.0 + PHI) / (1.0 - PHI);
+    ok = fabs(r_corr->g[0] - g_esperada) < 0.35 * g_esperada && fabs(r->g[0] - 1.0) < 0.5;
+    printf("\nIneficiencia: independientes g = %.2f, AR(1) g = %.2f (esperada %.1f)  %s\n",
+           r->g[0], r_corr->g[0], g_esperada, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+    PuntoReponderado p = reponderacion_en(r, 1.5), pc = reponderacion_en(r_corr, 1.5);
+    ok = pc.error > 2.0 * p.error;
+    printf("Error a F = 1.5: independientes %.5f, correlacionadas %.5f  %s\n", p.error, pc.error, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // 4. Diagnósticos de solapamiento
+    double O_01 = solapamiento_estados(r, 0, 1), O_03 = solapamiento_estados(r, 0, 3);
+    PuntoReponderado lejos = reponderacion_en(r, 40.0);
+    ok = O_01 > 0.05 && O_03 < O_01 && !lejos.fiable;
+    printf("Solapamiento F=0/F=1: %.4f, F=0/F=3: %.2e; F = 40: n_ef = %.1f fiable %d  %s\n",
+           O_01, O_03, lejos.n_efectivo, lejos.fiable, ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    free(x);
+    libera_reponderacion(r);
+    libera_reponderacion(r_hist);
+    libera_reponderacion(r_corr);
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+#include "simulacion.h"
+#include "reponderacion.h"
+#include "salud.h"
+
+/*
+ * Test de la vigilancia de la estabilidad numérica (salud.c).
+ *  1. Una simulación con dt razonable sigue sana y sus temperaturas medias son del orden de
+ *     Temperatura; con muelles blandos y F_cte los enlaces largos no se toman por rotos. Con WLCM
+ *     solo se comprueba que no se corta.
+ *  2. Con dt demasiado grande para K la trayectoria se detecta como inestable en las primeras
+ *     revisiones, con un diagnóstico.
+ *  3. Un NaN en las velocidades se detecta y el diagnóstico dice en qué partícula.
+ *  4. verlet_trayectoria corta la trayectoria inestable con una línea "# INESTABLE ..." y
+ *     lee_ree_trayectoria la salta.
+ *  5. Coste de una revisión frente a un paso.
+ * Los ficheros se crean en el directorio actual y se borran al terminar.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_salud.exe
+ */
+
+#define RUTA_TXT "prueba_salud.txt"
+
+// La flexión de WLCM no deriva de una energía: la cadena no se termaliza a Temperatura y sus
+// enlaces no siguen la distribución armónica, así que esas comprobaciones solo valen sin ella
+#ifndef WLCM
+#define CADENA_EN_EQUILIBRIO
+#endif
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+// Sigue 'revisiones' salidas de 'cada' pasos; devuelve la revisión en la que dejó de estar bien (0 si no)
+static long sigue_simulacion(double dt, double K, double F_cte, long revisiones, long cada, SaludSimulacion *salud) {
+    ConfiguracionSimulacion c = configuracion_simulacion_defecto();
+    c.dt = dt;
+    c.K = K;
+    c.F_cte = F_cte;
+    Simulacion *s = crea_simulacion(&c, NULL);
+    if (!s) return -1;
+    #ifdef FIXED
+    inicializa_salud(salud, c.N, c.K, c.kb, c.Temperatura, c.m, c.dt, c.F_cte);
+    #else
+    inicializa_salud(salud, c.N, c.K, c.kb, c.Temperatura, c.m, c.dt);
+    #endif
+    long primera = 0;
+    for (long r = 1; r <= revisiones; r++) {
+        avanza_simulacion(s, cada);
+        if (revisa_salud_simulacion(s, salud) == SALUD_INESTABLE) {
+            primera = r;
+            break;
+        }
+    }
+    destruye_simulacion(s);
+    return primera;
+}
+
+static int estable(void) {
+    SaludSimulacion salud;
+    long cortada = sigue_simulacion(0.0003, 1000.0, 0.0, 300, 1000, &salud);
+    double T_cin = temperatura_cinetica_salud(&salud), T_conf = temperatura_configuracional_salud(&salud);
+    int ok = cortada == 0 && salud.estiramiento_maximo < ESTIRAMIENTO_MAXIMO;
+    #ifdef CADENA_EN_EQUILIBRIO
+    ok = ok && salud.estado == SALUD_BIEN;
+    #endif
+    printf("dt = 0.0003: T cinética %.3f, configuracional %.3f, enlace máximo %.3f L_0  %s\n", T_cin, T_conf,
+           salud.estiramiento_maximo, ok ? "PASA" : "FALLA");
+    if (salud.estado != SALUD_BIEN) printf("  %s\n", salud.diagnostico);
+
+    #ifdef CADENA_EN_EQUILIBRIO
+    SaludSimulacion blando;
+    int ok_blando = sigue_simulacion(0.001, 10.0, 2.0, 2000, 1000, &blando) == 0;
+    printf("K = 10, F_cte = 2: enlace máximo %.3f L_0 (límite %.3f)  %s\n", blando.estiramiento_maximo,
+           blando.enlace_limite / L_0, ok_blando ? "PASA" : "FALLA");
+    if (!ok_blando) printf("  %s\n", blando.diagnostico);
+    return ok && ok_blando;
+    #else
+    return ok;
+    #endif
+}
+
+static int explota(void) {
+    SaludSimulacion salud;
+    long cortada = sigue_simulacion(0.1, 1000.0, 0.0, 1000, 10, &salud);
+    int ok = cortada > 0 && cortada <= 20 && salud.estado == SALUD_INESTABLE && strstr(salud.diagnostico, "dt = 0.1");
+    printf("dt = 0.1: inestable en la revisión %ld  %s\n  %s\n", cortada, ok ? "PASA" : "FALLA", salud.diagnostico);
+    return ok;
+}
+
+static int detecta_nan(void) {
+    int N = 8;
+    double x[24], v[24], F[24];
+    for (int i = 0; i < 3*N; i++) {
+        x[i] = i % 3 == 0 ? (i / 3) * L_0 : 0.0;
+        v[i] = 0.1;
+        F[i] = 0.0;
+    }
+    SaludSimulacion salud;
+    #ifdef FIXED
+    inicializa_salud(&salud, N, 100.0, 1.0, 1.0, 1.0, 0.001, 0.0);
+    #else
+    inicializa_salud(&salud, N, 100.0, 1.0, 1.0, 1.0, 0.001);
+    #endif
+    int bien = revisa_salud(&salud, 0.0, x, v, F) == SALUD_BIEN;
+    v[3*5 + 1] = NAN;
+    int ok = bien && revisa_salud(&salud, 0.1, x, v, F) == SALUD_INESTABLE && strstr(salud.diagnostico, "partícula 5")
+             && revisa_salud(&salud, 0.2, x, v, F) == SALUD_INESTABLE;
+    printf("NaN en la velocidad detectado  %s\n  %s\n", ok ? "PASA" : "FALLA", salud.diagnostico);
+    return ok;
+}
+
+#ifdef SALUD
+// Borra lo que verlet_trayectoria deja en <carpeta>/*_prueba_salud.txt
+static void borra_auxiliares(const char *carpeta) {
+    DIR *d = opendir(carpeta);
+    if (!d) return;
+    struct dirent *e;
+    char ruta[512];
+    while ((e = readdir(d))) {
+        if (!strstr(e->d_name, "_" RUTA_TXT)) continue;
+        snprintf(ruta, sizeof(ruta), "%s/%s", carpeta, e->d_name);
+        remove(ruta);
+    }
+    closedir(d);
+    remove(carpeta);  // Solo si ha quedado vacía
+}
+
+static int corta_trayectoria(void) {
+    int N = 4, pasos = 1000000;
+    double x_0[12], v_0[12];
+    for (int i = 0; i < N; i++) {
+        x_0[3*i] = 0.0; x_0[3*i+1] = 0.0; x_0[3*i+2] = i;
+        v_0[3*i] = v_0[3*i+1] = v_0[3*i+2] = 0.0;
+    }
+    inicializa_PR(5);
+    double t0 = segundos();
+    #ifdef FIXED
+    verlet_trayectoria("prueba", 1.0, 1.0, 0.5, N, 0.05, 1.0, pasos, Fuerza_verlet, RUTA_TXT, x_0, v_0, 1000.0, 1.0);
+    #else
+    verlet_trayectoria("prueba", 1.0, 1.0, 0.5, N, 0.05, 1.0, pasos, Fuerza_verlet, RUTA_TXT, x_0, v_0, 1000.0);
+    #endif
+    double tiempo = segundos() - t0;
+
+    FILE *f = fopen(RUTA_TXT, "r");
+    if (!f) return 0;
+    char linea[1024];
+    long lineas = 0, comentarios = 0;
+    while (fgets(linea, sizeof(linea), f)) {
+        lineas++;
+        if (strncmp(linea, "# INESTABLE", 11) == 0) comentarios++;
+    }
+    fclose(f);
+    long long n;
+    double *ree = lee_ree_trayectoria(RUTA_TXT, 0, &n);
+    int finitos = ree != NULL;
+    for (long long k = 0; ree && k < n; k++) finitos &= isfinite(ree[k]);
+    free(ree);
+    // Cabecera, n salidas y la línea de la inestabilidad
+    int ok = comentarios == 1 && lineas < 100 && n == lineas - 2 && finitos;
+    printf("verlet_trayectoria cortada tras %ld líneas (%.3f s), lee_ree_trayectoria salta el comentario  %s\n",
+           lineas, tiempo, ok ? "PASA" : "FALLA");
+    remove(RUTA_TXT);
+    borra_auxiliares("DISTRIBUCIONES");
+    borra_auxiliares("CORRELACIONES");
+    borra_auxiliares("ESTIMADORES");
+    borra_auxiliares("FORMA");
+    return ok;
+}
+#endif
+
+static void coste(void) {
+    int N = 1000, repeticiones = 2000;
+    double *x = malloc(3*N*sizeof(double)), *v = malloc(3*N*sizeof(double)), *F = malloc(3*N*sizeof(double));
+    double *betta = malloc(3*N*sizeof(double)), *x2 = malloc(3*N*sizeof(double)), *v2 = malloc(3*N*sizeof(double));
+    double *F2 = malloc(3*N*sizeof(double));
+    for (int i = 0; i < 3*N; i++) {
+        x[i] = i % 3 == 0 ? (i / 3) * L_0 : 0.0;
+        v[i] = 0.01 * sin(i);
+        betta[i] = 0.0;
+    }
+    #ifdef FIXED
+    Fuerza_verlet(N, x, F, 100.0, 1.0);
+    #else
+    Fuerza_verlet(N, x, F, 100.0);
+    #endif
+    SaludSimulacion salud;
+    #ifdef FIXED
+    inicializa_salud(&salud, N, 100.0, 1.0, 1.0, 1.0, 0.001, 1.0);
+    #else
+    inicializa_salud(&salud, N, 100.0, 1.0, 1.0, 1.0, 0.001);
+    #endif
+    double t0 = segundos();
+    for (int r = 0; r < repeticiones; r++) revisa_salud(&salud, r, x, v, F);
+    double revision = (segundos() - t0) / repeticiones;
+    t0 = segundos();
+    for (int r = 0; r < repeticiones; r++) {
+        #ifdef FIXED
+        un_paso_verlet(betta, 1.0, 1.0, N, x, x2, v, v2, F, F2, 0.001, 1.0, Fuerza_verlet, 100.0, 1.0);
+        #else
+        un_paso_verlet(betta, 1.0, 1.0, N, x, x2, v, v2, F, F2, 0.001, 1.0, Fuerza_verlet, 100.0);
+        #endif
+    }
+    double paso = (segundos() - t0) / repeticiones;
+    printf("N = %d: revisión %.2f us, paso %.2f us (una revisión cada 100 pasos: %.2f %% más)\n", N, 1e6 * revision,
+           1e6 * paso, 100.0 * revision / (100.0 * paso));
+    free(x); free(v); free(F); free(betta); free(x2); free(v2); free(F2);
+}
+
+int main(void) {
+    int fallos = 0;
+    setenv("TELEMETRIA_CADENA", "prueba_salud_telemetria", 1);
+    if (!estable()) fallos++;
+    if (!explota()) fallos++;
+    if (!detecta_nan()) fallos++;
+    #ifdef SALUD
+    if (!corta_trayectoria()) fallos++;
+    #else
+    printf("verlet_trayectoria solo se corta con SALUD definido: no se comprueba\n");
+    #endif
+    coste();
+    remove("prueba_salud_telemetria");
+    return fallos ? 1 : 0;
+}
@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "simulacion.h"
+
+/*
+ * Test de la API embebible (simulacion.c).
+ *  1. Con la misma semilla reproduce bit a bit el bucle de un_paso_verlet con el generador global
+ *     (con RUIDO_CONTADOR, con el ruido por contador sacado de él).
+ *  2. Dos simulaciones avanzadas intercaladas dan lo mismo que por separado.
+ *  3. Con memoria de quien llama da lo mismo que con memoria propia.
+ *  4. Muchas simulaciones repartidas en hilos dan lo mismo que en serie.
+ *  5. Las configuraciones no válidas se rechazan.
+ *  6. Simulaciones cortas por segundo dentro del proceso.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_simulacion.exe [simulaciones]
+ */
+
+#define PASOS 500
+#define N_HILOS_PRUEBA 4
+#define SIMULACIONES_HILOS 64
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+static ConfiguracionSimulacion configuracion(int semilla) {
+    ConfiguracionSimulacion c = configuracion_simulacion_defecto();
+    c.N = 6;
+    c.F_cte = 0.5;
+    c.semilla = semilla;
+    return c;
+}
+
+static int reproduce_un_paso_verlet(void) {
+    ConfiguracionSimulacion c = configuracion(31);
+    Simulacion *s = crea_simulacion(&c, NULL);
+    if (!s) return 0;
+    avanza_simulacion(s, PASOS);
+    int n = 3*c.N;
+    double x_s[18], v_s[18];
+    estado_simulacion(s, x_s, v_s);
+    destruye_simulacion(s);
+
+    double x[18], v[18], F[18], x_n[18], v_n[18], F_n[18], betta[18];
+    for (int j = 0; j < c.N; j++) {
+        x[3*j] = j * L_0; x[3*j+1] = x[3*j+2] = 0.0;
+        v[3*j] = v[3*j+1] = v[3*j+2] = 0.0;
+    }
+    double a = (1.0 - c.alfa * c.dt / (2.0 * c.m)) / (1.0 + c.alfa * c.dt / (2.0 * c.m));
+    double b = 1.0 / (1.0 + c.alfa * c.dt / (2.0 * c.m));
+    double sigma = sqrt(2 * c.alfa * c.Temperatura * c.kb * c.dt);
+    inicializa_PR(c.semilla);
+    #ifdef RUIDO_CONTADOR
+    RuidoContador ruido;
+    inicializa_ruido_contador_desde(&ruido, &estado_PR_global, 0);
+    #endif
+    #ifdef FIXED
+    Fuerza_verlet(c.N, x, F, c.K, c.F_cte);
+    #else
+    Fuerza_verlet(c.N, x, F, c.K);
+    #endif
+    for (int p = 0; p < PASOS; p++) {
+        #ifdef RUIDO_CONTADOR
+        gaussianas_contador(&ruido, 0, n, sigma, betta);
+        ruido.paso++;
+        #else
+        for (int i = 0; i < n; i++) betta[i] = gaussian() * sigma;
+        #endif
+        #ifdef FIXED
+        un_paso_verlet(betta, b, a, c.N, x, x_n, v, v_n, F, F_n, c.dt, c.m, Fuerza_verlet, c.K, c.F_cte);
+        #else
+        un_paso_verlet(betta, b, a, c.N, x, x_n, v, v_n, F, F_n, c.dt, c.m, Fuerza_verlet, c.K);
+        #endif
+        memcpy(x, x_n, sizeof(x));
+        memcpy(v, v_n, sizeof(v));
+        memcpy(F, F_n, sizeof(F));
+    }
+    return memcmp(x, x_s, n*sizeof(double)) == 0 && memcmp(v, v_s, n*sizeof(double)) == 0;
+}
+
+// Posiciones finales de la simulación con la semilla dada
+static void corre(int semilla, void *memoria, double x[]) {
+    ConfiguracionSimulacion c = configuracion(semilla);
+    Simulacion *s = crea_simulacion(&c, memoria);
+    avanza_simulacion(s, PASOS);
+    estado_simulacion(s, x, NULL);
+    destruye_simulacion(s);
+}
+
+static int intercaladas(void) {
+    ConfiguracionSimulacion ca = configuracion(1), cb = configuracion(2);
+    Simulacion *a = crea_simulacion(&ca, NULL), *b = crea_simulacion(&cb, NULL);
+    for (int k = 0; k < 10; k++) {
+        avanza_simulacion(a, PASOS / 10);
+        avanza_simulacion(b, PASOS / 10);
+    }
+    double xa[18], xb[18], ya[18], yb[18];
+    estado_simulacion(a, xa, NULL);
+    estado_simulacion(b, xb, NULL);
+    destruye_simulacion(a);
+    destruye_simulacion(b);
+    corre(1, NULL, ya);
+    corre(2, NULL, yb);
+    return memcmp(xa, ya, sizeof(xa)) == 0 && memcmp(xb, yb, sizeof(xb)) == 0;
+}
+
+static int memoria_ajena(void) {
+    double *bloque = malloc(tam_simulacion(6));
+    double x[18], y[18];
+    corre(3, bloque, x);
+    corre(3, NULL, y);
+    free(bloque);
+    return memcmp(x, y, sizeof(x)) == 0;
+}
+
+typedef struct {
+    int primera, cuantas;
+    double *finales;
+} TrabajoHilo;
+
+static void *trabajo(void *arg) {
+    TrabajoHilo *t = arg;
+    for (int k = t->primera; k < t->primera + t->cuantas; k++) corre(100 + k, NULL, &t->finales[18*k]);
+    return NULL;
+}
+
+static int en_hilos(void) {
+    double *en_serie = malloc(SIMULACIONES_HILOS * 18 * sizeof(double));
+    double *paralelo = malloc(SIMULACIONES_HILOS * 18 * sizeof(double));
+    for (int k = 0; k < SIMULACIONES_HILOS; k++) corre(100 + k, NULL, &en_serie[18*k]);
+    pthread_t hilos[N_HILOS_PRUEBA];
+    TrabajoHilo t[N_HILOS_PRUEBA];
+    for (int h = 0; h < N_HILOS_PRUEBA; h++) {
+        t[h].primera = h * SIMULACIONES_HILOS / N_HILOS_PRUEBA;
+        t[h].cuantas = SIMULACIONES_HILOS / N_HILOS_PRUEBA;
+        t[h].finales = paralelo;
+        pthread_create(&hilos[h], NULL, trabajo, &t[h]);
+    }
+    for (int h = 0; h < N_HILOS_PRUEBA; h++) pthread_join(hilos[h], NULL);
+    int ok = memcmp(en_serie, paralelo, SIMULACIONES_HILOS * 18 * sizeof(double)) == 0;
+    free(en_serie);
+    free(paralelo);
+    return ok;
+}
+
+static int rechaza_invalidas(void) {
+    ConfiguracionSimulacion c = configuracion(1);
+    c.N = 1;
+    int ok = crea_simulacion(&c, NULL) == NULL;
+    c = configuracion(1);
+    c.dt = 0.0;
+    ok = ok && crea_simulacion(&c, NULL) == NULL;
+    c = configuracion(1);
+    Simulacion *s = crea_simulacion(&c, NULL);
+    c.N = 8;
+    ok = ok && configura_simulacion(s, &c) == 1;
+    c.N = 6;
+    c.Temperatura = 2.0;
+    ok = ok && configura_simulacion(s, &c) == 0;
+    destruye_simulacion(s);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int simulaciones = argc > 1 ? atoi(argv[1]) : 2000;
+    int fallos = 0, ok;
+
+    ok = reproduce_un_paso_verlet();
+    printf("Bit a bit igual que un_paso_verlet  %s\n", ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    ok = intercaladas();
+    printf("Intercaladas igual que por separado  %s\n", ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    ok = memoria_ajena();
+    printf("Memoria de quien llama  %s\n", ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    ok = en_hilos();
+    printf("%d simulaciones en %d hilos igual que en serie  %s\n", SIMULACIONES_HILOS, N_HILOS_PRUEBA,
+           ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    printf("Configuraciones no válidas (se esperan mensajes):\n");
+    ok = rechaza_invalidas();
+    printf("Configuraciones no válidas rechazadas  %s\n", ok ? "PASA" : "FALLA");
+    if (!ok) fallos++;
+
+    // Muchas simulaciones cortas reutilizando el mismo bloque de memoria
+    ConfiguracionSimulacion c = configuracion(1);
+    void *bloque = malloc(tam_simulacion(c.N));
+    double t0 = segundos(), suma = 0.0;
+    ObservablesSimulacion o;
+    for (int k = 0; k < simulaciones; k++) {
+        c.semilla = 1000 + k;
+        Simulacion *s = crea_simulacion(&c, bloque);
+        avanza_simulacion(s, 1000);
+        observa_simulacion(s, &o);
+        suma += o.Ree;
+        destruye_simulacion(s);
+    }
+    double t = segundos() - t0;
+    printf("%d simulaciones de 1000 pasos (N = %d): %.3f s, %.1f us por simulación (<Ree> final %.4f)\n",
+           simulaciones, c.N, t, 1e6 * t / simulaciones, suma / simulaciones);
+    free(bloque);
+
+    return fallos ? 1 : 0;
+}
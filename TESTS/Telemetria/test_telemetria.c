@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <dirent.h>
+#include "telemetria.h"
+#include "simulacion.h"
+
+/*
+ * Test de la telemetría en vivo (telemetria.c).
+ *  1. Lo publicado se lee igual con lee_telemetria, y al cerrar el .tel y la carpeta desaparecen.
+ *  2. Un lector que lee sin parar mientras otro hilo publica nunca ve un registro a medias.
+ *  3. Un fichero que no es un .tel se rechaza.
+ *  4. Coste de publicar frente al de los PASOS_TELEMETRIA pasos que hay entre publicaciones.
+ * La carpeta de telemetría es CARPETA_PRUEBA en el directorio actual (TELEMETRIA_CADENA).
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_telemetria.exe [publicaciones] (y una décima parte de lecturas concurrentes)
+ */
+
+#define CARPETA_PRUEBA "prueba_telemetria"
+#define N_PRUEBA 16
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+// Ruta del único .tel de la carpeta de prueba (0 si no hay)
+static int busca_tel(char *ruta, size_t tam) {
+    DIR *d = opendir(CARPETA_PRUEBA);
+    if (!d) return 0;
+    struct dirent *e;
+    int encontrados = 0;
+    while ((e = readdir(d))) {
+        size_t n = strlen(e->d_name);
+        if (n < 4 || strcmp(e->d_name + n - 4, ".tel") != 0) continue;
+        snprintf(ruta, tam, "%s/%s", CARPETA_PRUEBA, e->d_name);
+        encontrados++;
+    }
+    closedir(d);
+    return encontrados == 1;
+}
+
+static int ida_y_vuelta(void) {
+    Telemetria *t = abre_telemetria("RESULTADOS/trayectoria_prueba.txt", N_PRUEBA, 0.001, 100000);
+    char ruta[512];
+    if (!t || !busca_tel(ruta, sizeof(ruta))) return 0;
+    acumula_telemetria(t, 1.0, 2.0, 3.0);
+    acumula_telemetria(t, 3.0, 4.0, 5.0);
+    publica_telemetria(t, PASOS_TELEMETRIA - 1, 10);    // Aún no toca
+    RegistroTelemetria r;
+    int ok = lee_telemetria(ruta, &r) && r.paso == 0 && r.N == N_PRUEBA && r.pasos_totales == 100000;
+    publica_telemetria(t, PASOS_TELEMETRIA, 1234);
+    ok = ok && lee_telemetria(ruta, &r) && r.paso == PASOS_TELEMETRIA && r.bytes_salida == 1234
+         && r.muestras == 2 && r.media_Ek == 2.0 && r.media_Ep == 3.0 && r.media_Ree == 4.0
+         && r.pasos_por_segundo > 0.0 && strcmp(r.nombre, "trayectoria_prueba.txt") == 0 && !r.terminado;
+    cierra_telemetria(t);
+    DIR *d = opendir(CARPETA_PRUEBA);
+    int borrado = !lee_telemetria(ruta, &r) && d == NULL;
+    if (d) closedir(d);
+    printf("Publicado y leído igual, y borrado al cerrar  %s\n", ok && borrado ? "PASA" : "FALLA");
+    return ok && borrado;
+}
+
+typedef struct {
+    Telemetria *t;
+    volatile int parar;
+    long publicaciones;
+} Escritor;
+
+// Cada publicación k: una salida con Ek = k, paso = k*PASOS_TELEMETRIA y bytes = 3*paso
+static void *escribe(void *arg) {
+    Escritor *e = arg;
+    long k;
+    for (k = 1; !e->parar; k++) {
+        acumula_telemetria(e->t, (double)k, 0.0, 0.0);
+        publica_telemetria(e->t, k*PASOS_TELEMETRIA, 3*k*PASOS_TELEMETRIA);
+    }
+    e->publicaciones = k - 1;
+    return NULL;
+}
+
+static int concurrente(long lecturas_pedidas) {
+    Escritor e = {abre_telemetria("concurrente", N_PRUEBA, 0.001, 1L << 40), 0, 0};
+    char ruta[512];
+    if (!e.t || !busca_tel(ruta, sizeof(ruta))) return 0;
+    pthread_t hilo;
+    pthread_create(&hilo, NULL, escribe, &e);
+    long lecturas = 0, incoherentes = 0, distintas = 0;
+    int64_t ultimo = -1;
+    RegistroTelemetria r;
+    while (lecturas < lecturas_pedidas) {
+        if (!lee_telemetria(ruta, &r)) continue;
+        lecturas++;
+        int64_t k = r.paso / PASOS_TELEMETRIA;
+        // Media de 1..k = (k+1)/2
+        if (k > 0 && (r.paso % PASOS_TELEMETRIA || r.bytes_salida != 3*r.paso || r.muestras != k
+                      || r.media_Ek != 0.5*(k + 1))) incoherentes++;
+        if (r.paso < ultimo) incoherentes++;
+        if (r.paso != ultimo) distintas++;
+        ultimo = r.paso;
+    }
+    e.parar = 1;
+    pthread_join(hilo, NULL);
+    cierra_telemetria(e.t);
+    int ok = incoherentes == 0 && lecturas > 0;
+    printf("%ld publicaciones, %ld lecturas concurrentes (%ld estados distintos), %ld incoherentes  %s\n",
+           e.publicaciones, lecturas, distintas, incoherentes, ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+static int rechaza_otros(void) {
+    FILE *f = fopen("prueba_telemetria.tel", "wb");
+    if (!f) return 0;
+    for (int i = 0; i < 64; i++) fprintf(f, "%.6f\n", i * 0.1);
+    fclose(f);
+    RegistroTelemetria r;
+    int ok = !lee_telemetria("prueba_telemetria.tel", &r) && !lee_telemetria("no_existe.tel", &r);
+    remove("prueba_telemetria.tel");
+    printf("Se rechazan un fichero que no es .tel y uno que no existe  %s\n", ok ? "PASA" : "FALLA");
+    return ok;
+}
+
+static void coste(long publicaciones) {
+    Telemetria *t = abre_telemetria("coste", N_PRUEBA, 0.001, publicaciones*PASOS_TELEMETRIA);
+    if (!t) return;
+    double t0 = segundos();
+    for (long k = 1; k <= publicaciones; k++) {
+        acumula_telemetria(t, 1.0, 2.0, 3.0);
+        publica_telemetria(t, k*PASOS_TELEMETRIA, k);
+    }
+    double por_publicacion = (segundos() - t0) / publicaciones;
+    cierra_telemetria(t);
+
+    ConfiguracionSimulacion c = configuracion_simulacion_defecto();
+    c.N = N_PRUEBA;
+    Simulacion *s = crea_simulacion(&c, NULL);
+    t0 = segundos();
+    avanza_simulacion(s, PASOS_TELEMETRIA);
+    double por_bloque = segundos() - t0;
+    destruye_simulacion(s);
+    printf("Publicar: %.2f us; %d pasos con N = %d: %.2f ms; sobrecoste %.4f%%\n", 1e6 * por_publicacion,
+           PASOS_TELEMETRIA, N_PRUEBA, 1e3 * por_bloque, 100.0 * por_publicacion / por_bloque);
+}
+
+int main(int argc, char *argv[]) {
+    long publicaciones = argc > 1 ? atol(argv[1]) : 200000;
+    int fallos = 0;
+    setenv("TELEMETRIA_CADENA", CARPETA_PRUEBA, 1);
+
+    if (!ida_y_vuelta()) fallos++;
+    if (!concurrente(publicaciones / 10)) fallos++;
+    if (!rechaza_otros()) fallos++;
+    coste(publicaciones);
+    return fallos ? 1 : 0;
+}
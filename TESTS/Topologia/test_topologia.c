@@ -0,0 +1,374 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+#include "topologia.h"
+
+/*
+ * Test de la topología general de enlaces (topologia.c).
+ *  1. La cadena lineal da las mismas fuerzas que Fuerza_verlet (con FIXED, WLCM o sin nada), tanto
+ *     por el bucle contiguo como por el coloreado (la misma cadena con los enlaces al revés).
+ *  2. En anillos, estrellas, cepillos y varias cadenas ningún color repite partícula, el número de
+ *     colores es el esperado y las moléculas y los vecinos salen bien.
+ *  3. Con K y L distintos en cada enlace las fuerzas son menos el gradiente de Energia_topologia
+ *     (diferencias finitas) y, sin partículas fijas ni tiradas, suman cero (también con ángulos).
+ *  4. Varias cadenas: cada una da las fuerzas y el radio de giro de Fuerza_verlet y
+ *     calcula_radio_giro sobre sus partículas.
+ *  5. Un anillo integrado con un_paso_verlet y Fuerza_verlet_topologia sigue cerrado: el enlace de
+ *     cierre mide de media lo mismo que los demás.
+ *  6. Coste por partícula de la cadena lineal frente a Fuerza_verlet: el bucle contiguo no puede
+ *     costar más de FACTOR_MAXIMO veces lo mismo.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_topologia.exe
+ */
+
+#define K_PRUEBA 100.0
+#define F_PRUEBA 1.5
+#define TOLERANCIA 1e-10
+#define FACTOR_MAXIMO 1.5
+#define RONDAS 5
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+// Cadena casi recta a lo largo de z con ruido 'ruido' en cada coordenada
+static void cadena_ruidosa(int N, double x[], double ruido, EstadoPR *g) {
+    for (int i = 0; i < N; i++) {
+        x[3*i]     = ruido * (2.0*fran_r(g) - 1.0);
+        x[3*i + 1] = ruido * (2.0*fran_r(g) - 1.0);
+        x[3*i + 2] = i * L_0 + ruido * (2.0*fran_r(g) - 1.0);
+    }
+}
+
+// Posiciones al azar en un cubo de lado 3N (enlaces estirados y comprimidos)
+static void nube(int N, double x[], EstadoPR *g) {
+    for (int i = 0; i < 3*N; i++) x[i] = 3.0 * N * (fran_r(g) - 0.5);
+}
+
+static double diferencia_maxima(int n, const double a[], const double b[]) {
+    double d = 0.0;
+    for (int i = 0; i < n; i++)
+        if (fabs(a[i] - b[i]) > d) d = fabs(a[i] - b[i]);
+    return d;
+}
+
+static void fuerza_cadena(int N, double x[], double F[]) {
+    #ifdef FIXED
+    Fuerza_verlet(N, x, F, K_PRUEBA, F_PRUEBA);
+    #else
+    Fuerza_verlet(N, x, F, K_PRUEBA);
+    #endif
+}
+
+// La lineal con los enlaces (y ángulos) en orden inverso: mismas fuerzas por el camino coloreado
+static Topologia *lineal_al_reves(int N) {
+    Topologia *t = crea_topologia(N);
+    for (int b = N - 2; b >= 0; b--) anade_enlace_topologia(t, b + 1, b, K_PRUEBA, L_0);
+    #ifdef WLCM
+    asegura_flexion();
+    for (int i = N - 2; i >= 1; i--)
+        anade_angulo_topologia(t, i - 1, i, i + 1, rigidez_flexion(i), acos(parametros_flexion.cos_theta0));
+    #endif
+    #ifdef FIXED
+    fija_particula_topologia(t, 0);
+    tira_particula_topologia(t, N - 1);
+    #endif
+    cierra_topologia(t);
+    return t;
+}
+
+static int lineal(void) {
+    int N = 50;
+    double x[3*50], F[3*50], F_top[3*50], F_rev[3*50];
+    EstadoPR g;
+    inicializa_PR_r(&g, 11);
+    cadena_ruidosa(N, x, 0.15, &g);
+    Topologia *t = topologia_lineal(N, K_PRUEBA), *r = lineal_al_reves(N);
+    fuerza_cadena(N, x, F);
+    Fuerza_topologia(t, x, F_top, F_PRUEBA);
+    Fuerza_topologia(r, x, F_rev, F_PRUEBA);
+    double d_top = diferencia_maxima(3*N, F, F_top), d_rev = diferencia_maxima(3*N, F, F_rev);
+    // Sin FIXED la topología no tira de nadie y F_cte no cuenta
+    int ok = t->lineal && !r->lineal && r->n_colores_enlaces == 2 && d_top < TOLERANCIA && d_rev < TOLERANCIA
+             && fabs(Energia_topologia(t, x) - Energia_potencial_instantanea(N, x, 1.0, K_PRUEBA)) < TOLERANCIA;
+    printf("Cadena lineal (N = %d): contigua %.1e, coloreada %.1e frente a Fuerza_verlet  %s\n", N, d_top, d_rev,
+           ok ? "PASA" : "FALLA");
+    libera_topologia(t);
+    libera_topologia(r);
+    return ok;
+}
+
+// Ningún color (de enlaces o ángulos) repite partícula
+static int colores_validos(const Topologia *t) {
+    int *visto = malloc(t->N*sizeof(int)), ok = 1;
+    for (int i = 0; i < t->N; i++) visto[i] = -1;
+    for (int c = 0; c < t->n_colores_enlaces; c++)
+        for (int b = t->inicio_color_enlaces[c]; b < t->inicio_color_enlaces[c+1]; b++) {
+            int i = t->enlace_i[b], j = t->enlace_j[b];
+            ok &= visto[i] != c && visto[j] != c;
+            visto[i] = visto[j] = c;
+        }
+    for (int i = 0; i < t->N; i++) visto[i] = -1;
+    for (int c = 0; c < t->n_colores_angulos; c++)
+        for (int n = t->inicio_color_angulos[c]; n < t->inicio_color_angulos[c+1]; n++) {
+            int p[3] = {t->angulo_a[n], t->angulo_b[n], t->angulo_c[n]};
+            for (int k = 0; k < 3; k++) {
+                ok &= visto[p[k]] != c;
+                visto[p[k]] = c;
+            }
+        }
+    free(visto);
+    return ok;
+}
+
+static int colores(void) {
+    // colores = 0: el voraz solo garantiza entre grado_max y 2 grado_max - 1
+    struct { const char *nombre; Topologia *t; int colores, moleculas, grado_max; } casos[] = {
+        {"anillo par (12)",       topologia_anillo(12, K_PRUEBA),         2, 1, 2},
+        {"anillo impar (11)",     topologia_anillo(11, K_PRUEBA),         3, 1, 2},
+        {"estrella (6 x 5)",      topologia_estrella(6, 5, K_PRUEBA),     6, 1, 6},
+        {"cepillo (20, 2, 4)",    topologia_cepillo(20, 2, 4, K_PRUEBA),  0, 1, 3},
+        {"cadenas (4 x 10)",      topologia_cadenas(4, 10, K_PRUEBA),     2, 4, 2},
+    };
+    int todo = 1;
+    for (size_t k = 0; k < sizeof(casos)/sizeof(casos[0]); k++) {
+        Topologia *t = casos[k].t;
+        if (!t) return 0;
+        int grado_max = 0, simetricos = 1;
+        for (int i = 0; i < t->N; i++) {
+            int grado = t->inicio_vecinos[i+1] - t->inicio_vecinos[i];
+            if (grado > grado_max) grado_max = grado;
+            // j es vecino de i si y solo si i es vecino de j
+            for (int p = t->inicio_vecinos[i]; p < t->inicio_vecinos[i+1]; p++) {
+                int j = t->vecinos[p], encontrado = 0;
+                for (int q = t->inicio_vecinos[j]; q < t->inicio_vecinos[j+1]; q++) encontrado |= t->vecinos[q] == i;
+                simetricos &= encontrado;
+            }
+        }
+        int n_colores = t->n_colores_enlaces;
+        int ok = colores_validos(t) && n_colores >= grado_max && n_colores <= 2*grado_max - 1
+                 && (casos[k].colores == 0 || n_colores == casos[k].colores) && t->n_moleculas == casos[k].moleculas
+                 && grado_max == casos[k].grado_max && simetricos && t->inicio_molecula[t->n_moleculas] == t->N;
+        printf("%-20s N = %3d, %3d enlaces en %d colores, %3d ángulos en %d colores, %d moléculas  %s\n",
+               casos[k].nombre, t->N, t->n_enlaces, t->n_colores_enlaces, t->n_angulos, t->n_colores_angulos,
+               t->n_moleculas, ok ? "PASA" : "FALLA");
+        todo &= ok;
+        libera_topologia(t);
+    }
+    return todo;
+}
+
+// Copia los enlaces de 'base' con K y L al azar, sin ángulos ni partículas fijas o tiradas
+static Topologia *enlaces_al_azar(Topologia *base, EstadoPR *g) {
+    Topologia *t = crea_topologia(base->N);
+    for (int b = 0; b < base->n_enlaces; b++)
+        anade_enlace_topologia(t, base->enlace_i[b], base->enlace_j[b], 10.0 + 90.0*fran_r(g), 0.5 + fran_r(g));
+    cierra_topologia(t);
+    libera_topologia(base);
+    return t;
+}
+
+static int gradiente(void) {
+    EstadoPR g;
+    inicializa_PR_r(&g, 23);
+    Topologia *casos[] = {
+        enlaces_al_azar(topologia_anillo(9, K_PRUEBA), &g),
+        enlaces_al_azar(topologia_estrella(4, 3, K_PRUEBA), &g),
+        enlaces_al_azar(topologia_cepillo(8, 3, 2, K_PRUEBA), &g),
+    };
+    int todo = 1;
+    for (int k = 0; k < 3; k++) {
+        Topologia *t = casos[k];
+        int N = t->N;
+        double *x = malloc(3*N*sizeof(double)), *F = malloc(3*N*sizeof(double));
+        nube(N, x, &g);
+        Fuerza_topologia(t, x, F, F_PRUEBA);
+        double error = 0.0, escala = 0.0, h = 1e-6;
+        for (int i = 0; i < 3*N; i++) {
+            double x0 = x[i];
+            x[i] = x0 + h;
+            double V_mas = Energia_topologia(t, x);
+            x[i] = x0 - h;
+            double V_menos = Energia_topologia(t, x);
+            x[i] = x0;
+            double numerica = -(V_mas - V_menos) / (2.0*h);
+            if (fabs(numerica - F[i]) > error) error = fabs(numerica - F[i]);
+            if (fabs(F[i]) > escala) escala = fabs(F[i]);
+        }
+        int ok = error < 1e-6 * escala;
+        printf("Gradiente con K y L por enlace (N = %d, %d colores): error relativo %.1e  %s\n", N,
+               t->n_colores_enlaces, error / escala, ok ? "PASA" : "FALLA");
+        todo &= ok;
+        free(x);
+        free(F);
+        libera_topologia(t);
+    }
+
+    // Sin fijas ni tiradas las fuerzas internas (enlaces y ángulos) suman cero
+    Topologia *anillo = topologia_anillo(10, K_PRUEBA);
+    Topologia *ang = crea_topologia(10);
+    for (int b = 0; b < anillo->n_enlaces; b++) anade_enlace_topologia(ang, anillo->enlace_i[b], anillo->enlace_j[b], K_PRUEBA, L_0);
+    for (int i = 0; i < 10; i++) anade_angulo_topologia(ang, (i + 9) % 10, i, (i + 1) % 10, 5.0, 0.3);
+    cierra_topologia(ang);
+    double x[30], F[30], suma[3] = {0.0, 0.0, 0.0};
+    nube(10, x, &g);
+    Fuerza_topologia(ang, x, F, F_PRUEBA);
+    for (int i = 0; i < 10; i++)
+        for (int d = 0; d < 3; d++) suma[d] += F[3*i + d];
+    double neta = sqrt(suma[0]*suma[0] + suma[1]*suma[1] + suma[2]*suma[2]);
+    int ok = neta < TOLERANCIA && ang->n_colores_angulos >= 3 && colores_validos(ang);
+    printf("Anillo con ángulos: fuerza neta %.1e (%d colores de ángulos)  %s\n", neta, ang->n_colores_angulos,
+           ok ? "PASA" : "FALLA");
+    libera_topologia(anillo);
+    libera_topologia(ang);
+    return todo && ok;
+}
+
+static int varias_cadenas(void) {
+    int n_cadenas = 3, N_cadena = 12, N = n_cadenas * N_cadena;
+    double x[3*N], F[3*N], F_una[3*N_cadena];
+    EstadoPR g;
+    inicializa_PR_r(&g, 31);
+    for (int c = 0; c < n_cadenas; c++) {
+        cadena_ruidosa(N_cadena, x + 3*c*N_cadena, 0.2, &g);
+        for (int i = 0; i < N_cadena; i++) x[3*(c*N_cadena + i)] += 5.0 * c;  // Separadas en x
+    }
+    Topologia *t = topologia_cadenas(n_cadenas, N_cadena, K_PRUEBA);
+    Fuerza_topologia(t, x, F, F_PRUEBA);
+    double d_F = 0.0, d_Rg = 0.0, media = 0.0;
+    for (int c = 0; c < n_cadenas; c++) {
+        fuerza_cadena(N_cadena, x + 3*c*N_cadena, F_una);
+        double d = diferencia_maxima(3*N_cadena, F + 3*c*N_cadena, F_una);
+        if (d > d_F) d_F = d;
+        double Rg = calcula_radio_giro(N_cadena, x + 3*c*N_cadena);
+        media += Rg / n_cadenas;
+        if (fabs(Rg - radio_giro_molecula(t, x, c)) > d_Rg) d_Rg = fabs(Rg - radio_giro_molecula(t, x, c));
+    }
+    int ok = !t->lineal && t->n_moleculas == n_cadenas && d_F < TOLERANCIA && d_Rg < TOLERANCIA
+             && fabs(radio_giro_topologia(t, x) - media) < TOLERANCIA;
+    printf("%d cadenas de %d: fuerzas %.1e y radios de giro %.1e frente a una cadena sola  %s\n", n_cadenas, N_cadena,
+           d_F, d_Rg, ok ? "PASA" : "FALLA");
+    libera_topologia(t);
+    return ok;
+}
+
+// Anillo de n partículas en 1..n (enlace de cierre n-1) con la 0 suelta: con FIXED un_paso_verlet
+// fija la partícula 0, y así no rompe la simetría del anillo
+static Topologia *anillo_con_particula_suelta(int n) {
+    Topologia *t = crea_topologia(n + 1);
+    if (!t) return NULL;
+    int fallo = 0;
+    for (int k = 0; k < n && !fallo; k++) fallo = anade_enlace_topologia(t, 1 + k, 1 + (k + 1) % n, K_PRUEBA, L_0);
+    #ifdef WLCM
+    asegura_flexion();
+    double theta_0 = acos(parametros_flexion.cos_theta0);
+    for (int k = 0; k < n && !fallo; k++) {
+        int centro = 1 + (k + 1) % n;
+        fallo = anade_angulo_topologia(t, 1 + k, centro, 1 + (k + 2) % n, rigidez_flexion(centro), theta_0);
+    }
+    #endif
+    if (fallo || cierra_topologia(t)) {
+        libera_topologia(t);
+        return NULL;
+    }
+    return t;
+}
+
+static int anillo_integrado(void) {
+    int n = 20, N = n + 1, pasos = 20000;
+    double kb = 1.0, T = 1.0, alfa = 1.0, m = 1.0, dt = 0.002;
+    Topologia *t = anillo_con_particula_suelta(n);
+    if (!t) return 0;
+    configura_topologia(t);
+    double *memoria = calloc(7*3*N, sizeof(double));
+    double *x = memoria, *v = memoria + 3*N, *F = memoria + 6*N, *x2 = memoria + 9*N, *v2 = memoria + 12*N;
+    double *F2 = memoria + 15*N, *betta = memoria + 18*N;
+    // Polígono regular de lado L_0 (la partícula 0 se queda en el centro)
+    double R = L_0 / (2.0 * sin(acos(-1.0) / n));
+    for (int i = 0; i < n; i++) {
+        x[3*(1+i)] = R * cos(2.0*acos(-1.0)*i / n);
+        x[3*(1+i) + 1] = R * sin(2.0*acos(-1.0)*i / n);
+    }
+    double a = (1.0 - alfa*dt/(2.0*m)) / (1.0 + alfa*dt/(2.0*m)), b = 1.0 / (1.0 + alfa*dt/(2.0*m));
+    double sigma = sqrt(2.0*alfa*T*kb*dt);
+    #ifdef FIXED
+    Fuerza_verlet_topologia(N, x, F, K_PRUEBA, F_PRUEBA);
+    #else
+    Fuerza_verlet_topologia(N, x, F, K_PRUEBA);
+    #endif
+    inicializa_PR(41);
+    double suma_cierre = 0.0, suma_resto = 0.0;
+    for (int p = 0; p < pasos; p++) {
+        for (int i = 0; i < 3*N; i++) betta[i] = gaussian() * sigma;
+        #ifdef FIXED
+        un_paso_verlet(betta, b, a, N, x, x2, v, v2, F, F2, dt, m, Fuerza_verlet_topologia, K_PRUEBA, F_PRUEBA);
+        #else
+        un_paso_verlet(betta, b, a, N, x, x2, v, v2, F, F2, dt, m, Fuerza_verlet_topologia, K_PRUEBA);
+        #endif
+        memcpy(x, x2, 3*N*sizeof(double));
+        memcpy(v, v2, 3*N*sizeof(double));
+        memcpy(F, F2, 3*N*sizeof(double));
+        for (int k = 0; k < n; k++) {
+            int i = 1 + k, j = 1 + (k + 1) % n;
+            double dx = x[3*j] - x[3*i], dy = x[3*j+1] - x[3*i+1], dz = x[3*j+2] - x[3*i+2];
+            double r = sqrt(dx*dx + dy*dy + dz*dz);
+            if (j == 1) suma_cierre += r;
+            else suma_resto += r / (n - 1);
+        }
+    }
+    // En el anillo todos los enlaces son equivalentes: el de cierre mide como los demás
+    double cierre = suma_cierre / pasos, resto = suma_resto / pasos;
+    int ok = isfinite(cierre) && fabs(cierre - resto) < 0.05 * resto;
+    printf("Anillo integrado (N = %d, %d pasos): enlace de cierre medio %.4f, resto %.4f  %s\n", n, pasos, cierre,
+           resto, ok ? "PASA" : "FALLA");
+    configura_topologia(NULL);
+    libera_topologia(t);
+    free(memoria);
+    return ok;
+}
+
+static int coste(void) {
+    int N = 1000, repeticiones = 2000;
+    double *x = malloc(3*N*sizeof(double)), *F = malloc(3*N*sizeof(double));
+    EstadoPR g;
+    inicializa_PR_r(&g, 53);
+    cadena_ruidosa(N, x, 0.1, &g);
+    Topologia *t = topologia_lineal(N, K_PRUEBA), *r = lineal_al_reves(N);
+    double mejor[3] = {INFINITY, INFINITY, INFINITY};
+    for (int ronda = 0; ronda < RONDAS; ronda++) {
+        double t0 = segundos();
+        for (int k = 0; k < repeticiones; k++) fuerza_cadena(N, x, F);
+        double t1 = segundos();
+        for (int k = 0; k < repeticiones; k++) Fuerza_topologia(t, x, F, F_PRUEBA);
+        double t2 = segundos();
+        for (int k = 0; k < repeticiones; k++) Fuerza_topologia(r, x, F, F_PRUEBA);
+        double t3 = segundos();
+        mejor[0] = fmin(mejor[0], t1 - t0);
+        mejor[1] = fmin(mejor[1], t2 - t1);
+        mejor[2] = fmin(mejor[2], t3 - t2);
+    }
+    double escala = 1e9 / ((double)repeticiones * N);
+    int ok = mejor[1] <= FACTOR_MAXIMO * mejor[0];
+    printf("N = %d: Fuerza_verlet %.2f ns/partícula, topología contigua %.2f, coloreada %.2f  %s\n", N,
+           escala * mejor[0], escala * mejor[1], escala * mejor[2], ok ? "PASA" : "FALLA");
+    libera_topologia(t);
+    libera_topologia(r);
+    free(x);
+    free(F);
+    return ok;
+}
+
+int main(void) {
+    int fallos = 0;
+    if (!lineal()) fallos++;
+    if (!colores()) fallos++;
+    if (!gradiente()) fallos++;
+    if (!varias_cadenas()) fallos++;
+    if (!anillo_integrado()) fallos++;
+    if (!coste()) fallos++;
+    return fallos ? 1 : 0;
+}
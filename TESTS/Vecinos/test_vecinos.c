@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "integracion.h"
+
+/*
+ * Prueba de la lista de vecinos del volumen excluido (vecinos.c).
+ *  1. Las fuerzas WCA con la lista coinciden con el cálculo directo O(N^2) en paseos aleatorios
+ *     de varios tamaños.
+ *  2. Moviendo las partículas poco a poco la lista se reutiliza mientras nadie pasa de media
+ *     piel y sigue dando las mismas fuerzas; al moverse más se reconstruye.
+ *  3. El coste por partícula con la lista no crece con N (O(N)), mientras que el directo sí.
+ * Devuelve 0 si todo pasa y 1 si algo falla.
+ *
+ * Uso: test_vecinos.exe [N_max]
+ */
+
+#define TOLERANCIA 1e-9          // Diferencia relativa máxima con el cálculo directo
+#define FACTOR_LINEALIDAD 3.0    // Máximo cociente entre el coste por partícula con N grande y el mínimo
+
+// Paseo aleatorio de pasos de longitud L_0 (la cadena ideal de partida)
+static void paseo_aleatorio(int N, double x[]) {
+    x[0] = x[1] = x[2] = 0.0;
+    for (int j = 1; j < N; j++) {
+        double cos_t = 2.0*fran() - 1.0, phi = 2.0*M_PI*fran();
+        double sin_t = sqrt(1.0 - cos_t*cos_t);
+        x[3*j]   = x[3*(j-1)]   + L_0*sin_t*cos(phi);
+        x[3*j+1] = x[3*(j-1)+1] + L_0*sin_t*sin(phi);
+        x[3*j+2] = x[3*(j-1)+2] + L_0*cos_t;
+    }
+}
+
+static double diferencia_relativa(int N, double x[]) {
+    double *F_l = calloc(3*N, sizeof(double)), *F_d = calloc(3*N, sizeof(double));
+    Fuerza_volumen_excluido(N, x, F_l);
+    Fuerza_volumen_excluido_directa(N, x, F_d);
+
+    double dif = 0.0, maximo = 1e-300;
+    for (int i = 0; i < 3*N; i++) {
+        if (fabs(F_l[i] - F_d[i]) > dif) dif = fabs(F_l[i] - F_d[i]);
+        if (fabs(F_d[i]) > maximo) maximo = fabs(F_d[i]);
+    }
+    free(F_l); free(F_d);
+    return dif / maximo;
+}
+
+// Devuelve ns por partícula y por llamada
+static double mide(int N, int directa) {
+    double *x = malloc(3*N*sizeof(double)), *F = calloc(3*N, sizeof(double));
+    paseo_aleatorio(N, x);
+    Fuerza_volumen_excluido(N, x, F);  // Construye la lista fuera de la medida
+
+    int llamadas = (int)(2000000 / ((directa ? (double)N*N/20 : N) + 1)) + 1;
+    clock_t inicio = clock();
+    for (int k = 0; k < llamadas; k++) {
+        if (directa) Fuerza_volumen_excluido_directa(N, x, F);
+        else         Fuerza_volumen_excluido(N, x, F);
+    }
+    clock_t fin = clock();
+
+    free(x); free(F);
+    return 1e9*(double)(fin - inicio)/CLOCKS_PER_SEC/((double)llamadas*N);
+}
+
+int main(int argc, char *argv[]) {
+    int N_max = argc > 1 ? atoi(argv[1]) : 100000;
+    int fallos = 0;
+    inicializa_PR(12456);
+
+    // 1. Lista frente a cálculo directo
+    int N_eq[] = {3, 10, 100, 1000, 3000};
+    for (unsigned k = 0; k < sizeof(N_eq)/sizeof(N_eq[0]); k++) {
+        int N = N_eq[k];
+        double *x = malloc(3*N*sizeof(double));
+        paseo_aleatorio(N, x);
+        double dif = diferencia_relativa(N, x);
+        int ok = dif < TOLERANCIA;
+        printf("Lista frente a directo, N = %-5d dif. relativa = %.2e  %s\n", N, dif, ok ? "PASA" : "FALLA");
+        if (!ok) fallos++;
+        free(x);
+    }
+
+    // 2. Reutilización y reconstrucción de la lista
+    {
+        int N = 1000;
+        double *x = malloc(3*N*sizeof(double));
+        paseo_aleatorio(N, x);
+        long r0, r1, r2;
+        diferencia_relativa(N, x);
+        estadisticas_vecinos(&r0, NULL);
+
+        // Desplazamientos acumulados por debajo de media piel: no debe reconstruir
+        double paso = 0.2 * PIEL_VECINOS / sqrt(3.0) / 5.0;
+        double peor = 0.0;
+        for (int k = 0; k < 4; k++) {
+            for (int i = 0; i < 3*N; i++) x[i] += paso * (2.0*fran() - 1.0);
+            double dif = diferencia_relativa(N, x);
+            if (dif > peor) peor = dif;
+        }
+        estadisticas_vecinos(&r1, NULL);
+
+        // Un desplazamiento mayor que media piel: debe reconstruir
+        x[3*(N/2)] += PIEL_VECINOS;
+        double dif = diferencia_relativa(N, x);
+        if (dif > peor) peor = dif;
+        estadisticas_vecinos(&r2, NULL);
+
+        int ok = (r1 == r0) && (r2 == r1 + 1) && peor < TOLERANCIA;
+        printf("Piel: %ld reconstrucciones con movimientos pequeños, %ld tras uno grande, dif. = %.2e  %s\n",
+               r1 - r0, r2 - r1, peor, ok ? "PASA" : "FALLA");
+        if (!ok) fallos++;
+        free(x);
+    }
+
+    // 3. Escalado
+    printf("\n%8s %16s %16s\n", "N", "lista ns/part", "directo ns/part");
+    double minimo = 1e300, ultimo = 0.0;
+    int N_ultimo = 0;
+    for (int N = 1000; N <= N_max; N *= 4) {
+        double c_lista = mide(N, 0);
+        if (N <= 16000) printf("%8d %16.2f %16.2f\n", N, c_lista, mide(N, 1));
+        else            printf("%8d %16.2f %16s\n", N, c_lista, "-");
+        if (c_lista < minimo) minimo = c_lista;
+        ultimo = c_lista;
+        N_ultimo = N;
+    }
+    double cociente = ultimo / minimo;
+    int lineal = cociente < FACTOR_LINEALIDAD;
+    printf("\nCoste por partícula N = %d / mínimo = %.2f -> %s\n", N_ultimo, cociente, lineal ? "PASA (lineal)" : "FALLA");
+    if (!lineal) fallos++;
+
+    libera_vecinos();
+    return fallos ? 1 : 0;
+}